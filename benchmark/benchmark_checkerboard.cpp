@@ -0,0 +1,153 @@
+/**
+  *  Benchmark of the checkerboard breakups against the dense multiplications of exp( -dt K ).
+  *  The B-matrix multiplications, which are called in the wrapping loops of dqmc sweeps,
+  *  are timed with the model linked either to the dense path ( ModelBase::link() )
+  *  or to the checkerboard breakups ( ModelBase::link( checkerboard ) ).
+  *  Model and lattice parameters are read from the toml configuration file,
+  *  and so is the checkerboard method if enabled there ( e.g. the sparse method ),
+  *  otherwise the hand-written breakups of the lattice are used.
+  */
+
+#include <memory>
+#include <string>
+#include <chrono>
+#include <iostream>
+#include <functional>
+
+#include <boost/format.hpp>
+#include <boost/program_options.hpp>
+
+#include "model/model_base.h"
+#include "lattice/lattice_base.h"
+#include "lattice/square.h"
+#include "lattice/cubic.h"
+#include "checkerboard/checkerboard_base.h"
+#include "checkerboard/square.h"
+#include "checkerboard/cubic.h"
+#include "measure/measure_handler.h"
+#include "dqmc_walker.h"
+#include "dqmc_initializer.h"
+#include "svd_stack.h"
+#include "random.h"
+
+
+int main( int argc, char* argv[] ) {
+
+    // ------------------------------------------------------------------------------------------------
+    //                                      Program options
+    // ------------------------------------------------------------------------------------------------
+
+    std::string config_file{};
+    int repeats{};
+
+    boost::program_options::options_description opts("Program options");
+    boost::program_options::variables_map vm;
+
+    opts.add_options()
+        (   "help,h", "display this information" )
+        (   "config,c",
+            boost::program_options::value<std::string>(&config_file)->default_value("../example/config.toml"),
+            "path of the configuration file, default: ../example/config.toml" )
+        (   "repeats,r",
+            boost::program_options::value<int>(&repeats)->default_value(100),
+            "number of repeated multiplications for each kernel, default: 100" );
+
+    try {
+        boost::program_options::store(parse_command_line(argc, argv, opts), vm);
+    }
+    catch ( ... ) {
+        std::cerr << "main(): undefined options got from command line." << std::endl; exit(1);
+    }
+    boost::program_options::notify(vm);
+
+    if ( vm.count("help") ) {
+        std::cerr << argv[0] << "\n" << opts << std::endl;
+        return 0;
+    }
+
+
+    // ------------------------------------------------------------------------------------------------
+    //                                    Initialize the modules
+    // ------------------------------------------------------------------------------------------------
+
+    std::unique_ptr<Model::ModelBase> model;
+    std::unique_ptr<Lattice::LatticeBase> lattice;
+    std::unique_ptr<QuantumMonteCarlo::DqmcWalker> walker;
+    std::unique_ptr<Measure::MeasureHandler> meas_handler;
+    std::unique_ptr<CheckerBoard::CheckerBoardBase> checkerboard;
+
+    QuantumMonteCarlo::DqmcInitializer::parse_toml_config
+        ( config_file, 1, model, lattice, walker, meas_handler, checkerboard );
+
+    if ( !checkerboard ) {
+        if ( lattice->SideLength() % 2 != 0 ) {
+            std::cerr << "main(): the checkerboard breakups require a lattice with even side length." << std::endl;
+            exit(1);
+        }
+        if ( dynamic_cast<const Lattice::Square*>(lattice.get()) ) { checkerboard = std::make_unique<CheckerBoard::Square>(); }
+        else if ( dynamic_cast<const Lattice::Cubic*>(lattice.get()) ) { checkerboard = std::make_unique<CheckerBoard::Cubic>(); }
+        else {
+            std::cerr << "main(): the checkerboard breakups are only implemented for 2d square and 3d cubic lattice." << std::endl;
+            exit(1);
+        }
+    }
+
+    using Matrix = Eigen::MatrixXd;
+    using Kernel = std::function<void( Matrix& )>;
+    const int space_size = lattice->SpaceSize();
+    const int time_index = 1;
+    const int spin = +1;
+
+    const std::vector<std::pair<std::string, Kernel>> kernels = {
+        { "B * G",      [&]( Matrix& mat ) { model->mult_B_from_left( mat, time_index, spin ); } },
+        { "G * B",      [&]( Matrix& mat ) { model->mult_B_from_right( mat, time_index, spin ); } },
+        { "B^-1 * G",   [&]( Matrix& mat ) { model->mult_invB_from_left( mat, time_index, spin ); } },
+        { "G * B^-1",   [&]( Matrix& mat ) { model->mult_invB_from_right( mat, time_index, spin ); } },
+        { "B^T * G",    [&]( Matrix& mat ) { model->mult_transB_from_left( mat, time_index, spin ); } },
+    };
+
+    // time the kernels for both linkings, starting from the identical random matrix
+    const Matrix input = Matrix::Random( space_size, space_size );
+    std::vector<double> time_dense( kernels.size() ), time_checkerboard( kernels.size() );
+    std::vector<double> difference( kernels.size() );
+    std::vector<Matrix> result_dense( kernels.size() );
+
+    for ( const bool is_checkerboard : { false, true } ) {
+        if ( is_checkerboard ) {
+            QuantumMonteCarlo::DqmcInitializer::initial_modules( *model, *lattice, *walker, *meas_handler, *checkerboard );
+        }
+        else {
+            QuantumMonteCarlo::DqmcInitializer::initial_modules( *model, *lattice, *walker, *meas_handler );
+        }
+        Utils::Philox rng( 12345, 0, 0 );
+        model->set_bosonic_fields_to_random( rng );
+
+        for ( auto k = 0; k < (int)kernels.size(); ++k ) {
+            Matrix mat = input;
+            kernels[k].second( mat );
+            if ( is_checkerboard ) { difference[k] = ( mat - result_dense[k] ).cwiseAbs().maxCoeff(); }
+            else { result_dense[k] = mat; }
+
+            mat = input;
+            const auto begin_t = std::chrono::steady_clock::now();
+            for ( auto r = 0; r < repeats; ++r ) {
+                kernels[k].second( mat );
+            }
+            const auto end_t = std::chrono::steady_clock::now();
+            const double time = std::chrono::duration<double, std::micro>(end_t - begin_t).count() / repeats;
+            if ( is_checkerboard ) { time_checkerboard[k] = time; }
+            else { time_dense[k] = time; }
+        }
+    }
+
+    boost::format fmt_head("%| 12s|%| 18s|%| 22s|%| 12s|%| 22s|\n");
+    boost::format fmt_line("%| 12s|%| 18.2f|%| 22.2f|%| 12.2f|%| 22.2e|\n");
+    std::cout << "space size: " << space_size << "\n"
+              << fmt_head % "kernel" % "dense time/us" % "checkerboard time/us" % "speedup" % "max deviation";
+    for ( auto k = 0; k < (int)kernels.size(); ++k ) {
+        std::cout << fmt_line % kernels[k].first % time_dense[k] % time_checkerboard[k]
+                                % ( time_dense[k] / time_checkerboard[k] ) % difference[k];
+    }
+
+    return 0;
+}
@@ -0,0 +1,113 @@
+/**
+  *  Benchmark of the delayed updates of the equal-time greens functions.
+  *  The wall time of Monte Carlo sweeps is recorded against the delay depth k,
+  *  where k = 1 corresponds to the conventional rank-1 updates.
+  *  Model and lattice parameters are read from the toml configuration file.
+  */
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <iostream>
+
+#include <boost/format.hpp>
+#include <boost/program_options.hpp>
+
+#include "model/model_base.h"
+#include "lattice/lattice_base.h"
+#include "checkerboard/checkerboard_base.h"
+#include "measure/measure_handler.h"
+#include "dqmc_walker.h"
+#include "dqmc_initializer.h"
+#include "svd_stack.h"
+#include "random.h"
+
+
+int main( int argc, char* argv[] ) {
+
+    // ------------------------------------------------------------------------------------------------
+    //                                      Program options
+    // ------------------------------------------------------------------------------------------------
+
+    std::string config_file{};
+    int sweeps{};
+    std::vector<int> delay_depths{};
+
+    boost::program_options::options_description opts("Program options");
+    boost::program_options::variables_map vm;
+
+    opts.add_options()
+        (   "help,h", "display this information" )
+        (   "config,c",
+            boost::program_options::value<std::string>(&config_file)->default_value("../example/config.toml"),
+            "path of the configuration file, default: ../example/config.toml" )
+        (   "sweeps,s",
+            boost::program_options::value<int>(&sweeps)->default_value(10),
+            "number of sweeps ( forth and back ) for each delay depth, default: 10" )
+        (   "depths,k",
+            boost::program_options::value<std::vector<int>>(&delay_depths)->multitoken()
+                ->default_value(std::vector<int>{1, 2, 4, 8, 16, 32, 64}, "1 2 4 8 16 32 64"),
+            "delay depths to be benchmarked, default: 1 2 4 8 16 32 64" );
+
+    try {
+        boost::program_options::store(parse_command_line(argc, argv, opts), vm);
+    }
+    catch ( ... ) {
+        std::cerr << "main(): undefined options got from command line." << std::endl; exit(1);
+    }
+    boost::program_options::notify(vm);
+
+    if ( vm.count("help") ) {
+        std::cerr << argv[0] << "\n" << opts << std::endl;
+        return 0;
+    }
+
+
+    // ------------------------------------------------------------------------------------------------
+    //                                    Initialize the modules
+    // ------------------------------------------------------------------------------------------------
+
+    std::unique_ptr<Model::ModelBase> model;
+    std::unique_ptr<Lattice::LatticeBase> lattice;
+    std::unique_ptr<QuantumMonteCarlo::DqmcWalker> walker;
+    std::unique_ptr<Measure::MeasureHandler> meas_handler;
+    std::unique_ptr<CheckerBoard::CheckerBoardBase> checkerboard;
+
+    QuantumMonteCarlo::DqmcInitializer::parse_toml_config
+        ( config_file, 1, model, lattice, walker, meas_handler, checkerboard );
+
+    boost::format fmt_head("%| 15s|%| 20s|%| 20s|%| 15s|\n");
+    boost::format fmt_line("%| 15d|%| 20.3f|%| 20.3f|%| 15.2e|\n");
+    std::cout << fmt_head % "delay depth" % "time per sweep/ms" % "speedup" % "wrap error";
+
+    double time_rank_one = 0.0;
+    for ( const auto delay_depth : delay_depths ) {
+        walker->set_delay_depth( delay_depth );
+
+        if ( checkerboard ) {
+            QuantumMonteCarlo::DqmcInitializer::initial_modules( *model, *lattice, *walker, *meas_handler, *checkerboard );
+        }
+        else {
+            QuantumMonteCarlo::DqmcInitializer::initial_modules( *model, *lattice, *walker, *meas_handler );
+        }
+
+        // identical initial configurations and random streams for all delay depths
+        walker->set_random_key( 12345, 0 );
+        model->set_bosonic_fields_to_random( walker->RandomEngine() );
+        QuantumMonteCarlo::DqmcInitializer::initial_dqmc( *model, *lattice, *walker, *meas_handler );
+
+        const auto begin_t = std::chrono::steady_clock::now();
+        for ( auto sweep = 0; sweep < sweeps; ++sweep ) {
+            walker->sweep_from_0_to_beta( *model );
+            walker->sweep_from_beta_to_0( *model );
+        }
+        const auto end_t = std::chrono::steady_clock::now();
+
+        const double time_per_sweep = std::chrono::duration<double, std::milli>(end_t - begin_t).count() / ( 2 * sweeps );
+        if ( time_rank_one == 0.0 ) { time_rank_one = time_per_sweep; }
+        std::cout << fmt_line % delay_depth % time_per_sweep % ( time_rank_one / time_per_sweep ) % walker->WrapError();
+    }
+
+    return 0;
+}
@@ -0,0 +1,121 @@
+/**
+  *  Benchmark of the spin-parallel mode of DqmcWalker.
+  *  The wall time of Monte Carlo sweeps is recorded with the two spin sectors
+  *  processed one after another and concurrently on two OpenMP threads ( lanes ),
+  *  optionally pinned to the given cpu cores.
+  *  Model and lattice parameters are read from the toml configuration file.
+  */
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <iostream>
+
+#include <boost/format.hpp>
+#include <boost/program_options.hpp>
+
+#include "model/model_base.h"
+#include "lattice/lattice_base.h"
+#include "checkerboard/checkerboard_base.h"
+#include "measure/measure_handler.h"
+#include "dqmc_walker.h"
+#include "dqmc_initializer.h"
+#include "svd_stack.h"
+#include "random.h"
+
+
+int main( int argc, char* argv[] ) {
+
+    // ------------------------------------------------------------------------------------------------
+    //                                      Program options
+    // ------------------------------------------------------------------------------------------------
+
+    std::string config_file{};
+    int sweeps{};
+    int lane_mkl_threads{};
+    std::vector<int> lane_cores{};
+
+    boost::program_options::options_description opts("Program options");
+    boost::program_options::variables_map vm;
+
+    opts.add_options()
+        (   "help,h", "display this information" )
+        (   "config,c",
+            boost::program_options::value<std::string>(&config_file)->default_value("../example/config.toml"),
+            "path of the configuration file, default: ../example/config.toml" )
+        (   "sweeps,s",
+            boost::program_options::value<int>(&sweeps)->default_value(10),
+            "number of sweeps ( forth and back ) for each mode, default: 10" )
+        (   "threads,t",
+            boost::program_options::value<int>(&lane_mkl_threads)->default_value(1),
+            "number of MKL threads inside each lane, default: 1" )
+        (   "cores,p",
+            boost::program_options::value<std::vector<int>>(&lane_cores)->multitoken(),
+            "two cpu cores to which the lanes are pinned, default: not pinned" );
+
+    try {
+        boost::program_options::store(parse_command_line(argc, argv, opts), vm);
+    }
+    catch ( ... ) {
+        std::cerr << "main(): undefined options got from command line." << std::endl; exit(1);
+    }
+    boost::program_options::notify(vm);
+
+    if ( vm.count("help") ) {
+        std::cerr << argv[0] << "\n" << opts << std::endl;
+        return 0;
+    }
+    if ( !lane_cores.empty() && lane_cores.size() != 2 ) {
+        std::cerr << "main(): the lanes should be pinned to two cpu cores." << std::endl; exit(1);
+    }
+
+
+    // ------------------------------------------------------------------------------------------------
+    //                                    Initialize the modules
+    // ------------------------------------------------------------------------------------------------
+
+    std::unique_ptr<Model::ModelBase> model;
+    std::unique_ptr<Lattice::LatticeBase> lattice;
+    std::unique_ptr<QuantumMonteCarlo::DqmcWalker> walker;
+    std::unique_ptr<Measure::MeasureHandler> meas_handler;
+    std::unique_ptr<CheckerBoard::CheckerBoardBase> checkerboard;
+
+    QuantumMonteCarlo::DqmcInitializer::parse_toml_config
+        ( config_file, 1, model, lattice, walker, meas_handler, checkerboard );
+
+    boost::format fmt_head("%| 20s|%| 20s|%| 15s|%| 15s|\n");
+    boost::format fmt_line("%| 20s|%| 20.3f|%| 15.3f|%| 15.2e|\n");
+    std::cout << fmt_head % "mode" % "time per sweep/ms" % "speedup" % "wrap error";
+
+    double time_sequential = 0.0;
+    for ( const bool is_spin_parallel : { false, true } ) {
+        walker->set_spin_parallel( is_spin_parallel, lane_cores, lane_mkl_threads );
+
+        if ( checkerboard ) {
+            QuantumMonteCarlo::DqmcInitializer::initial_modules( *model, *lattice, *walker, *meas_handler, *checkerboard );
+        }
+        else {
+            QuantumMonteCarlo::DqmcInitializer::initial_modules( *model, *lattice, *walker, *meas_handler );
+        }
+
+        // identical initial configurations and random streams for both modes
+        walker->set_random_key( 12345, 0 );
+        model->set_bosonic_fields_to_random( walker->RandomEngine() );
+        QuantumMonteCarlo::DqmcInitializer::initial_dqmc( *model, *lattice, *walker, *meas_handler );
+
+        const auto begin_t = std::chrono::steady_clock::now();
+        for ( auto sweep = 0; sweep < sweeps; ++sweep ) {
+            walker->sweep_from_0_to_beta( *model );
+            walker->sweep_from_beta_to_0( *model );
+        }
+        const auto end_t = std::chrono::steady_clock::now();
+
+        const double time_per_sweep = std::chrono::duration<double, std::milli>(end_t - begin_t).count() / ( 2 * sweeps );
+        if ( !is_spin_parallel ) { time_sequential = time_per_sweep; }
+        std::cout << fmt_line % ( is_spin_parallel? "spin lanes" : "sequential" )
+                              % time_per_sweep % ( time_sequential / time_per_sweep ) % walker->WrapError();
+    }
+
+    return 0;
+}
@@ -0,0 +1,54 @@
+# dqmc modules shared by the unit tests and the benchmarks,
+# i.e. all the sources except the main program, built into the static library dqmc_modules
+# and linked against the dependencies with the same version requirements as the main program.
+# PROJECT_SOURCE_DIR should point to the root of the repository before including this file.
+
+# find MKL
+find_package( MKL MODULE REQUIRED )
+if ( MKL_FOUND )
+    message( STATUS "Found MKL (mkl_include_dir): ${MKL_INCLUDE_DIR}" )
+    message( STATUS "Found MKL (mkl_library_dir): ${MKL_LIBRARY_DIR}" )
+else()
+    message( FATAL_ERROR "MKL not found" )
+endif()
+
+# find MPI
+find_package( MPI MODULE REQUIRED )
+if ( MPI_CXX_FOUND )
+    message( STATUS "Found MPI (mpi_cxx_include_path): ${MPI_CXX_INCLUDE_PATH}" )
+else()
+    message( FATAL_ERROR "MPI not found" )
+endif()
+
+# find Eigen3
+find_package( Eigen3 MODULE 3.4.0 REQUIRED )
+if ( Eigen3_FOUND )
+    message( STATUS "Found Eigen3 (eigen3_include_dir): ${EIGEN3_INCLUDE_DIR}" )
+else()
+    message( FATAL_ERROR "Eigen3 not found" )
+endif()
+
+# find Boost
+set( Boost_USE_RELEASE_lIBS ON )
+set( Boost_USE_MULTITHREAD ON )
+find_package( Boost MODULE 1.71.0 COMPONENTS program_options mpi serialization REQUIRED )
+if ( Boost_FOUND )
+    message( STATUS "Found Boost: version ${Boost_VERSION}" )
+    message( STATUS "Found Boost (boost_include_dirs): ${Boost_INCLUDE_DIRS}" )
+    message( STATUS "Found Boost (boost_library_dirs): ${Boost_LIBRARY_DIRS}" )
+else()
+    message( FATAL_ERROR "Boost not found" )
+endif()
+
+# link the dependencies to the target with the given scope
+function( dqmc_link_dependencies TARGET SCOPE )
+    target_include_directories( ${TARGET} ${SCOPE} ${MKL_INCLUDE_DIR} ${MPI_CXX_INCLUDE_PATH} ${Boost_INCLUDE_DIRS} )
+    target_link_libraries( ${TARGET} ${SCOPE} ${MKL_LIBRARIES} MPI::MPI_CXX Eigen3::Eigen ${Boost_LIBRARIES} )
+endfunction()
+
+# dqmc modules, excluding the main program
+file( GLOB DQMC_MODULE_FILE ${PROJECT_SOURCE_DIR}/src/*.cpp ${PROJECT_SOURCE_DIR}/src/*/*.cpp )
+list( REMOVE_ITEM DQMC_MODULE_FILE ${PROJECT_SOURCE_DIR}/src/dqmc_main.cpp )
+add_library( dqmc_modules STATIC ${DQMC_MODULE_FILE} )
+target_include_directories( dqmc_modules PUBLIC ${PROJECT_SOURCE_DIR}/include )
+dqmc_link_dependencies( dqmc_modules PUBLIC )
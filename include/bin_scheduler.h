@@ -0,0 +1,74 @@
+#ifndef BIN_SCHEDULER_H
+#define BIN_SCHEDULER_H
+#pragma once
+
+
+/**
+  *  This header file defines QuantumMonteCarlo::BinScheduler class for the dynamic scheduling of bins,
+  *  in which the MPI processes draw the measuring bins one by one from a counter shared among them,
+  *  until the total number of bins is reached.
+  *  Faster processes thereby measure more bins, and no process idles waiting for the slowest one,
+  *  which is favorable on heterogeneous nodes or when the cost of sweeps fluctuates among the processes.
+  */
+
+#include <mpi.h>
+#include <boost/mpi/communicator.hpp>
+
+
+namespace QuantumMonteCarlo {
+
+    // ------------------------------ Crucial class QuantumMonteCarlo::BinScheduler ------------------------------
+    class BinScheduler {
+        private:
+
+            int m_bin_num{};                        // total number of bins to be measured by all the processes
+            int m_bins_taken{};                     // number of bins drawn by this process
+            int m_procs_num{};                      // number of processes sharing the counter
+
+            // the shared counter lives in a one-sided MPI window exposed by the master process,
+            // and is atomically fetched and incremented by the processes without involving the master.
+            MPI_Comm m_comm{MPI_COMM_NULL};
+            MPI_Win m_window{MPI_WIN_NULL};
+            long* m_counter{nullptr};
+
+
+        public:
+
+            BinScheduler() = default;
+            ~BinScheduler();
+
+            BinScheduler( const BinScheduler& ) = delete;
+            BinScheduler& operator=( const BinScheduler& ) = delete;
+
+            // ------------------------------------------ Interfaces -----------------------------------------------
+
+            const int BinsNum() const       { return this->m_bin_num; }
+            const int BinsTaken() const     { return this->m_bins_taken; }
+            const int ProcessesNum() const  { return this->m_procs_num; }
+
+            // expected number of bins per process, if all the processes run at the same pace
+            const int ExpectedBinsPerProc() const { 
+                return ( this->m_procs_num > 0 )? ( this->m_bin_num + this->m_procs_num - 1 ) / this->m_procs_num : 0; 
+            }
+
+
+            // ------------------------------------------ Setup and scheduling ------------------------------------------
+
+            // create the shared counter of bins, collective over the processes of the communicator.
+            // for a restarted simulation, 'bins_done' is the number of bins this process restored from its checkpoint,
+            // and the counter starts from the total number of bins restored by all the processes.
+            void initial( const boost::mpi::communicator& comm, int bin_num, int bins_done = 0 );
+
+            // draw the next bin from the shared counter, 
+            // returning false if all the bins have been drawn by the processes
+            bool acquire_bin();
+
+            // release the shared counter, collective over the processes of the communicator
+            void deallocate();
+
+    };
+
+} // namespace QuantumMonteCarlo
+
+
+#endif // BIN_SCHEDULER_H
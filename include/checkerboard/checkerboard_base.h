@@ -22,6 +22,7 @@ namespace CheckerBoard {
 
     using Site = std::vector<int>;
     using Matrix = Eigen::MatrixXd;
+    using Vector = Eigen::VectorXd;
     using RealScalar = double;
 
     using ModelBase = Model::ModelBase;
@@ -46,6 +47,14 @@ namespace CheckerBoard {
             virtual void mult_inv_expK_from_right   ( Matrix &matrix ) const = 0;
             virtual void mult_trans_expK_from_left  ( Matrix &matrix ) const = 0;
 
+            // multiply the exponent of hopping matrix K together with a diagonal matrix D, e.g. exp( -dt V ),
+            // where the scaling of the rows ( columns ) by D is performed within the first or the last pass over the matrix
+            virtual void mult_diag_expK_from_left       ( Matrix &matrix, const Vector& diag ) const = 0;    // D * expK * M
+            virtual void mult_diag_expK_from_right      ( Matrix &matrix, const Vector& diag ) const = 0;    // M * D * expK
+            virtual void mult_inv_expK_diag_from_left   ( Matrix &matrix, const Vector& diag ) const = 0;    // expK^-1 * D * M
+            virtual void mult_inv_expK_diag_from_right  ( Matrix &matrix, const Vector& diag ) const = 0;    // M * expK^-1 * D
+            virtual void mult_trans_expK_diag_from_left ( Matrix &matrix, const Vector& diag ) const = 0;    // expK^T * D * M
+
     };
 
 } // namespace CheckerBoard 
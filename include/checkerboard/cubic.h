@@ -3,6 +3,85 @@
 #pragma once
 
 
+/**
+  *  This header file defines the CheckerBoard::Cubic class for the checkerboard breakups
+  *  of 3d cubic lattice, which is derived from the base class CheckerBoard::Base .
+  *  The nearest-neighbour bonds are divided into six families of disjoint bonds,
+  *  labeled by the direction (x,y,z) and the parity of the starting site along it.
+  *  Notice that the break-ups can only be applied to the cubic lattice with even side length.
+  */
 
+#include <array>
+#include <vector>
+#include "checkerboard/checkerboard_base.h"
 
-#endif // CHECKERBOARD_CUBIC_H
\ No newline at end of file
+
+namespace CheckerBoard {
+
+
+    // ---------------------------- Derived Checkerboard class CheckerBoard::Cubic -----------------------------
+    class Cubic : public CheckerBoardBase {
+        private:
+
+            using Bond = std::array<int,2>;
+            using BondFamily = std::vector<Bond>;
+
+            int m_side_length{};                // side length of the lattice
+            int m_space_size{};                 // total number of sites
+            RealScalar m_hopping_t{};
+            RealScalar m_chemical_potential{};
+            RealScalar m_time_interval{};
+
+            // exponent of (inverse) hopping within one bond
+            Eigen::Matrix2d m_expK_bond{};
+            Eigen::Matrix2d m_inv_expK_bond{};
+
+            // site indexes of the two ends of each bond, which are tabulated during initialization.
+            // families are ordered as (x,even), (x,odd), (y,even), (y,odd), (z,even), (z,odd),
+            // and exp( -dt K ) is approximated by the product of the exponents of the six families in this order.
+            std::array<BondFamily, 6> m_bond_families{};
+
+
+        public:
+            // set up parameters
+            void set_checkerboard_params( const LatticeBase& lattice,
+                                          const ModelBase& model,
+                                          const DqmcWalker& walker );
+
+            // initialization
+            void initial();
+
+            // multiply the exponent of hopping matrix K using checkerboard breakups
+            void mult_expK_from_left        ( Matrix &matrix ) const ;
+            void mult_expK_from_right       ( Matrix &matrix ) const ;
+            void mult_inv_expK_from_left    ( Matrix &matrix ) const ;
+            void mult_inv_expK_from_right   ( Matrix &matrix ) const ;
+            void mult_trans_expK_from_left  ( Matrix &matrix ) const ;
+
+            // multiply the exponent of hopping matrix K together with a diagonal matrix D
+            void mult_diag_expK_from_left       ( Matrix &matrix, const Vector& diag ) const ;
+            void mult_diag_expK_from_right      ( Matrix &matrix, const Vector& diag ) const ;
+            void mult_inv_expK_diag_from_left   ( Matrix &matrix, const Vector& diag ) const ;
+            void mult_inv_expK_diag_from_right  ( Matrix &matrix, const Vector& diag ) const ;
+            void mult_trans_expK_diag_from_left ( Matrix &matrix, const Vector& diag ) const ;
+
+
+        private:
+            // tabulate the bonds along the given direction ( 0,1,2 for x,y,z ) starting from sites of the given parity
+            void initial_bond_family( BondFamily& bonds, int direction, int parity ) const ;
+
+            // multiply the 2*2 exponent of hopping matrix within every bond of one family,
+            // namely the rows ( from left ) or columns ( from right ) of the two end sites are mixed in place.
+            // optionally the end sites are scaled by the diagonal matrices diag_before and diag_after,
+            // which is exact since the bonds of each family cover every site exactly once.
+            void mult_bonds_from_left   ( Matrix &matrix, const Eigen::Matrix2d& bond_mat, const BondFamily& bonds,
+                                          const Vector* diag_before = nullptr, const Vector* diag_after = nullptr ) const ;
+            void mult_bonds_from_right  ( Matrix &matrix, const Eigen::Matrix2d& bond_mat, const BondFamily& bonds,
+                                          const Vector* diag_before = nullptr, const Vector* diag_after = nullptr ) const ;
+    };
+
+
+} // namespace CheckerBoard
+
+
+#endif // CHECKERBOARD_CUBIC_H
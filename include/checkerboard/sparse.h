@@ -0,0 +1,92 @@
+#ifndef CHECKERBOARD_SPARSE_H
+#define CHECKERBOARD_SPARSE_H
+#pragma once
+
+
+/**
+  *  This header file defines the CheckerBoard::Sparse class, derived from the base class CheckerBoard::Base,
+  *  which is not a checkerboard breakup but a general fallback for lattices without hand-written breakups.
+  *  The exponent of the hopping matrix exp( -dt K ) is computed exactly,
+  *  and the elements smaller than a given threshold, relative to the 1-norm of the matrix, are dropped,
+  *  so that it can be stored in the compressed sparse format and multiplied efficiently.
+  */
+
+#include "checkerboard/checkerboard_base.h"
+#include <Eigen/SparseCore>
+
+
+namespace CheckerBoard {
+
+
+    // ---------------------------- Derived Checkerboard class CheckerBoard::Sparse -----------------------------
+    class Sparse : public CheckerBoardBase {
+        private:
+
+            // compressed sparse column format, for which the products G * S of
+            // column-major dense G and sparse S reduce to contiguous column updates of G
+            using SparseMatrix = Eigen::SparseMatrix<double, Eigen::ColMajor>;
+
+            int m_space_size{};                 // total number of sites
+            RealScalar m_hopping_t{};
+            RealScalar m_chemical_potential{};
+            RealScalar m_time_interval{};
+            Matrix m_hopping_matrix{};
+
+            // elements of exp( -dt K ) with absolute values smaller than the threshold
+            // times the 1-norm of exp( -dt K ) are dropped
+            RealScalar m_threshold{1e-12};
+
+            // deviation max| exp(-dtK) * exp(+dtK) - I | of the truncated matrices from the identity
+            RealScalar m_inverse_error{};
+
+            // exponent of (inverse) hopping matrix and their transposes in sparse format,
+            // and the products from the left are performed as S * G = ( G^T * S^T )^T
+            SparseMatrix m_expK_mat{};
+            SparseMatrix m_inv_expK_mat{};
+            SparseMatrix m_trans_expK_mat{};
+            SparseMatrix m_trans_inv_expK_mat{};
+
+            // scratch matrix of the calling thread for the sparse-dense products
+            Matrix& thread_buffer() const;
+
+
+        public:
+            // set up the threshold below which the elements of exp( -dt K ) are dropped
+            void set_threshold( RealScalar threshold );
+
+            const RealScalar Threshold() const { return this->m_threshold; }
+
+            // fraction of the nonzero elements of exp( -dt K ) after truncation
+            const RealScalar Density() const;
+
+            // deviation of the truncated exp( -dt K ) * exp( +dt K ) from the identity
+            const RealScalar InverseError() const { return this->m_inverse_error; }
+
+            // set up parameters
+            void set_checkerboard_params( const LatticeBase& lattice,
+                                          const ModelBase& model,
+                                          const DqmcWalker& walker );
+
+            // initialization
+            void initial();
+
+            // multiply the exponent of hopping matrix K using sparse-dense matrix products
+            void mult_expK_from_left        ( Matrix &matrix ) const ;
+            void mult_expK_from_right       ( Matrix &matrix ) const ;
+            void mult_inv_expK_from_left    ( Matrix &matrix ) const ;
+            void mult_inv_expK_from_right   ( Matrix &matrix ) const ;
+            void mult_trans_expK_from_left  ( Matrix &matrix ) const ;
+
+            // multiply the exponent of hopping matrix K together with a diagonal matrix D
+            void mult_diag_expK_from_left       ( Matrix &matrix, const Vector& diag ) const ;
+            void mult_diag_expK_from_right      ( Matrix &matrix, const Vector& diag ) const ;
+            void mult_inv_expK_diag_from_left   ( Matrix &matrix, const Vector& diag ) const ;
+            void mult_inv_expK_diag_from_right  ( Matrix &matrix, const Vector& diag ) const ;
+            void mult_trans_expK_diag_from_left ( Matrix &matrix, const Vector& diag ) const ;
+    };
+
+
+} // namespace CheckerBoard
+
+
+#endif // CHECKERBOARD_SPARSE_H
@@ -9,6 +9,8 @@
   *  Notice that the break-ups can only be applied to the square lattice with even side length.
   */
 
+#include <array>
+#include <vector>
 #include "checkerboard/checkerboard_base.h"
 
 
@@ -29,6 +31,13 @@ namespace CheckerBoard {
             Eigen::Matrix4d m_expK_plaquette{};
             Eigen::Matrix4d m_inv_expK_plaquette{};
 
+            // site indexes of the four corners of each plaquette,
+            // which are tabulated separately for the sublattice A and B during initialization
+            // to avoid index calculations and heap allocations in the wrapping loops
+            using Plaquette = std::array<int,4>;
+            std::vector<Plaquette> m_plaquettes_a{};
+            std::vector<Plaquette> m_plaquettes_b{};
+
 
         public:
             // set up parameters
@@ -46,13 +55,30 @@ namespace CheckerBoard {
             void mult_inv_expK_from_right   ( Matrix &matrix ) const ;
             void mult_trans_expK_from_left  ( Matrix &matrix ) const ;
 
+            // multiply the exponent of hopping matrix K together with a diagonal matrix D
+            void mult_diag_expK_from_left       ( Matrix &matrix, const Vector& diag ) const ;
+            void mult_diag_expK_from_right      ( Matrix &matrix, const Vector& diag ) const ;
+            void mult_inv_expK_diag_from_left   ( Matrix &matrix, const Vector& diag ) const ;
+            void mult_inv_expK_diag_from_right  ( Matrix &matrix, const Vector& diag ) const ;
+            void mult_trans_expK_diag_from_left ( Matrix &matrix, const Vector& diag ) const ;
+
 
         private:
-            // multiply hopping matrix K within single plaquette, labeled by site vector
-            void mult_expK_plaquette_from_left       ( Matrix &matrix, const Site& site ) const ;
-            void mult_expK_plaquette_from_right      ( Matrix &matrix, const Site& site ) const ;
-            void mult_inv_expK_plaquette_from_left   ( Matrix &matrix, const Site& site ) const ;
-            void mult_inv_expK_plaquette_from_right  ( Matrix &matrix, const Site& site ) const ;
+            // tabulate the corner sites of the plaquettes with upper-left conner (x,y) of the given parity
+            void initial_plaquettes( std::vector<Plaquette>& plaquettes, int parity ) const ;
+
+            // multiply the 4*4 exponent of hopping matrix within every plaquette of one sublattice,
+            // namely the rows ( from left ) or columns ( from right ) of the four corner sites are mixed in place.
+            // optionally the corner sites are scaled by the diagonal matrices diag_before and diag_after,
+            // i.e. P is replaced by diag_after * P * diag_before ( from left ) or diag_before * P * diag_after ( from right ).
+            void mult_plaquettes_from_left   ( Matrix &matrix, const Eigen::Matrix4d& plaquette_mat, 
+                                               const std::vector<Plaquette>& plaquettes,
+                                               const Vector* diag_before = nullptr, 
+                                               const Vector* diag_after = nullptr ) const ;
+            void mult_plaquettes_from_right  ( Matrix &matrix, const Eigen::Matrix4d& plaquette_mat, 
+                                               const std::vector<Plaquette>& plaquettes,
+                                               const Vector* diag_before = nullptr, 
+                                               const Vector* diag_after = nullptr ) const ;
     };
 
 
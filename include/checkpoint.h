@@ -0,0 +1,108 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+#pragma once
+
+
+/**
+  *  This header file defines QuantumMonteCarlo::Checkpoint class for the checkpoints and restarts of the simulation.
+  *  Each MPI process periodically stores its full state into its own binary file,
+  *  namely the bosonic fields and the random engines of its walkers, the progress of the warm-up and the measurements,
+  *  the bins collected so far and the counters of the replica exchanges,
+  *  so that a long simulation can be split into several jobs and resumed where the previous one stopped.
+  */
+
+#include <string>
+#include <boost/mpi/communicator.hpp>
+
+namespace Model { class ModelBase; }
+namespace Lattice { class LatticeBase; }
+namespace Measure { class MeasureHandler; }
+
+
+namespace QuantumMonteCarlo {
+
+    // forward declaration
+    class DqmcWalker;
+    class ReplicaExchange;
+    struct WalkerPool;
+
+    using ModelBase = Model::ModelBase;
+    using LatticeBase = Lattice::LatticeBase;
+    using MeasureHandler = Measure::MeasureHandler;
+
+
+    // ------------------------------ Crucial class QuantumMonteCarlo::Checkpoint ------------------------------
+    class Checkpoint {
+        private:
+
+            std::string m_folder{};                 // folder of the checkpoint files
+            std::string m_file{};                   // checkpoint file of the current process
+            int m_rank{};                           // rank of the current process in the world communicator
+            int m_world_size{};
+
+            int m_warmup_interval{};                // number of warm-up sweeps between two checkpoints
+            int m_bin_interval{};                   // number of bins between two checkpoints
+
+            // progress restored from the checkpoint, i.e. the numbers of warm-up sweeps and of bins done
+            int m_warmup_sweeps_done{};
+            int m_bins_done{};
+
+
+        public:
+
+            Checkpoint() = default;
+
+            // ------------------------------------------ Interfaces -----------------------------------------------
+
+            const std::string& Folder() const           { return this->m_folder; }
+            const std::string& File() const             { return this->m_file; }
+            const int WarmUpInterval() const            { return this->m_warmup_interval; }
+            const int BinInterval() const               { return this->m_bin_interval; }
+            const int WarmUpSweepsDone() const          { return this->m_warmup_sweeps_done; }
+            const int BinsDone() const                  { return this->m_bins_done; }
+
+
+            // ------------------------------------------ Setup and initialization ------------------------------------------
+
+            // set up the paces of the checkpoints, where non-positive intervals disable the periodic checkpoints
+            void set_params( int warmup_interval, int bin_interval );
+
+            // set up the folder of the checkpoint files, which is created by the master process if not exist,
+            // and each process stores its state into the file 'rank_<rank>.ckpt' under the folder
+            void initial( const boost::mpi::communicator& world, const std::string& folder );
+
+
+            // ------------------------------------------ Save and restore ------------------------------------------
+
+            // store the state of the process after the given numbers of warm-up sweeps and bins,
+            // which should be called at the end of a sweep from beta to 0, with no samples pending in the current bin.
+            // the file is first written into a temporary file and then renamed,
+            // so that the previous checkpoint survives an interruption during the writing.
+            void save( int warmup_sweeps_done,
+                       int bins_done,
+                       const LatticeBase& lattice,
+                       const DqmcWalker& walker,
+                       const ModelBase& model,
+                       const MeasureHandler& meas_handler,
+                       const WalkerPool& walker_pool,
+                       const ReplicaExchange* replica_exchange ) const;
+
+            // restore the state of the process from its checkpoint file,
+            // which should be called after the modules and the walker pool have been initialized
+            // with the same configurations as the run that wrote the checkpoint.
+            // a checkpoint of different model, lattice or imaginary-time parameters is refused.
+            // the greens functions of the walkers are recomputed from the restored fields.
+            void restore( const boost::mpi::communicator& world,
+                          const LatticeBase& lattice,
+                          DqmcWalker& walker,
+                          ModelBase& model,
+                          MeasureHandler& meas_handler,
+                          WalkerPool& walker_pool,
+                          ReplicaExchange* replica_exchange );
+
+    };
+
+} // namespace QuantumMonteCarlo
+
+
+#endif // CHECKPOINT_H
@@ -13,6 +13,9 @@
 
 
 #include <chrono>
+#include <memory>
+#include <vector>
+#include <functional>
 
 namespace Model { class ModelBase; }
 namespace Lattice { class LatticeBase; }
@@ -23,10 +26,24 @@ namespace QuantumMonteCarlo {
 
     // forward declaration
     class DqmcWalker;
+    class BinScheduler;
 
     using ModelBase = Model::ModelBase;
     using LatticeBase = Lattice::LatticeBase;
     using MeasureHandler = Measure::MeasureHandler;
+
+
+    // ----------------------------------- Struct QuantumMonteCarlo::WalkerPool -----------------------------------
+    // companion walkers running alongside the main walker of the process, each with its own model ( bosonic fields ) 
+    // and measure handler, while the lattice, the checkerboard and the exponents of K are shared with the main walker.
+    // the measured samples of the companions are merged into the main measure handler at the bin boundaries.
+    struct WalkerPool {
+        std::vector<std::unique_ptr<DqmcWalker>> walkers{};
+        std::vector<std::unique_ptr<ModelBase>> models{};
+        std::vector<std::unique_ptr<MeasureHandler>> meas_handlers{};
+
+        const int size() const { return this->walkers.size(); }
+    };
     
 
     // -------------------------------- Pure interface class QuantumMonteCarlo::Dqmc --------------------------------
@@ -54,20 +71,44 @@ namespace QuantumMonteCarlo {
             // end the timer
             static void timer_end();
 
+            // set up the hook called for the main walker at the end of every sweep forth and back,
+            // e.g. for the exchanges of configurations between replicas
+            using SweepHook = std::function<void( DqmcWalker&, ModelBase& )>;
+            static void set_sweep_hook( const SweepHook& sweep_hook );
+
+            // set up the hook for the checkpoints, called with the numbers of warm-up sweeps and of bins done
+            // every 'warmup_interval' warm-up sweeps and every 'bin_interval' bins,
+            // where non-positive intervals disable the corresponding checkpoints
+            using CheckpointHook = std::function<void( int, int )>;
+            static void set_checkpoint_hook( const CheckpointHook& checkpoint_hook, int warmup_interval, int bin_interval );
+
+            // set up the point where a restarted simulation resumes,
+            // namely the numbers of warm-up sweeps and of bins already done
+            static void set_resume_point( int warmup_sweeps_done, int bins_done );
+
             
             // ------------------------------------ Crucial Dqmc routines -------------------------------------
             
-            // thermalization of the field configurations
+            // thermalization of the field configurations,
+            // together with the companion walkers in the walker pool if provided,
+            // which starts from the resume point if set
             static void thermalize           ( DqmcWalker& walker, 
                                                ModelBase& model,
                                                LatticeBase& lattice,  
-                                               MeasureHandler& meas_handler );
+                                               MeasureHandler& meas_handler,
+                                               WalkerPool* walker_pool = nullptr );
             
-            // Monte Carlo updates and measurments
+            // Monte Carlo updates and measurments,
+            // with the samples of the companion walkers merged into meas_handler bin by bin.
+            // if the bin scheduler is provided, the bins are drawn from the counter shared by the processes
+            // until all of them are taken, and meas_handler is truncated to the bins measured by this process.
+            // the bins before the resume point are assumed to be restored already.
             static void measure              ( DqmcWalker& walker, 
                                                ModelBase& model,
                                                LatticeBase& lattice,  
-                                               MeasureHandler& meas_handler );
+                                               MeasureHandler& meas_handler,
+                                               WalkerPool* walker_pool = nullptr,
+                                               BinScheduler* bin_scheduler = nullptr );
 
             // analyse the measured data
             static void analyse              ( MeasureHandler& meas_handler );
@@ -83,6 +124,10 @@ namespace QuantumMonteCarlo {
             static char m_progress_bar_complete_char, m_progress_bar_incomplete_char;
             
             static std::chrono::steady_clock::time_point m_begin_time, m_end_time;
+            static SweepHook m_sweep_hook;
+            static CheckpointHook m_checkpoint_hook;
+            static int m_checkpoint_warmup_interval, m_checkpoint_bin_interval;
+            static int m_resume_warmup_sweeps, m_resume_bins;
 
             // sweep and update the field configurations 
             // from 0 to beta and back from beta to 0
@@ -92,6 +137,15 @@ namespace QuantumMonteCarlo {
                                                LatticeBase& lattice, 
                                                MeasureHandler& meas_handler );
 
+            // run the task for the main walker ( labeled by 0 ) and the companion walkers ( labeled by 1,2... ) 
+            // concurrently on OpenMP threads, with one MKL thread inside each walker if there are companions
+            using WalkerTask = std::function<void( DqmcWalker&, ModelBase&, MeasureHandler&, int )>;
+            static void run_walkers          ( DqmcWalker& walker, 
+                                               ModelBase& model,
+                                               MeasureHandler& meas_handler,
+                                               WalkerPool* walker_pool,
+                                               const WalkerTask& task );
+
     };
 
 }
@@ -22,6 +22,9 @@ namespace QuantumMonteCarlo {
 
     // forward declaration
     class DqmcWalker;
+    class ReplicaExchange;
+    class Checkpoint;
+    struct WalkerPool;
 
     using LatticeBase = Lattice::LatticeBase;
     using ModelBase = Model::ModelBase;
@@ -33,6 +36,8 @@ namespace QuantumMonteCarlo {
     using CheckerBoardBasePtr = std::unique_ptr<CheckerBoard::CheckerBoardBase>;
     using MeasureHandlerPtr = std::unique_ptr<Measure::MeasureHandler>;
     using DqmcWalkerPtr = std::unique_ptr<DqmcWalker>;
+    using ReplicaExchangePtr = std::unique_ptr<ReplicaExchange>;
+    using CheckpointPtr = std::unique_ptr<Checkpoint>;
     
     using MomentumIndex = int;
     using MomentumIndexList = std::vector<int>;
@@ -53,6 +58,20 @@ namespace QuantumMonteCarlo {
                                                       CheckerBoardBasePtr& checkerboard );
 
 
+            // parse the parameters of the replica exchanges ( parallel tempering ) from the toml configuration file,
+            // and the replica exchange object is created only if enabled in the config.
+            // this should be done before parse_toml_config(), since the bins of measurements are distributed
+            // among the processes of the same replica.
+            static void parse_replica_exchange      ( std::string_view toml_config,
+                                                      int world_size,
+                                                      ReplicaExchangePtr& replica_exchange );
+
+            // parse the paces of the checkpoints from the toml configuration file,
+            // and the checkpoint object is created only if enabled in the config.
+            static void parse_checkpoint            ( std::string_view toml_config,
+                                                      CheckpointPtr& checkpoint );
+
+
             // initialize modules including Lattice, Model, DqmcWalker and MeasureHandler
             // without checkerboard breakups.
             static void initial_modules             ( ModelBase& model, 
@@ -77,6 +96,17 @@ namespace QuantumMonteCarlo {
                                                       DqmcWalker& walker,
                                                       MeasureHandler& meas_handler );
 
+
+            // create and initialize the companion walkers of the walker pool, according to walker.WalkerPoolSize(),
+            // with the models cloned from the initialized model and the same parameters as the main walker.
+            // the random streams of the companions are labeled by the walker ids 1,2... 
+            // and the fields of the companions should be set up before initial_dqmc() is called for each of them.
+            static void create_walker_pool          ( const ModelBase& model, 
+                                                      LatticeBase& lattice, 
+                                                      const DqmcWalker& walker,
+                                                      const MeasureHandler& meas_handler,
+                                                      WalkerPool& walker_pool );
+
     };
 
 } // namespace QuantumMonteCarlo
@@ -16,6 +16,7 @@
 
 #include "dqmc.h"
 #include "dqmc_walker.h"
+#include "replica_exchange.h"
 
 #include "model/model_base.h"
 #include "model/repulsive_hubbard.h"
@@ -27,8 +28,10 @@
 #include "lattice/honeycomb.h"
 
 #include "checkerboard/checkerboard_base.h"
+#include "checkerboard/sparse.h"
 #include "measure/measure_handler.h"
 #include "measure/observable.h"
+#include "utils/binary_bins.hpp"
 
 
 namespace QuantumMonteCarlo {
@@ -61,6 +64,15 @@ namespace QuantumMonteCarlo {
             template<typename StreamType>
             static void output_ending_info            ( StreamType& ostream, const DqmcWalker& walker );
 
+            // output the parameters of the replica exchanges ( parallel tempering )
+            template<typename StreamType>
+            static void output_replica_exchange_info  ( StreamType& ostream, const ReplicaExchange& replica_exchange );
+
+            // output the acceptance statistics of the exchanges between neighbouring replicas,
+            // which should be gathered from all the processes in advance
+            template<typename StreamType>
+            static void output_exchange_statistics    ( StreamType& ostream, const ReplicaExchange& replica_exchange );
+
             // output the mean value and error bar of one specific observable
             template<typename StreamType, typename ObsType>
             static void output_observable             ( StreamType& ostream, const Observable::Observable<ObsType>& obs );
@@ -68,6 +80,16 @@ namespace QuantumMonteCarlo {
             // output the bin data of one specific observable
             template<typename StreamType, typename ObsType>
             static void output_observable_in_bins     ( StreamType& ostream, const Observable::Observable<ObsType>& obs );
+
+            // output the bin data of one specific observable into the binary container of Utils::BinaryBins,
+            // which is written directly from the storage of the bins
+            template<typename ObsType>
+            static void output_observable_in_binary_bins ( std::ofstream& ofstream, const Observable::Observable<ObsType>& obs );
+
+            // output the jackknife estimates and the integrated autocorrelation time of one specific observable,
+            // where the largest autocorrelation time over the elements is shown for vector and matrix observables
+            template<typename StreamType, typename ObsType>
+            static void output_observable_analysis    ( StreamType& ostream, const Observable::Observable<ObsType>& obs );
             
             // output list of inequivalent momentum points ( k stars )
             template<typename StreamType>
@@ -117,6 +139,7 @@ namespace QuantumMonteCarlo {
             boost::format fmt_param_str("%| 30s|%| 7s|%| 24s|\n");
             boost::format fmt_param_int("%| 30s|%| 7s|%| 24d|\n");
             boost::format fmt_param_double("%| 30s|%| 7s|%| 24.3f|\n");
+            boost::format fmt_param_sci("%| 30s|%| 7s|%| 24.2e|\n");
             const std::string_view joiner = "->";
             auto bool2str = [](bool b) {if (b) return "True"; else return "False";};
 
@@ -204,8 +227,15 @@ namespace QuantumMonteCarlo {
             // -------------------------------------------------------------------------------------------
             //                              Output CheckerBoard information
             // -------------------------------------------------------------------------------------------
-            ostream << fmt_param_str % "Checkerboard breakups" % joiner % bool2str((bool)checkerboard)
-                    << std::endl;
+            const auto sparse_checkerboard = dynamic_cast<const CheckerBoard::Sparse*>(checkerboard.get());
+            ostream << fmt_param_str % "Checkerboard breakups" % joiner % bool2str((bool)checkerboard && !sparse_checkerboard)
+                    << fmt_param_str % "Sparse exp(-dtK)" % joiner % bool2str((bool)sparse_checkerboard);
+            if ( sparse_checkerboard ) {
+                ostream << fmt_param_sci % "Sparse threshold" % joiner % sparse_checkerboard->Threshold()
+                        << fmt_param_double % "Sparse density" % joiner % sparse_checkerboard->Density()
+                        << fmt_param_sci % "Sparse inverse error" % joiner % sparse_checkerboard->InverseError();
+            }
+            ostream << std::endl;
 
 
             // -------------------------------------------------------------------------------------------
@@ -216,6 +246,12 @@ namespace QuantumMonteCarlo {
                     << fmt_param_int % "Imaginary-time length" % joiner % walker.TimeSize()
                     << fmt_param_double % "Imaginary-time interval" % joiner % walker.TimeInterval()
                     << fmt_param_int % "Stabilization pace" % joiner % walker.StabilizationPace()
+                    << fmt_param_int % "Delay depth of updates" % joiner % walker.DelayDepth()
+                    << fmt_param_str % "Stack decomposition" % joiner % walker.StackDecompositionName()
+                    << fmt_param_str % "Spin-parallel lanes" % joiner % bool2str(walker.isSpinParallel())
+                    << fmt_param_str % "Batched wrapping" % joiner % bool2str(walker.isBatchedWrap())
+                    << fmt_param_int % "Walkers per process" % joiner % walker.WalkerPoolSize()
+                    << fmt_param_str % "Spin-symmetric sectors" % joiner % bool2str(walker.isSpinSymmetric())
                     << std::endl;
 
             // -------------------------------------------------------------------------------------------
@@ -225,10 +261,16 @@ namespace QuantumMonteCarlo {
                     << fmt_param_str % "Warm up" % joiner % bool2str(meas_handler.isWarmUp())
                     << fmt_param_str % "Equal-time measure" % joiner % bool2str(meas_handler.isEqualTime())
                     << fmt_param_str % "Dynamical measure" % joiner % bool2str(meas_handler.isDynamic())
+                    << fmt_param_str % "Streaming equal-time" % joiner % bool2str(meas_handler.isEqualTimeStreaming())
+                    << fmt_param_str % "Streaming dynamical" % joiner % bool2str(meas_handler.isDynamicStreaming())
+                    << fmt_param_str % "Dynamic bin scheduling" % joiner % bool2str(meas_handler.isDynamicScheduling())
+                    << fmt_param_str % "Output of raw bins" % joiner % bool2str(meas_handler.isOutputBins())
+                    << fmt_param_str % "Format of raw bins" % joiner % ( meas_handler.isBinaryBins()? "binary" : "text" )
                     << std::endl;
             
             ostream << fmt_param_int % "Sweeps for warmup" % joiner % meas_handler.WarmUpSweeps()
-                    << fmt_param_int % "Number of bins" % joiner % ( meas_handler.BinsNum() * world_size )
+                    << fmt_param_int % "Number of bins" % joiner 
+                        % ( meas_handler.isDynamicScheduling()? meas_handler.BinsNum() : meas_handler.BinsNum() * world_size )
                     << fmt_param_int % "Sweeps per bin" % joiner % meas_handler.BinsSize()
                     << fmt_param_int % "Sweeps between bins" % joiner % meas_handler.SweepsBetweenBins()
                     << std::endl;
@@ -263,6 +305,59 @@ namespace QuantumMonteCarlo {
     }
 
 
+    template<typename StreamType>
+    void DqmcIO::output_replica_exchange_info( StreamType& ostream, const ReplicaExchange& replica_exchange )
+    {
+        if ( !ostream ) {
+            std::cerr << "QuantumMonteCarlo::DqmcIO::output_replica_exchange_info(): "
+                      << "the ostream failed to work, please check the input." << std::endl;
+            exit(1);
+        }
+        else {
+            boost::format fmt_param_str("%| 30s|%| 7s|%| 24s|\n");
+            boost::format fmt_param_int("%| 30s|%| 7s|%| 24d|\n");
+            const std::string_view joiner = "->";
+
+            std::string values{};
+            for ( auto i = 0; i < replica_exchange.ReplicasNum(); ++i ) {
+                values += ( boost::format( (i == 0)? "%.3f" : ", %.3f" ) % replica_exchange.Value(i) ).str();
+            }
+
+            ostream << "   Parallel Tempering:\n"
+                    << fmt_param_str % "Replica parameter" % joiner % replica_exchange.ParameterName()
+                    << fmt_param_int % "Number of replicas" % joiner % replica_exchange.ReplicasNum()
+                    << fmt_param_str % "Replica values" % joiner % values
+                    << fmt_param_int % "Sweeps between exchanges" % joiner % replica_exchange.ExchangeInterval()
+                    << std::endl;
+        }
+    }
+
+
+    template<typename StreamType>
+    void DqmcIO::output_exchange_statistics( StreamType& ostream, const ReplicaExchange& replica_exchange )
+    {
+        if ( !ostream ) {
+            std::cerr << "QuantumMonteCarlo::DqmcIO::output_exchange_statistics(): "
+                      << "the ostream failed to work, please check the input." << std::endl;
+            exit(1);
+        }
+        else {
+            boost::format fmt_pair("%.3f <-> %.3f");
+            boost::format fmt_exchange("%| 30s|%| 7s|%| 12d| / %-10d  ( %.4f )\n");
+            const std::string_view joiner = "->";
+
+            ostream << boost::format(">> Acceptance of the replica exchanges in \'%s\' ( accepted / attempted ):\n") 
+                       % replica_exchange.ParameterName();
+            for ( auto i = 0; i < replica_exchange.ReplicasNum()-1; ++i ) {
+                ostream << fmt_exchange % ( fmt_pair % replica_exchange.Value(i) % replica_exchange.Value(i+1) ) % joiner 
+                                        % replica_exchange.Accepts(i) % replica_exchange.Attempts(i) 
+                                        % replica_exchange.AcceptanceRate(i);
+            }
+            ostream << std::endl;
+        }
+    }
+
+
     template<typename StreamType, typename ObsType>
     void DqmcIO::output_observable( StreamType& ostream, const Observable::Observable<ObsType>& obs )
     {
@@ -362,6 +457,56 @@ namespace QuantumMonteCarlo {
     }
 
 
+    template<typename ObsType>
+    void DqmcIO::output_observable_in_binary_bins( std::ofstream& ofstream, const Observable::Observable<ObsType>& obs )
+    {
+        if ( !ofstream ) {
+            std::cerr << "QuantumMonteCarlo::DqmcIO::output_observable_in_binary_bins(): "
+                      << "the ofstream failed to work, please check the input." << std::endl;
+            exit(1);
+        }
+        else {
+            Utils::BinaryBins::write( ofstream, obs.name(), obs.bin_data() );
+        }
+    }
+
+
+    template<typename StreamType, typename ObsType>
+    void DqmcIO::output_observable_analysis( StreamType& ostream, const Observable::Observable<ObsType>& obs )
+    {
+        if ( !ostream ) {
+            std::cerr << "QuantumMonteCarlo::DqmcIO::output_observable_analysis(): "
+                      << "the ostream failed to work, please check the input." << std::endl;
+            exit(1);
+        }
+        else {
+            const std::string joiner = "->";
+
+            // for scalar observables
+            if constexpr ( std::is_same_v<ObsType, Observable::ScalarType> ) {
+                boost::format fmt_scalar_obs("%| 30s|%| 7s|%| 20.12f|  pm  %.12f    tau_int = %.2f");
+                ostream << fmt_scalar_obs % obs.description() % joiner 
+                        % obs.jackknife_mean() % obs.jackknife_error() % obs.autocorrelation_time() << std::endl;
+            }
+
+            // for vector and matrix observables
+            else if constexpr ( std::is_same_v<ObsType, Observable::VectorType> 
+                                || std::is_same_v<ObsType, Observable::MatrixType> ) {
+                boost::format fmt_tensor_obs("%| 30s|%| 7s|%| 20s|%| 46s|    tau_int = %.2f");
+                const double max_tau = ( obs.autocorrelation_time().size() > 0 )? obs.autocorrelation_time().maxCoeff() : 0.0;
+                ostream << fmt_tensor_obs % obs.description() % joiner % "" % "( max over the elements )" % max_tau << std::endl;
+            }
+
+            // other observable types, raising errors
+            else {
+                std::cerr << "QuantumMonteCarlo::DqmcIO::output_observable_analysis(): "
+                          << "undefined observable type." << std::endl;
+                exit(1);
+            }
+        }
+    }
+
+
     template<typename StreamType, typename ObsType>
     void DqmcIO::output_observable_in_bins( StreamType& ostream, const Observable::Observable<ObsType>& obs )
     {
@@ -501,7 +646,7 @@ namespace QuantumMonteCarlo {
                 ostream << fmt_fields_info % time_size % space_size << std::endl;
                 for ( auto t = 0; t < time_size; ++t ) {
                     for ( auto i = 0; i < space_size; ++i ) {
-                        ostream << fmt_fields % t % i % repulsive_hubbard->m_bosonic_field(t,i) << std::endl;
+                        ostream << fmt_fields % t % i % (double)repulsive_hubbard->m_bosonic_field(t,i) << std::endl;
                     }
                 }
             }
@@ -519,7 +664,7 @@ namespace QuantumMonteCarlo {
                 ostream << fmt_fields_info % time_size % space_size << std::endl;
                 for ( auto t = 0; t < time_size; ++t ) {
                     for ( auto i = 0; i < space_size; ++i ) {
-                        ostream << fmt_fields % t % i % attractive_hubbard->m_bosonic_field(t,i) << std::endl;
+                        ostream << fmt_fields % t % i % (double)attractive_hubbard->m_bosonic_field(t,i) << std::endl;
                     }
                 }
             }
@@ -579,7 +724,7 @@ namespace QuantumMonteCarlo {
                 data.erase(std::remove(std::begin(data), std::end(data), ""), std::end(data));
                 time_point = boost::lexical_cast<int>(data[0]);
                 space_point = boost::lexical_cast<int>(data[1]);
-                repulsive_hubbard->m_bosonic_field(time_point, space_point) = boost::lexical_cast<double>(data[2]);
+                repulsive_hubbard->m_bosonic_field(time_point, space_point) = ( boost::lexical_cast<double>(data[2]) > 0 )? +1 : -1;
             }
             // close the file stream
             infile.close();
@@ -612,7 +757,7 @@ namespace QuantumMonteCarlo {
                 data.erase(std::remove(std::begin(data), std::end(data), ""), std::end(data));
                 time_point = boost::lexical_cast<int>(data[0]);
                 space_point = boost::lexical_cast<int>(data[1]);
-                attractive_hubbard->m_bosonic_field(time_point, space_point) = boost::lexical_cast<double>(data[2]);
+                attractive_hubbard->m_bosonic_field(time_point, space_point) = ( boost::lexical_cast<double>(data[2]) > 0 )? +1 : -1;
             }
             // close the file stream
             infile.close();
@@ -10,12 +10,16 @@
 
 #include <memory>
 #include <vector>
+#include <string_view>
+#include <functional>
 #define EIGEN_USE_MKL_ALL
 #define EIGEN_VECTORIZE_SSE4_2
 #include <Eigen/Core>
 
+#include "random.h"
 
-namespace Utils { class SvdStack; }
+
+namespace Utils { class SvdStack; enum class Decomposition; }
 namespace Model { class ModelBase; }
 namespace Lattice { class LatticeBase; }
 namespace Measure { class MeasureHandler; }
@@ -41,12 +45,24 @@ namespace QuantumMonteCarlo {
             using ptrRealScalarVec = std::unique_ptr<Eigen::VectorXd>;
             using SvdStack = Utils::SvdStack;
             using ptrSvdStack = std::unique_ptr<SvdStack>;
+            using Matrix = Eigen::MatrixXd;
 
             using GreensFunc = Eigen::MatrixXd;
             using GreensFuncVec = std::vector<Eigen::MatrixXd>;
             using ptrGreensFunc = std::unique_ptr<Eigen::MatrixXd>;
             using ptrGreensFuncVec = std::unique_ptr<std::vector<Eigen::MatrixXd>>;
 
+        public:
+            // measuring hook called with the index of the time slice and the spin-up and spin-down greens functions
+            using EqtimeHook = std::function<void( TimeIndex, const GreensFunc&, const GreensFunc& )>;
+
+            // measuring hook called with the index of the time slice and the greens functions G(t,t), G(t,0) and G(0,t),
+            // each for spin up and spin down in order
+            using DynamicHook = std::function<void( TimeIndex, const GreensFunc&, const GreensFunc&, 
+                                                               const GreensFunc&, const GreensFunc&, 
+                                                               const GreensFunc&, const GreensFunc& )>;
+
+        private:
             
             // --------------------------------- Walker params ---------------------------------------------
 
@@ -74,6 +90,12 @@ namespace QuantumMonteCarlo {
             bool m_is_equaltime{};
             bool m_is_dynamic{};
 
+            // in the streaming mode, the equal-time ( and dynamic ) greens functions are handed over to the measuring hooks
+            // slice by slice during the sweeps instead of being stored for all time slices,
+            // which reduces the memory cost from O(L*N^2) to O(N^2).
+            bool m_is_equaltime_streaming{};
+            bool m_is_dynamic_streaming{};
+
 
             // ------------------------- SvdStack for numerical stabilization ------------------------------
 
@@ -88,9 +110,70 @@ namespace QuantumMonteCarlo {
             // or equivalently, the number of consequent wrapping steps of equal-time greens functions
             int m_stabilization_pace{};
 
+            // decomposition method of the svd stacks, e.g. SVD, QRP or JacobiSVD
+            Utils::Decomposition m_stack_decomposition{};
+
             // keep track of the wrapping error
             RealScalar m_wrap_error{};
 
+            // spare storage of the right svd stacks, the equal-time greens functions and the sign at time slice 0,
+            // into which the current ones are swapped before the bosonic fields are replaced tentatively.
+            ptrSvdStack m_saved_svd_stack_right_up{};
+            ptrSvdStack m_saved_svd_stack_right_dn{};
+            GreensFunc m_saved_green_tt_up{}, m_saved_green_tt_dn{};
+            RealScalar m_saved_config_sign{};
+
+
+            // ---------------------------- Delayed updates of greens functions ----------------------------
+
+            // accepted local updates within one time slice are accumulated as low-rank corrections
+            //      G  ->  G - U * W^T ,
+            // and applied to the equal-time greens functions by one rank-k product every 'delay_depth' updates.
+            // the diagonal elements of the greens functions are kept up to date in the meantime,
+            // so that the updating ratios can still be read off directly from the diagonal.
+            int m_delay_depth{};
+            int m_delayed_count{};
+            Matrix m_delayed_u_up{}, m_delayed_u_dn{};
+            Matrix m_delayed_w_up{}, m_delayed_w_dn{};
+            RealScalarVec m_delayed_diag_up{}, m_delayed_diag_dn{};
+
+
+            // ------------------------------ Spin-symmetric fast path -------------------------------------
+
+            // if the model is spin symmetric, e.g. the attractive hubbard model, 
+            // the spin-up and spin-down sectors share identical B matrices and greens functions.
+            // in this case only the spin-up sector is allocated and propagated,
+            // and the interfaces of the spin-down greens functions are aliases of the spin-up ones.
+            bool m_is_spin_symmetric{};
+
+
+            // ------------------------------ Parallelization of spin sectors ------------------------------
+
+            // the spin-up and spin-down sectors are independent between Metropolis updates,
+            // and in the spin-parallel mode they are processed concurrently by two OpenMP threads ( lanes ).
+            // optionally each lane is pinned to a specific cpu core,
+            // and the number of MKL threads used inside each lane is restricted.
+            bool m_is_spin_parallel{};
+            std::vector<int> m_spin_lane_cores{};
+            int m_lane_mkl_threads{1};
+
+            // alternatively, the dense wraps of the two spin sectors are issued as one batched gemm call,
+            // which keeps a multi-threaded MKL busy with both sectors without splitting the threads into lanes.
+            bool m_is_batched_wrap{};
+
+            // number of walkers in the walker pool of the process, including the main walker,
+            // each of which runs an independent Markov chain on its own OpenMP thread.
+            int m_walker_pool_size{1};
+
+
+            // ------------------------------------- Random numbers ----------------------------------------
+
+            // counter-based random engine owned by the walker, keyed by the random seed, 
+            // the rank of the process and the id of the walker.
+            // the uniform random numbers for the Metropolis acceptances are generated in batches of one time slice.
+            Utils::Philox m_rng{};
+            RealScalarVec m_uniforms{};
+
 
             // ---------------------------------- Reweighting params ---------------------------------------
             // keep track of the sign problem
@@ -109,25 +192,36 @@ namespace QuantumMonteCarlo {
             const RealScalar TimeInterval() const   { return this->m_time_interval; }
             const RealScalar WrapError() const      { return this->m_wrap_error; }
             const int StabilizationPace() const     { return this->m_stabilization_pace; }
+            const int DelayDepth() const            { return this->m_delay_depth; }
+            const bool isSpinParallel() const       { return this->m_is_spin_parallel; }
+            const bool isSpinSymmetric() const      { return this->m_is_spin_symmetric; }
+            const bool isBatchedWrap() const        { return this->m_is_batched_wrap; }
+            const int WalkerPoolSize() const        { return this->m_walker_pool_size; }
+            const bool isEqualTimeStreaming() const { return this->m_is_equaltime_streaming; }
+            const bool isDynamicStreaming() const   { return this->m_is_dynamic_streaming; }
+            const Utils::Philox& RandomEngine() const { return this->m_rng; }
+            Utils::Philox& RandomEngine()           { return this->m_rng; }
+            const Utils::Decomposition StackDecomposition() const { return this->m_stack_decomposition; }
+            const std::string_view StackDecompositionName() const;
 
             // interface for greens functions
             // todo: this may cause problems if the pointer is nullptr
             GreensFunc& GreenttUp() { return *this->m_green_tt_up; }
-            GreensFunc& GreenttDn() { return *this->m_green_tt_dn; }
+            GreensFunc& GreenttDn() { return *this->green_dn( this->m_green_tt_up, this->m_green_tt_dn ); }
 
             const GreensFunc& GreenttUp( int t ) const { return (*this->m_vec_green_tt_up)[t]; }
-            const GreensFunc& GreenttDn( int t ) const { return (*this->m_vec_green_tt_dn)[t]; }
+            const GreensFunc& GreenttDn( int t ) const { return (*this->green_dn( this->m_vec_green_tt_up, this->m_vec_green_tt_dn ))[t]; }
             const GreensFunc& Greent0Up( int t ) const { return (*this->m_vec_green_t0_up)[t]; }
-            const GreensFunc& Greent0Dn( int t ) const { return (*this->m_vec_green_t0_dn)[t]; }
+            const GreensFunc& Greent0Dn( int t ) const { return (*this->green_dn( this->m_vec_green_t0_up, this->m_vec_green_t0_dn ))[t]; }
             const GreensFunc& Green0tUp( int t ) const { return (*this->m_vec_green_0t_up)[t]; }
-            const GreensFunc& Green0tDn( int t ) const { return (*this->m_vec_green_0t_dn)[t]; }
+            const GreensFunc& Green0tDn( int t ) const { return (*this->green_dn( this->m_vec_green_0t_up, this->m_vec_green_0t_dn ))[t]; }
 
             const GreensFuncVec& vecGreenttUp() const { return *this->m_vec_green_tt_up; }
-            const GreensFuncVec& vecGreenttDn() const { return *this->m_vec_green_tt_dn; }
+            const GreensFuncVec& vecGreenttDn() const { return *this->green_dn( this->m_vec_green_tt_up, this->m_vec_green_tt_dn ); }
             const GreensFuncVec& vecGreent0Up() const { return *this->m_vec_green_t0_up; }
-            const GreensFuncVec& vecGreent0Dn() const { return *this->m_vec_green_t0_dn; }
+            const GreensFuncVec& vecGreent0Dn() const { return *this->green_dn( this->m_vec_green_t0_up, this->m_vec_green_t0_dn ); }
             const GreensFuncVec& vecGreen0tUp() const { return *this->m_vec_green_0t_up; }
-            const GreensFuncVec& vecGreen0tDn() const { return *this->m_vec_green_0t_dn; }
+            const GreensFuncVec& vecGreen0tDn() const { return *this->green_dn( this->m_vec_green_0t_up, this->m_vec_green_0t_dn ); }
 
             // interfaces for configuration signs
             const RealScalar& ConfigSign() const { return this->m_config_sign; }
@@ -146,6 +240,28 @@ namespace QuantumMonteCarlo {
             // set up the pace of stabilizations
             void set_stabilization_pace( int stabilization_pace );
 
+            // set up the decomposition method used in the svd stacks for numerical stabilizations
+            void set_stack_decomposition( Utils::Decomposition decomposition );
+
+            // set up the number of accepted updates collected before the greens functions are updated,
+            // and delay_depth = 1 corresponds to the conventional rank-1 updates
+            void set_delay_depth( int delay_depth );
+
+            // set up the spin-parallel mode, with the cpu cores to which the spin-up and spin-down lanes are pinned
+            // ( no pinning if empty ) and the number of MKL threads inside each lane
+            void set_spin_parallel( bool is_spin_parallel, const std::vector<int>& lane_cores = {}, int lane_mkl_threads = 1 );
+
+            // set up the batched wrapping of the two spin sectors, 
+            // which takes effect only for spin-asymmetric models out of the spin-parallel mode
+            void set_batched_wrap( bool is_batched_wrap );
+
+            // set up the number of walkers per process in the walker pool
+            void set_walker_pool_size( int walker_pool_size );
+
+            // set up the random engine of the walker, whose stream is determined by 
+            // the random seed, the rank of the process and the id of the walker within the process
+            void set_random_key( unsigned seed, int rank, int walker_id = 0 );
+
 
         private:
 
@@ -157,6 +273,9 @@ namespace QuantumMonteCarlo {
 
             void initial_svd_stacks( const LatticeBase& lattice, const ModelBase& model );
 
+            // fill the allocated right svd stacks from the current bosonic fields, with the left ones cleared
+            void build_svd_stacks( const ModelBase& model );
+
             // caution that this is a member function to initialize the model module
             // svd stacks should be initialized in advance
             void initial_greens_functions();
@@ -165,8 +284,16 @@ namespace QuantumMonteCarlo {
             void initial_config_sign();
 
             // allocate memory
+            // the depth of the svd stacks equals to the number of stabilization blocks
+            const int svd_stack_length() const;
             void allocate_svd_stacks();
             void allocate_greens_functions();
+            void allocate_delayed_updates();
+
+            // the spin-down counterpart of a greens function member,
+            // which is aliased to the spin-up one in the spin-symmetric mode
+            template<typename Ptr> 
+            const Ptr& green_dn( const Ptr& up, const Ptr& dn ) const { return ( this->m_is_spin_symmetric )? up : dn; }
 
         
         public:
@@ -174,20 +301,61 @@ namespace QuantumMonteCarlo {
             // ---------------------------------- Monte Carlo updates --------------------------------------
             
             // sweep forwards from time slice 0 to beta
-            void sweep_from_0_to_beta( ModelBase& model );
+            // the optional hook is called once the equal-time greens functions of each time slice are settled,
+            // with the same greens functions that are stored for the measurements in the non-streaming mode.
+            void sweep_from_0_to_beta( ModelBase& model, const EqtimeHook& hook = {} );
 
             // sweep backwards from time slice beta to 0
-            void sweep_from_beta_to_0( ModelBase& model );
+            void sweep_from_beta_to_0( ModelBase& model, const EqtimeHook& hook = {} );
+
+            // sweep forwards from 0 to beta especially to compute dynamic greens functions,
+            // without the updates of bosonic fields.
+            // the optional hook is called with the greens functions of each time slice once they are settled.
+            void sweep_for_dynamic_greens( ModelBase& model, const DynamicHook& hook = {} );
 
-            // sweep backwards from beta to 0 especially to compute dynamic greens functions,
-            // without the updates of bosonic fields
-            void sweep_for_dynamic_greens( ModelBase& model );
+
+            // ------------------------------- Replacement of configurations -------------------------------
+
+            // logarithm of the fermionic weight |det( 1 + B_up(beta,0) ) * det( 1 + B_dn(beta,0) )|
+            // of the current bosonic fields, evaluated stably from the svd stacks at time slice 0,
+            // namely at the end of a sweep from beta to 0.
+            const RealScalar LogFermionWeight() const;
+
+            // recompute the svd stacks, the equal-time greens functions and the sign at time slice 0 from scratch,
+            // e.g. after the bosonic fields are replaced by those of another replica in the replica exchanges.
+            void refresh_configurations( const LatticeBase& lattice, const ModelBase& model );
+
+            // swap the svd stacks, the equal-time greens functions and the sign at time slice 0 into spare storage,
+            // before the bosonic fields are replaced tentatively and the configurations are refreshed.
+            void save_configurations();
+
+            // swap the saved svd stacks, greens functions and sign back once the replacement is rejected,
+            // which undoes refresh_configurations() without rebuilding the stacks from the original fields.
+            void restore_configurations();
 
             
         private:
 
             // update the bosonic fields at time slice t using Metropolis algorithm
             void metropolis_update( ModelBase& model, TimeIndex t );
+
+            // record an accepted update at space site i of time slice t without touching the whole greens functions,
+            // and the collected updates are applied once the number of them reaches the delay depth
+            void delayed_update_greens_function( const ModelBase& model, TimeIndex t, int i );
+
+            // apply all the collected updates to the greens functions by one rank-k product
+            void flush_delayed_updates();
+
+            // run the task for spin-up ( lane 0 ) and spin-down ( lane 1 ) sectors,
+            // concurrently if the spin-parallel mode is on, and only for lane 0 in the spin-symmetric mode
+            void run_spin_lanes( const std::function<void(int)>& task ) const;
+
+            // run the task of the lane on the calling thread pinned to the cpu core assigned to the lane,
+            // and restore the original affinity of the thread afterwards
+            void run_pinned_spin_lane( int lane, const std::function<void(int)>& task ) const;
+
+            // hand over the current equal-time greens functions as those of time slice t to the hook if set
+            void call_eqtime_hook( const EqtimeHook& hook, TimeIndex t ) const;
             
             // wrap the equal-time greens functions from time slice t to t+1
             void wrap_from_0_to_beta( const ModelBase& model, TimeIndex t );
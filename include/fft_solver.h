@@ -2,20 +2,19 @@
 #define UTILS_FFT_SOLVER_H
 #pragma once
 
-// This class, which is initially intended to transform real-space greens function to momentum space, 
-// is temporarily not used in the dqmc simulations.
-// This is because that the transformation in dqmc is actually a four-dimension dft projected to 
-// a two-dimensional surface of momentum (kx, ky) due to the conservation of momentum
+// These classes are used to transform the translation-averaged real-space greens function G(r)
+// to momentum space. Notice that the transformation in dqmc is actually a four-dimension dft
+// projected to a two-dimensional surface of momentum (kx, ky) due to the conservation of momentum
 //
 //     < c(k1) c^\dagger(k2) >    ->    k1x = k2x and k1y = k2y 
 //
-// for ki = (kix, kiy) being two-dimensional momentum.
-// which should be more straightforward and efficient when intuitively calculated by `for` loops.
+// for ki = (kix, kiy) being two-dimensional momentum,
+// hence the greens function G(i,j) should be reduced to G(r) with r = rj - ri before transformed.
 
 /**
-  *  This header file includes `FFTSolver2d` class for the discrete fourier
+  *  This header file includes `FFTSolver2d` and `FFTSolver3d` classes for the discrete fourier
   *  transformation of real-space data using intel mkl fft, 
-  *  with friendly interface of Eigen::Matrix.
+  *  with friendly interface of Eigen::Matrix and Eigen::Vector.
   */
 
 #include <complex>
@@ -61,6 +60,11 @@ namespace Utils {
             public:
                 // default constructing function
                 FFTSolver2d() = default;
+                FFTSolver2d( const FFTSolver2d& ) = delete;
+                FFTSolver2d& operator=( const FFTSolver2d& ) = delete;
+
+                // free the mkl descriptor on destruction
+                ~FFTSolver2d() { this->deallocate(); }
 
                 // set up dimensions of fft
                 void set_up_dimension(int row, int col);
@@ -68,8 +72,56 @@ namespace Utils {
                 // initialization
                 void initial();
 
+                // fft computation, where the input may also be a mapped view of a flattened vector,
+                // and the output is only resized if its dimensions differ
+                void compute(const Eigen::Ref<const Matrix>& in, Matrix& out);
+
+                // deallocate memory
+                void deallocate();
+        };
+
+
+        // ---------------------------------- Utils::FFTSolver::FFTSolver3d ---------------------------------------
+        /**
+          *  Specialized fft solver class for three-dimensional fft of real input data,
+          *  which are stored in a Eigen::VectorXd with the first axis running fastest,
+          *  namely the element (x,y,z) locates at x + dim_x * y + dim_x * dim_y * z .
+          *  Same as FFTSolver2d, only the real part of the transformed results is returned,
+          *  and the output vector shares the same layout as the input.
+          */
+        class FFTSolver3d {
+            private:
+                using ptrCpxArray = std::unique_ptr<std::complex<double>[]>;
+                using DftHandler = DFTI_DESCRIPTOR_HANDLE;
+                using Vector = Eigen::VectorXd;
+
+
+                // dimension information
+                int m_dim_x{}, m_dim_y{}, m_dim_z{};
+
+                // variables storing the intermediate data during fft
+                ptrCpxArray m_dft_data{};
+
+                // descriptor of mkl fft
+                DftHandler m_desc_handle{NULL};
+
+            public:
+                // default constructing function
+                FFTSolver3d() = default;
+                FFTSolver3d( const FFTSolver3d& ) = delete;
+                FFTSolver3d& operator=( const FFTSolver3d& ) = delete;
+
+                // free the mkl descriptor on destruction
+                ~FFTSolver3d() { this->deallocate(); }
+
+                // set up dimensions of fft
+                void set_up_dimension(int dim_x, int dim_y, int dim_z);
+
+                // initialization
+                void initial();
+
                 // fft computation
-                void compute(const Matrix& in, Matrix& out);
+                void compute(const Vector& in, Vector& out);
 
                 // deallocate memory
                 void deallocate();
@@ -0,0 +1,169 @@
+#ifndef LOG_BINNING_H
+#define LOG_BINNING_H
+#pragma once
+
+/**
+  *  This head file includes the template class Observable::LogBinning<ObsType>,
+  *  an online accumulator of the measured samples over a logarithmic binning hierarchy.
+  *  At level l the samples are averaged into blocks of 2^l consecutive samples,
+  *  and only the running sums of the block values and of their squares are kept,
+  *  together with at most one incomplete block per level.
+  *  The memory cost thus grows as O(log N) with the number of samples N,
+  *  and the growth of the error estimates with the block size gives the integrated autocorrelation time.
+  */
+
+#include <vector>
+#include <cmath>
+#include <cassert>
+#include <type_traits>
+#include <Eigen/Core>
+
+
+namespace Observable {
+
+    // ------------------------------  Template class Observable::LogBinning<ObsType>  -------------------------------
+    template<typename ObsType> class LogBinning {
+        private:
+
+            // the highest level is chosen with at least this number of complete blocks,
+            // below which the variance of the block values is too noisy to be trusted
+            static constexpr int m_min_blocks = 16;
+
+            ObsType m_zero_elem{};                  // zero element of the observable type
+
+            std::vector<ObsType> m_sum{};           // sums of the block values at each level
+            std::vector<ObsType> m_sqsum{};         // sums of the squared block values at each level
+            std::vector<double> m_count{};          // number of complete blocks at each level
+            std::vector<ObsType> m_pending{};       // incomplete block waiting for its partner at each level
+            std::vector<bool> m_has_pending{};
+
+
+        public:
+
+            LogBinning() = default;
+
+            // -------------------------------------  Interface functions  ------------------------------------------
+
+            int levels() const { return this->m_sum.size(); }
+            double count( int level ) const { return this->m_count[level]; }
+
+            // raw access to the sums for the reductions among the walkers or processes
+            ObsType& sum( int level ) { return this->m_sum[level]; }
+            ObsType& sqsum( int level ) { return this->m_sqsum[level]; }
+            double& count( int level ) { return this->m_count[level]; }
+
+            void set_zero_element( const ObsType& zero_elem ) { this->m_zero_elem = zero_elem; }
+
+            // serialization of the hierarchy, e.g. for the checkpoints
+            template<class Archive> void serialize( Archive& ar, const unsigned int version ) {
+                ar & this->m_sum;
+                ar & this->m_sqsum;
+                ar & this->m_count;
+                ar & this->m_pending;
+                ar & this->m_has_pending;
+            }
+
+
+            // -------------------------------------  Accumulations  ------------------------------------------
+
+            // remove all the samples
+            void clear() {
+                this->m_sum.clear();
+                this->m_sqsum.clear();
+                this->m_count.clear();
+                this->m_pending.clear();
+                this->m_has_pending.clear();
+            }
+
+            // extend the hierarchy to the given number of levels, filled with empty levels
+            void resize_levels( int levels ) {
+                while ( this->levels() < levels ) {
+                    this->m_sum.emplace_back(this->m_zero_elem);
+                    this->m_sqsum.emplace_back(this->m_zero_elem);
+                    this->m_count.emplace_back(0.0);
+                    this->m_pending.emplace_back(this->m_zero_elem);
+                    this->m_has_pending.emplace_back(false);
+                }
+            }
+
+            // add one sample into the lowest level,
+            // and propagate the completed blocks upwards by averaging pairs of neighbouring blocks
+            void push( const ObsType& sample ) {
+                ObsType value = sample;
+                for ( auto level = 0; ; ++level ) {
+                    if ( level == this->levels() ) { this->resize_levels(level+1); }
+                    this->m_sum[level] += value;
+                    this->m_sqsum[level] += square(value);
+                    this->m_count[level] += 1.0;
+
+                    if ( !this->m_has_pending[level] ) {
+                        this->m_pending[level] = value;
+                        this->m_has_pending[level] = true;
+                        break;
+                    }
+                    value = 0.5 * ( this->m_pending[level] + value );
+                    this->m_has_pending[level] = false;
+                }
+            }
+
+            // merge the complete blocks of another hierarchy, e.g. of an independent Markov chain,
+            // while the incomplete blocks of the other are discarded
+            void merge( const LogBinning<ObsType>& other ) {
+                this->resize_levels(other.levels());
+                for ( auto level = 0; level < other.levels(); ++level ) {
+                    this->m_sum[level] += other.m_sum[level];
+                    this->m_sqsum[level] += other.m_sqsum[level];
+                    this->m_count[level] += other.m_count[level];
+                }
+            }
+
+
+            // -------------------------------------  Statistics  ------------------------------------------
+
+            // squared error of the mean estimated from the block values at the given level
+            ObsType squared_error( int level ) const {
+                assert( level >= 0 && level < this->levels() );
+                const double n = this->m_count[level];
+                if ( n < 2.0 ) { return this->m_zero_elem; }
+                const ObsType mean = this->m_sum[level] / n;
+                ObsType variance = this->m_sqsum[level] / n - square(mean);
+                return variance / ( n - 1.0 );
+            }
+
+            // the highest level with enough blocks for a reliable error estimate
+            int reliable_level() const {
+                int level = 0;
+                while ( level+1 < this->levels() && this->m_count[level+1] >= m_min_blocks ) { ++level; }
+                return level;
+            }
+
+            // integrated autocorrelation time in units of the samples, estimated from
+            //     sigma^2_L = ( 1 + 2 tau_int ) sigma^2_0 ,
+            // where sigma_0 is the naive error of uncorrelated samples and sigma_L the error at the reliable level.
+            // the elements with vanishing fluctuations are assigned with zero.
+            ObsType autocorrelation_time() const {
+                if ( this->levels() == 0 ) { return this->m_zero_elem; }
+                const ObsType error0 = this->squared_error(0);
+                const ObsType errorL = this->squared_error(this->reliable_level());
+
+                if constexpr ( std::is_same_v<ObsType, double> ) {
+                    return ( error0 > 0.0 )? 0.5 * ( errorL / error0 - 1.0 ) : 0.0;
+                }
+                else {
+                    return ( error0.array() > 0.0 ).select(
+                        0.5 * ( errorL.array() / error0.array() - 1.0 ), 0.0 ).matrix();
+                }
+            }
+
+
+        private:
+
+            static ObsType square( const ObsType& value ) {
+                if constexpr ( std::is_same_v<ObsType, double> ) { return value * value; }
+                else { return value.array().square().matrix(); }
+            }
+    };
+
+} // namespace Observable
+
+#endif // LOG_BINNING_H
@@ -10,7 +10,9 @@
   */
 
 
+#include <memory>
 #include "measure/observable_handler.h"
+#include "fft_solver.h"
 
 // forward declaration
 namespace Model { class ModelBase; }
@@ -27,10 +29,55 @@ namespace Measure {
     using DqmcWalker = QuantumMonteCarlo::DqmcWalker;
     using Matrix = Eigen::MatrixXd;
     using Vector = Eigen::VectorXd;
+    using RealScalar = double;
     using MomentumIndex = int;
     using MomentumIndexList = std::vector<int>;
 
 
+    // equal-time quantities of one time slice, which are computed in a single pass over the greens functions
+    // and shared by the equal-time observables, so that the observables only perform cheap contractions.
+    struct EqtimeCorrelations {
+        // local quantities averaged over sites, namely the filling < n_up + n_dn >, 
+        // double occupancy < n_up * n_dn >, local spin correlation < ( n_up - n_dn )^2 >
+        // and the sum of the nearest-neighbour hoppings 1/N \sum <ij> < c^+_j c_i > ( without the factor 2t )
+        RealScalar filling{};
+        RealScalar double_occupancy{};
+        RealScalar local_spin_corr{};
+        RealScalar nn_hopping{};
+
+        // s-wave pairing correlation 1/N \sum ij ( c^+_up c^+_dn )(i) * ( c_dn c_up )(j)
+        RealScalar s_wave_pairing{};
+
+        // translation-averaged correlations indexed by the displacement r, 
+        // whose fourier transformations reduce to the O(N) contractions \sum r cos( k*r ) * f(r).
+        // spin-summed greens function 1/N \sum i ( G_up + G_dn )(i+r, i)
+        Vector greens_r{};
+        // density-density correlations 1/N \sum i < n(i+r) * n(i) > of spin ( n_up - n_dn ) and charge ( n_up + n_dn )
+        Vector spin_corr_r{};
+        Vector charge_corr_r{};
+    };
+
+
+    // dynamic quantities of one dynamic sweep, which are accumulated over the time slices in a single pass
+    // and shared by the dynamic observables. the time index t labels the imaginary time t * dtau,
+    // which involves the greens functions of time slice t-1, and t = 0 is taken from the last time slice.
+    struct DynamicCorrelations {
+        // spin-averaged greens functions G(k,t) in momentum space,
+        // with the rows labeling the momenta in the momentum list and the columns labeling the imaginary time
+        Matrix greens_kt{};
+
+        // spin-averaged local greens function 1/N \sum i G(i,i;t,0)
+        Vector local_greens_t{};
+
+        // local spin correlations 1/N \sum i < ( n_up - n_dn )(i,t) * ( n_up - n_dn )(i,0) >
+        Vector local_spin_corr_t{};
+
+        // current-current correlations \sum t \sum ij ( exp( -i kx*r ) - exp( -i ky*r ) ) * < jx(j,t) * jx(i,0) >
+        // with the minimal momenta kx and ky, and without the factor t^2 of the current operators
+        RealScalar current_corr{};
+    };
+
+
     // -----------------------------------  Handler class Measure::MeasureHandler  ---------------------------------
     class MeasureHandler : public Observable::ObservableHandler {
         private:
@@ -38,9 +85,14 @@ namespace Measure {
             bool m_is_warmup{};             // whether to warm up the system or not
             bool m_is_equaltime{};          // whether to perform equal-time measurements or not
             bool m_is_dynamic{};            // whether to perform dynamic measurements or not
+            bool m_is_streaming{};          // whether to collect the measured quantities slice by slice during the sweeps
+            bool m_is_dynamic_scheduling{}; // whether the bins are drawn dynamically from a counter shared by the processes
+            bool m_is_output_bins{};        // whether to gather and output the raw data of bins
+            bool m_is_binary_bins{};        // whether to output the bins in the binary container instead of text
 
+            int m_time_size{};              // number of the imaginary-time slices
             int m_sweeps_warmup{};          // number of the MC sweeps for the warm-up process
-            int m_bin_num{};                // number of measuring bins 
+            int m_bin_num{};                // number of measuring bins ( at most ) of the process
             int m_bin_size{};               // number of samples in one measuring bin
             int m_sweeps_between_bins{};    // number of the MC sweeps between two adjoining bins
 
@@ -49,6 +101,48 @@ namespace Measure {
             // lattice momentum for the momentum-dependent measurements
             MomentumIndex m_momentum{};
             MomentumIndexList m_momentum_list{};
+
+            // fft solvers for transforming the translation-averaged real-space data to momentum space,
+            // which are enabled for the square and cubic lattices if all the measured momenta lie on the fft grids.
+            // otherwise the transformation falls back to the direct summation over displacements.
+            bool m_is_fft_enabled{false};
+            std::unique_ptr<Utils::FFTSolver::FFTSolver2d> m_fft_solver_2d{};
+            std::unique_ptr<Utils::FFTSolver::FFTSolver3d> m_fft_solver_3d{};
+
+            // map from the i-th momentum in the momentum list to the flattened index of fft grids
+            std::vector<int> m_fft_grid_index{};
+
+            // outputs of the 2d and 3d fft solvers, sized once in initial_fft_solver()
+            mutable Matrix m_fft_out{};
+            mutable Vector m_fft_data{};
+
+            // equal-time quantities for each time slice, which are prepared before the equal-time observables are measured.
+            // the O(N^2) pair correlations are computed only if any of the observables depends on them.
+            bool m_is_eqtime_pair_corr{false};
+            std::vector<EqtimeCorrelations> m_eqtime_corr{};
+
+            // preallocated buffers for the diagonal elements of 1 - G
+            Vector m_guc_diag{};
+            Vector m_gdc_diag{};
+
+            // dynamic quantities of the current dynamic sweep, and which of them are required by the observables
+            bool m_is_dynamic_greens{false};
+            bool m_is_dynamic_current{false};
+            bool m_is_dynamic_spin{false};
+            DynamicCorrelations m_dynamic_corr{};
+
+            // intermediate data of the uncorrelated parts, which are contracted with the greens functions
+            // of the last time slice ( t = 0 ) at the end of the dynamic sweep, costing O(N) and O(L*N) in memory.
+            //   m_current_factor_r : fourier factors exp( -i kx*r ) - exp( -i ky*r ) indexed by the displacement r
+            //   m_current_sum      : current < jx(j,t) > summed over t, without the factor i*t
+            //   m_magnetization_t  : local magnetization < ( n_up - n_dn )(i,t) > with the columns labeling t
+            Vector m_current_factor_r{};
+            Vector m_current_sum{};
+            Matrix m_magnetization_t{};
+
+            // preallocated buffers for the translation-averaged greens functions in real and momentum space
+            Vector m_greens_r{};
+            Vector m_greens_k{};
             
         
         public:
@@ -61,6 +155,26 @@ namespace Measure {
 
             void set_observables( ObsList obs_list );
 
+            // set up the streaming mode of measurements, in which the equal-time and dynamic quantities 
+            // are computed from the greens functions handed over by the walker at each time slice,
+            // and the greens functions of all time slices are no longer stored.
+            // notice that walker.GreenttUp(t), walker.Greent0Up(t) and so on are not available for the observables then.
+            void set_streaming( bool is_streaming );
+
+            // set up the dynamic scheduling of bins, in which the processes keep drawing bins from a shared counter
+            // until the total number of bins is reached, so that faster processes measure more bins.
+            // in this case the number of bins of the handler is the total one, 
+            // which is truncated to the bins actually measured at the end of the measurements,
+            // while the storage of the observables grows bin by bin as the bins are written.
+            void set_dynamic_scheduling( bool is_dynamic_scheduling );
+
+            // set up whether to gather the raw data of bins from all the processes and output them,
+            // otherwise only the statistics needed by the analysis are reduced over the processes.
+            void set_output_bins( bool is_output_bins );
+
+            // set up whether to output the bins in the binary format of Utils::BinaryBins
+            void set_binary_bins( bool is_binary_bins );
+
             // set up lattice momentum params for momentum-dependent measurements
             // the input momentum list should be provided by Lattice module
             void set_measured_momentum( const MomentumIndex& momentum_index );
@@ -77,6 +191,13 @@ namespace Measure {
             const bool isWarmUp() const;
             const bool isEqualTime() const ;
             const bool isDynamic() const ;
+            const bool isEqualTimeStreaming() const ;
+            const bool isDynamicStreaming() const ;
+            const bool isStreaming() const ;
+            const bool isDynamicScheduling() const ;
+            const bool isOutputBins() const ;
+            const bool isBinaryBins() const ;
+            const ObsList& ObservableList() const ;
 
             const int WarmUpSweeps() const ;
             const int SweepsBetweenBins() const;
@@ -87,6 +208,14 @@ namespace Measure {
             const MomentumIndex& MomentumList( const int i ) const;
             const MomentumIndexList& MomentumList() const;
 
+            const bool isFFTEnabled() const;
+
+            // equal-time quantities and correlations at time slice t
+            const EqtimeCorrelations& EqtimeCorr( const int t ) const;
+
+            // dynamic quantities and correlations of the current dynamic sweep
+            const DynamicCorrelations& DynamicCorr() const;
+
             
             // the following interfaces have been implemented 
             // in the base class Observable::ObservableHandler.
@@ -105,18 +234,81 @@ namespace Measure {
             void equaltime_measure( const DqmcWalker& walker, const ModelBase& model, const LatticeBase& lattice );
             void dynamic_measure  ( const DqmcWalker& walker, const ModelBase& model, const LatticeBase& lattice );
 
+            // collect the equal-time quantities of time slice t in the streaming mode,
+            // which is called by the walker during the sweeps, before equaltime_measure() at the end of the sweep.
+            void stream_equaltime_slice( int t, const Matrix& green_tt_up, const Matrix& green_tt_dn, const LatticeBase& lattice );
+
+            // collect the dynamic quantities of time slice t in the streaming mode,
+            // which is called by the walker during the dynamic sweep, before dynamic_measure() at the end of the sweep.
+            void stream_dynamic_slice( int t, const Matrix& green_tt_up, const Matrix& green_tt_dn,
+                                              const Matrix& green_t0_up, const Matrix& green_t0_dn,
+                                              const Matrix& green_0t_up, const Matrix& green_0t_dn,
+                                              const LatticeBase& lattice );
+
+            // transform the translation-averaged real-space data f(r), indexed by the displacement,
+            // to momentum space f(k) = \sum r cos( k*r ) * f(r) for all momenta in the momentum list
+            void fourier_transform( const Vector& data_r, Vector& data_k, const LatticeBase& lattice ) const;
+
             // normalize the observable samples
             void normalize_stats();
             
             // bin collections of the observable samples
             void write_stats_to_bins( int bin );
 
-            // analyse the statistics by calculating means and errors
+            // keep only the first bin_num bins of all the observables
+            void truncate_bins( int bin_num );
+
+            // analyse the statistics by calculating means and errors,
+            // together with the jackknife estimates of the ratios to the sign and the autocorrelation times
             void analyse_stats();
 
             // clear the temporary data
             void clear_temporary();
 
+            // accumulate the temporary data of another measure handler with identical observables,
+            // e.g. of a companion walker in the walker pool, before the samples are normalized and binned
+            void merge_temporary( const MeasureHandler& other );
+
+            // merge the logarithmic binning of the individual measurements of another measure handler,
+            // e.g. of a companion walker, into the estimates of the autocorrelation times
+            void merge_log_binning( const MeasureHandler& other );
+
+            // serialization of the collected data of all the observables, e.g. for the checkpoints,
+            // where the handler should have been initialized with the same observables and parameters
+            template<class Archive> void serialize( Archive& ar, const unsigned int version ) {
+                ar & this->m_bin_num;
+                if ( this->m_is_equaltime ) {
+                    ar & *this->m_equaltime_sign;
+                    for (auto& scalar_obs : this->m_eqtime_scalar_obs) { ar & *scalar_obs; }
+                    for (auto& vector_obs : this->m_eqtime_vector_obs) { ar & *vector_obs; }
+                    for (auto& matrix_obs : this->m_eqtime_matrix_obs) { ar & *matrix_obs; }
+                }
+                if ( this->m_is_dynamic ) {
+                    ar & *this->m_dynamic_sign;
+                    for (auto& scalar_obs : this->m_dynamic_scalar_obs) { ar & *scalar_obs; }
+                    for (auto& vector_obs : this->m_dynamic_vector_obs) { ar & *vector_obs; }
+                    for (auto& matrix_obs : this->m_dynamic_matrix_obs) { ar & *matrix_obs; }
+                }
+            }
+
+
+        private:
+            // extend the storage of the bins of all the observables up to bin_num bins
+            void extend_bins( int bin_num );
+
+            // set up the fft solvers and the map from the momentum list to fft grids
+            void initial_fft_solver( const LatticeBase& lattice );
+
+            // compute the equal-time quantities of time slice t, with one pass over the greens functions
+            void compute_eqtime_correlations( int t, const Matrix& gu, const Matrix& gd, const LatticeBase& lattice );
+
+            // accumulate the dynamic quantities of time slice t, which should be visited in the order t = 0,1,...,L-1.
+            // the quantities are completed at the last time slice, whose equal-time greens functions serve as G(0,0).
+            void compute_dynamic_correlations( int t, const Matrix& gttu, const Matrix& gttd,
+                                                      const Matrix& gt0u, const Matrix& gt0d,
+                                                      const Matrix& g0tu, const Matrix& g0td,
+                                                      const LatticeBase& lattice );
+
 
             // ---------------------------------  Friend class Utils::MPI  ---------------------------------------
             // for collecting measuring data among a set of MPI processes
@@ -14,9 +14,12 @@
 #include <string>
 #include <functional>
 #include <numeric>
+#include <algorithm>
+#include <cmath>
 #define EIGEN_USE_MKL_ALL
 #define EIGEN_VECTORIZE_SSE4_2
 #include <Eigen/Core>
+#include "measure/log_binning.h"
 
 
 // forward declaration
@@ -73,6 +76,28 @@ namespace Observable {
             int m_bin_num{0};                       // total number of bins
             std::vector<ObsType> m_bin_data{};      // collected data in bins
 
+            // sums of the bin data and of their squares, from which the mean and error are estimated.
+            // they are accumulated from the local bins in analyse(), unless already reduced over the processes.
+            ObsType m_bin_sum{};
+            ObsType m_bin_sqsum{};
+            bool m_is_reduced{false};
+
+            // jackknife resampling of the sign-reweighted ratio < O s > / < s > over the bins,
+            // with the bins weighted by their signed average sign. only the sums over the bins are kept, namely
+            // the weighted sum of the bin data, and the sums of the leave-one-out estimates and of their squares,
+            // which are accumulated in analyse_jackknife(), unless already reduced over the processes.
+            ObsType m_weighted_sum{};
+            ObsType m_jackknife_sum{};
+            ObsType m_jackknife_sqsum{};
+            ObsType m_jackknife_mean{};             // bias-corrected jackknife estimate of the mean value
+            ObsType m_jackknife_error{};            // jackknife estimate of the error bar
+            bool m_is_jackknife_reduced{false};
+
+            // online logarithmic binning of the individual measurements,
+            // from which the integrated autocorrelation time is estimated
+            LogBinning<ObsType> m_log_binning{};
+            ObsType m_autocorr_time{};              // integrated autocorrelation time in units of measurements
+
             std::function<ObsMethod> m_method{};    // user-defined measuring method
 
         
@@ -97,6 +122,9 @@ namespace Observable {
             const ObsType& zero_element() const { return this->m_zero_elem; } 
             const ObsType& mean_value() const { return this->m_mean_value; }
             const ObsType& error_bar() const { return this->m_error_bar; }
+            const ObsType& jackknife_mean() const { return this->m_jackknife_mean; }
+            const ObsType& jackknife_error() const { return this->m_jackknife_error; }
+            const ObsType& autocorrelation_time() const { return this->m_autocorr_time; }
             
             const ObsType& tmp_value() const { return this->m_tmp_value; }
             ObsType& tmp_value() { return this->m_tmp_value; }
@@ -112,6 +140,16 @@ namespace Observable {
             }
 
             std::vector<ObsType>& bin_data() { return this->m_bin_data; }
+            const std::vector<ObsType>& bin_data() const { return this->m_bin_data; }
+
+            ObsType& bin_sum() { return this->m_bin_sum; }
+            ObsType& bin_sqsum() { return this->m_bin_sqsum; }
+            const ObsType& bin_sum() const { return this->m_bin_sum; }
+            
+            ObsType& weighted_sum() { return this->m_weighted_sum; }
+            ObsType& jackknife_sum() { return this->m_jackknife_sum; }
+            ObsType& jackknife_sqsum() { return this->m_jackknife_sqsum; }
+            LogBinning<ObsType>& log_binning() { return this->m_log_binning; }
             
 
             // ---------------------------------  Set up parameters and methods  ------------------------------------
@@ -121,16 +159,32 @@ namespace Observable {
             void set_name_and_description(const std::string& name, const std::string& desc) { this->m_name = name; this->m_desc = desc; }
             void add_method(const std::function<ObsMethod>& method) { this->m_method = method; }
 
+            // serialization of the collected data, e.g. for the checkpoints,
+            // while the measuring method and the analysed statistics are not included
+            template<class Archive> void serialize(Archive& ar, const unsigned int version) {
+                ar & this->m_tmp_value;
+                ar & this->m_count;
+                ar & this->m_bin_num;
+                ar & this->m_bin_data;
+                ar & this->m_log_binning;
+            }
+
 
             // -------------------------------------  Other member functions  ---------------------------------------
             
-            // perform one step of measurement
+            // perform one step of measurement, 
+            // whose average over the time slices is recorded as one sample of the logarithmic binning
             void measure( const MeasureHandler& meas_handler,
                           const DqmcWalker& walker, 
                           const ModelBase& model, 
                           const LatticeBase& lattice )
             { 
+                const ObsType tmp_value = this->m_tmp_value;
+                const int count = this->m_count;
                 this->m_method( *this, meas_handler, walker, model, lattice ); 
+                if ( this->m_count > count ) {
+                    this->m_log_binning.push( ( this->m_tmp_value - tmp_value ) / ( this->m_count - count ) );
+                }
             }
 
             // allocate memory
@@ -138,6 +192,18 @@ namespace Observable {
                 this->m_mean_value = this->m_zero_elem;
                 this->m_error_bar = this->m_zero_elem;
                 this->m_tmp_value = this->m_zero_elem;
+                this->m_bin_sum = this->m_zero_elem;
+                this->m_bin_sqsum = this->m_zero_elem;
+                this->m_is_reduced = false;
+                this->m_weighted_sum = this->m_zero_elem;
+                this->m_jackknife_sum = this->m_zero_elem;
+                this->m_jackknife_sqsum = this->m_zero_elem;
+                this->m_jackknife_mean = this->m_zero_elem;
+                this->m_jackknife_error = this->m_zero_elem;
+                this->m_is_jackknife_reduced = false;
+                this->m_autocorr_time = this->m_zero_elem;
+                this->m_log_binning.set_zero_element(this->m_zero_elem);
+                this->m_log_binning.clear();
 
                 std::vector<ObsType>().swap(this->m_bin_data);
                 this->m_bin_data.reserve(this->m_bin_num);
@@ -158,26 +224,161 @@ namespace Observable {
                 this->m_count = 0;
             }
 
+            // accumulate the temporary data and countings of the same observable from another sample collection,
+            // e.g. from the companion walkers of the walker pool
+            void merge_temporary( const Observable<ObsType>& other ) {
+                this->m_tmp_value += other.m_tmp_value;
+                this->m_count += other.m_count;
+            }
+
+            // merge the logarithmic binning of the same observable measured by an independent Markov chain,
+            // e.g. by the companion walkers of the walker pool
+            void merge_log_binning( const Observable<ObsType>& other ) {
+                this->m_log_binning.merge(other.m_log_binning);
+            }
+
+            // keep only the first bin_num bins, e.g. the bins actually measured by a process
+            // whose bins are drawn dynamically from a shared counter
+            void truncate_bins(int bin_num) {
+                assert( bin_num >= 0 && bin_num <= (int)this->m_bin_data.size() );
+                this->m_bin_data.erase(this->m_bin_data.begin() + bin_num, this->m_bin_data.end());
+                this->m_bin_num = bin_num;
+            }
+
+            // extend the bin collections with zero elements up to bin_num bins,
+            // e.g. for the bins claimed one by one in the dynamic scheduling
+            void extend_bins(int bin_num) {
+                assert( bin_num >= (int)this->m_bin_data.size() );
+                this->m_bin_data.resize(bin_num, this->m_zero_elem);
+                this->m_bin_num = bin_num;
+            }
+
             // clear data of bin collections
             void clear_bin_data() {
                 for (auto& bin_data : this->m_bin_data) {
                     bin_data = this->m_zero_elem;
                 }
+                this->m_bin_sum = this->m_zero_elem;
+                this->m_bin_sqsum = this->m_zero_elem;
+                this->m_is_reduced = false;
+                this->m_weighted_sum = this->m_zero_elem;
+                this->m_jackknife_sum = this->m_zero_elem;
+                this->m_jackknife_sqsum = this->m_zero_elem;
+                this->m_is_jackknife_reduced = false;
+                this->m_log_binning.clear();
+            }
+
+            // accumulate the sums of the local bin data and of their squares
+            void accumulate_bin_sums() {
+                this->m_bin_sum = std::accumulate(this->m_bin_data.begin(), this->m_bin_data.end(), this->m_zero_elem);
+                
+                // for observables with Scalar type
+                if constexpr ( std::is_same_v<ObsType, ScalarType> ) {
+                    this->m_bin_sqsum = this->m_zero_elem;
+                    for (const auto& bin_data : this->m_bin_data) {
+                        this->m_bin_sqsum += std::pow(bin_data, 2);
+                    }
+                }
+
+                // for observables with Vector and Matrix types
+                else if constexpr ( std::is_same_v<ObsType, VectorType> || std::is_same_v<ObsType, MatrixType> ) {
+                    this->m_bin_sqsum = this->m_zero_elem;
+                    for (const auto& bin_data : this->m_bin_data) {
+                        this->m_bin_sqsum += bin_data.array().square().matrix();
+                    }
+                }
+            }
+
+            // mark the bin sums as reduced over the processes, which together measured bin_num bins,
+            // so that the analysis no longer depends on the local bin data
+            void set_reduced_bin_sums(int bin_num) {
+                this->m_bin_num = bin_num;
+                this->m_is_reduced = true;
             }
 
+            // accumulate the sum of the local bin data weighted by the average sign of the bins.
+            // each bin stores the ratio < O s >_b / < s >_b, hence the weights w_b = < s >_b recover < O s >_b,
+            // from which the sign-reweighted estimates of the jackknife resampling are reconstructed.
+            void accumulate_weighted_sum( const std::vector<ScalarType>& weights ) {
+                assert( weights.size() >= this->m_bin_data.size() );
+                this->m_weighted_sum = this->m_zero_elem;
+                for (auto bin = 0; bin < (int)this->m_bin_data.size(); ++bin) {
+                    this->m_weighted_sum += weights[bin] * this->m_bin_data[bin];
+                }
+            }
+
+            // accumulate the leave-one-out estimates of the local bins and their squares, 
+            //     r_j = ( \sum_{b != j} w_b O_b ) / ( \sum_{b != j} w_b ) ,
+            // where the weighted sum and the total weight should be summed over all the bins in advance
+            void accumulate_jackknife_sums( const std::vector<ScalarType>& weights, ScalarType total_weight ) {
+                assert( weights.size() >= this->m_bin_data.size() );
+                this->m_jackknife_sum = this->m_zero_elem;
+                this->m_jackknife_sqsum = this->m_zero_elem;
+                for (auto bin = 0; bin < (int)this->m_bin_data.size(); ++bin) {
+                    const ObsType estimate = ( this->m_weighted_sum - weights[bin] * this->m_bin_data[bin] ) 
+                                           / ( total_weight - weights[bin] );
+                    this->m_jackknife_sum += estimate;
+                    if constexpr ( std::is_same_v<ObsType, ScalarType> ) {
+                        this->m_jackknife_sqsum += estimate * estimate;
+                    }
+                    else {
+                        this->m_jackknife_sqsum += estimate.array().square().matrix();
+                    }
+                }
+            }
+
+            // mark the jackknife sums as reduced over the processes
+            void set_reduced_jackknife_sums() { this->m_is_jackknife_reduced = true; }
+
             // perform data analysis, especially computing the mean and error
             void analyse() {
                 this->clear_stats();
+                if ( !this->m_is_reduced ) { this->accumulate_bin_sums(); }
                 this->calculate_mean_value();
                 this->calculate_error_bar();
+                this->m_autocorr_time = this->m_log_binning.autocorrelation_time();
+            }
+
+            // jackknife analysis of the ratio to the sign, whose bins serve as the weights 
+            // and which should be analysed in advance.
+            void analyse_jackknife( const Observable<ScalarType>& sign ) {
+                if ( !this->m_is_jackknife_reduced ) {
+                    this->accumulate_weighted_sum( sign.bin_data() );
+                    this->accumulate_jackknife_sums( sign.bin_data(), sign.bin_sum() );
+                }
+                this->calculate_jackknife( sign.bin_sum() );
             }
 
 
         private:
 
+            // the bias-corrected jackknife estimates of n bins
+            //     O_jk = n * r - (n-1) * \bar{r_j} ,   sigma_jk = \sqrt{ (n-1) * ( \bar{r_j^2} - \bar{r_j}^2 ) } ,
+            // where r is the ratio estimated by all the bins and \bar{...} the average over the leave-one-out estimates.
+            void calculate_jackknife( ScalarType total_weight ) {
+                const int n = this->bin_num();
+                // no leave-one-out estimate exists for a single bin, whose ratio is reported without error
+                if ( n < 2 ) {
+                    this->m_jackknife_mean = ( n == 1 )? this->m_weighted_sum / total_weight : this->m_zero_elem;
+                    this->m_jackknife_error = this->m_zero_elem;
+                    return;
+                }
+                const ObsType full_estimate = this->m_weighted_sum / total_weight;
+                const ObsType mean_estimate = this->m_jackknife_sum / n;
+                this->m_jackknife_mean = n * full_estimate - (n-1) * mean_estimate;
+                if constexpr ( std::is_same_v<ObsType, ScalarType> ) {
+                    this->m_jackknife_error = std::sqrt( std::max( 0.0, 
+                        (n-1) * ( this->m_jackknife_sqsum / n - mean_estimate * mean_estimate ) ) );
+                }
+                else {
+                    this->m_jackknife_error = ( (n-1) * ( this->m_jackknife_sqsum.array() / n 
+                        - mean_estimate.array().square() ) ).max(0.0).sqrt().matrix();
+                }
+            }
+
             // calculating mean value of the measurement
             void calculate_mean_value() {
-                this->m_mean_value = std::accumulate(this->m_bin_data.begin(), this->m_bin_data.end(), this->m_zero_elem);
+                this->m_mean_value = this->m_bin_sum;
                 this->m_mean_value /= this->bin_num();
             }
             
@@ -185,18 +386,14 @@ namespace Observable {
             void calculate_error_bar() {
                 // for observables with Scalar type
                 if constexpr ( std::is_same_v<ObsType, ScalarType> ) {
-                    for (const auto& bin_data : this->m_bin_data) {
-                        this->m_error_bar += std::pow(bin_data, 2);
-                    }
+                    this->m_error_bar = this->m_bin_sqsum;
                     this->m_error_bar /= this->bin_num();
                     this->m_error_bar = std::sqrt(this->m_error_bar - std::pow(this->m_mean_value,2)) / std::sqrt(this->bin_num()-1);
                 }
 
                 // for observables with Vector and Matrix types
                 else if constexpr ( std::is_same_v<ObsType, VectorType> || std::is_same_v<ObsType, MatrixType> ) {
-                    for (const auto& bin_data : this->m_bin_data) {
-                        this->m_error_bar += bin_data.array().square().matrix();
-                    }
+                    this->m_error_bar = this->m_bin_sqsum;
                     this->m_error_bar /= this->bin_num();
                     this->m_error_bar = ( this->m_error_bar.array() - this->m_mean_value.array().square() ).sqrt().matrix() / std::sqrt(this->bin_num()-1);
                 }
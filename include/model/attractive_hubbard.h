@@ -8,6 +8,8 @@
   *  for describing the attractive fermion hubbard model, which is derived from Model::ModelBase.
   */  
 
+#include <array>
+#include <cstdint>
 #include "model/model_base.h"
 
 
@@ -24,6 +26,7 @@ namespace Model {
 
             using RealScalar = double;
             using SpaceTimeMat = Eigen::MatrixXd;
+            using SpaceTimeField = Eigen::Matrix<std::int8_t, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>;
             
             // Model parameters
             // The Hamiltonian of attractive hubbard model
@@ -37,8 +40,14 @@ namespace Model {
             // helping parameter for construction of V matrices
             RealScalar m_alpha{};
 
-            // auxiliary bonsonic fields
-            SpaceTimeMat m_bosonic_field{};
+            // tables of the exponential factors exp( alpha * x ) and exp( 2 * alpha * x ) for x = -1, +1,
+            // indexed by ( x + 1 ) / 2, since the Ising fields only take the values +1 and -1.
+            std::array<RealScalar, 2> m_exp_alpha{};
+            std::array<RealScalar, 2> m_exp_2alpha{};
+
+            // auxiliary bonsonic fields s(t,i) = +1 or -1 of the time slice t and site i,
+            // stored in int8 and in row-major order, so that the fields of one time slice are contiguous
+            SpaceTimeField m_bosonic_field{};
 
 
         public:
@@ -55,6 +64,9 @@ namespace Model {
             const RealScalar OnSiteU()  const;
             const RealScalar ChemicalPotential() const;
 
+            // the spin-up and spin-down sectors are coupled to the bosonic fields in the same way
+            const bool isSpinSymmetric() const { return true; }
+
 
             // ----------------------------------- Set up model parameters ----------------------------------------
             
@@ -66,7 +78,16 @@ namespace Model {
             virtual void initial              ( const LatticeBase& lattice, const Walker& walker );
             virtual void initial_params       ( const LatticeBase& lattice, const Walker& walker );
             virtual void initial_KV_matrices  ( const LatticeBase& lattice, const Walker& walker );
-            void set_bosonic_fields_to_random ( );
+            void set_bosonic_fields_to_random ( Utils::Philox& rng );
+            std::unique_ptr<ModelBase> clone  ( ) const ;
+
+            // the fields flattened in the order of time slices
+            const Vector BosonicFields() const ;
+            void set_bosonic_fields( const Vector& fields );
+
+            // the Ising fields are coupled to the charge, and the HS transformation
+            // comes with the factor exp( -alpha * s(t,i) ) besides the determinants
+            const RealScalar LogBosonicWeight() const ;
 
 
             // ------------------------------------- Monte Carlo updates ------------------------------------------
@@ -74,6 +95,7 @@ namespace Model {
             void update_bosonic_field      ( TimeIndex time_index, SpaceIndex space_index );
             void update_greens_function    ( Walker& walker, TimeIndex time_index, SpaceIndex space_index );
             const double get_update_ratio  ( Walker& walker, TimeIndex time_index, SpaceIndex space_index ) const ;
+            const double get_update_delta  ( TimeIndex time_index, SpaceIndex space_index, Spin spin ) const ;
 
             
             // -------------------------------------- Warpping methods --------------------------------------------
@@ -84,6 +106,16 @@ namespace Model {
             virtual void mult_invB_from_right   ( GreensFunc& green, TimeIndex time_index, Spin spin ) const ;
             virtual void mult_transB_from_left  ( GreensFunc& green, TimeIndex time_index, Spin spin ) const ;
 
+            // fill the diagonal elements exp( +-alpha * s(t,i) ) of expV(t) or its inverse, looked up from the tables
+            void fill_expV_diagonal( TimeIndex time_index, Spin spin, bool is_inverse, Vector& diag ) const ;
+
+
+        protected:
+
+            // look up exp( alpha * x ) and exp( 2 * alpha * x ) for x = +1 or -1
+            const RealScalar exp_alpha  ( int x ) const { return this->m_exp_alpha[(x+1)/2]; }
+            const RealScalar exp_2alpha ( int x ) const { return this->m_exp_2alpha[(x+1)/2]; }
+
     };
 
 } // namespace Model
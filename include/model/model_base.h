@@ -8,6 +8,7 @@
   *  which is pure virtual, for describing different kinds of quantum models.
   */  
 
+#include <array>
 #include <memory>
 #include <functional>
 #define EIGEN_USE_MKL_ALL
@@ -28,6 +29,10 @@ namespace CheckerBoard {
     class CheckerBoardBase;
 }
 
+namespace Utils {
+    class Philox;
+}
+
 namespace Model {
 
     // useful aliases
@@ -40,6 +45,7 @@ namespace Model {
     using LatticeBase = Lattice::LatticeBase;
     using CheckerBoardBase = CheckerBoard::CheckerBoardBase;
     using Matrix = Eigen::MatrixXd;
+    using Vector = Eigen::VectorXd;
 
     using GreensFunc = Eigen::MatrixXd;
     using GreensFuncVec = std::vector<Eigen::MatrixXd>;
@@ -49,6 +55,7 @@ namespace Model {
     using MultExpKMethod = void( GreensFunc& );
     using MultInvExpKMethod = void( GreensFunc& );
     using MultTransExpKMethod = void( GreensFunc& );
+    using MultExpKDiagMethod = void( GreensFunc&, const Vector& );
 
 
     // ------------------------------------- Abstract base class Model::ModelBase ------------------------------------------
@@ -82,11 +89,12 @@ namespace Model {
             // In conclusion, directly computing the expK or expV are not a necessity
             // For better performance, depending on specific lattice and model, 
             // it's recommended to link the Model class to a specific checkerboard class.
-            Matrix m_expK_mat{};
+            // the exponents of K are immutable once initialized, and are shared among the clones of the model.
+            std::shared_ptr<const Matrix> m_expK_mat{};
+            std::shared_ptr<const Matrix> m_inv_expK_mat{};
+            std::shared_ptr<const Matrix> m_trans_expK_mat{};
             Matrix m_expV_mat{};
-            Matrix m_inv_expK_mat{};
             Matrix m_inv_expV_mat{};
-            Matrix m_trans_expK_mat{};
             Matrix m_trans_expV_mat{};
 
             // function pointers for multiplying exponent of K matrix to a dense matrix
@@ -98,12 +106,32 @@ namespace Model {
             std::function<MultInvExpKMethod>    m_mult_inv_expK_from_right{};
             std::function<MultTransExpKMethod>  m_mult_trans_expK_from_left{};
 
+            // function pointers for multiplying exponent of K matrix together with the diagonal expV(t),
+            // which are linked only to the checkerboard methods, where the diagonal scaling is fused into the breakups
+            std::function<MultExpKDiagMethod>   m_mult_diag_expK_from_left{};
+            std::function<MultExpKDiagMethod>   m_mult_diag_expK_from_right{};
+            std::function<MultExpKDiagMethod>   m_mult_inv_expK_diag_from_left{};
+            std::function<MultExpKDiagMethod>   m_mult_inv_expK_diag_from_right{};
+            std::function<MultExpKDiagMethod>   m_mult_trans_expK_diag_from_left{};
+
+            // whether the model is linked to the checkerboard breakups, or to the dense exponent of K
+            bool m_is_checkerboard{false};
+
+            // preallocated buffers for the products of the gemm in the dense multiplications of B matrices.
+            // one buffer for each spin sector, since the two sectors may be wrapped concurrently by the walker.
+            mutable std::array<Matrix, 2> m_product_buffer{};
+
+            // preallocated buffers for the diagonal elements of expV(t) ( or its inverse ) of each spin sector,
+            // which are refilled in place for every multiplication of the B matrices.
+            mutable std::array<Vector, 2> m_expV_buffer{};
+
             // other model parameters should be defined in the derived Model classes.
 
 
         public:
 
             ModelBase() = default;
+            virtual ~ModelBase() = default;
 
             // ------------------------------------------ Setup interfaces -----------------------------------------------
 
@@ -111,8 +139,14 @@ namespace Model {
             virtual void set_model_params(RealScalar, RealScalar, RealScalar) = 0;
 
             virtual const RealScalar HoppingT() const = 0; 
+            virtual const RealScalar OnSiteU() const = 0;
             virtual const RealScalar ChemicalPotential() const = 0;
 
+            // whether the spin-up and spin-down sectors are coupled to the bosonic fields in the same way,
+            // in which case the two sectors share identical B matrices and greens functions,
+            // and it is sufficient for DqmcWalker to propagate only the spin-up sector.
+            virtual const bool isSpinSymmetric() const { return false; }
+
 
             // ----------------------------------------- Initializations -------------------------------------------------
 
@@ -121,8 +155,22 @@ namespace Model {
             virtual void initial_params      (const LatticeBase& lattice, const Walker& walker) = 0;
             virtual void initial_KV_matrices (const LatticeBase& lattice, const Walker& walker) = 0;
 
-            // randomize the bosonic fields, which is model-dependent
-            virtual void set_bosonic_fields_to_random() = 0;
+            // randomize the bosonic fields with the given random engine, e.g. the one of the walker,
+            // which is model-dependent
+            virtual void set_bosonic_fields_to_random( Utils::Philox& rng ) = 0;
+
+            // flattened configurations of the bosonic fields, and the replacement of them,
+            // e.g. for exchanging the configurations between replicas of different model parameters
+            virtual const Vector BosonicFields() const = 0;
+            virtual void set_bosonic_fields( const Vector& fields ) = 0;
+
+            // logarithm of the weight of the bosonic fields apart from the fermion determinants,
+            // up to a constant independent of the configurations, which is model-dependent
+            virtual const RealScalar LogBosonicWeight() const { return 0.0; }
+
+            // copy of the initialized model, e.g. for the companion walkers of the walker pool,
+            // which owns its bosonic fields and buffers but shares the exponents of K and the linked checkerboard.
+            virtual std::unique_ptr<ModelBase> clone() const = 0;
 
             
             // ------------------------------------------ Linking methods ------------------------------------------------
@@ -149,6 +197,11 @@ namespace Model {
             // given a specific update of the bosonic fields
             virtual void update_greens_function(Walker& walker, TimeIndex time_index, SpaceIndex space_index) = 0;
             
+            // return the diagonal element of \delta = exp( -dt V'_sigma ) * exp( +dt V_sigma ) - 1
+            // at the flipped site, given a specific update of the bosonic fields,
+            // which is required by the delayed updates of the greens functions in DqmcWalker
+            virtual const double get_update_delta(TimeIndex time_index, SpaceIndex space_index, Spin spin) const = 0;
+            
 
             // ------------------------------------------ Warpping methods -----------------------------------------------
 
@@ -162,6 +215,34 @@ namespace Model {
             virtual void mult_invB_from_right   ( GreensFunc& green, TimeIndex time_index, Spin spin ) const = 0;
             virtual void mult_transB_from_left  ( GreensFunc& green, TimeIndex time_index, Spin spin ) const = 0;
 
+            // fill in place the diagonal elements of expV(t) = exp( -dt V_sigma(t) ), or of its inverse if is_inverse is true,
+            // for the models whose V matrices are diagonal
+            virtual void fill_expV_diagonal( TimeIndex time_index, Spin spin, bool is_inverse, Vector& diag ) const = 0;
+
+            // wrap the greens functions of both spin sectors to the neighbouring time slice at once,
+            //      G_sigma  ->  B_sigma(t) * G_sigma * B_sigma(t)^-1     ( forwards )
+            //      G_sigma  ->  B_sigma(t)^-1 * G_sigma * B_sigma(t)     ( backwards )
+            // for the dense exponent of K, the products of the two sectors are issued as batched gemm calls,
+            // which amortizes the dispatching overhead of the small products on small lattices.
+            // otherwise the two sectors are wrapped one after another using the checkerboard breakups.
+            void wrap_forwards_batched  ( GreensFunc& green_up, GreensFunc& green_dn, TimeIndex time_index ) const ;
+            void wrap_backwards_batched ( GreensFunc& green_up, GreensFunc& green_dn, TimeIndex time_index ) const ;
+
+
+        protected:
+
+            // multiply the B matrices B(t) = expV(t) * expK to the greens function in place, 
+            // for models whose V matrices are diagonal, with the diagonal elements of expV(t) ( or its inverse )
+            // filled into the diagonal buffer of the spin sector by fill_expV_diagonal().
+            // for the dense exponent of K, G is passed over by a single gemm into the preallocated buffer,
+            // and the diagonal scaling is performed as a separate O(N^2) pass, or folded into the copy back to G.
+            // otherwise the checkerboard breakups are performed in place, with the diagonal scaling fused into their first or last pass.
+            void mult_expV_expK_from_left       ( GreensFunc& green, TimeIndex time_index, Spin spin ) const ;   // expV * expK * G
+            void mult_expV_expK_from_right      ( GreensFunc& green, TimeIndex time_index, Spin spin ) const ;   // G * expV * expK
+            void mult_inv_expK_expV_from_left   ( GreensFunc& green, TimeIndex time_index, Spin spin ) const ;   // expK^-1 * expV^-1 * G
+            void mult_inv_expK_expV_from_right  ( GreensFunc& green, TimeIndex time_index, Spin spin ) const ;   // G * expK^-1 * expV^-1
+            void mult_trans_expK_expV_from_left ( GreensFunc& green, TimeIndex time_index, Spin spin ) const ;   // expK^T * expV * G
+
         
         private:
 
@@ -173,6 +254,14 @@ namespace Model {
             void mult_inv_expK_from_left    ( GreensFunc& green ) const ;
             void mult_inv_expK_from_right   ( GreensFunc& green ) const ;
             void mult_trans_expK_from_left  ( GreensFunc& green ) const ;
+
+            // diagonal of expV(t) ( or its inverse ) filled into the buffer of the spin sector
+            const Vector& expV_diagonal( TimeIndex time_index, Spin spin, bool is_inverse ) const ;
+
+            // batched dense products c[s] = a[s] * b[s] of the two spin sectors, in a single call of cblas_dgemm_batch
+            static void gemm_batched( const std::array<const Matrix*, 2>& a, 
+                                      const std::array<const Matrix*, 2>& b, 
+                                      const std::array<Matrix*, 2>& c );
     };
 
 }
@@ -2,21 +2,78 @@
 #define UTILS_RANDOM_H
 #pragma once
 
-#include <random>
+#include <array>
+#include <cstdint>
+#include <limits>
 
 namespace Utils {
 
-    // --------------------  Utils::Random class for generating random seeds used in MPI program  ----------------------
-    class Random {
+    // ------------------------  Utils::Philox class of counter-based random number generator  -------------------------
+    // Philox4x32-10 generator ( Salmon et al., SC'11 ), which maps a 128-bit counter and a 64-bit key
+    // to four 32-bit random words by ten rounds of multiply-xor bijections.
+    // the key consists of the random seed and the rank of the MPI process,
+    // and the upper half of the counter labels the stream, e.g. the id of the walker,
+    // so that the streams of different ranks and walkers are statistically independent by construction.
+    // the generator meets the requirements of UniformRandomBitGenerator and works with the std distributions.
+    class Philox {
         public:
-            static std::default_random_engine Engine;
+            using result_type = std::uint32_t;
+            using Block = std::array<std::uint32_t, 4>;
+            using Key = std::array<std::uint32_t, 2>;
 
-            // explicitly setup seeds for the random engine
-            // e.g. set_seed(123) with fixed seed for debug usages
-            // or set_seed( time(nullptr)+rank ) to setup different seeds for different Mpi processes
-            static void set_seed( const int seed );
+            Philox() = default;
+            Philox( std::uint32_t seed, std::uint32_t rank, std::uint32_t stream ) { this->set_key( seed, rank, stream ); }
+
+            // set up the key and the stream, and reset the counter
+            // e.g. set_key( 12345, rank, walker_id ) to reproduce a previous run with the same seed
+            void set_key( std::uint32_t seed, std::uint32_t rank, std::uint32_t stream );
+
+            static constexpr result_type min() { return 0; }
+            static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+            // next random 32-bit word
+            result_type operator()();
+
+            // uniform random number in [0,1) with 53 random bits
+            double uniform();
+
+            // fill the array with uniform random numbers in [0,1),
+            // generating two numbers from each block of the counter
+            void fill_uniform( double* data, int size );
+
+            const std::uint32_t Seed() const        { return this->m_key[0]; }
+            const std::uint32_t Rank() const        { return this->m_key[1]; }
+            const std::uint32_t Stream() const      { return this->m_stream; }
+            const std::uint64_t BlockCounter() const { return this->m_block_counter; }
+
+            // the Philox4x32-10 bijection of one counter block under the key,
+            // where the block of counter n is { n_low, n_high, stream, 0 } under the key { seed, rank }.
+            // it is checked against the known-answer vectors of the reference implementation Random123.
+            static Block philox4x32_10( Block counter, Key key );
+
+            // serialization of the full state of the generator, e.g. for the checkpoints,
+            // including the random words of the current block not handed out yet
+            template<class Archive> void serialize( Archive& ar, const unsigned int version ) {
+                for ( auto& key : this->m_key ) { ar & key; }
+                ar & this->m_stream;
+                ar & this->m_block_counter;
+                for ( auto& word : this->m_buffer ) { ar & word; }
+                ar & this->m_buffer_pos;
+            }
+
+        private:
+            Key m_key{};
+            std::uint32_t m_stream{};
+            std::uint64_t m_block_counter{};
+
+            // random words of the current block, which are handed out one by one
+            Block m_buffer{};
+            int m_buffer_pos{4};
+
+            // generate the block of the current counter and increase the counter
+            Block next_block();
     };
 
 } // namespace Utils
 
-#endif // UTILS_RANDOM_H
\ No newline at end of file
+#endif // UTILS_RANDOM_H
@@ -0,0 +1,121 @@
+#ifndef REPLICA_EXCHANGE_H
+#define REPLICA_EXCHANGE_H
+#pragma once
+
+
+/**
+  *  This header file defines QuantumMonteCarlo::ReplicaExchange class for the parallel tempering,
+  *  in which the MPI processes simulate replicas of the system with different values of one parameter,
+  *  namely the onsite interaction U, the chemical potential mu or the inverse temperature beta,
+  *  and configurations of neighbouring replicas are swapped from time to time
+  *  according to the ratio of their dqmc weights.
+  */
+
+#include <string_view>
+#include <vector>
+#include <boost/mpi/communicator.hpp>
+
+namespace Model { class ModelBase; }
+namespace Lattice { class LatticeBase; }
+
+
+namespace QuantumMonteCarlo {
+
+    // forward declaration
+    class DqmcWalker;
+
+    using ModelBase = Model::ModelBase;
+    using LatticeBase = Lattice::LatticeBase;
+
+
+    // ------------------------------ Crucial class QuantumMonteCarlo::ReplicaExchange ------------------------------
+    class ReplicaExchange {
+        public:
+
+            // the parameter varied among the replicas
+            enum class Parameter { OnSiteU, ChemicalPotential, Beta };
+
+        private:
+
+            Parameter m_parameter{};
+            std::vector<double> m_values{};         // parameter values of the replicas in order
+            int m_exchange_interval{1};             // number of sweeps forth and back between two exchange attempts
+
+            // the processes are grouped into chains of consecutive ranks, each containing all the replicas,
+            // and the replica index of a process equals to its rank within the chain.
+            // the processes simulating the same replica form the replica communicator,
+            // among which the bins of measurements are distributed and gathered.
+            int m_replica{};
+            int m_chain{};
+            boost::mpi::communicator m_chain_comm{};
+            boost::mpi::communicator m_replica_comm{};
+
+            // counters of the sweeps and of the exchange rounds,
+            // where the pairs ( i, i+1 ) with even and odd i are attempted in alternating rounds.
+            int m_sweep_count{};
+            int m_round_count{};
+
+            // number of attempted and accepted exchanges of the pairs ( i, i+1 ), recorded by the replica i,
+            // which are summed over all the chains after gather_statistics() is called
+            std::vector<int> m_attempts{};
+            std::vector<int> m_accepts{};
+
+
+        public:
+
+            ReplicaExchange() = default;
+
+            // ------------------------------------------ Interfaces -----------------------------------------------
+
+            const Parameter ReplicaParameter() const        { return this->m_parameter; }
+            const std::string_view ParameterName() const;
+            const int ReplicasNum() const                   { return this->m_values.size(); }
+            const int Replica() const                       { return this->m_replica; }
+            const double Value( int replica ) const         { return this->m_values[replica]; }
+            const int ExchangeInterval() const              { return this->m_exchange_interval; }
+            const boost::mpi::communicator& ReplicaComm() const { return this->m_replica_comm; }
+
+            // acceptance statistics of the exchanges between the replicas i and i+1
+            const int Attempts( int i ) const               { return this->m_attempts[i]; }
+            const int Accepts( int i ) const                { return this->m_accepts[i]; }
+            const double AcceptanceRate( int i ) const;
+
+
+            // ------------------------------------------ Setup and initialization ------------------------------------------
+
+            // set up the varied parameter, its values of the replicas and the pace of exchanges
+            void set_params( Parameter parameter, const std::vector<double>& values, int exchange_interval );
+
+            // split the processes into chains and replicas,
+            // and the number of processes should be a multiple of the number of replicas
+            void initial( const boost::mpi::communicator& world );
+
+            // overwrite the varied parameter of the model or the walker with the value of the replica,
+            // which should be called before the modules are initialized
+            void set_replica_params( ModelBase& model, DqmcWalker& walker ) const;
+
+
+            // --------------------------------------------- Exchanges ---------------------------------------------
+
+            // count the sweep forth and back of the walker, and attempt an exchange of the configurations
+            // with the neighbouring replica every 'exchange_interval' sweeps.
+            // the walker should be at time slice 0 with the svd stacks ready, i.e. at the end of a sweep from beta to 0.
+            void exchange( DqmcWalker& walker, ModelBase& model, const LatticeBase& lattice );
+
+            // sum up the acceptance statistics over all the processes
+            void gather_statistics( const boost::mpi::communicator& world );
+
+            // serialization of the counters of the exchanges, e.g. for the checkpoints
+            template<class Archive> void serialize( Archive& ar, const unsigned int version ) {
+                ar & this->m_sweep_count;
+                ar & this->m_round_count;
+                ar & this->m_attempts;
+                ar & this->m_accepts;
+            }
+
+    };
+
+} // namespace QuantumMonteCarlo
+
+
+#endif // REPLICA_EXCHANGE_H
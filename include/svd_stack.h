@@ -5,16 +5,27 @@
   *  This head file includes SvdClass and SvdStack class for stable 
   *  multiplication of long chains of dense matrices.
   *  BLAS and LAPACK libraries are needed for the svd decomposition.
+  *  Besides the svd, the column-pivoting QR (UDT) and the Jacobi svd
+  *  decompositions are also supported for the stabilizations.
   */
 
 #include <vector>
 #define EIGEN_USE_MKL_ALL
 #define EIGEN_VECTORIZE_SSE4_2
 #include <Eigen/Core>
+#include "utils/linear_algebra.hpp"
 
 
 namespace Utils {
 
+    // supported decomposition methods for the stabilization of matrix chains
+    //   1. SVD       : singular value decomposition using dgesvd
+    //   2. QRP       : column-pivoting QR ( UDT ) decomposition using dgeqp3,
+    //                  which is cheaper than svd, but the resulting V matrix is not orthogonal
+    //   3. JacobiSVD : singular value decomposition using one-sided Jacobi rotations ( dgesvj ),
+    //                  which is slower but more accurate for the small singular values
+    enum class Decomposition { SVD, QRP, JacobiSVD };
+
 
     // ------------------------------------------  Utils::SvdClass  ----------------------------------------------
     class SvdClass {
@@ -40,11 +51,16 @@ namespace Utils {
             uMat& MatrixU() { return this->m_u_mat; }
             sVec& SingularValues() { return this->m_s_vec; }
             vMat& MatrixV() { return this->m_v_mat; }
+
+            const uMat& MatrixU() const { return this->m_u_mat; }
+            const sVec& SingularValues() const { return this->m_s_vec; }
+            const vMat& MatrixV() const { return this->m_v_mat; }
     };
 
 
     // -----------------------  Utils::SvdStack class for multiplications of matrix stacks  ----------------------
     // udv stack of a matrix product: u * d * vt = ... A_2 * A_1 * A_0
+    // the u matrix is always orthogonal, while the orthogonality of v depends on the decomposition method.
     class SvdStack {
 
         private:
@@ -59,25 +75,42 @@ namespace Utils {
             int m_mat_dim{};  
             int m_stack_length{0};
 
+            // accumulated products of the v matrices, V_0 * V_1 * ... * V_i for the i-th level of the stack,
+            // which are updated incrementally during push()
+            std::vector<Matrix> m_v_prods{};
+
             Matrix m_tmp_matrix{};
 
+            // method of the udv decompositions
+            Decomposition m_decomposition{Decomposition::SVD};
+
+            // persistent workspaces for the decompositions,
+            // and only the one for the chosen method is allocated
+            SvdWorkspace m_svd_workspace{};
+            QrpWorkspace m_qrp_workspace{};
+            JacobiSvdWorkspace m_jacobi_svd_workspace{};
+
         public:
 
             EIGEN_MAKE_ALIGNED_OPERATOR_NEW
 
             SvdStack() = default;
 
-            explicit SvdStack(int mat_dim, int stack_length);
+            explicit SvdStack(int mat_dim, int stack_length, Decomposition decomposition = Decomposition::SVD);
 
             // interface
             bool empty() const;
             int MatDim() const;
             int StackLength() const;
+            Decomposition DecompositionMethod() const;
+
+            // whether the v matrix of the stack is orthogonal, which is true for svd decompositions
+            bool isOrthogonalV() const;
 
             // return udv decomposition matrices of the stack
-            const Vector SingularValues();
-            const Matrix MatrixU();
-            const Matrix MatrixV();
+            const Vector& SingularValues() const;
+            const Matrix& MatrixU() const;
+            const Matrix& MatrixV() const;
             
             // clear the stack
             // simply set stack_length = 0, note that the memory is not really deallocated.
@@ -90,6 +123,11 @@ namespace Utils {
             // pop the last matrix from the stack
             void pop();
 
+        private:
+
+            // udv decomposition of a matrix using the chosen method
+            void decompose(const Matrix& matrix, SvdClass& udv);
+
     };
 
 } // namespace Utils
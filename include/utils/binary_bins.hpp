@@ -0,0 +1,258 @@
+#ifndef UTILS_BINARY_BINS_HPP
+#define UTILS_BINARY_BINS_HPP
+#pragma once
+
+/**
+  *  This source file includes the binary container of the bin data of observables,
+  *  with the writer Utils::BinaryBins::write() and the memory-mapped reader Utils::BinsReader.
+  *
+  *  Layout of the file, with all the integers and floating numbers stored in little-endian:
+  *      offset  0 :  char[8]   magic string "DQMCBINS"
+  *      offset  8 :  uint32    version of the format
+  *      offset 12 :  uint32    rank of the observable, 0 for scalar, 1 for vector and 2 for matrix
+  *      offset 16 :  uint64    number of rows of one bin ( 1 for scalar )
+  *      offset 24 :  uint64    number of columns of one bin ( 1 for scalar and vector )
+  *      offset 32 :  uint64    number of bins
+  *      offset 40 :  uint64    length of the name of the observable
+  *      offset 48 :  uint64    byte offset of the data, aligned to 64 bytes
+  *      offset 56 :  char[]    name of the observable, followed by zero paddings up to the data offset
+  *  The data are a ( rows*cols ) x bins matrix of doubles in column-major order,
+  *  i.e. each bin is one contiguous column holding the column-major storage of the Eigen object,
+  *  which is written directly from the Eigen storage and read back as Eigen::Map without copies.
+  */
+
+#include <cstdint>
+#include <cstring>
+#include <cassert>
+#include <string>
+#include <fstream>
+#include <iostream>
+#include <vector>
+#include <type_traits>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <Eigen/Core>
+
+
+namespace Utils {
+
+    // -----------------------------------------  Utils::BinaryBins  ---------------------------------------------
+    class BinaryBins {
+        public:
+
+            static constexpr char magic[8] = { 'D', 'Q', 'M', 'C', 'B', 'I', 'N', 'S' };
+            static constexpr std::uint32_t version = 1;
+            static constexpr std::uint64_t header_size = 56;
+            static constexpr std::uint64_t alignment = 64;
+
+            static bool is_little_endian() {
+                const std::uint16_t one = 1;
+                unsigned char byte{};
+                std::memcpy( &byte, &one, 1 );
+                return byte == 1;
+            }
+
+            // byte offset of the data for a given length of the name
+            static std::uint64_t data_offset( std::uint64_t name_length ) {
+                return ( header_size + name_length + alignment - 1 ) / alignment * alignment;
+            }
+
+
+            // write the bins of a scalar ( double ), vector ( Eigen::VectorXd ) or matrix ( Eigen::MatrixXd ) observable,
+            // where all the bins should share the same shape
+            template<typename ObsType>
+            static void write( std::ofstream& ofstream, const std::string& name, const std::vector<ObsType>& bins )
+            {
+                std::uint32_t rank{};
+                std::uint64_t rows{1}, cols{1};
+                if constexpr ( std::is_same_v<ObsType, double> ) {
+                    rank = 0;
+                }
+                else {
+                    rank = ( ObsType::ColsAtCompileTime == 1 )? 1 : 2;
+                    rows = ( bins.empty() )? 0 : bins.front().rows();
+                    cols = ( bins.empty() )? 0 : bins.front().cols();
+                }
+
+                // header
+                const std::uint64_t name_length = name.size();
+                const std::uint64_t offset = data_offset( name_length );
+                ofstream.write( magic, sizeof(magic) );
+                write_integer( ofstream, version );
+                write_integer( ofstream, rank );
+                write_integer( ofstream, rows );
+                write_integer( ofstream, cols );
+                write_integer( ofstream, (std::uint64_t)bins.size() );
+                write_integer( ofstream, name_length );
+                write_integer( ofstream, offset );
+                ofstream.write( name.data(), name_length );
+                const std::vector<char> padding( offset - header_size - name_length, '\0' );
+                ofstream.write( padding.data(), padding.size() );
+
+                // contiguous arrays of the bins, written directly from the storage on little-endian machines
+                for ( const auto& bin : bins ) {
+                    if constexpr ( std::is_same_v<ObsType, double> ) {
+                        write_doubles( ofstream, &bin, 1 );
+                    }
+                    else {
+                        assert( (std::uint64_t)bin.rows() == rows && (std::uint64_t)bin.cols() == cols );
+                        write_doubles( ofstream, bin.data(), bin.size() );
+                    }
+                }
+
+                if ( !ofstream ) {
+                    std::cerr << "Utils::BinaryBins::write(): "
+                              << "fail to write the bins of \'" << name << "\'." << std::endl;
+                    exit(1);
+                }
+            }
+
+
+        private:
+
+            template<typename IntType>
+            static void write_integer( std::ofstream& ofstream, IntType value ) {
+                unsigned char bytes[sizeof(IntType)];
+                for ( std::size_t i = 0; i < sizeof(IntType); ++i ) {
+                    bytes[i] = static_cast<unsigned char>( ( value >> (8*i) ) & 0xff );
+                }
+                ofstream.write( reinterpret_cast<const char*>(bytes), sizeof(IntType) );
+            }
+
+            static void write_doubles( std::ofstream& ofstream, const double* data, std::size_t size ) {
+                if ( is_little_endian() ) {
+                    ofstream.write( reinterpret_cast<const char*>(data), size * sizeof(double) );
+                }
+                else {
+                    for ( std::size_t i = 0; i < size; ++i ) {
+                        std::uint64_t bits{};
+                        std::memcpy( &bits, data + i, sizeof(double) );
+                        write_integer( ofstream, bits );
+                    }
+                }
+            }
+    };
+
+
+    // -----------------------------------------  Utils::BinsReader  ---------------------------------------------
+    // read-only view of a binary bins file, memory-mapped so that only the accessed pages are loaded.
+    // the arrays are exposed as Eigen::Map without copies, hence a little-endian machine is required.
+    class BinsReader {
+        private:
+
+            int m_fd{-1};
+            void* m_address{MAP_FAILED};
+            std::size_t m_file_size{};
+
+            std::uint32_t m_rank{};
+            std::uint64_t m_rows{}, m_cols{}, m_bin_num{};
+            std::string m_name{};
+            const double* m_data{nullptr};
+
+
+        public:
+
+            using ConstMatrixMap = Eigen::Map<const Eigen::MatrixXd, Eigen::Aligned64>;
+
+            explicit BinsReader( const std::string& filename )
+            {
+                if ( !BinaryBins::is_little_endian() ) {
+                    std::cerr << "Utils::BinsReader::BinsReader(): "
+                              << "the memory-mapped reader requires a little-endian machine." << std::endl;
+                    exit(1);
+                }
+
+                this->m_fd = open( filename.c_str(), O_RDONLY );
+                struct stat file_stat{};
+                if ( this->m_fd < 0 || fstat( this->m_fd, &file_stat ) != 0 ) {
+                    std::cerr << "Utils::BinsReader::BinsReader(): "
+                              << "fail to open the file \'" << filename << "\'." << std::endl;
+                    exit(1);
+                }
+                this->m_file_size = file_stat.st_size;
+                if ( this->m_file_size < BinaryBins::header_size ) { this->invalid(filename); }
+
+                this->m_address = mmap( nullptr, this->m_file_size, PROT_READ, MAP_PRIVATE, this->m_fd, 0 );
+                if ( this->m_address == MAP_FAILED ) {
+                    std::cerr << "Utils::BinsReader::BinsReader(): "
+                              << "fail to map the file \'" << filename << "\' into memory." << std::endl;
+                    exit(1);
+                }
+
+                // parse and validate the header
+                const char* bytes = static_cast<const char*>(this->m_address);
+                if ( std::memcmp( bytes, BinaryBins::magic, sizeof(BinaryBins::magic) ) != 0 ) { this->invalid(filename); }
+                if ( read_integer<std::uint32_t>(bytes + 8) != BinaryBins::version ) { this->invalid(filename); }
+                this->m_rank = read_integer<std::uint32_t>(bytes + 12);
+                this->m_rows = read_integer<std::uint64_t>(bytes + 16);
+                this->m_cols = read_integer<std::uint64_t>(bytes + 24);
+                this->m_bin_num = read_integer<std::uint64_t>(bytes + 32);
+                const auto name_length = read_integer<std::uint64_t>(bytes + 40);
+                const auto offset = read_integer<std::uint64_t>(bytes + 48);
+
+                if ( offset != BinaryBins::data_offset(name_length)
+                     || offset + this->m_rows * this->m_cols * this->m_bin_num * sizeof(double) != this->m_file_size ) {
+                    this->invalid(filename);
+                }
+                this->m_name.assign( bytes + BinaryBins::header_size, name_length );
+                this->m_data = reinterpret_cast<const double*>( bytes + offset );
+            }
+
+            ~BinsReader()
+            {
+                if ( this->m_address != MAP_FAILED ) { munmap( this->m_address, this->m_file_size ); }
+                if ( this->m_fd >= 0 ) { close( this->m_fd ); }
+            }
+
+            BinsReader( const BinsReader& ) = delete;
+            BinsReader& operator=( const BinsReader& ) = delete;
+
+
+            // -------------------------------------  Interface functions  ------------------------------------------
+
+            const std::string& name() const { return this->m_name; }
+            int rank() const { return this->m_rank; }
+            int rows() const { return this->m_rows; }
+            int cols() const { return this->m_cols; }
+            int bin_num() const { return this->m_bin_num; }
+
+            // all the bins as a ( rows*cols ) x bins matrix, one bin per column
+            ConstMatrixMap bins() const {
+                return ConstMatrixMap( this->m_data, this->m_rows * this->m_cols, this->m_bin_num );
+            }
+
+            // one bin in the original shape of the observable
+            Eigen::Map<const Eigen::MatrixXd> bin( int bin ) const {
+                assert( bin >= 0 && bin < (int)this->m_bin_num );
+                return Eigen::Map<const Eigen::MatrixXd>( this->m_data + bin * this->m_rows * this->m_cols,
+                                                          this->m_rows, this->m_cols );
+            }
+
+            // the scalar value of one bin for scalar observables
+            double scalar( int bin ) const {
+                assert( this->m_rank == 0 );
+                return this->m_data[bin];
+            }
+
+
+        private:
+
+            template<typename IntType>
+            static IntType read_integer( const char* bytes ) {
+                IntType value{};
+                std::memcpy( &value, bytes, sizeof(IntType) );
+                return value;
+            }
+
+            [[noreturn]] static void invalid( const std::string& filename ) {
+                std::cerr << "Utils::BinsReader::BinsReader(): "
+                          << "\'" << filename << "\' is not a valid file of binary bins." << std::endl;
+                exit(1);
+            }
+    };
+
+} // namespace Utils
+
+#endif // UTILS_BINARY_BINS_HPP
@@ -7,7 +7,8 @@
   *  for diagonalizing real matrices using mkl and lapack.
   *  including:
   *    1. generalized SVD decomposition for arbitrary M * N matrices
-  *    2. optimized diagonalizing mechanism for N * N real symmetric matrix
+  *    2. column-pivoting QR (UDT) decomposition and one-sided Jacobi SVD for N * N matrices
+  *    3. optimized diagonalizing mechanism for N * N real symmetric matrix
   *  The calculation accuracy and efficiency are guaranteed.
   */
 
@@ -17,10 +18,113 @@
 #include <Eigen/Core>
 #include <mkl_lapacke.h>
 #include <iostream>
+#include <algorithm>
+#include <cassert>
 
 
 namespace Utils {
 
+    // -------------------------------------  Utils::SvdWorkspace class  -----------------------------------------
+    // persistent workspace for the SVD decompositions of `row` * `col` real matrices.
+    // the memory is allocated, aligned by Eigen, once and for all on construction,
+    // such that repeated decompositions of matrices with the same size are free of allocations.
+    class SvdWorkspace {
+
+        public:
+
+            Eigen::MatrixXd m_mat{};       // copy of the input matrix, destroyed by lapack
+            Eigen::MatrixXd m_vt{};        // V transpose, `col` * `col`
+            Eigen::VectorXd m_work{};      // workspace array of dgesvd
+            lapack_int m_lwork{};
+
+            SvdWorkspace() = default;
+
+            explicit SvdWorkspace( int row, int col ) { this->resize(row, col); }
+
+            void resize( int row, int col ) 
+            {
+                this->m_mat.resize(row, col);
+                this->m_vt.resize(col, col);
+
+                // query the optimal size of the workspace array
+                double work_query = 0.0;
+                const lapack_int info = LAPACKE_dgesvd_work( LAPACK_COL_MAJOR, 'A', 'A', row, col, 
+                                                             nullptr, row, nullptr, nullptr, row, nullptr, col, 
+                                                             &work_query, -1 );
+                if ( info != 0 ) {
+                    std::cerr << "Utils::SvdWorkspace::resize(): "
+                              << "fail to query the workspace size of dgesvd." << std::endl;
+                    exit(1);
+                }
+                this->m_lwork = static_cast<lapack_int>(work_query);
+                this->m_work.resize(this->m_lwork);
+            }
+    };
+
+
+    // -------------------------------------  Utils::QrpWorkspace class  -------------------------------------------
+    // persistent workspace for the column-pivoting QR decompositions of N * N real matrices.
+    class QrpWorkspace {
+
+        public:
+
+            Eigen::MatrixXd m_mat{};                                // input matrix, overwritten by R and Q
+            Eigen::VectorXd m_tau{};                                // scalar factors of the elementary reflectors
+            Eigen::Matrix<lapack_int, Eigen::Dynamic, 1> m_jpvt{};  // column permutations
+            Eigen::VectorXd m_work{};                               // workspace array of dgeqp3 and dorgqr
+            lapack_int m_lwork{};
+
+            QrpWorkspace() = default;
+
+            explicit QrpWorkspace( int dim ) { this->resize(dim); }
+
+            void resize( int dim ) 
+            {
+                this->m_mat.resize(dim, dim);
+                this->m_tau.resize(dim);
+                this->m_jpvt.resize(dim);
+
+                // query the optimal size of the workspace array
+                double work_query_qp3 = 0.0, work_query_orgqr = 0.0;
+                const lapack_int info_qp3 = LAPACKE_dgeqp3_work( LAPACK_COL_MAJOR, dim, dim, 
+                                                                 nullptr, dim, nullptr, nullptr, 
+                                                                 &work_query_qp3, -1 );
+                const lapack_int info_orgqr = LAPACKE_dorgqr_work( LAPACK_COL_MAJOR, dim, dim, dim, 
+                                                                   nullptr, dim, nullptr, 
+                                                                   &work_query_orgqr, -1 );
+                if ( info_qp3 != 0 || info_orgqr != 0 ) {
+                    std::cerr << "Utils::QrpWorkspace::resize(): "
+                              << "fail to query the workspace size of dgeqp3." << std::endl;
+                    exit(1);
+                }
+                this->m_lwork = static_cast<lapack_int>(std::max(work_query_qp3, work_query_orgqr));
+                this->m_work.resize(this->m_lwork);
+            }
+    };
+
+
+    // -----------------------------------  Utils::JacobiSvdWorkspace class  ----------------------------------------
+    // persistent workspace for the one-sided Jacobi SVD decompositions of N * N real matrices.
+    class JacobiSvdWorkspace {
+
+        public:
+
+            Eigen::VectorXd m_work{};      // workspace array of dgesvj
+            lapack_int m_lwork{};
+
+            JacobiSvdWorkspace() = default;
+
+            explicit JacobiSvdWorkspace( int dim ) { this->resize(dim); }
+
+            void resize( int dim ) 
+            {
+                // minimal size of the workspace array required by dgesvj
+                this->m_lwork = std::max(6, 2 * dim);
+                this->m_work.resize(this->m_lwork);
+            }
+    };
+
+
     // -------------------------------------  Utils::LinearAlgebra class  ----------------------------------------
     class LinearAlgebra {
 
@@ -30,6 +134,54 @@ namespace Utils {
           *  SVD decomposition of arbitrary M * N real matrix, using MKL_LAPACK:
           *       A  ->  U * S * V^T
           *  Remind that V is returned in this subroutine, not V transpose.
+          *  Column-major lapack routine is called directly on the Eigen storage,
+          *  and the workspace is provided by the caller, hence no memory is allocated.
+          *
+          *  @param workspace -> workspace of type Utils::SvdWorkspace, matching the size of `mat`.
+          *  @param mat -> arbitrary `row` * `col` real matrix to be solved.
+          *  @param u -> u matrix of type Eigen::MatrixXd, `row` * `row`.
+          *  @param s -> eigenvalues s of type Eigen::VectorXd, descending sorted.
+          *  @param v -> v matrix of type Eigen::MatrixXd, `col` * `col`.
+          */
+        static void mkl_lapack_dgesvd(  SvdWorkspace& workspace,
+                                        const Eigen::MatrixXd& mat, 
+                                        Eigen::MatrixXd& u, 
+                                        Eigen::VectorXd& s, 
+                                        Eigen::MatrixXd& v  ) 
+        {
+            const lapack_int row = mat.rows();
+            const lapack_int col = mat.cols();
+            assert( workspace.m_mat.rows() == row && workspace.m_mat.cols() == col );
+            assert( u.rows() == row && u.cols() == row );
+            assert( s.size() == std::min(row, col) );
+            assert( v.rows() == col && v.cols() == col );
+
+            // the input matrix is overwritten by lapack
+            workspace.m_mat = mat;
+
+            // compute SVD
+            const lapack_int info = LAPACKE_dgesvd_work( LAPACK_COL_MAJOR, 'A', 'A', row, col, 
+                                                         workspace.m_mat.data(), row, s.data(), 
+                                                         u.data(), row, workspace.m_vt.data(), col, 
+                                                         workspace.m_work.data(), workspace.m_lwork );
+
+            // check for convergence
+            if( info > 0 ) {
+                std::cerr << "Utils::LinearAlgebra::mkl_lapack_dgesvd(): "
+                          << "the algorithm computing SVD failed to converge." << std::endl;
+                exit(1);
+            }
+
+            v.noalias() = workspace.m_vt.transpose();
+        }
+
+
+        /**
+          *  SVD decomposition of arbitrary M * N real matrix, using MKL_LAPACK:
+          *       A  ->  U * S * V^T
+          *  Remind that V is returned in this subroutine, not V transpose.
+          *  A temporary workspace is allocated for each call,
+          *  and for repeated decompositions the workspace version above is preferred.
           *
           *  @param row -> number of rows.
           *  @param col -> number of cols.
@@ -47,36 +199,123 @@ namespace Utils {
         {
             assert( row == mat.rows() );
             assert( col == mat.cols() );
-            // TODO: currently, the subroutine would fail 
-            // if the input matrix has different rows and columns
-            assert( row == col );
 
-            // matrix size
-            int matrix_layout = LAPACK_ROW_MAJOR;
-            lapack_int info, lda = row, ldu = row, ldvt = col;
+            SvdWorkspace workspace(row, col);
+            u.resize(row, row);
+            s.resize(std::min(row, col));
+            v.resize(col, col);
+            mkl_lapack_dgesvd( workspace, mat, u, s, v );
+        }
 
-            // local arrays
-            double tmp_s[ldu * ldu], tmp_u[ldu * row], tmp_vt[ldvt * col];
-            double mat_in[lda * col];
-            double super_mat[ldu * lda];
 
-            // convert eigen matrix to c-style array
-            Eigen::Map<Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>>(&mat_in[0], lda, col) = mat;
+        /**
+          *  Column-pivoting QR decomposition (UDT) of N * N real matrix, using MKL_LAPACK:
+          *       A * P  ->  Q * R   such that   A  ->  U * D * V^T
+          *  with U = Q orthogonal, D = |diag(R)| and V^T = D^-1 * R * P^T.
+          *  Remind that, different from the SVD, V is well-conditioned but not orthogonal.
+          *
+          *  @param workspace -> workspace of type Utils::QrpWorkspace, matching the size of `mat`.
+          *  @param mat -> arbitrary N * N real matrix to be solved.
+          *  @param u -> orthogonal u matrix of type Eigen::MatrixXd, N * N.
+          *  @param d -> diagonal elements d of type Eigen::VectorXd, non-negative and only roughly non-increasing,
+          *               since the column pivoting does not strictly order |R_ii|.
+          *  @param v -> v matrix of type Eigen::MatrixXd, N * N.
+          */
+        static void mkl_lapack_dgeqp3(  QrpWorkspace& workspace,
+                                        const Eigen::MatrixXd& mat, 
+                                        Eigen::MatrixXd& u, 
+                                        Eigen::VectorXd& d, 
+                                        Eigen::MatrixXd& v  ) 
+        {
+            const lapack_int dim = mat.rows();
+            assert( mat.cols() == dim );
+            assert( workspace.m_mat.rows() == dim && workspace.m_mat.cols() == dim );
+            assert( u.rows() == dim && u.cols() == dim );
+            assert( d.size() == dim );
+            assert( v.rows() == dim && v.cols() == dim );
 
-            // compute SVD
-            info = LAPACKE_dgesvd( matrix_layout, 'A', 'A', row, col, mat_in, lda, tmp_s, tmp_u, ldu, tmp_vt, ldvt, super_mat );
+            // the input matrix is overwritten by lapack
+            workspace.m_mat = mat;
 
-            // check for convergence
-            if( info > 0 ) {
-                std::cerr << "Utils::LinearAlgebra::mkl_lapack_dgesvd(): "
+            // all columns are free to be pivoted
+            workspace.m_jpvt.setZero();
+
+            // compute pivoted QR
+            const lapack_int info = LAPACKE_dgeqp3_work( LAPACK_COL_MAJOR, dim, dim, 
+                                                         workspace.m_mat.data(), dim, workspace.m_jpvt.data(), 
+                                                         workspace.m_tau.data(), workspace.m_work.data(), workspace.m_lwork );
+            if( info != 0 ) {
+                std::cerr << "Utils::LinearAlgebra::mkl_lapack_dgeqp3(): "
+                          << "the algorithm computing pivoted QR failed." << std::endl;
+                exit(1);
+            }
+
+            // d = |diag(R)| and V = P * R^T * D^-1, 
+            // where the upper triangle of the workspace matrix is R, and jpvt labels the permutation P (1-based).
+            // a vanishing R_ii, e.g. of a rank-deficient matrix, comes with a vanishing row i of R,
+            // which is replaced by the unit row to keep V invertible, while D * V^T = R * P^T still holds.
+            d = workspace.m_mat.diagonal().cwiseAbs();
+            for (int j = 0; j < dim; ++j) {
+                const int pj = workspace.m_jpvt(j) - 1;
+                for (int i = 0; i < dim; ++i) {
+                    if ( i > j ) { v(pj, i) = 0.0; }
+                    else if ( d(i) > 0.0 ) { v(pj, i) = workspace.m_mat(i, j) / d(i); }
+                    else { v(pj, i) = ( i == j )? 1.0 : 0.0; }
+                }
+            }
+
+            // generate the orthogonal matrix Q from the elementary reflectors
+            const lapack_int info_q = LAPACKE_dorgqr_work( LAPACK_COL_MAJOR, dim, dim, dim, 
+                                                           workspace.m_mat.data(), dim, workspace.m_tau.data(), 
+                                                           workspace.m_work.data(), workspace.m_lwork );
+            if( info_q != 0 ) {
+                std::cerr << "Utils::LinearAlgebra::mkl_lapack_dgeqp3(): "
+                          << "the algorithm generating Q matrix failed." << std::endl;
+                exit(1);
+            }
+            u = workspace.m_mat;
+        }
+
+
+        /**
+          *  SVD decomposition of N * N real matrix using one-sided Jacobi rotations, using MKL_LAPACK:
+          *       A  ->  U * S * V^T
+          *  which is slower than dgesvd, but computes the small singular values to high relative accuracy.
+          *  Remind that V is returned in this subroutine, not V transpose.
+          *
+          *  @param workspace -> workspace of type Utils::JacobiSvdWorkspace, matching the size of `mat`.
+          *  @param mat -> arbitrary N * N real matrix to be solved.
+          *  @param u -> u matrix of type Eigen::MatrixXd, N * N.
+          *  @param s -> singular values s of type Eigen::VectorXd.
+          *  @param v -> v matrix of type Eigen::MatrixXd, N * N.
+          */
+        static void mkl_lapack_dgesvj(  JacobiSvdWorkspace& workspace,
+                                        const Eigen::MatrixXd& mat, 
+                                        Eigen::MatrixXd& u, 
+                                        Eigen::VectorXd& s, 
+                                        Eigen::MatrixXd& v  ) 
+        {
+            const lapack_int dim = mat.rows();
+            assert( mat.cols() == dim );
+            assert( u.rows() == dim && u.cols() == dim );
+            assert( s.size() == dim );
+            assert( v.rows() == dim && v.cols() == dim );
+
+            // the input matrix is overwritten by the left singular vectors
+            u = mat;
+
+            // compute SVD
+            const lapack_int info = LAPACKE_dgesvj_work( LAPACK_COL_MAJOR, 'G', 'U', 'V', dim, dim, 
+                                                         u.data(), dim, s.data(), 0, v.data(), dim, 
+                                                         workspace.m_work.data(), workspace.m_lwork );
+            if( info != 0 ) {
+                std::cerr << "Utils::LinearAlgebra::mkl_lapack_dgesvj(): "
                           << "the algorithm computing SVD failed to converge." << std::endl;
                 exit(1);
             }
 
-            // convert the results into Eigen style
-            u = Eigen::Map<Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>>(tmp_u, col, col);
-            s = Eigen::Map<Eigen::Matrix<double, 1, Eigen::Dynamic, Eigen::RowMajor>>(tmp_s, 1, col);
-            v = Eigen::Map<Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::ColMajor>>(tmp_vt, row, row);
+            // the singular values are returned scaled by the factor work(1)
+            s *= workspace.m_work(0);
         }
 
 
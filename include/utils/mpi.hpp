@@ -3,10 +3,15 @@
 #pragma once
 
 /**
-  *  This source file includes implementations of the special mpi::gather method,
-  *  which is designed to collect Observable::Observable classes among a set of MPI processes.
+  *  This source file includes implementations of the special mpi::reduce and mpi::gather methods,
+  *  which are designed to collect Observable::Observable classes among a set of MPI processes.
+  *  The reduction sums up the statistics needed by the analysis in place, with the memory of each process
+  *  independent of the number of processes, while the gather collects all the raw bins into the master.
   */
 
+#include <functional>
+#include <type_traits>
+#include <mpi.h>
 #include <boost/mpi.hpp>
 #include <boost/serialization/vector.hpp>
 #include "utils/eigen_boost_serialization.hpp"
@@ -22,6 +27,68 @@ namespace Utils {
 
         public:
 
+            // sum up the data of the observable type over all the processes in place,
+            // operating on the raw buffers of the Eigen objects without serializations
+            template<typename ObsType>
+            static void allreduce_sum( const boost::mpi::communicator &world, ObsType& data )
+            {
+                if constexpr ( std::is_same_v<ObsType, Observable::ScalarType> ) {
+                    MPI_Allreduce( MPI_IN_PLACE, &data, 1, MPI_DOUBLE, MPI_SUM, world );
+                }
+                else {
+                    MPI_Allreduce( MPI_IN_PLACE, data.data(), data.size(), MPI_DOUBLE, MPI_SUM, world );
+                }
+            }
+
+
+            // reduce the bin statistics of an observable object over all the processes,
+            // namely the number of bins, the sum of the bin data and the sum of their squares,
+            // after which the observable is analysed as if all the bins were measured by the current process.
+            template<typename ObsType>
+            static void reduce_observable( const boost::mpi::communicator &world, 
+                                           Observable::Observable<ObsType>* obs )
+            {
+                obs->accumulate_bin_sums();
+                allreduce_sum( world, obs->bin_sum() );
+                allreduce_sum( world, obs->bin_sqsum() );
+                obs->set_reduced_bin_sums( boost::mpi::all_reduce( world, obs->bin_num(), std::plus<int>() ) );
+            }
+
+
+            // sum up the logarithmic binning of an observable object over all the processes,
+            // each of which contributes an independent Markov chain of measurements.
+            // the hierarchies are padded with empty levels to the same depth before the reduction.
+            template<typename ObsType>
+            static void reduce_log_binning( const boost::mpi::communicator &world, 
+                                            Observable::Observable<ObsType>* obs )
+            {
+                auto& log_binning = obs->log_binning();
+                log_binning.resize_levels( boost::mpi::all_reduce( world, log_binning.levels(), boost::mpi::maximum<int>() ) );
+                for ( auto level = 0; level < log_binning.levels(); ++level ) {
+                    allreduce_sum( world, log_binning.sum(level) );
+                    allreduce_sum( world, log_binning.sqsum(level) );
+                    allreduce_sum( world, log_binning.count(level) );
+                }
+            }
+
+
+            // reduce the jackknife sums of an observable object over all the processes,
+            // with the bins of the sign as the weights, whose bin statistics should be reduced in advance.
+            // the weighted sum over all the bins is needed for the leave-one-out estimates, hence two passes.
+            template<typename ObsType>
+            static void reduce_jackknife( const boost::mpi::communicator &world, 
+                                          Observable::Observable<ObsType>* obs,
+                                          Observable::Observable<Observable::ScalarType>* sign )
+            {
+                obs->accumulate_weighted_sum( sign->bin_data() );
+                allreduce_sum( world, obs->weighted_sum() );
+                obs->accumulate_jackknife_sums( sign->bin_data(), sign->bin_sum() );
+                allreduce_sum( world, obs->jackknife_sum() );
+                allreduce_sum( world, obs->jackknife_sqsum() );
+                obs->set_reduced_jackknife_sums();
+            }
+
+
             // gather the bin data of an observable object from other processes.
             // the data are collected into the master process,
             // and the corresponding Observable class is changed in place
@@ -62,9 +129,55 @@ namespace Utils {
             }
 
 
-            // gather all observable objects in the measuring handler
+            // reduce the statistics of all observable objects in the measuring handler,
+            // which suffices for the analysis of the means and errors.
             // note that the Utils::MPI class should be a friend class of Measure::MeasureHandler
             // to get access to the protected observable members
+            static void mpi_reduce( const boost::mpi::communicator &world, Measure::MeasureHandler& meas_handler )
+            {
+                for ( auto& scalar_obs : meas_handler.m_eqtime_scalar_obs ) { reduce_observable( world, scalar_obs.get() ); }
+                for ( auto& scalar_obs : meas_handler.m_dynamic_scalar_obs ) { reduce_observable( world, scalar_obs.get() ); }
+                for ( auto& vector_obs : meas_handler.m_eqtime_vector_obs ) { reduce_observable( world, vector_obs.get() ); }
+                for ( auto& vector_obs : meas_handler.m_dynamic_vector_obs ) { reduce_observable( world, vector_obs.get() ); }
+                for ( auto& matrix_obs : meas_handler.m_eqtime_matrix_obs ) { reduce_observable( world, matrix_obs.get() ); }
+                for ( auto& matrix_obs : meas_handler.m_dynamic_matrix_obs ) { reduce_observable( world, matrix_obs.get() ); }
+
+                // statistics of the configuration sign
+                if ( meas_handler.m_equaltime_sign ) {
+                    reduce_observable( world, meas_handler.m_equaltime_sign.get() );
+                }
+                if ( meas_handler.m_dynamic_sign ) {
+                    reduce_observable( world, meas_handler.m_dynamic_sign.get() );
+                }
+
+                // jackknife sums of the ratios to the sign
+                if ( meas_handler.m_equaltime_sign ) {
+                    auto sign = meas_handler.m_equaltime_sign.get();
+                    for ( auto& scalar_obs : meas_handler.m_eqtime_scalar_obs ) { reduce_jackknife( world, scalar_obs.get(), sign ); }
+                    for ( auto& vector_obs : meas_handler.m_eqtime_vector_obs ) { reduce_jackknife( world, vector_obs.get(), sign ); }
+                    for ( auto& matrix_obs : meas_handler.m_eqtime_matrix_obs ) { reduce_jackknife( world, matrix_obs.get(), sign ); }
+                    reduce_log_binning( world, sign );
+                }
+                if ( meas_handler.m_dynamic_sign ) {
+                    auto sign = meas_handler.m_dynamic_sign.get();
+                    for ( auto& scalar_obs : meas_handler.m_dynamic_scalar_obs ) { reduce_jackknife( world, scalar_obs.get(), sign ); }
+                    for ( auto& vector_obs : meas_handler.m_dynamic_vector_obs ) { reduce_jackknife( world, vector_obs.get(), sign ); }
+                    for ( auto& matrix_obs : meas_handler.m_dynamic_matrix_obs ) { reduce_jackknife( world, matrix_obs.get(), sign ); }
+                    reduce_log_binning( world, sign );
+                }
+
+                // logarithmic binning of the individual measurements
+                for ( auto& scalar_obs : meas_handler.m_eqtime_scalar_obs ) { reduce_log_binning( world, scalar_obs.get() ); }
+                for ( auto& scalar_obs : meas_handler.m_dynamic_scalar_obs ) { reduce_log_binning( world, scalar_obs.get() ); }
+                for ( auto& vector_obs : meas_handler.m_eqtime_vector_obs ) { reduce_log_binning( world, vector_obs.get() ); }
+                for ( auto& vector_obs : meas_handler.m_dynamic_vector_obs ) { reduce_log_binning( world, vector_obs.get() ); }
+                for ( auto& matrix_obs : meas_handler.m_eqtime_matrix_obs ) { reduce_log_binning( world, matrix_obs.get() ); }
+                for ( auto& matrix_obs : meas_handler.m_dynamic_matrix_obs ) { reduce_log_binning( world, matrix_obs.get() ); }
+            }
+
+
+            // gather the raw bin data of all observable objects in the measuring handler into the master,
+            // which is only needed for the output of the bins, since the memory of the master grows with the processes.
             static void mpi_gather( const boost::mpi::communicator &world, Measure::MeasureHandler& meas_handler )
             {   
                 // scalar observables
@@ -99,8 +212,8 @@ namespace Utils {
                     gather_observable( world, meas_handler.m_dynamic_sign.get() );
                 }
 
-                // reset the number of bins
-                meas_handler.m_bin_num *= world.size();
+                // reset the number of bins, which may differ among the processes in the dynamic scheduling
+                meas_handler.m_bin_num = boost::mpi::all_reduce( world, meas_handler.m_bin_num, std::plus<int>() );
             }
 
 
@@ -6,10 +6,13 @@
   *  This head file defines the interface Utils::NumericalStable class,
   *  which contains subroutines to help compute equal-time and 
   *  time-displaced (dynamical) Greens function in a stable manner.
+  *  The u matrices of the stacks are assumed orthogonal, 
+  *  while the v matrices are not, to support different decomposition methods.
   */
 
 #define EIGEN_USE_MKL_ALL
 #define EIGEN_VECTORIZE_SSE4_2
+#include <cmath>
 #include <Eigen/Core>
 #include <Eigen/LU>
 #include <Eigen/QR>
@@ -152,6 +155,49 @@ namespace Utils {
         }
 
 
+        /*
+         *  return log|det(1 + USV^T)| and the sign of the determinant, with method of LU decomposition
+         *  to obtain the fermionic weight of the configurations, e.g. for the replica exchanges.
+         *  note that 1 + USV^T = (Sbi U^T)^-1 * H, with H = Sbi U^T + Ss V^T well conditioned,
+         *  so that the large scales of S only enter through the logarithms of Sbi.
+         */
+        static void compute_log_det_00_bb(const Matrix& U, const Vector& S, const Matrix& V, double& log_det, double& sign) {
+            // split S = Sbi^-1 * Ss
+            Vector Sbi(S.size());
+            Vector Ss(S.size());
+            for (int i = 0; i < S.size(); ++i) {
+                assert( S(i) >= 0 );
+                if(S(i) > 1) {
+                    Sbi(i) = 1.0/S(i); Ss(i) = 1.0;
+                }
+                else {
+                    Sbi(i) = 1.0; Ss(i) = S(i);
+                }
+            }
+
+            // accumulate the logarithms of the diagonal elements of the LU factors
+            auto log_det_lu = [](const Matrix& mat, double& log_det_mat, double& sign_mat) {
+                const Eigen::PartialPivLU<Matrix> lu(mat);
+                log_det_mat = 0.0;
+                sign_mat = lu.permutationP().determinant();
+                for (int i = 0; i < mat.rows(); ++i) {
+                    const double diag = lu.matrixLU()(i, i);
+                    log_det_mat += std::log(std::abs(diag));
+                    sign_mat *= (diag >= 0)? +1.0 : -1.0;
+                }
+            };
+
+            const Matrix H = Sbi.asDiagonal() * U.transpose() + Ss.asDiagonal() * V.transpose();
+            double log_det_h = 0.0, sign_h = 0.0;
+            double log_det_u = 0.0, sign_u = 0.0;
+            log_det_lu(H, log_det_h, sign_h);
+            log_det_lu(U, log_det_u, sign_u);
+
+            log_det = log_det_h - log_det_u - Sbi.array().log().sum();
+            sign = sign_h * sign_u;
+        }
+
+
         /*
          *  return (1 + USV^T)^-1 * USV^T, with method of QR decomposition
          *  to obtain time-displaced Green's functions G(beta, 0)
@@ -183,13 +229,15 @@ namespace Utils {
          *  return (1 + left * right^T)^-1 in a stable manner, with method of MGS factorization
          *  note: (1 + left * right^T)^-1 = (1 + (USV^T)_left * (VSU^T)_right)^-1
          */
-        static void compute_equaltime_greens(SvdStack& left, SvdStack& right, Matrix &gtt) {
+        static void compute_equaltime_greens(const SvdStack& left, const SvdStack& right, Matrix &gtt) {
             assert(left.MatDim() == right.MatDim());
             const int ndim = left.MatDim();
 
             // at time slice t = 0
+            // (1 + right^T)^-1 = ( (1 + right)^-1 )^T, which does not rely on the orthogonality of v
             if ( left.empty() ) {
-                compute_greens_00_bb(right.MatrixV(), right.SingularValues(), right.MatrixU(), gtt);
+                compute_greens_00_bb(right.MatrixU(), right.SingularValues(), right.MatrixV(), gtt);
+                gtt.transposeInPlace();
                 return;
             }
 
@@ -199,13 +247,13 @@ namespace Utils {
                 return;
             }
 
-            // local params
-            const Matrix ul = left.MatrixU();
-            const Vector dl = left.SingularValues();
-            const Matrix vl = left.MatrixV();
-            const Matrix ur = right.MatrixU();
-            const Vector dr = right.SingularValues();
-            const Matrix vr = right.MatrixV();
+            // local params, referring to the cached matrices in the stacks
+            const Matrix& ul = left.MatrixU();
+            const Vector& dl = left.SingularValues();
+            const Matrix& vl = left.MatrixV();
+            const Matrix& ur = right.MatrixU();
+            const Vector& dr = right.SingularValues();
+            const Matrix& vr = right.MatrixV();
 
             Vector dlmax(dl.size()), dlmin(dl.size());
             Vector drmax(dr.size()), drmin(dr.size());
@@ -243,14 +291,15 @@ namespace Utils {
          *  return time-displaced Green's function in a stable manner,
          *  with the method of MGS factorization
          */
-        static void compute_dynamic_greens(SvdStack& left, SvdStack& right, Matrix &gt0, Matrix &g0t) {
+        static void compute_dynamic_greens(const SvdStack& left, const SvdStack& right, Matrix &gt0, Matrix &g0t) {
             assert( left.MatDim() == right.MatDim() );
             const int ndim = left.MatDim();
 
             // at time slice t = 0
             if( left.empty() ) {
                 // gt0 = gtt at t = 0
-                compute_greens_00_bb(right.MatrixV(), right.SingularValues(), right.MatrixU(), gt0);
+                compute_greens_00_bb(right.MatrixU(), right.SingularValues(), right.MatrixV(), gt0);
+                gt0.transposeInPlace();
 
                 // g0t = - ( 1 - gtt ）at t = 0, and this is a natural extension of g0t for t = 0.
                 // however from the physical point of view, g0t should degenerate to gtt at t = 0,
@@ -269,13 +318,13 @@ namespace Utils {
                 return;
             }
 
-            // local params
-            const Matrix ul = left.MatrixU();
-            const Vector dl = left.SingularValues();
-            const Matrix vl = left.MatrixV();
-            const Matrix ur = right.MatrixU();
-            const Vector dr = right.SingularValues();
-            const Matrix vr = right.MatrixV();
+            // local params, referring to the cached matrices in the stacks
+            const Matrix& ul = left.MatrixU();
+            const Vector& dl = left.SingularValues();
+            const Matrix& vl = left.MatrixV();
+            const Matrix& ur = right.MatrixU();
+            const Vector& dr = right.SingularValues();
+            const Matrix& vr = right.MatrixV();
 
             Vector dlmax(dl.size()), dlmin(dl.size());
             Vector drmax(dr.size()), drmin(dr.size());
@@ -306,12 +355,16 @@ namespace Utils {
             mult_v_invd_u(ur, drmax, tmp.inverse(), Atmp);
             mult_v_d_u(Atmp, dlmin, vl.transpose(), gt0);
 
-            // compute g0t
-            // Xtmp = vr^T * vl, Ytmp = ur^T * ul
-            Xtmp = vr.transpose() * vl;
+            // compute g0t, which requires the inversion of v matrices
+            // for orthogonal v, vr^-1 = vr^T and (vl^T)^-1 = vl
+            const Matrix vr_inv = ( right.isOrthogonalV() )? Matrix(vr.transpose()) : Matrix(vr.inverse());
+            const Matrix vlt_inv = ( left.isOrthogonalV() )? vl : Matrix(vl.transpose().inverse());
+
+            // Xtmp = vr^-1 * (vl^T)^-1, Ytmp = ur^T * ul
+            Xtmp = vr_inv * vlt_inv;
             Ytmp = ur.transpose() * ul;
 
-            // Xtmp = drmax^-1 * (vr^T * vl) * dlmax^-1
+            // Xtmp = drmax^-1 * (vr^-1 * (vl^T)^-1) * dlmax^-1
             // Ytmp = drmin * (ur^T * ul) * dlmin
             for (int j = 0; j < ndim; ++j) {
                 for (int i = 0; i < ndim; ++i) {
@@ -320,7 +373,7 @@ namespace Utils {
                 }
             }
             tmp = Xtmp + Ytmp;
-            mult_v_invd_u(-vl, dlmax, tmp.inverse(), Xtmp);
+            mult_v_invd_u(-vlt_inv, dlmax, tmp.inverse(), Xtmp);
             mult_v_d_u(Xtmp, drmin, ur.transpose(), g0t);
         }
 
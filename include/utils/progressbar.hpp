@@ -3,6 +3,7 @@
 #pragma once
 
 #include <chrono>
+#include <algorithm>
 #include <iostream>
 #include <boost/format.hpp>
 
@@ -26,7 +27,8 @@ public:
     unsigned int operator++() { return ++ticks; }
 
     void display() const {
-        float progress = (float) ticks / total_ticks;
+        // the ticks may exceed the estimated total, e.g. for the dynamically scheduled bins
+        float progress = std::min(1.0f, (float) ticks / total_ticks);
         int pos = (int) (bar_width * progress);
 
         std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
@@ -0,0 +1,75 @@
+#include "bin_scheduler.h"
+
+#include <cassert>
+#include <iostream>
+#include <boost/mpi/collectives.hpp>
+
+
+namespace QuantumMonteCarlo {
+
+    // the counter is stored in the memory of the master process
+    static constexpr int master = 0;
+
+
+    BinScheduler::~BinScheduler()
+    {
+        // the window should have been released collectively before the destruction
+        assert( this->m_window == MPI_WIN_NULL );
+    }
+
+
+    void BinScheduler::initial( const boost::mpi::communicator& comm, int bin_num, int bins_done )
+    {
+        assert( bin_num >= 0 && bins_done >= 0 );
+        assert( this->m_window == MPI_WIN_NULL );
+        this->m_bin_num = bin_num;
+        this->m_bins_taken = bins_done;
+        this->m_procs_num = comm.size();
+        this->m_comm = comm;
+
+        // only the master exposes memory for the counter
+        const int rank = comm.rank();
+        const MPI_Aint size = ( rank == master )? sizeof(long) : 0;
+        if ( MPI_Win_allocate( size, sizeof(long), MPI_INFO_NULL, this->m_comm, 
+                               &this->m_counter, &this->m_window ) != MPI_SUCCESS ) {
+            std::cerr << "QuantumMonteCarlo::BinScheduler::initial(): "
+                      << "fail to allocate the shared counter of bins." << std::endl;
+            exit(1);
+        }
+        const long bins_restored = boost::mpi::all_reduce( comm, (long)bins_done, std::plus<long>() );
+        if ( rank == master ) { *this->m_counter = bins_restored; }
+
+        // a passive-target epoch lasting for the whole measurement,
+        // and the initialized counter becomes visible to all the processes after the barrier
+        MPI_Win_lock_all( MPI_MODE_NOCHECK, this->m_window );
+        MPI_Win_sync( this->m_window );
+        MPI_Barrier( this->m_comm );
+    }
+
+
+    bool BinScheduler::acquire_bin()
+    {
+        assert( this->m_window != MPI_WIN_NULL );
+
+        // atomic fetch-and-increment of the counter, whose previous value is the ticket of this process
+        const long one = 1;
+        long ticket = 0;
+        MPI_Fetch_and_op( &one, &ticket, MPI_LONG, master, 0, MPI_SUM, this->m_window );
+        MPI_Win_flush( master, this->m_window );
+
+        if ( ticket >= this->m_bin_num ) { return false; }
+        ++this->m_bins_taken;
+        return true;
+    }
+
+
+    void BinScheduler::deallocate()
+    {
+        if ( this->m_window == MPI_WIN_NULL ) { return; }
+        MPI_Win_unlock_all( this->m_window );
+        MPI_Win_free( &this->m_window );
+        this->m_counter = nullptr;
+        this->m_comm = MPI_COMM_NULL;
+    }
+
+} // namespace QuantumMonteCarlo
@@ -1 +1,254 @@
-#include "checkerboard/cubic.h"
\ No newline at end of file
+#include "checkerboard/cubic.h"
+#include "lattice/cubic.h"
+#include "model/model_base.h"
+#include "dqmc_walker.h"
+
+
+namespace CheckerBoard {
+
+    void Cubic::set_checkerboard_params( const LatticeBase& lattice,
+                                         const ModelBase& model,
+                                         const DqmcWalker& walker )
+    {
+        // make sure that the lattice class is of type Lattice::Cubic
+        assert( dynamic_cast<const Lattice::Cubic*>(&lattice) != nullptr );
+        assert( lattice.SpaceSize() >= 8 );
+        this->m_side_length = lattice.SideLength();
+        this->m_space_size = lattice.SpaceSize();
+        this->m_time_interval = walker.TimeInterval();
+        this->m_hopping_t = model.HoppingT();
+        this->m_chemical_potential = model.ChemicalPotential();
+    }
+
+
+    void Cubic::initial()
+    {
+        // construct the exponent of hopping matrix in a reduced 2*2 Hilbert-space
+        //   exp( dt * t * ( 0.0, 1.0,  = ( cosh(dt*t), sinh(dt*t),
+        //                   1.0, 0.0 ) )   sinh(dt*t), cosh(dt*t) )
+        // and the chemical potential term exp( -dt * mu ) is shared equally by the six bond families,
+        // since each site belongs to exactly one bond of each family.
+        double ch, sh;
+
+        ch = cosh(this->m_time_interval * this->m_hopping_t);
+        sh = sinh(this->m_time_interval * this->m_hopping_t);
+        this->m_expK_bond << ch, sh,
+                             sh, ch;
+        this->m_expK_bond *= exp( -this->m_time_interval*this->m_chemical_potential/6.0 );
+
+        ch = cosh(-this->m_time_interval * this->m_hopping_t);
+        sh = sinh(-this->m_time_interval * this->m_hopping_t);
+        this->m_inv_expK_bond << ch, sh,
+                                 sh, ch;
+        this->m_inv_expK_bond *= exp( +this->m_time_interval*this->m_chemical_potential/6.0 );
+
+        // tabulate the bond families
+        for (auto direction = 0; direction < 3; ++direction) {
+            this->initial_bond_family( this->m_bond_families[2*direction],   direction, 0 );
+            this->initial_bond_family( this->m_bond_families[2*direction+1], direction, 1 );
+        }
+    }
+
+
+    void Cubic::initial_bond_family( BondFamily& bonds, int direction, int parity ) const
+    {
+        // site (x,y,z) is labeled by index = x + L * y + L^2 * z,
+        // and the bond connects it to its neighbour (x,y,z) + e_direction
+        const int side_length = this->m_side_length;
+        bonds.clear();
+        bonds.reserve( this->m_space_size / 2 );
+        for (auto index = 0; index < this->m_space_size; ++index) {
+            std::array<int,3> site = { index % side_length,
+                                       ( index % (side_length * side_length) ) / side_length,
+                                       index / (side_length * side_length) };
+            if ( site[direction] % 2 != parity ) { continue; }
+
+            site[direction] = ( site[direction] + 1 ) % side_length;
+            const int neighbour = site[0] + side_length * site[1] + side_length * side_length * site[2];
+            bonds.push_back( { index, neighbour } );
+        }
+    }
+
+
+    void Cubic::mult_bonds_from_left( Matrix &matrix, const Eigen::Matrix2d& bond_mat, const BondFamily& bonds,
+                                      const Vector* diag_before, const Vector* diag_after ) const
+    {
+        assert( matrix.rows() == this->m_space_size && matrix.cols() == this->m_space_size );
+        assert( !diag_before || diag_before->size() == this->m_space_size );
+        assert( !diag_after || diag_after->size() == this->m_space_size );
+
+        // the bonds within one family are disjoint, and each column is transformed independently
+        const double b00 = bond_mat(0,0), b01 = bond_mat(0,1);
+        const double b10 = bond_mat(1,0), b11 = bond_mat(1,1);
+        const double* const before = diag_before? diag_before->data() : nullptr;
+        const double* const after = diag_after? diag_after->data() : nullptr;
+        for (auto col = 0; col < matrix.cols(); ++col) {
+            double* const column = matrix.col(col).data();
+            for (const auto& bond : bonds) {
+                double x0 = column[bond[0]], x1 = column[bond[1]];
+                if ( before ) { x0 *= before[bond[0]]; x1 *= before[bond[1]]; }
+                double y0 = b00 * x0 + b01 * x1;
+                double y1 = b10 * x0 + b11 * x1;
+                if ( after ) { y0 *= after[bond[0]]; y1 *= after[bond[1]]; }
+                column[bond[0]] = y0;
+                column[bond[1]] = y1;
+            }
+        }
+    }
+
+
+    void Cubic::mult_bonds_from_right( Matrix &matrix, const Eigen::Matrix2d& bond_mat, const BondFamily& bonds,
+                                       const Vector* diag_before, const Vector* diag_after ) const
+    {
+        assert( matrix.rows() == this->m_space_size && matrix.cols() == this->m_space_size );
+        assert( !diag_before || diag_before->size() == this->m_space_size );
+        assert( !diag_after || diag_after->size() == this->m_space_size );
+
+        // the two columns of the end sites are contiguous in memory ( column major ),
+        // so that the row loop below is vectorized by the compiler.
+        // the diagonal scalings are absorbed into the rows ( diag_before ) and columns ( diag_after )
+        // of the 2*2 matrix of each bond.
+        const int rows = matrix.rows();
+        for (const auto& bond : bonds) {
+            const double s0 = diag_before? (*diag_before)(bond[0]) : 1.0;
+            const double s1 = diag_before? (*diag_before)(bond[1]) : 1.0;
+            const double t0 = diag_after? (*diag_after)(bond[0]) : 1.0;
+            const double t1 = diag_after? (*diag_after)(bond[1]) : 1.0;
+            const double b00 = s0 * bond_mat(0,0) * t0, b01 = s0 * bond_mat(0,1) * t1;
+            const double b10 = s1 * bond_mat(1,0) * t0, b11 = s1 * bond_mat(1,1) * t1;
+
+            double* __restrict__ const col0 = matrix.col(bond[0]).data();
+            double* __restrict__ const col1 = matrix.col(bond[1]).data();
+            for (auto row = 0; row < rows; ++row) {
+                const double x0 = col0[row], x1 = col1[row];
+                col0[row] = x0 * b00 + x1 * b10;
+                col1[row] = x0 * b01 + x1 * b11;
+            }
+        }
+    }
+
+
+    // with exp( -dt K ) approximated by the ordered product F0 * F1 * ... * F5
+    // of the exponents of the bond families, one has
+    //      exp( -dt K )^-1  =  F5^-1 * ... * F0^-1 ,
+    //      exp( -dt K )^T   =  F5 * ... * F0 ,
+    // since the exponent of each bond family is symmetric.
+
+    void Cubic::mult_expK_from_left( Matrix &matrix ) const
+    {
+        // checkerboard breakups are only supported for lattices with even side length
+        assert( this->m_side_length % 2 == 0 );
+
+        for (auto family = 5; family >= 0; --family) {
+            this->mult_bonds_from_left( matrix, this->m_expK_bond, this->m_bond_families[family] );
+        }
+    }
+
+
+    void Cubic::mult_inv_expK_from_left( Matrix &matrix ) const
+    {
+        // checkerboard breakups are only supported for lattices with even side length
+        assert( this->m_side_length % 2 == 0 );
+
+        for (auto family = 0; family <= 5; ++family) {
+            this->mult_bonds_from_left( matrix, this->m_inv_expK_bond, this->m_bond_families[family] );
+        }
+    }
+
+
+    void Cubic::mult_expK_from_right( Matrix &matrix ) const
+    {
+        // checkerboard breakups are only supported for lattices with even side length
+        assert( this->m_side_length % 2 == 0 );
+
+        for (auto family = 0; family <= 5; ++family) {
+            this->mult_bonds_from_right( matrix, this->m_expK_bond, this->m_bond_families[family] );
+        }
+    }
+
+
+    void Cubic::mult_inv_expK_from_right( Matrix &matrix ) const
+    {
+        // checkerboard breakups are only supported for lattices with even side length
+        assert( this->m_side_length % 2 == 0 );
+
+        for (auto family = 5; family >= 0; --family) {
+            this->mult_bonds_from_right( matrix, this->m_inv_expK_bond, this->m_bond_families[family] );
+        }
+    }
+
+
+    void Cubic::mult_trans_expK_from_left( Matrix &matrix ) const
+    {
+        // checkerboard breakups are only supported for lattices with even side length
+        assert( this->m_side_length % 2 == 0 );
+
+        for (auto family = 0; family <= 5; ++family) {
+            this->mult_bonds_from_left( matrix, this->m_expK_bond, this->m_bond_families[family] );
+        }
+    }
+
+
+    // the diagonal D is applied within the pass of the family F0, which is the first or the last one.
+
+    void Cubic::mult_diag_expK_from_left( Matrix &matrix, const Vector& diag ) const
+    {
+        // checkerboard breakups are only supported for lattices with even side length
+        assert( this->m_side_length % 2 == 0 );
+
+        for (auto family = 5; family >= 1; --family) {
+            this->mult_bonds_from_left( matrix, this->m_expK_bond, this->m_bond_families[family] );
+        }
+        this->mult_bonds_from_left( matrix, this->m_expK_bond, this->m_bond_families[0], nullptr, &diag );
+    }
+
+
+    void Cubic::mult_diag_expK_from_right( Matrix &matrix, const Vector& diag ) const
+    {
+        // checkerboard breakups are only supported for lattices with even side length
+        assert( this->m_side_length % 2 == 0 );
+
+        this->mult_bonds_from_right( matrix, this->m_expK_bond, this->m_bond_families[0], &diag, nullptr );
+        for (auto family = 1; family <= 5; ++family) {
+            this->mult_bonds_from_right( matrix, this->m_expK_bond, this->m_bond_families[family] );
+        }
+    }
+
+
+    void Cubic::mult_inv_expK_diag_from_left( Matrix &matrix, const Vector& diag ) const
+    {
+        // checkerboard breakups are only supported for lattices with even side length
+        assert( this->m_side_length % 2 == 0 );
+
+        this->mult_bonds_from_left( matrix, this->m_inv_expK_bond, this->m_bond_families[0], &diag, nullptr );
+        for (auto family = 1; family <= 5; ++family) {
+            this->mult_bonds_from_left( matrix, this->m_inv_expK_bond, this->m_bond_families[family] );
+        }
+    }
+
+
+    void Cubic::mult_inv_expK_diag_from_right( Matrix &matrix, const Vector& diag ) const
+    {
+        // checkerboard breakups are only supported for lattices with even side length
+        assert( this->m_side_length % 2 == 0 );
+
+        for (auto family = 5; family >= 1; --family) {
+            this->mult_bonds_from_right( matrix, this->m_inv_expK_bond, this->m_bond_families[family] );
+        }
+        this->mult_bonds_from_right( matrix, this->m_inv_expK_bond, this->m_bond_families[0], nullptr, &diag );
+    }
+
+
+    void Cubic::mult_trans_expK_diag_from_left( Matrix &matrix, const Vector& diag ) const
+    {
+        // checkerboard breakups are only supported for lattices with even side length
+        assert( this->m_side_length % 2 == 0 );
+
+        this->mult_bonds_from_left( matrix, this->m_expK_bond, this->m_bond_families[0], &diag, nullptr );
+        for (auto family = 1; family <= 5; ++family) {
+            this->mult_bonds_from_left( matrix, this->m_expK_bond, this->m_bond_families[family] );
+        }
+    }
+
+
+} // namespace CheckerBoard
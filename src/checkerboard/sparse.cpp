@@ -0,0 +1,190 @@
+#include "checkerboard/sparse.h"
+#include "lattice/lattice_base.h"
+#include "model/model_base.h"
+#include "dqmc_walker.h"
+
+#define EIGEN_USE_MKL_ALL
+#define EIGEN_VECTORIZE_SSE4_2
+#include <unsupported/Eigen/MatrixFunctions>
+
+
+namespace CheckerBoard {
+
+    void Sparse::set_threshold( RealScalar threshold )
+    {
+        assert( threshold >= 0.0 );
+        this->m_threshold = threshold;
+    }
+
+
+    const RealScalar Sparse::Density() const
+    {
+        return (RealScalar)this->m_expK_mat.nonZeros() / ( (RealScalar)this->m_space_size * this->m_space_size );
+    }
+
+
+    void Sparse::set_checkerboard_params( const LatticeBase& lattice,
+                                          const ModelBase& model,
+                                          const DqmcWalker& walker )
+    {
+        // no requirement on the geometry of the lattice
+        this->m_space_size = lattice.SpaceSize();
+        this->m_time_interval = walker.TimeInterval();
+        this->m_hopping_t = model.HoppingT();
+        this->m_chemical_potential = model.ChemicalPotential();
+        this->m_hopping_matrix = lattice.HoppingMatrix();
+    }
+
+
+    void Sparse::initial()
+    {
+        // construct the exponent of hopping matrix in the same way as the model classes,
+        //      K = - t * H + mu * I ,
+        // and drop the small elements, which decay rapidly with the distance between sites for small dt.
+        const Matrix Kmat = -this->m_hopping_t * this->m_hopping_matrix
+                          + this->m_chemical_potential * Matrix::Identity(this->m_space_size, this->m_space_size);
+        const Matrix expK = ( -this->m_time_interval * Kmat ).exp();
+        const Matrix inv_expK = ( +this->m_time_interval * Kmat ).exp();
+
+        // the threshold is relative to the 1-norm ( maximum absolute column sum ) of the matrix,
+        // so that the truncation is independent of the overall scale of exp( -dt K ) set by mu and dt.
+        auto truncate = [&]( const Matrix& mat ) {
+            const RealScalar cutoff = this->m_threshold * mat.cwiseAbs().colwise().sum().maxCoeff();
+            return mat.unaryExpr( [&]( double x ) { return ( std::abs(x) < cutoff )? 0.0 : x; } );
+        };
+        this->m_expK_mat = truncate( expK ).sparseView();
+        this->m_inv_expK_mat = truncate( inv_expK ).sparseView();
+        this->m_trans_expK_mat = this->m_expK_mat.transpose();
+        this->m_trans_inv_expK_mat = this->m_inv_expK_mat.transpose();
+
+        this->m_expK_mat.makeCompressed();
+        this->m_inv_expK_mat.makeCompressed();
+        this->m_trans_expK_mat.makeCompressed();
+        this->m_trans_inv_expK_mat.makeCompressed();
+
+        // the truncated matrices are no longer exact inverses of each other,
+        // and the deviation max| exp(-dtK) * exp(+dtK) - I | enters the wrapping of the greens functions
+        // as a systematic error, which should stay well below the wrap error of the simulation.
+        const Matrix product = this->m_expK_mat * this->m_inv_expK_mat;
+        this->m_inverse_error = ( product - Matrix::Identity(this->m_space_size, this->m_space_size) ).cwiseAbs().maxCoeff();
+
+        // the hopping matrix is no longer needed
+        this->m_hopping_matrix.resize(0, 0);
+    }
+
+
+    Matrix& Sparse::thread_buffer() const
+    {
+        // the checkerboard is shared among the walkers and the spin lanes running on different threads,
+        // hence each thread owns a scratch matrix, which is allocated once at its first use
+        static thread_local Matrix buffer{};
+        buffer.resize( this->m_space_size, this->m_space_size );
+        return buffer;
+    }
+
+
+    // the sparse-dense products S * G are much slower than G * S for column-major G,
+    // hence the products from the left are computed as ( G^T * S^T )^T,
+    // with G^T copied into the scratch matrix of the thread and the result transposed in place.
+
+    void Sparse::mult_expK_from_left( Matrix &matrix ) const
+    {
+        assert( matrix.rows() == this->m_space_size && matrix.cols() == this->m_space_size );
+        Matrix& buffer = this->thread_buffer();
+        buffer = matrix.transpose();
+        matrix.noalias() = buffer * this->m_trans_expK_mat;
+        matrix.transposeInPlace();
+    }
+
+
+    void Sparse::mult_expK_from_right( Matrix &matrix ) const
+    {
+        assert( matrix.rows() == this->m_space_size && matrix.cols() == this->m_space_size );
+        Matrix& buffer = this->thread_buffer();
+        buffer.noalias() = matrix * this->m_expK_mat;
+        matrix.swap( buffer );
+    }
+
+
+    void Sparse::mult_inv_expK_from_left( Matrix &matrix ) const
+    {
+        assert( matrix.rows() == this->m_space_size && matrix.cols() == this->m_space_size );
+        Matrix& buffer = this->thread_buffer();
+        buffer = matrix.transpose();
+        matrix.noalias() = buffer * this->m_trans_inv_expK_mat;
+        matrix.transposeInPlace();
+    }
+
+
+    void Sparse::mult_inv_expK_from_right( Matrix &matrix ) const
+    {
+        assert( matrix.rows() == this->m_space_size && matrix.cols() == this->m_space_size );
+        Matrix& buffer = this->thread_buffer();
+        buffer.noalias() = matrix * this->m_inv_expK_mat;
+        matrix.swap( buffer );
+    }
+
+
+    void Sparse::mult_trans_expK_from_left( Matrix &matrix ) const
+    {
+        assert( matrix.rows() == this->m_space_size && matrix.cols() == this->m_space_size );
+        Matrix& buffer = this->thread_buffer();
+        buffer = matrix.transpose();
+        matrix.noalias() = buffer * this->m_expK_mat;
+        matrix.transposeInPlace();
+    }
+
+
+    // the diagonal D is folded into the copies of the matrix into or out of the scratch matrix,
+    // except for D * expK * M, which is scaled in a separate pass before the final in-place transposition.
+
+    void Sparse::mult_diag_expK_from_left( Matrix &matrix, const Vector& diag ) const
+    {
+        assert( matrix.rows() == this->m_space_size && matrix.cols() == this->m_space_size );
+        Matrix& buffer = this->thread_buffer();
+        buffer = matrix.transpose();
+        matrix.noalias() = buffer * this->m_trans_expK_mat;
+        matrix.array().rowwise() *= diag.transpose().array();
+        matrix.transposeInPlace();
+    }
+
+
+    void Sparse::mult_diag_expK_from_right( Matrix &matrix, const Vector& diag ) const
+    {
+        assert( matrix.rows() == this->m_space_size && matrix.cols() == this->m_space_size );
+        Matrix& buffer = this->thread_buffer();
+        buffer.noalias() = matrix * diag.asDiagonal();
+        matrix.noalias() = buffer * this->m_expK_mat;
+    }
+
+
+    void Sparse::mult_inv_expK_diag_from_left( Matrix &matrix, const Vector& diag ) const
+    {
+        assert( matrix.rows() == this->m_space_size && matrix.cols() == this->m_space_size );
+        Matrix& buffer = this->thread_buffer();
+        buffer.noalias() = matrix.transpose() * diag.asDiagonal();
+        matrix.noalias() = buffer * this->m_trans_inv_expK_mat;
+        matrix.transposeInPlace();
+    }
+
+
+    void Sparse::mult_inv_expK_diag_from_right( Matrix &matrix, const Vector& diag ) const
+    {
+        assert( matrix.rows() == this->m_space_size && matrix.cols() == this->m_space_size );
+        Matrix& buffer = this->thread_buffer();
+        buffer.noalias() = matrix * this->m_inv_expK_mat;
+        matrix.noalias() = buffer * diag.asDiagonal();
+    }
+
+
+    void Sparse::mult_trans_expK_diag_from_left( Matrix &matrix, const Vector& diag ) const
+    {
+        assert( matrix.rows() == this->m_space_size && matrix.cols() == this->m_space_size );
+        Matrix& buffer = this->thread_buffer();
+        buffer.noalias() = matrix.transpose() * diag.asDiagonal();
+        matrix.noalias() = buffer * this->m_expK_mat;
+        matrix.transposeInPlace();
+    }
+
+
+} // namespace CheckerBoard
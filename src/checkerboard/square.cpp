@@ -38,7 +38,7 @@ namespace CheckerBoard {
                                 ch * sh, sh * sh, ch * ch, ch * sh,
                                 sh * sh, ch * sh, ch * sh, ch * ch;
         // factor 0.5 comes from the double counting of sites
-        this->m_expK_plaquette = exp( 0.5*this->m_time_interval*this->m_chemical_potential ) * reduced_hopping_mat;
+        this->m_expK_plaquette = exp( -0.5*this->m_time_interval*this->m_chemical_potential ) * reduced_hopping_mat;
 
         ch = cosh(-this->m_time_interval * this->m_hopping_t);
         sh = sinh(-this->m_time_interval * this->m_hopping_t);
@@ -46,7 +46,11 @@ namespace CheckerBoard {
                                 ch * sh, ch * ch, sh * sh, ch * sh,
                                 ch * sh, sh * sh, ch * ch, ch * sh,
                                 sh * sh, ch * sh, ch * sh, ch * ch;
-        this->m_inv_expK_plaquette = exp( -0.5*this->m_time_interval*this->m_chemical_potential ) * reduced_hopping_mat;
+        this->m_inv_expK_plaquette = exp( +0.5*this->m_time_interval*this->m_chemical_potential ) * reduced_hopping_mat;
+
+        // tabulate the plaquettes of sublattice A and B
+        this->initial_plaquettes( this->m_plaquettes_a, 0 );
+        this->initial_plaquettes( this->m_plaquettes_b, 1 );
     }
 
 
@@ -63,67 +67,101 @@ namespace CheckerBoard {
     //   1.0, 0.0, 0.0, 1.0,
     //   0.0, 1.0, 1.0, 0.0.
 
-    void Square::mult_expK_plaquette_from_left( Matrix &matrix, const Site& site ) const
+    void Square::initial_plaquettes( std::vector<Plaquette>& plaquettes, int parity ) const
     {
-        assert( matrix.rows() == this->m_space_size && matrix.cols() == this->m_space_size );
-        assert( site.size() == 2 );
-        const int x = site[0];
-        const int y = site[1];
-        const int index_xy          = ( x%this->m_side_length ) + this->m_side_length * ( y%this->m_side_length );
-        const int index_xy_right    = ( (x+1)%this->m_side_length ) + this->m_side_length * ( y%this->m_side_length );
-        const int index_xy_down     = ( x%this->m_side_length ) + this->m_side_length * ( (y+1)%this->m_side_length );
-        const int index_xy_diagonal = ( (x+1)%this->m_side_length ) + this->m_side_length * ( (y+1)%this->m_side_length );
-        
-        const std::array<int,4> indexes = { index_xy, index_xy_right, index_xy_down, index_xy_diagonal };
-        matrix(indexes, Eigen::all) = this->m_expK_plaquette * matrix(indexes, Eigen::all);
+        // parity = 0 for sublattice A and 1 for sublattice B
+        plaquettes.clear();
+        plaquettes.reserve( this->m_space_size / 4 );
+        for (auto x = parity; x < this->m_side_length; x+=2) {
+            for (auto y = parity; y < this->m_side_length; y+=2) {
+                const int index_xy          = ( x%this->m_side_length ) + this->m_side_length * ( y%this->m_side_length );
+                const int index_xy_right    = ( (x+1)%this->m_side_length ) + this->m_side_length * ( y%this->m_side_length );
+                const int index_xy_down     = ( x%this->m_side_length ) + this->m_side_length * ( (y+1)%this->m_side_length );
+                const int index_xy_diagonal = ( (x+1)%this->m_side_length ) + this->m_side_length * ( (y+1)%this->m_side_length );
+                plaquettes.push_back( { index_xy, index_xy_right, index_xy_down, index_xy_diagonal } );
+            }
+        }
     }
 
 
-    void Square::mult_inv_expK_plaquette_from_left( Matrix &matrix, const Site& site ) const
+    void Square::mult_plaquettes_from_left( Matrix &matrix, 
+                                            const Eigen::Matrix4d& plaquette_mat, 
+                                            const std::vector<Plaquette>& plaquettes,
+                                            const Vector* diag_before,
+                                            const Vector* diag_after ) const
     {
         assert( matrix.rows() == this->m_space_size && matrix.cols() == this->m_space_size );
-        assert( site.size() == 2 );
-        const int x = site[0];
-        const int y = site[1];
-        const int index_xy          = ( x%this->m_side_length ) + this->m_side_length * ( y%this->m_side_length );
-        const int index_xy_right    = ( (x+1)%this->m_side_length ) + this->m_side_length * ( y%this->m_side_length );
-        const int index_xy_down     = ( x%this->m_side_length ) + this->m_side_length * ( (y+1)%this->m_side_length );
-        const int index_xy_diagonal = ( (x+1)%this->m_side_length ) + this->m_side_length * ( (y+1)%this->m_side_length );
-        
-        const std::array<int,4> indexes = { index_xy, index_xy_right, index_xy_down, index_xy_diagonal };
-        matrix(indexes, Eigen::all) = this->m_inv_expK_plaquette * matrix(indexes, Eigen::all);
+        assert( !diag_before || diag_before->size() == this->m_space_size );
+        assert( !diag_after || diag_after->size() == this->m_space_size );
+
+        // the plaquettes within one sublattice are disjoint, and each column is transformed independently.
+        // sweeping column by column keeps the memory access contiguous,
+        // and the 4*4 products are performed in registers without any temporaries.
+        // the plaquettes of one sublattice cover every site exactly once,
+        // hence the diagonal scalings are applied to the corner elements as they are loaded or stored.
+        const double* const before = diag_before? diag_before->data() : nullptr;
+        const double* const after = diag_after? diag_after->data() : nullptr;
+        for (auto col = 0; col < matrix.cols(); ++col) {
+            double* const column = matrix.col(col).data();
+            for (const auto& plaquette : plaquettes) {
+                Eigen::Vector4d vec( column[plaquette[0]], column[plaquette[1]], 
+                                     column[plaquette[2]], column[plaquette[3]] );
+                if ( before ) {
+                    vec = vec.cwiseProduct( Eigen::Vector4d( before[plaquette[0]], before[plaquette[1]], 
+                                                             before[plaquette[2]], before[plaquette[3]] ) );
+                }
+                Eigen::Vector4d res = plaquette_mat * vec;
+                if ( after ) {
+                    res = res.cwiseProduct( Eigen::Vector4d( after[plaquette[0]], after[plaquette[1]], 
+                                                             after[plaquette[2]], after[plaquette[3]] ) );
+                }
+                column[plaquette[0]] = res(0);
+                column[plaquette[1]] = res(1);
+                column[plaquette[2]] = res(2);
+                column[plaquette[3]] = res(3);
+            }
+        }
     }
 
 
-    void Square::mult_expK_plaquette_from_right( Matrix &matrix, const Site& site ) const
+    void Square::mult_plaquettes_from_right( Matrix &matrix, 
+                                             const Eigen::Matrix4d& plaquette_mat, 
+                                             const std::vector<Plaquette>& plaquettes,
+                                             const Vector* diag_before,
+                                             const Vector* diag_after ) const
     {
         assert( matrix.rows() == this->m_space_size && matrix.cols() == this->m_space_size );
-        assert( site.size() == 2 );
-        const int x = site[0];
-        const int y = site[1];
-        const int index_xy          = ( x%this->m_side_length ) + this->m_side_length * ( y%this->m_side_length );
-        const int index_xy_right    = ( (x+1)%this->m_side_length ) + this->m_side_length * ( y%this->m_side_length );
-        const int index_xy_down     = ( x%this->m_side_length ) + this->m_side_length * ( (y+1)%this->m_side_length );
-        const int index_xy_diagonal = ( (x+1)%this->m_side_length ) + this->m_side_length * ( (y+1)%this->m_side_length );
-        
-        const std::array<int,4> indexes = { index_xy, index_xy_right, index_xy_down, index_xy_diagonal };
-        matrix(Eigen::all, indexes) = matrix(Eigen::all, indexes) * this->m_expK_plaquette;
-    }
+        assert( !diag_before || diag_before->size() == this->m_space_size );
+        assert( !diag_after || diag_after->size() == this->m_space_size );
 
-    
-    void Square::mult_inv_expK_plaquette_from_right( Matrix &matrix, const Site& site ) const
-    {
-        assert( matrix.rows() == this->m_space_size && matrix.cols() == this->m_space_size );
-        assert( site.size() == 2 );
-        const int x = site[0];
-        const int y = site[1];
-        const int index_xy          = ( x%this->m_side_length ) + this->m_side_length * ( y%this->m_side_length );
-        const int index_xy_right    = ( (x+1)%this->m_side_length ) + this->m_side_length * ( y%this->m_side_length );
-        const int index_xy_down     = ( x%this->m_side_length ) + this->m_side_length * ( (y+1)%this->m_side_length );
-        const int index_xy_diagonal = ( (x+1)%this->m_side_length ) + this->m_side_length * ( (y+1)%this->m_side_length );
-        
-        const std::array<int,4> indexes = { index_xy, index_xy_right, index_xy_down, index_xy_diagonal };
-        matrix(Eigen::all, indexes) = matrix(Eigen::all, indexes) * this->m_inv_expK_plaquette;
+        // the four columns of the corner sites are contiguous in memory ( column major ),
+        // so that the row loop below is vectorized by the compiler.
+        // the diagonal scalings are absorbed into the rows ( diag_before ) and columns ( diag_after )
+        // of the 4*4 matrix of each plaquette, which costs nothing compared with the row loop.
+        const int rows = matrix.rows();
+        for (const auto& plaquette : plaquettes) {
+            Eigen::Matrix4d mat = plaquette_mat;
+            for (auto k = 0; k < 4; ++k) {
+                if ( diag_before ) { mat.row(k) *= (*diag_before)(plaquette[k]); }
+                if ( diag_after ) { mat.col(k) *= (*diag_after)(plaquette[k]); }
+            }
+            const double p00 = mat(0,0), p01 = mat(0,1), p02 = mat(0,2), p03 = mat(0,3);
+            const double p10 = mat(1,0), p11 = mat(1,1), p12 = mat(1,2), p13 = mat(1,3);
+            const double p20 = mat(2,0), p21 = mat(2,1), p22 = mat(2,2), p23 = mat(2,3);
+            const double p30 = mat(3,0), p31 = mat(3,1), p32 = mat(3,2), p33 = mat(3,3);
+
+            double* __restrict__ const col0 = matrix.col(plaquette[0]).data();
+            double* __restrict__ const col1 = matrix.col(plaquette[1]).data();
+            double* __restrict__ const col2 = matrix.col(plaquette[2]).data();
+            double* __restrict__ const col3 = matrix.col(plaquette[3]).data();
+            for (auto row = 0; row < rows; ++row) {
+                const double x0 = col0[row], x1 = col1[row], x2 = col2[row], x3 = col3[row];
+                col0[row] = x0 * p00 + x1 * p10 + x2 * p20 + x3 * p30;
+                col1[row] = x0 * p01 + x1 * p11 + x2 * p21 + x3 * p31;
+                col2[row] = x0 * p02 + x1 * p12 + x2 * p22 + x3 * p32;
+                col3[row] = x0 * p03 + x1 * p13 + x2 * p23 + x3 * p33;
+            }
+        }
     }
 
 
@@ -132,18 +170,9 @@ namespace CheckerBoard {
         // checkerboard breakups are only supported for lattices with even side length
         assert( this->m_side_length % 2 == 0 );
 
-        // sublattice B
-        for (auto x = 1; x < this->m_side_length; x+=2) {
-            for (auto y = 1; y < this->m_side_length; y+=2) {
-                this->mult_expK_plaquette_from_left( matrix, {x,y} );
-            }
-        }
-        // sublattice A
-        for (int x = 0; x < this->m_side_length; x+=2) {
-            for (int y = 0; y < this->m_side_length; y+=2) {
-                this->mult_expK_plaquette_from_left( matrix, {x,y} );
-            }
-        }
+        // sublattice B, and then sublattice A
+        this->mult_plaquettes_from_left( matrix, this->m_expK_plaquette, this->m_plaquettes_b );
+        this->mult_plaquettes_from_left( matrix, this->m_expK_plaquette, this->m_plaquettes_a );
     }
 
     
@@ -152,18 +181,9 @@ namespace CheckerBoard {
         // checkerboard breakups are only supported for lattices with even side length
         assert( this->m_side_length % 2 == 0 );
 
-        // sublattice A
-        for (int x = 0; x < this->m_side_length; x+=2) {
-            for (int y = 0; y < this->m_side_length; y+=2) {
-                this->mult_inv_expK_plaquette_from_left( matrix, {x,y} );
-            }
-        }
-        // sublattice B
-        for (auto x = 1; x < this->m_side_length; x+=2) {
-            for (auto y = 1; y < this->m_side_length; y+=2) {
-                this->mult_inv_expK_plaquette_from_left( matrix, {x,y} );
-            }
-        }
+        // sublattice A, and then sublattice B
+        this->mult_plaquettes_from_left( matrix, this->m_inv_expK_plaquette, this->m_plaquettes_a );
+        this->mult_plaquettes_from_left( matrix, this->m_inv_expK_plaquette, this->m_plaquettes_b );
     }
 
     
@@ -172,18 +192,9 @@ namespace CheckerBoard {
         // checkerboard breakups are only supported for lattices with even side length
         assert( this->m_side_length % 2 == 0 );
 
-        // sublattice A
-        for (int x = 0; x < this->m_side_length; x+=2) {
-            for (int y = 0; y < this->m_side_length; y+=2) {
-                this->mult_expK_plaquette_from_right( matrix, {x,y} );
-            }
-        }
-        // sublattice B
-        for (auto x = 1; x < this->m_side_length; x+=2) {
-            for (auto y = 1; y < this->m_side_length; y+=2) {
-                this->mult_expK_plaquette_from_right( matrix, {x,y} );
-            }
-        }
+        // sublattice A, and then sublattice B
+        this->mult_plaquettes_from_right( matrix, this->m_expK_plaquette, this->m_plaquettes_a );
+        this->mult_plaquettes_from_right( matrix, this->m_expK_plaquette, this->m_plaquettes_b );
     }
 
     
@@ -192,18 +203,9 @@ namespace CheckerBoard {
         // checkerboard breakups are only supported for lattices with even side length
         assert( this->m_side_length % 2 == 0 );
 
-        // sublattice B
-        for (auto x = 1; x < this->m_side_length; x+=2) {
-            for (auto y = 1; y < this->m_side_length; y+=2) {
-                this->mult_inv_expK_plaquette_from_right( matrix, {x,y} );
-            }
-        }
-        // sublattice A
-        for (int x = 0; x < this->m_side_length; x+=2) {
-            for (int y = 0; y < this->m_side_length; y+=2) {
-                this->mult_inv_expK_plaquette_from_right( matrix, {x,y} );
-            }
-        }
+        // sublattice B, and then sublattice A
+        this->mult_plaquettes_from_right( matrix, this->m_inv_expK_plaquette, this->m_plaquettes_b );
+        this->mult_plaquettes_from_right( matrix, this->m_inv_expK_plaquette, this->m_plaquettes_a );
     }
 
     void Square::mult_trans_expK_from_left( Matrix &matrix ) const
@@ -211,18 +213,68 @@ namespace CheckerBoard {
         // checkerboard breakups are only supported for lattices with even side length
         assert( this->m_side_length % 2 == 0 );
 
-        // sublattice A
-        for (int x = 0; x < this->m_side_length; x+=2) {
-            for (int y = 0; y < this->m_side_length; y+=2) {
-                this->mult_expK_plaquette_from_left( matrix, {x,y} );
-            }
-        }
-        // sublattice B
-        for (auto x = 1; x < this->m_side_length; x+=2) {
-            for (auto y = 1; y < this->m_side_length; y+=2) {
-                this->mult_expK_plaquette_from_left( matrix, {x,y} );
-            }
-        }
+        // the plaquette matrix is symmetric
+        // sublattice A, and then sublattice B
+        this->mult_plaquettes_from_left( matrix, this->m_expK_plaquette, this->m_plaquettes_a );
+        this->mult_plaquettes_from_left( matrix, this->m_expK_plaquette, this->m_plaquettes_b );
+    }
+
+
+    // with exp( -dt K ) approximated by the product A * B of the two sublattices,
+    // the diagonal D is applied within the first or the last pass of the breakups.
+
+    void Square::mult_diag_expK_from_left( Matrix &matrix, const Vector& diag ) const
+    {
+        // checkerboard breakups are only supported for lattices with even side length
+        assert( this->m_side_length % 2 == 0 );
+
+        // sublattice B, and then sublattice A followed by D
+        this->mult_plaquettes_from_left( matrix, this->m_expK_plaquette, this->m_plaquettes_b );
+        this->mult_plaquettes_from_left( matrix, this->m_expK_plaquette, this->m_plaquettes_a, nullptr, &diag );
+    }
+
+
+    void Square::mult_diag_expK_from_right( Matrix &matrix, const Vector& diag ) const
+    {
+        // checkerboard breakups are only supported for lattices with even side length
+        assert( this->m_side_length % 2 == 0 );
+
+        // D followed by sublattice A, and then sublattice B
+        this->mult_plaquettes_from_right( matrix, this->m_expK_plaquette, this->m_plaquettes_a, &diag, nullptr );
+        this->mult_plaquettes_from_right( matrix, this->m_expK_plaquette, this->m_plaquettes_b );
+    }
+
+
+    void Square::mult_inv_expK_diag_from_left( Matrix &matrix, const Vector& diag ) const
+    {
+        // checkerboard breakups are only supported for lattices with even side length
+        assert( this->m_side_length % 2 == 0 );
+
+        // D followed by sublattice A, and then sublattice B
+        this->mult_plaquettes_from_left( matrix, this->m_inv_expK_plaquette, this->m_plaquettes_a, &diag, nullptr );
+        this->mult_plaquettes_from_left( matrix, this->m_inv_expK_plaquette, this->m_plaquettes_b );
+    }
+
+
+    void Square::mult_inv_expK_diag_from_right( Matrix &matrix, const Vector& diag ) const
+    {
+        // checkerboard breakups are only supported for lattices with even side length
+        assert( this->m_side_length % 2 == 0 );
+
+        // sublattice B, and then sublattice A followed by D
+        this->mult_plaquettes_from_right( matrix, this->m_inv_expK_plaquette, this->m_plaquettes_b );
+        this->mult_plaquettes_from_right( matrix, this->m_inv_expK_plaquette, this->m_plaquettes_a, nullptr, &diag );
+    }
+
+
+    void Square::mult_trans_expK_diag_from_left( Matrix &matrix, const Vector& diag ) const
+    {
+        // checkerboard breakups are only supported for lattices with even side length
+        assert( this->m_side_length % 2 == 0 );
+
+        // D followed by sublattice A, and then sublattice B
+        this->mult_plaquettes_from_left( matrix, this->m_expK_plaquette, this->m_plaquettes_a, &diag, nullptr );
+        this->mult_plaquettes_from_left( matrix, this->m_expK_plaquette, this->m_plaquettes_b );
     }
 
 
@@ -0,0 +1,242 @@
+#include "checkpoint.h"
+#include "dqmc.h"
+#include "dqmc_walker.h"
+#include "replica_exchange.h"
+#include "model/model_base.h"
+#include "lattice/lattice_base.h"
+#include "measure/measure_handler.h"
+#include "random.h"
+#include "utils/eigen_boost_serialization.hpp"
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <functional>
+#include <typeinfo>
+#include <unistd.h>
+#include <boost/format.hpp>
+#include <boost/archive/binary_oarchive.hpp>
+#include <boost/archive/binary_iarchive.hpp>
+#include <boost/serialization/string.hpp>
+#include <boost/serialization/vector.hpp>
+#include <boost/mpi/collectives.hpp>
+
+
+namespace QuantumMonteCarlo {
+
+    using Vector = Eigen::VectorXd;
+
+    // identification of the checkpoint files
+    static const std::string checkpoint_magic = "DQMC-CHECKPOINT";
+    static constexpr int checkpoint_version = 2;
+
+
+    // physical parameters of the run, which determine the meaning of the stored fields and bins,
+    // hence a checkpoint is refused by a run whose model, lattice or imaginary-time grids differ
+    struct PhysicalParams {
+        std::string model_type{};
+        std::string lattice_type{};
+        double hopping_t{}, onsite_u{}, chemical_potential{};
+        int space_dim{}, side_length{}, space_size{};
+        double beta{};
+        int time_size{};
+
+        PhysicalParams() = default;
+        PhysicalParams( const ModelBase& model, const LatticeBase& lattice, const DqmcWalker& walker )
+            : model_type( typeid(model).name() ), lattice_type( typeid(lattice).name() ),
+              hopping_t( model.HoppingT() ), onsite_u( model.OnSiteU() ), chemical_potential( model.ChemicalPotential() ),
+              space_dim( lattice.SpaceDim() ), side_length( lattice.SideLength() ), space_size( lattice.SpaceSize() ),
+              beta( walker.Beta() ), time_size( walker.TimeSize() ) {}
+
+        template<class Archive> void serialize( Archive& ar, const unsigned int version ) {
+            ar & model_type & lattice_type;
+            ar & hopping_t & onsite_u & chemical_potential;
+            ar & space_dim & side_length & space_size;
+            ar & beta & time_size;
+        }
+    };
+
+
+    void Checkpoint::set_params( int warmup_interval, int bin_interval )
+    {
+        this->m_warmup_interval = warmup_interval;
+        this->m_bin_interval = bin_interval;
+    }
+
+
+    void Checkpoint::initial( const boost::mpi::communicator& world, const std::string& folder )
+    {
+        this->m_folder = folder;
+        this->m_rank = world.rank();
+        this->m_world_size = world.size();
+        this->m_file = ( boost::format("%s/rank_%d.ckpt") % folder % this->m_rank ).str();
+
+        if ( world.rank() == 0 && access(folder.c_str(), 0) != 0 ) {
+            const std::string command = "mkdir -p " + folder;
+            if ( system(command.c_str()) != 0 ) {
+                std::cerr << "QuantumMonteCarlo::Checkpoint::initial(): "
+                          << "fail to create the folder of checkpoints at " << folder << " ." << std::endl;
+                exit(1);
+            }
+        }
+        world.barrier();
+    }
+
+
+    void Checkpoint::save( int warmup_sweeps_done,
+                           int bins_done,
+                           const LatticeBase& lattice,
+                           const DqmcWalker& walker,
+                           const ModelBase& model,
+                           const MeasureHandler& meas_handler,
+                           const WalkerPool& walker_pool,
+                           const ReplicaExchange* replica_exchange ) const
+    {
+        const std::string tmp_file = this->m_file + ".tmp";
+        {
+            std::ofstream outfile( tmp_file, std::ios::binary | std::ios::trunc );
+            if ( !outfile ) {
+                std::cerr << "QuantumMonteCarlo::Checkpoint::save(): "
+                          << "fail to open the checkpoint file " << tmp_file << " ." << std::endl;
+                exit(1);
+            }
+            boost::archive::binary_oarchive archive( outfile );
+
+            // parameters of the run, which are checked when restarting
+            archive << checkpoint_magic << checkpoint_version;
+            archive << this->m_world_size << this->m_rank << walker.WalkerPoolSize();
+            archive << PhysicalParams( model, lattice, walker );
+            archive << meas_handler.WarmUpSweeps() << meas_handler.BinsNum() << meas_handler.BinsSize();
+            archive << meas_handler.ObservableList();
+
+            // progress of the simulation
+            archive << warmup_sweeps_done << bins_done;
+
+            // bosonic fields and random engines of the main walker and the companion walkers
+            archive << model.BosonicFields() << walker.RandomEngine();
+            for ( auto i = 0; i < walker_pool.size(); ++i ) {
+                archive << walker_pool.models[i]->BosonicFields() << walker_pool.walkers[i]->RandomEngine();
+            }
+
+            // bins and samples collected so far
+            archive << meas_handler;
+            for ( const auto& companion_handler : walker_pool.meas_handlers ) {
+                archive << *companion_handler;
+            }
+
+            // counters of the replica exchanges
+            const bool is_replica_exchange = ( replica_exchange != nullptr );
+            archive << is_replica_exchange;
+            if ( is_replica_exchange ) { archive << *replica_exchange; }
+
+            if ( !outfile ) {
+                std::cerr << "QuantumMonteCarlo::Checkpoint::save(): "
+                          << "fail to write the checkpoint file " << tmp_file << " ." << std::endl;
+                exit(1);
+            }
+        }
+
+        if ( std::rename( tmp_file.c_str(), this->m_file.c_str() ) != 0 ) {
+            std::cerr << "QuantumMonteCarlo::Checkpoint::save(): "
+                      << "fail to rename the checkpoint file " << tmp_file << " ." << std::endl;
+            exit(1);
+        }
+    }
+
+
+    void Checkpoint::restore( const boost::mpi::communicator& world,
+                              const LatticeBase& lattice,
+                              DqmcWalker& walker,
+                              ModelBase& model,
+                              MeasureHandler& meas_handler,
+                              WalkerPool& walker_pool,
+                              ReplicaExchange* replica_exchange )
+    {
+        std::ifstream infile( this->m_file, std::ios::binary );
+        if ( !infile ) {
+            std::cerr << "QuantumMonteCarlo::Checkpoint::restore(): "
+                      << "fail to open the checkpoint file " << this->m_file << " ." << std::endl;
+            exit(1);
+        }
+
+        // the checkpoint should be written by the same process of a run with identical parameters
+        auto check = [&]( bool is_consistent, const std::string& message ) {
+            if ( !is_consistent ) {
+                std::cerr << "QuantumMonteCarlo::Checkpoint::restore(): "
+                          << "inconsistent " << message << " in the checkpoint file " << this->m_file
+                          << ", please check the config." << std::endl;
+                exit(1);
+            }
+        };
+
+        try {
+            boost::archive::binary_iarchive archive( infile );
+
+            std::string magic{};
+            int version{}, world_size{}, rank{}, pool_size{}, warmup_sweeps{}, bin_num{}, bin_size{};
+            Measure::ObsList obs_list{};
+            archive >> magic >> version;
+            check( magic == checkpoint_magic && version == checkpoint_version, "format" );
+            archive >> world_size >> rank >> pool_size;
+            check( world_size == this->m_world_size && rank == this->m_rank, "number of processes" );
+            check( pool_size == walker.WalkerPoolSize(), "number of walkers" );
+
+            // the physical parameters of a process are those of its replica in the parallel tempering
+            PhysicalParams params{};
+            const PhysicalParams current( model, lattice, walker );
+            archive >> params;
+            check( params.model_type == current.model_type, "type of the model" );
+            check( params.hopping_t == current.hopping_t && params.onsite_u == current.onsite_u
+                   && params.chemical_potential == current.chemical_potential, "model parameters" );
+            check( params.lattice_type == current.lattice_type && params.space_dim == current.space_dim
+                   && params.side_length == current.side_length && params.space_size == current.space_size, "lattice" );
+            check( params.beta == current.beta && params.time_size == current.time_size, "imaginary-time grids" );
+            archive >> warmup_sweeps >> bin_num >> bin_size;
+            check( warmup_sweeps == meas_handler.WarmUpSweeps() && bin_num == meas_handler.BinsNum()
+                   && bin_size == meas_handler.BinsSize(), "measuring parameters" );
+            archive >> obs_list;
+            check( obs_list == meas_handler.ObservableList(), "observables" );
+
+            archive >> this->m_warmup_sweeps_done >> this->m_bins_done;
+
+            // restore the fields and the random engines, and recompute the greens functions of the walkers
+            auto restore_walker = [&]( DqmcWalker& walker, ModelBase& model ) {
+                Vector fields{};
+                archive >> fields;
+                check( fields.size() == model.BosonicFields().size(), "size of the bosonic fields" );
+                model.set_bosonic_fields( fields );
+                archive >> walker.RandomEngine();
+                walker.refresh_configurations( lattice, model );
+            };
+            restore_walker( walker, model );
+            for ( auto i = 0; i < walker_pool.size(); ++i ) {
+                restore_walker( *walker_pool.walkers[i], *walker_pool.models[i] );
+            }
+
+            archive >> meas_handler;
+            for ( auto& companion_handler : walker_pool.meas_handlers ) {
+                archive >> *companion_handler;
+            }
+
+            bool is_replica_exchange{};
+            archive >> is_replica_exchange;
+            check( is_replica_exchange == ( replica_exchange != nullptr ), "replica exchanges" );
+            if ( is_replica_exchange ) { archive >> *replica_exchange; }
+        }
+        catch ( const boost::archive::archive_exception& e ) {
+            std::cerr << "QuantumMonteCarlo::Checkpoint::restore(): "
+                      << "fail to read the checkpoint file " << this->m_file << " ( " << e.what() << " )." << std::endl;
+            exit(1);
+        }
+
+        // the replicas exchange configurations in lockstep, hence all the checkpoints should share the same progress
+        if ( replica_exchange ) {
+            const int min_progress = boost::mpi::all_reduce( world, this->m_warmup_sweeps_done + this->m_bins_done,
+                                                             boost::mpi::minimum<int>() );
+            const int max_progress = boost::mpi::all_reduce( world, this->m_warmup_sweeps_done + this->m_bins_done,
+                                                             boost::mpi::maximum<int>() );
+            check( min_progress == max_progress, "progress among the replicas" );
+        }
+    }
+
+} // namespace QuantumMonteCarlo
@@ -1,10 +1,14 @@
 #include "dqmc.h"
 #include "dqmc_walker.h"
+#include "bin_scheduler.h"
 #include "model/model_base.h"
 #include "lattice/lattice_base.h"
 #include "measure/measure_handler.h"
 #include "utils/progressbar.hpp"
 
+#include <algorithm>
+#include <mkl_service.h>
+
 
 namespace QuantumMonteCarlo {
     
@@ -15,6 +19,10 @@ namespace QuantumMonteCarlo {
     unsigned int Dqmc::m_refresh_rate{10};
     char Dqmc::m_progress_bar_complete_char{'='}, Dqmc::m_progress_bar_incomplete_char{' '};
     std::chrono::steady_clock::time_point Dqmc::m_begin_time{}, Dqmc::m_end_time{};
+    Dqmc::SweepHook Dqmc::m_sweep_hook{};
+    Dqmc::CheckpointHook Dqmc::m_checkpoint_hook{};
+    int Dqmc::m_checkpoint_warmup_interval{0}, Dqmc::m_checkpoint_bin_interval{0};
+    int Dqmc::m_resume_warmup_sweeps{0}, Dqmc::m_resume_bins{0};
 
     // set up whether to show the process bar or not
     void Dqmc::show_progress_bar( bool show_progress_bar ) { Dqmc::m_show_progress_bar = show_progress_bar; }
@@ -33,6 +41,27 @@ namespace QuantumMonteCarlo {
         Dqmc::m_refresh_rate = refresh_rate;
     }
     
+    // set up the hook at the end of sweeps
+    void Dqmc::set_sweep_hook( const SweepHook& sweep_hook )
+    {
+        Dqmc::m_sweep_hook = sweep_hook;
+    }
+
+    // set up the hook for the checkpoints
+    void Dqmc::set_checkpoint_hook( const CheckpointHook& checkpoint_hook, int warmup_interval, int bin_interval )
+    {
+        Dqmc::m_checkpoint_hook = checkpoint_hook;
+        Dqmc::m_checkpoint_warmup_interval = warmup_interval;
+        Dqmc::m_checkpoint_bin_interval = bin_interval;
+    }
+
+    // set up the resume point of a restarted simulation
+    void Dqmc::set_resume_point( int warmup_sweeps_done, int bins_done )
+    {
+        Dqmc::m_resume_warmup_sweeps = warmup_sweeps_done;
+        Dqmc::m_resume_bins = bins_done;
+    }
+    
     // timer functions
     void Dqmc::timer_begin() { Dqmc::m_begin_time = std::chrono::steady_clock::now(); }
     void Dqmc::timer_end()   { Dqmc::m_end_time = std::chrono::steady_clock::now(); }
@@ -50,51 +79,119 @@ namespace QuantumMonteCarlo {
                                      LatticeBase& lattice, 
                                      MeasureHandler& meas_handler )
     {
+        // in the streaming mode, the equal-time quantities are collected slice by slice during the sweeps
+        DqmcWalker::EqtimeHook eqtime_hook{};
+        if ( meas_handler.isEqualTimeStreaming() ) {
+            eqtime_hook = [&]( int t, const Eigen::MatrixXd& green_tt_up, const Eigen::MatrixXd& green_tt_dn ) {
+                meas_handler.stream_equaltime_slice(t, green_tt_up, green_tt_dn, lattice);
+            };
+        }
+
+        // and so are the dynamic quantities during the dynamic sweep
+        DqmcWalker::DynamicHook dynamic_hook{};
+        if ( meas_handler.isDynamicStreaming() ) {
+            dynamic_hook = [&]( int t, const Eigen::MatrixXd& green_tt_up, const Eigen::MatrixXd& green_tt_dn,
+                                       const Eigen::MatrixXd& green_t0_up, const Eigen::MatrixXd& green_t0_dn,
+                                       const Eigen::MatrixXd& green_0t_up, const Eigen::MatrixXd& green_0t_dn ) {
+                meas_handler.stream_dynamic_slice(t, green_tt_up, green_tt_dn, green_t0_up, green_t0_dn, 
+                                                     green_0t_up, green_0t_dn, lattice);
+            };
+        }
+
         // sweep forth from 0 to beta
         if ( meas_handler.isDynamic() ) {
-            walker.sweep_for_dynamic_greens(model);
+            walker.sweep_for_dynamic_greens(model, dynamic_hook);
             meas_handler.dynamic_measure(walker, model, lattice);
         }
         else {
-            walker.sweep_from_0_to_beta(model);
+            walker.sweep_from_0_to_beta(model, eqtime_hook);
             if ( meas_handler.isEqualTime() ) {
                 meas_handler.equaltime_measure(walker, model, lattice);
             }
         }
 
         // sweep back from beta to 0
-        walker.sweep_from_beta_to_0(model);
+        walker.sweep_from_beta_to_0(model, eqtime_hook);
         if ( meas_handler.isEqualTime() ) {
             meas_handler.equaltime_measure(walker, model, lattice);
         }
     }
 
 
+    void Dqmc::run_walkers( DqmcWalker& walker, 
+                            ModelBase& model,
+                            MeasureHandler& meas_handler,
+                            WalkerPool* walker_pool,
+                            const WalkerTask& task )
+    {
+        const int pool_size = ( walker_pool )? 1 + walker_pool->size() : 1;
+        if ( pool_size == 1 ) {
+            task( walker, model, meas_handler, 0 );
+            return;
+        }
+
+        // each walker is processed by one thread, and the MKL routines inside are restricted to one thread
+        // to avoid oversubscriptions. the walkers only share read-only data, namely the lattice, 
+        // the checkerboard and the exponents of K, so that no synchronization is needed within the task.
+        #pragma omp parallel for num_threads(pool_size) schedule(static, 1)
+        for ( auto id = 0; id < pool_size; ++id ) {
+            mkl_set_num_threads_local( 1 );
+            if ( id == 0 ) { 
+                task( walker, model, meas_handler, 0 ); 
+            }
+            else { 
+                task( *walker_pool->walkers[id-1], *walker_pool->models[id-1], *walker_pool->meas_handlers[id-1], id ); 
+            }
+            mkl_set_num_threads_local( 0 );
+        }
+    }
+
+
     void Dqmc::thermalize( DqmcWalker& walker, 
                            ModelBase& model,
                            LatticeBase& lattice,  
-                           MeasureHandler& meas_handler ) 
+                           MeasureHandler& meas_handler,
+                           WalkerPool* walker_pool ) 
     {
         if ( meas_handler.isWarmUp() ) {
 
             // create progress bar
-            progresscpp::ProgressBar progressbar( meas_handler.WarmUpSweeps()/2,            // total loops 
+            const int total_loops = meas_handler.WarmUpSweeps()/2;
+            progresscpp::ProgressBar progressbar( total_loops,                              // total loops 
                                                   Dqmc::m_progress_bar_width,               // bar width
                                                   Dqmc::m_progress_bar_complete_char,       // complete character
                                                   Dqmc::m_progress_bar_incomplete_char      // incomplete character
                                                 );
 
-            // warm-up sweeps
-            for ( auto sweep = 1; sweep <= meas_handler.WarmUpSweeps()/2; ++sweep ) {
-                // sweep forth and back without measuring
-                walker.sweep_from_0_to_beta(model);
-                walker.sweep_from_beta_to_0(model);
+            // the warm-up is split into chunks between two checkpoints,
+            // and a restarted simulation skips the sweeps already done
+            const bool is_checkpoint = ( Dqmc::m_checkpoint_hook && Dqmc::m_checkpoint_warmup_interval > 0 );
+            const int chunk = ( is_checkpoint )? std::max( 1, Dqmc::m_checkpoint_warmup_interval/2 ) : total_loops;
+            const int first_loop = std::min( Dqmc::m_resume_warmup_sweeps/2, total_loops );
+            for ( auto loop = 0; loop < first_loop; ++loop ) { ++progressbar; }
 
-                // record the tick
-                ++progressbar;
-                if ( Dqmc::m_show_progress_bar && (sweep % Dqmc::m_refresh_rate == 1) ) {
-                    std::cout << " Warming up "; progressbar.display();
-                }
+            for ( auto begin = first_loop; begin < total_loops; begin += chunk ) {
+                const int end = std::min( begin + chunk, total_loops );
+
+                // warm-up sweeps of all the walkers, and the progress is tracked by the main walker
+                Dqmc::run_walkers( walker, model, meas_handler, walker_pool,
+                    [&]( DqmcWalker& walker, ModelBase& model, MeasureHandler& meas_handler, int id ) {
+                        for ( auto sweep = begin+1; sweep <= end; ++sweep ) {
+                            // sweep forth and back without measuring
+                            walker.sweep_from_0_to_beta(model);
+                            walker.sweep_from_beta_to_0(model);
+
+                            // record the tick
+                            if ( id != 0 ) { continue; }
+                            if ( Dqmc::m_sweep_hook ) { Dqmc::m_sweep_hook(walker, model); }
+                            ++progressbar;
+                            if ( Dqmc::m_show_progress_bar && (sweep % Dqmc::m_refresh_rate == 1) ) {
+                                std::cout << " Warming up "; progressbar.display();
+                            }
+                        }
+                    });
+
+                if ( is_checkpoint ) { Dqmc::m_checkpoint_hook( 2*end, 0 ); }
             }
             
             // progress bar finish
@@ -108,26 +205,50 @@ namespace QuantumMonteCarlo {
     void Dqmc::measure( DqmcWalker& walker, 
                         ModelBase& model,
                         LatticeBase& lattice,  
-                        MeasureHandler& meas_handler ) 
+                        MeasureHandler& meas_handler,
+                        WalkerPool* walker_pool,
+                        BinScheduler* bin_scheduler ) 
     {   
         if ( meas_handler.isEqualTime() || meas_handler.isDynamic() ) {
 
-            // create progress bar
-            progresscpp::ProgressBar progressbar( meas_handler.BinsNum()*meas_handler.BinsSize()/2,
+            // create progress bar, whose length is estimated in the dynamic scheduling of bins
+            const int bins_expected = ( bin_scheduler )? bin_scheduler->ExpectedBinsPerProc() : meas_handler.BinsNum();
+            progresscpp::ProgressBar progressbar( bins_expected*meas_handler.BinsSize()/2,
                                                   Dqmc::m_progress_bar_width,
                                                   Dqmc::m_progress_bar_complete_char,
                                                   Dqmc::m_progress_bar_incomplete_char );
 
+            // a restarted simulation continues after the bins restored from the checkpoint
+            const int first_bin = std::min( Dqmc::m_resume_bins, meas_handler.BinsNum() );
+            for ( auto loop = 0; loop < first_bin*meas_handler.BinsSize()/2; ++loop ) { ++progressbar; }
+            const bool is_checkpoint = ( Dqmc::m_checkpoint_hook && Dqmc::m_checkpoint_bin_interval > 0 );
+
             // measuring sweeps
-            for ( auto bin = 0; bin < meas_handler.BinsNum(); ++bin ) {
-                for ( auto sweep = 1; sweep <= meas_handler.BinsSize()/2; ++sweep ) {
-                    // update and measure
-                    Dqmc::sweep_forth_and_back(walker, model, lattice, meas_handler);
-
-                    // record the tick
-                    ++progressbar;
-                    if ( Dqmc::m_show_progress_bar && (sweep % Dqmc::m_refresh_rate == 1) ) {
-                        std::cout << " Measuring  "; progressbar.display();
+            for ( auto bin = first_bin; bin < meas_handler.BinsNum(); ++bin ) {
+                // stop once all the bins have been taken by the processes
+                if ( bin_scheduler && !bin_scheduler->acquire_bin() ) { break; }
+
+                Dqmc::run_walkers( walker, model, meas_handler, walker_pool,
+                    [&]( DqmcWalker& walker, ModelBase& model, MeasureHandler& meas_handler, int id ) {
+                        for ( auto sweep = 1; sweep <= meas_handler.BinsSize()/2; ++sweep ) {
+                            // update and measure
+                            Dqmc::sweep_forth_and_back(walker, model, lattice, meas_handler);
+
+                            // record the tick
+                            if ( id != 0 ) { continue; }
+                            if ( Dqmc::m_sweep_hook ) { Dqmc::m_sweep_hook(walker, model); }
+                            ++progressbar;
+                            if ( Dqmc::m_show_progress_bar && (sweep % Dqmc::m_refresh_rate == 1) ) {
+                                std::cout << " Measuring  "; progressbar.display();
+                            }
+                        }
+                    });
+
+                // merge the samples of the companion walkers into the main measure handler
+                if ( walker_pool ) {
+                    for ( auto& companion_handler : walker_pool->meas_handlers ) {
+                        meas_handler.merge_temporary( *companion_handler );
+                        companion_handler->clear_temporary();
                     }
                 }
 
@@ -137,12 +258,32 @@ namespace QuantumMonteCarlo {
                 meas_handler.clear_temporary();
 
                 // avoid correlations between adjoining bins
-                for ( auto sweep = 0; sweep < meas_handler.SweepsBetweenBins()/2; ++sweep ) {
-                    walker.sweep_from_0_to_beta(model);
-                    walker.sweep_from_beta_to_0(model);
+                Dqmc::run_walkers( walker, model, meas_handler, walker_pool,
+                    [&]( DqmcWalker& walker, ModelBase& model, MeasureHandler& meas_handler, int id ) {
+                        for ( auto sweep = 0; sweep < meas_handler.SweepsBetweenBins()/2; ++sweep ) {
+                            walker.sweep_from_0_to_beta(model);
+                            walker.sweep_from_beta_to_0(model);
+                            if ( id == 0 && Dqmc::m_sweep_hook ) { Dqmc::m_sweep_hook(walker, model); }
+                        }
+                    });
+
+                if ( is_checkpoint && (bin+1) % Dqmc::m_checkpoint_bin_interval == 0 ) {
+                    Dqmc::m_checkpoint_hook( meas_handler.WarmUpSweeps(), bin+1 );
                 }
             }
 
+            // the companion walkers contribute their own chains of measurements to the autocorrelation analysis
+            if ( walker_pool ) {
+                for ( auto& companion_handler : walker_pool->meas_handlers ) {
+                    meas_handler.merge_log_binning( *companion_handler );
+                }
+            }
+
+            // only the bins actually measured by this process are kept
+            if ( bin_scheduler ) {
+                meas_handler.truncate_bins( bin_scheduler->BinsTaken() );
+            }
+
             // progress bar finish
             if ( Dqmc::m_show_progress_bar ) {
                 std::cout << " Measuring  "; progressbar.done();
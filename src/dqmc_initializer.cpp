@@ -1,6 +1,9 @@
 #include "dqmc_initializer.h"
 #include "dqmc_walker.h"
+#include "dqmc.h"
 #include "svd_stack.h"
+#include "replica_exchange.h"
+#include "checkpoint.h"
 
 #include "model/model_base.h"
 #include "model/repulsive_hubbard.h"
@@ -14,6 +17,7 @@
 #include "checkerboard/checkerboard_base.h"
 #include "checkerboard/square.h"
 #include "checkerboard/cubic.h"
+#include "checkerboard/sparse.h"
 
 #include "measure/measure_handler.h"
 
@@ -166,17 +170,45 @@ namespace QuantumMonteCarlo {
         // --------------------------------------------------------------------------------------------------
         //                                  Parse the CheckerBoard module
         // --------------------------------------------------------------------------------------------------
-        // note that the checkerboard method is currently only implemented for 2d square lattice
+        // note that the checkerboard breakups are currently only implemented for 2d square and 3d cubic lattice,
+        // and for other lattices the sparse method, with a truncated exp( -dt K ) in CSR format, should be used instead.
         const bool is_checker_board = config["CheckerBoard"]["whether_or_not"].value_or(false);
+        const std::string_view checkerboard_method = config["CheckerBoard"]["method"].value_or("breakups");
+        const double sparse_threshold = config["CheckerBoard"]["sparse_threshold"].value_or(1e-12);
         
         if ( checkerboard ) { checkerboard.reset(); }
         if ( is_checker_board ) {
-            if ( lattice_type == "Square" ) {
-                checkerboard = std::make_unique<CheckerBoard::Square>();
+            if ( checkerboard_method == "sparse" ) {
+                if ( sparse_threshold < 0.0 ) {
+                    std::cerr << "QuantumMonteCarlo::DqmcInitializer::parse_toml_config(): "
+                              << "the threshold of the sparse method should be non-negative, "
+                              << "please check the config." << std::endl;
+                    exit(1);
+                }
+                auto sparse_checkerboard = std::make_unique<CheckerBoard::Sparse>();
+                sparse_checkerboard->set_threshold( sparse_threshold );
+                checkerboard = std::move( sparse_checkerboard );
+            }
+            else if ( checkerboard_method != "breakups" ) {
+                std::cerr << "QuantumMonteCarlo::DqmcInitializer::parse_toml_config(): "
+                          << "undefined checkerboard method \'" << checkerboard_method << "\', "
+                          << "please check the config." << std::endl;
+                exit(1);
+            }
+            else if ( lattice_type == "Square" || lattice_type == "Cubic" ) {
+                // the breakups require lattices with even side length
+                if ( lattice->SideLength() % 2 != 0 ) {
+                    std::cerr << "QuantumMonteCarlo::DqmcInitializer::parse_toml_config(): "
+                              << "the checkerboard method requires a lattice with even side length, "
+                              << "please check the config." << std::endl;
+                    exit(1);
+                }
+                if ( lattice_type == "Square" ) { checkerboard = std::make_unique<CheckerBoard::Square>(); }
+                else { checkerboard = std::make_unique<CheckerBoard::Cubic>(); }
             }
             else {
                 std::cerr << "QuantumMonteCarlo::DqmcInitializer::parse_toml_config(): "
-                          << "the checkerboard method is currently only implemented for 2d square lattice, "
+                          << "the checkerboard method is currently only implemented for 2d square and 3d cubic lattice, "
                           << "please check the config." << std::endl;
                 exit(1);
             }
@@ -189,12 +221,80 @@ namespace QuantumMonteCarlo {
         const double beta = config["MonteCarlo"]["beta"].value_or(4.0);
         const double time_size = config["MonteCarlo"]["time_size"].value_or(80);
         const int stabilization_pace = config["MonteCarlo"]["stabilization_pace"].value_or(10);
+        const int delay_depth = config["MonteCarlo"]["delay_depth"].value_or(1);
+        const std::string_view decomposition = config["MonteCarlo"]["decomposition"].value_or("SVD");
+        const bool spin_parallel = config["MonteCarlo"]["spin_parallel"].value_or(false);
+        const int lane_mkl_threads = config["MonteCarlo"]["lane_mkl_threads"].value_or(1);
+        const bool batched_wrap = config["MonteCarlo"]["batched_wrap"].value_or(false);
+        const int walkers = config["MonteCarlo"]["walkers"].value_or(1);
+
+        // parse the cpu cores to which the two spin lanes are pinned, either empty or of two cores
+        std::vector<int> lane_cores;
+        if ( toml::array* lane_cores_arr = config["MonteCarlo"]["lane_cores"].as_array() ) {
+            if ( !lane_cores_arr->empty() 
+                 && ( lane_cores_arr->size() != 2 || !lane_cores_arr->is_homogeneous<int64_t>() ) ) {
+                std::cerr << "QuantumMonteCarlo::DqmcInitializer::parse_toml_config(): "
+                          << "the input lane cores should be a vector containing two non-negative integers or empty, "
+                          << "please check the config." << std::endl;
+                exit(1);
+            }
+            for ( auto&& el : *lane_cores_arr ) {
+                if ( el.value_or(-1) < 0 ) {
+                    std::cerr << "QuantumMonteCarlo::DqmcInitializer::parse_toml_config(): "
+                              << "the input lane cores should be a vector containing two non-negative integers or empty, "
+                              << "please check the config." << std::endl;
+                    exit(1);
+                }
+                lane_cores.emplace_back(el.value_or(0));
+            }
+        }
+        if ( delay_depth < 1 ) {
+            std::cerr << "QuantumMonteCarlo::DqmcInitializer::parse_toml_config(): "
+                      << "the delay depth of the updates should be positive, please check the config." << std::endl;
+            exit(1);
+        }
+        if ( walkers < 1 ) {
+            std::cerr << "QuantumMonteCarlo::DqmcInitializer::parse_toml_config(): "
+                      << "the number of walkers per process should be positive, please check the config." << std::endl;
+            exit(1);
+        }
+        if ( walkers > 1 && spin_parallel ) {
+            std::cerr << "QuantumMonteCarlo::DqmcInitializer::parse_toml_config(): "
+                      << "the walker pool and the spin-parallel mode can not be enabled at the same time, "
+                      << "please check the config." << std::endl;
+            exit(1);
+        }
+        if ( lane_mkl_threads < 1 ) {
+            std::cerr << "QuantumMonteCarlo::DqmcInitializer::parse_toml_config(): "
+                      << "the number of MKL threads per spin lane should be positive, please check the config." << std::endl;
+            exit(1);
+        }
 
         // create dqmc walker and set up parameters
         if ( walker ) { walker.reset(); }
         walker = std::make_unique<DqmcWalker>();
         walker->set_physical_params( beta, time_size );
         walker->set_stabilization_pace( stabilization_pace );
+        walker->set_delay_depth( delay_depth );
+        walker->set_spin_parallel( spin_parallel, lane_cores, lane_mkl_threads );
+        walker->set_batched_wrap( batched_wrap );
+        walker->set_walker_pool_size( walkers );
+
+        // decomposition method for the numerical stabilizations
+        if ( decomposition == "SVD" ) { 
+            walker->set_stack_decomposition( Utils::Decomposition::SVD ); 
+        }
+        else if ( decomposition == "QRP" ) { 
+            walker->set_stack_decomposition( Utils::Decomposition::QRP ); 
+        }
+        else if ( decomposition == "JacobiSVD" ) { 
+            walker->set_stack_decomposition( Utils::Decomposition::JacobiSVD ); 
+        }
+        else {
+            std::cerr << "QuantumMonteCarlo::DqmcInitializer::parse_toml_config(): "
+                      << "undefined decomposition method \'" << decomposition << "\', please check the config." << std::endl; 
+            exit(1);
+        }
 
 
         // --------------------------------------------------------------------------------------------------
@@ -204,6 +304,15 @@ namespace QuantumMonteCarlo {
         const int bin_num = config["Measure"]["bin_num"].value_or(20);
         const int bin_size = config["Measure"]["bin_size"].value_or(100);
         const int sweeps_between_bins = config["Measure"]["sweeps_between_bins"].value_or(20);
+        const bool streaming = config["Measure"]["streaming"].value_or(false);
+        const bool dynamic_scheduling = config["Measure"]["dynamic_scheduling"].value_or(false);
+        const bool output_bins = config["Measure"]["output_bins"].value_or(false);
+        const std::string_view bins_format = config["Measure"]["bins_format"].value_or("text");
+        if ( bins_format != "text" && bins_format != "binary" ) {
+            std::cerr << "QuantumMonteCarlo::DqmcInitializer::parse_toml_config(): "
+                      << "undefined format \'" << bins_format << "\' of the bins, please check the config." << std::endl; 
+            exit(1);
+        }
         
         // parse obervable lists
         std::vector<std::string> observables;
@@ -240,10 +349,17 @@ namespace QuantumMonteCarlo {
         if ( meas_handler ) { meas_handler.reset(); }
         meas_handler = std::make_unique<Measure::MeasureHandler>();
 
-        // send measuring tasks to a set of processes
-        const int bins_per_proc = (bin_num % world_size == 0)? bin_num/world_size : bin_num/world_size+1;
+        // send measuring tasks to a set of processes, either evenly in advance,
+        // or dynamically during the measurements, in which case each process may take up to all the bins,
+        // and the storage of the bins grows as they are claimed
+        const int bins_per_proc = ( dynamic_scheduling )? bin_num
+                                : (bin_num % world_size == 0)? bin_num/world_size : bin_num/world_size+1;
         meas_handler->set_measure_params( sweeps_warmup, bins_per_proc, bin_size, sweeps_between_bins );
         meas_handler->set_observables( observables );
+        meas_handler->set_streaming( streaming );
+        meas_handler->set_dynamic_scheduling( dynamic_scheduling );
+        meas_handler->set_output_bins( output_bins );
+        meas_handler->set_binary_bins( bins_format == "binary" );
 
 
         // --------------------------------------------------------------------------------------------------
@@ -338,6 +454,115 @@ namespace QuantumMonteCarlo {
     }
 
 
+    void DqmcInitializer::parse_replica_exchange( std::string_view toml_config,
+                                                  int world_size,
+                                                  ReplicaExchangePtr& replica_exchange )
+    {
+        // parse the configuration file
+        auto config = toml::parse_file( toml_config );
+
+        if ( replica_exchange ) { replica_exchange.reset(); }
+        if ( !config["ParallelTempering"]["whether_or_not"].value_or(false) ) { return; }
+
+        const std::string_view parameter = config["ParallelTempering"]["parameter"].value_or("onsite_u");
+        const int exchange_interval = config["ParallelTempering"]["exchange_interval"].value_or(1);
+
+        // parse the parameter values of the replicas
+        std::vector<double> values;
+        toml::array* values_arr = config["ParallelTempering"]["values"].as_array();
+        if ( values_arr && !values_arr->empty() ) {
+            values.reserve(values_arr->size());
+            for ( auto&& el : *values_arr ) {
+                if ( !el.is_number() ) {
+                    std::cerr << "QuantumMonteCarlo::DqmcInitializer::parse_replica_exchange(): "
+                              << "the input values of the replicas should be a vector of numbers, "
+                              << "please check the config." << std::endl;
+                    exit(1);
+                }
+                values.emplace_back(el.value_or(0.0));
+            }
+        }
+        else {
+            std::cerr << "QuantumMonteCarlo::DqmcInitializer::parse_replica_exchange(): "
+                      << "the input values of the replicas should be a non-empty vector of numbers, "
+                      << "please check the config." << std::endl;
+            exit(1);
+        }
+
+        if ( world_size % values.size() != 0 ) {
+            std::cerr << "QuantumMonteCarlo::DqmcInitializer::parse_replica_exchange(): "
+                      << "the number of processes should be a multiple of the number of replicas, "
+                      << "please check the config." << std::endl;
+            exit(1);
+        }
+        if ( exchange_interval < 1 ) {
+            std::cerr << "QuantumMonteCarlo::DqmcInitializer::parse_replica_exchange(): "
+                      << "the interval of exchanges should be positive, please check the config." << std::endl;
+            exit(1);
+        }
+
+        // the replicas of a chain exchange configurations in lockstep, 
+        // hence they should run the same number of sweeps
+        if ( config["Measure"]["dynamic_scheduling"].value_or(false) ) {
+            std::cerr << "QuantumMonteCarlo::DqmcInitializer::parse_replica_exchange(): "
+                      << "the replica exchanges and the dynamic scheduling of bins can not be enabled at the same time."
+                      << std::endl;
+            exit(1);
+        }
+
+        ReplicaExchange::Parameter replica_parameter{};
+        if ( parameter == "onsite_u" ) {
+            replica_parameter = ReplicaExchange::Parameter::OnSiteU;
+        }
+        else if ( parameter == "chemical_potential" ) {
+            replica_parameter = ReplicaExchange::Parameter::ChemicalPotential;
+        }
+        else if ( parameter == "beta" ) {
+            replica_parameter = ReplicaExchange::Parameter::Beta;
+        }
+        else {
+            std::cerr << "QuantumMonteCarlo::DqmcInitializer::parse_replica_exchange(): "
+                      << "undefined parameter \'" << parameter << "\' of the replicas, please check the config." << std::endl; 
+            exit(1);
+        }
+
+        // the onsite interaction and the inverse temperature are restricted to positive values
+        for ( const auto value : values ) {
+            if ( ( replica_parameter == ReplicaExchange::Parameter::OnSiteU && value < 0.0 ) 
+                 || ( replica_parameter == ReplicaExchange::Parameter::Beta && value <= 0.0 ) ) {
+                std::cerr << "QuantumMonteCarlo::DqmcInitializer::parse_replica_exchange(): "
+                          << "invalid value " << value << " of the parameter \'" << parameter << "\', "
+                          << "please check the config." << std::endl;
+                exit(1);
+            }
+        }
+
+        replica_exchange = std::make_unique<ReplicaExchange>();
+        replica_exchange->set_params( replica_parameter, values, exchange_interval );
+    }
+
+
+    void DqmcInitializer::parse_checkpoint( std::string_view toml_config, CheckpointPtr& checkpoint )
+    {
+        // parse the configuration file
+        auto config = toml::parse_file( toml_config );
+
+        if ( checkpoint ) { checkpoint.reset(); }
+        if ( !config["Checkpoint"]["whether_or_not"].value_or(false) ) { return; }
+
+        const int warmup_interval = config["Checkpoint"]["warmup_interval"].value_or(100);
+        const int bin_interval = config["Checkpoint"]["bin_interval"].value_or(1);
+        if ( warmup_interval < 0 || bin_interval < 0 ) {
+            std::cerr << "QuantumMonteCarlo::DqmcInitializer::parse_checkpoint(): "
+                      << "the intervals of checkpoints should be non-negative, please check the config." << std::endl;
+            exit(1);
+        }
+
+        checkpoint = std::make_unique<Checkpoint>();
+        checkpoint->set_params( warmup_interval, bin_interval );
+    }
+
+
     void DqmcInitializer::initial_modules( ModelBase& model, 
                                            LatticeBase& lattice, 
                                            DqmcWalker& walker,
@@ -408,4 +633,48 @@ namespace QuantumMonteCarlo {
     }
 
 
+
+    void DqmcInitializer::create_walker_pool( const ModelBase& model, 
+                                              LatticeBase& lattice, 
+                                              const DqmcWalker& walker,
+                                              const MeasureHandler& meas_handler,
+                                              WalkerPool& walker_pool )
+    {
+        walker_pool.walkers.clear();
+        walker_pool.models.clear();
+        walker_pool.meas_handlers.clear();
+
+        for ( auto id = 1; id < walker.WalkerPoolSize(); ++id ) {
+            // companion walker with the same parameters as the main walker
+            auto companion_walker = std::make_unique<DqmcWalker>();
+            companion_walker->set_physical_params( walker.Beta(), walker.TimeSize() );
+            companion_walker->set_stabilization_pace( walker.StabilizationPace() );
+            companion_walker->set_stack_decomposition( walker.StackDecomposition() );
+            companion_walker->set_delay_depth( walker.DelayDepth() );
+            companion_walker->set_batched_wrap( walker.isBatchedWrap() );
+            companion_walker->set_walker_pool_size( walker.WalkerPoolSize() );
+            companion_walker->set_random_key( walker.RandomEngine().Seed(), walker.RandomEngine().Rank(), id );
+
+            // companion measure handler with the same measuring parameters and observables,
+            // which only accumulates the temporary samples merged into the main handler at the bin boundaries,
+            // hence no storage of bins is allocated for it.
+            auto companion_handler = std::make_unique<Measure::MeasureHandler>();
+            companion_handler->set_measure_params( meas_handler.WarmUpSweeps(), 0, 
+                                                   meas_handler.BinsSize(), meas_handler.SweepsBetweenBins() );
+            companion_handler->set_observables( meas_handler.ObservableList() );
+            companion_handler->set_streaming( meas_handler.isStreaming() );
+            companion_handler->set_measured_momentum( meas_handler.Momentum() );
+            companion_handler->set_measured_momentum_list( meas_handler.MomentumList() );
+
+            // the lattice is shared, and the cloned model shares the exponents of K and the checkerboard
+            companion_handler->initial( lattice, *companion_walker );
+            companion_walker->initial( lattice, *companion_handler );
+
+            walker_pool.walkers.emplace_back( std::move(companion_walker) );
+            walker_pool.models.emplace_back( model.clone() );
+            walker_pool.meas_handlers.emplace_back( std::move(companion_handler) );
+        }
+    }
+
+
 } // namespace QuantumMonteCarlo
\ No newline at end of file
@@ -1,3 +1,4 @@
+#include <ctime>
 #include <memory>
 #include <string>
 #include <iostream>
@@ -17,6 +18,9 @@
 #include "measure/measure_handler.h"
 #include "dqmc.h"
 #include "dqmc_walker.h"
+#include "replica_exchange.h"
+#include "bin_scheduler.h"
+#include "checkpoint.h"
 
 #include "dqmc_initializer.h"
 #include "dqmc_io.h"
@@ -45,6 +49,7 @@ int main( int argc, char* argv[] ) {
     std::string config_file{};
     std::string fields_file{};
     std::string out_path{};
+    unsigned seed{};
     
     // read parameters from the command line 
     boost::program_options::options_description opts("Program options");
@@ -60,7 +65,12 @@ int main( int argc, char* argv[] ) {
             "folder path which stores the output of measuring results, default: ../example" )
         (   "fields,f",
             boost::program_options::value<std::string>(&fields_file), 
-            "path of the configurations of auxiliary fields, if not assigned the fields are to be set randomly." );
+            "path of the configurations of auxiliary fields, if not assigned the fields are to be set randomly." )
+        (   "seed,s",
+            boost::program_options::value<unsigned>(&seed), 
+            "random seed shared by all processes, which reproduces the run if assigned, default: current time" )
+        (   "restart,r",
+            "resume the simulation from the checkpoints stored under the output folder" );
     
     // parse the command line options
     try {
@@ -113,10 +123,13 @@ int main( int argc, char* argv[] ) {
     //                                 Process of DQMC simulation
     // ------------------------------------------------------------------------------------------------
 
-    // set up random seeds for different processes
-    Utils::Random::set_seed( std::time(nullptr) + rank );
-    // // fixed random seed for debug
-    // Utils::Random::set_seed( 12345 );
+    // set up the random seed, which is shared by all processes and broadcast from the master,
+    // and the random streams of the processes are distinguished by their ranks.
+    if ( !vm.count("seed") ) { seed = std::time(nullptr); }
+    boost::mpi::broadcast( world, seed, master );
+    if ( rank == master ) {
+        std::cout << boost::format(">> Random seed: %d\n") % seed << std::endl;
+    }
     
     
     // -----------------------------------  Initializations  ------------------------------------------
@@ -127,14 +140,49 @@ int main( int argc, char* argv[] ) {
     std::unique_ptr<QuantumMonteCarlo::DqmcWalker> walker;
     std::unique_ptr<Measure::MeasureHandler> meas_handler;
     std::unique_ptr<CheckerBoard::CheckerBoardBase> checkerboard;
+    std::unique_ptr<QuantumMonteCarlo::ReplicaExchange> replica_exchange;
+    std::unique_ptr<QuantumMonteCarlo::Checkpoint> checkpoint;
+
+    // the checkpoints of all the processes are stored under the same folder,
+    // and are also required when restarting, even if the periodic checkpoints are disabled
+    const bool is_restart = vm.count("restart");
+    QuantumMonteCarlo::DqmcInitializer::parse_checkpoint( config_file, checkpoint );
+    if ( !checkpoint && is_restart ) { checkpoint = std::make_unique<QuantumMonteCarlo::Checkpoint>(); }
+    if ( checkpoint ) { checkpoint->initial( world, out_path + "/checkpoints" ); }
+
+    // in the parallel tempering, the processes are split into replicas of different parameters,
+    // and the bins of measurements are distributed among the processes of the same replica.
+    QuantumMonteCarlo::DqmcInitializer::parse_replica_exchange( config_file, world.size(), replica_exchange );
+    if ( replica_exchange ) { replica_exchange->initial( world ); }
+    const boost::mpi::communicator& measure_comm = ( replica_exchange )? replica_exchange->ReplicaComm() : world;
+
+    // the results of each replica are output by the first process of the replica into its own subfolder
+    const bool is_output_rank = ( measure_comm.rank() == master );
+    if ( replica_exchange ) {
+        out_path = ( boost::format("%s/replica_%d") % out_path % replica_exchange->Replica() ).str();
+        if ( is_output_rank && access(out_path.c_str(), 0) != 0 ) {
+            const std::string command = "mkdir -p " + out_path;
+            if ( system(command.c_str()) != 0 ) {
+                std::cerr << boost::format("main(): fail to creat folder at %s .\n") % out_path 
+                          << std::endl;
+                exit(1);
+            }
+        }
+    }
 
     // parse parmas from the configuation file
     QuantumMonteCarlo::DqmcInitializer::parse_toml_config
         ( 
-            config_file, world.size(),
+            config_file, measure_comm.size(),
             model, lattice, walker, meas_handler, checkerboard 
         );
 
+    // overwrite the varied parameter with the value of the replica
+    if ( replica_exchange ) { replica_exchange->set_replica_params( *model, *walker ); }
+
+    // the random engine of the walker, keyed by the seed and the rank of the process
+    walker->set_random_key( seed, rank );
+
     // initialize modules
     if ( checkerboard ) { 
         // using checkerboard break-up
@@ -147,7 +195,7 @@ int main( int argc, char* argv[] ) {
 
     if ( fields_file.empty() ) {
         // randomly initialize the bosonic fields if there are no input field configs
-        model->set_bosonic_fields_to_random();
+        model->set_bosonic_fields_to_random( walker->RandomEngine() );
         if ( rank == master ) { 
             std::cout << ">> Configurations of the bosonic fields set to random.\n" << std::endl; 
         }
@@ -162,6 +210,31 @@ int main( int argc, char* argv[] ) {
     // initialize dqmc, preparing for the simulation
     QuantumMonteCarlo::DqmcInitializer::initial_dqmc( *model, *lattice, *walker, *meas_handler );
 
+    // create the companion walkers of the walker pool, if more than one walker per process is required,
+    // which start from their own random fields, or from the input fields as the main walker does.
+    QuantumMonteCarlo::WalkerPool walker_pool;
+    QuantumMonteCarlo::DqmcInitializer::create_walker_pool( *model, *lattice, *walker, *meas_handler, walker_pool );
+    for ( auto i = 0; i < walker_pool.size(); ++i ) {
+        if ( fields_file.empty() ) {
+            walker_pool.models[i]->set_bosonic_fields_to_random( walker_pool.walkers[i]->RandomEngine() );
+        }
+        QuantumMonteCarlo::DqmcInitializer::initial_dqmc
+            ( *walker_pool.models[i], *lattice, *walker_pool.walkers[i], *walker_pool.meas_handlers[i] );
+    }
+
+    // restore the fields, the random engines and the bins collected so far from the checkpoints,
+    // overwriting the initial configurations above
+    if ( is_restart ) {
+        checkpoint->restore( world, *lattice, *walker, *model, *meas_handler, walker_pool, replica_exchange.get() );
+        QuantumMonteCarlo::Dqmc::set_resume_point( checkpoint->WarmUpSweepsDone(), checkpoint->BinsDone() );
+        if ( rank == master ) {
+            std::cout << boost::format(">> Simulation restarted from the checkpoints in %s, "
+                                       "after %d warm-up sweeps and %d bins.\n") 
+                         % checkpoint->Folder() % checkpoint->WarmUpSweepsDone() % checkpoint->BinsDone() 
+                      << std::endl;
+        }
+    }
+
     if ( rank == master ) {
         std::cout << ">> Initialization finished. \n\n" 
                   << ">> The simulation is going to get started with parameters shown below :\n"
@@ -172,9 +245,30 @@ int main( int argc, char* argv[] ) {
     if ( rank == master ) {
         QuantumMonteCarlo::DqmcIO::output_init_info 
             ( 
-                std::cout, world.size(), 
+                std::cout, measure_comm.size(), 
                 *model, *lattice, *walker, *meas_handler, checkerboard 
             );
+        if ( replica_exchange ) {
+            QuantumMonteCarlo::DqmcIO::output_replica_exchange_info( std::cout, *replica_exchange );
+        }
+    }
+
+    // attempt the exchanges of configurations between neighbouring replicas after the sweeps
+    if ( replica_exchange ) {
+        QuantumMonteCarlo::Dqmc::set_sweep_hook( 
+            [&]( QuantumMonteCarlo::DqmcWalker& walker, Model::ModelBase& model ) {
+                replica_exchange->exchange( walker, model, *lattice );
+            });
+    }
+
+    // store the state of the process periodically during the simulation
+    if ( checkpoint ) {
+        QuantumMonteCarlo::Dqmc::set_checkpoint_hook( 
+            [&]( int warmup_sweeps_done, int bins_done ) {
+                checkpoint->save( warmup_sweeps_done, bins_done, *lattice, *walker, *model, *meas_handler, 
+                                  walker_pool, replica_exchange.get() );
+            }, 
+            checkpoint->WarmUpInterval(), checkpoint->BinInterval() );
     }
 
     // set up progress bar
@@ -187,11 +281,22 @@ int main( int argc, char* argv[] ) {
 
     // the dqmc simulation start
     QuantumMonteCarlo::Dqmc::timer_begin();
-    QuantumMonteCarlo::Dqmc::thermalize( *walker, *model, *lattice, *meas_handler );
-    QuantumMonteCarlo::Dqmc::measure( *walker, *model, *lattice, *meas_handler );
+    QuantumMonteCarlo::Dqmc::thermalize( *walker, *model, *lattice, *meas_handler, &walker_pool );
+
+    // in the dynamic scheduling, the processes draw bins from a shared counter until all of them are measured
+    std::unique_ptr<QuantumMonteCarlo::BinScheduler> bin_scheduler;
+    if ( meas_handler->isDynamicScheduling() ) {
+        bin_scheduler = std::make_unique<QuantumMonteCarlo::BinScheduler>();
+        bin_scheduler->initial( measure_comm, meas_handler->BinsNum(), ( is_restart )? checkpoint->BinsDone() : 0 );
+    }
+    QuantumMonteCarlo::Dqmc::measure( *walker, *model, *lattice, *meas_handler, &walker_pool, bin_scheduler.get() );
+    if ( bin_scheduler ) { bin_scheduler->deallocate(); }
 
-    // gather observable objects from other processes
-    Utils::MPI::mpi_gather( world, *meas_handler );
+    // reduce the statistics of the observables over the processes of the same replica,
+    // and gather the raw bins into the output process only if they are to be output
+    Utils::MPI::mpi_reduce( measure_comm, *meas_handler );
+    if ( meas_handler->isOutputBins() ) { Utils::MPI::mpi_gather( measure_comm, *meas_handler ); }
+    if ( replica_exchange ) { replica_exchange->gather_statistics( world ); }
 
     // perform the analysis
     QuantumMonteCarlo::Dqmc::analyse( *meas_handler );
@@ -202,86 +307,123 @@ int main( int argc, char* argv[] ) {
     // output the ending info
     if ( rank == master ) {
         QuantumMonteCarlo::DqmcIO::output_ending_info( std::cout, *walker );
+        if ( replica_exchange ) {
+            QuantumMonteCarlo::DqmcIO::output_exchange_statistics( std::cout, *replica_exchange );
+        }
     }
 
 
     // ---------------------------------  Output measuring results  ------------------------------------
 
-    // screen output the results of scalar observables
-    if ( rank == master ) 
+    // output the results of scalar observables to the screen,
+    // and also to the folder of each replica in the parallel tempering
+    auto output_scalar_observables = [&]( std::ostream& ostream ) 
     {
         if ( meas_handler->find("equaltime_sign") ) {
             QuantumMonteCarlo::DqmcIO::output_observable( 
-                std::cout, meas_handler->find<Observable::ScalarObs>("equaltime_sign") );
+                ostream, meas_handler->find<Observable::ScalarObs>("equaltime_sign") );
         }
 
         if ( meas_handler->find("dynamic_sign") ) {
             QuantumMonteCarlo::DqmcIO::output_observable( 
-                std::cout, meas_handler->find<Observable::ScalarObs>("dynamic_sign") );
+                ostream, meas_handler->find<Observable::ScalarObs>("dynamic_sign") );
         }
 
-        std::cout << std::endl;
+        ostream << std::endl;
       
         if ( meas_handler->find("filling_number") ) {
             QuantumMonteCarlo::DqmcIO::output_observable( 
-                std::cout, meas_handler->find<Observable::ScalarObs>("filling_number") );
+                ostream, meas_handler->find<Observable::ScalarObs>("filling_number") );
         }
 
         if ( meas_handler->find("double_occupancy") ) {
             QuantumMonteCarlo::DqmcIO::output_observable( 
-                std::cout, meas_handler->find<Observable::ScalarObs>("double_occupancy") );
+                ostream, meas_handler->find<Observable::ScalarObs>("double_occupancy") );
         }
 
         if ( meas_handler->find("kinetic_energy") ) {
             QuantumMonteCarlo::DqmcIO::output_observable( 
-                std::cout, meas_handler->find<Observable::ScalarObs>("kinetic_energy") );
+                ostream, meas_handler->find<Observable::ScalarObs>("kinetic_energy") );
         }
 
         if ( meas_handler->find("local_spin_corr") ) {
             QuantumMonteCarlo::DqmcIO::output_observable( 
-                std::cout, meas_handler->find<Observable::ScalarObs>("local_spin_corr") );
+                ostream, meas_handler->find<Observable::ScalarObs>("local_spin_corr") );
         }
 
         if ( meas_handler->find("momentum_distribution") ) {
             QuantumMonteCarlo::DqmcIO::output_observable( 
-                std::cout, meas_handler->find<Observable::ScalarObs>("momentum_distribution") );
+                ostream, meas_handler->find<Observable::ScalarObs>("momentum_distribution") );
         }
 
         if ( meas_handler->find("spin_density_structure_factor") ) {
             QuantumMonteCarlo::DqmcIO::output_observable( 
-                std::cout, meas_handler->find<Observable::ScalarObs>("spin_density_structure_factor") );
+                ostream, meas_handler->find<Observable::ScalarObs>("spin_density_structure_factor") );
         }
 
         if ( meas_handler->find("charge_density_structure_factor") ) {
             QuantumMonteCarlo::DqmcIO::output_observable( 
-                std::cout, meas_handler->find<Observable::ScalarObs>("charge_density_structure_factor") );
+                ostream, meas_handler->find<Observable::ScalarObs>("charge_density_structure_factor") );
         }
 
         if ( meas_handler->find("s_wave_pairing_corr") ) {
             QuantumMonteCarlo::DqmcIO::output_observable( 
-                std::cout, meas_handler->find<Observable::ScalarObs>("s_wave_pairing_corr") );
+                ostream, meas_handler->find<Observable::ScalarObs>("s_wave_pairing_corr") );
         }
 
         if ( meas_handler->find("superfluid_stiffness") ) {  
             QuantumMonteCarlo::DqmcIO::output_observable( 
-                std::cout, meas_handler->find<Observable::ScalarObs>("superfluid_stiffness") );
+                ostream, meas_handler->find<Observable::ScalarObs>("superfluid_stiffness") );
         }
+    };
+
+    // output the jackknife estimates of the ratios to the sign and the integrated autocorrelation times
+    auto output_observable_analysis = [&]( std::ostream& ostream ) 
+    {
+        ostream << "\n>> Jackknife estimates and integrated autocorrelation times ( in units of measurements ):\n" 
+                << std::endl;
+        for ( const auto& obs_name : meas_handler->ObservableList() ) {
+            if ( !meas_handler->find(obs_name) ) { continue; }
+            if ( const auto obs = meas_handler->find<Observable::ScalarObs>(obs_name); !obs.name().empty() ) {
+                QuantumMonteCarlo::DqmcIO::output_observable_analysis( ostream, obs );
+            }
+            else if ( const auto obs = meas_handler->find<Observable::VectorObs>(obs_name); !obs.name().empty() ) {
+                QuantumMonteCarlo::DqmcIO::output_observable_analysis( ostream, obs );
+            }
+            else if ( const auto obs = meas_handler->find<Observable::MatrixObs>(obs_name); !obs.name().empty() ) {
+                QuantumMonteCarlo::DqmcIO::output_observable_analysis( ostream, obs );
+            }
+        }
+        ostream << std::endl;
+    };
+
+    if ( rank == master ) { 
+        output_scalar_observables( std::cout ); 
+        output_observable_analysis( std::cout );
     }
 
 
     // file output 
-    if ( rank == master ) {
+    if ( is_output_rank ) {
         
         std::ofstream outfile;
 
         // output the configurations of the bosonic fields
         // if there exist input file of fields configs, overwrite it.
-        // otherwise the field configs are stored under the output folder.
-        const auto fields_out = ( fields_file.empty() )? out_path + "/fields.out" : fields_file;
+        // otherwise, or if the input file is shared by the replicas, the field configs are stored under the output folder.
+        const auto fields_out = ( fields_file.empty() || replica_exchange )? out_path + "/fields.out" : fields_file;
         outfile.open(fields_out, std::ios::trunc);
         QuantumMonteCarlo::DqmcIO::output_bosonic_fields( outfile, *model );
         outfile.close();
 
+        // output the scalar observables of the replica
+        if ( replica_exchange ) {
+            outfile.open(out_path + "/scalars.out", std::ios::trunc);
+            output_scalar_observables( outfile );
+            output_observable_analysis( outfile );
+            outfile.close();
+        }
+
         // output the k stars
         outfile.open(out_path + "/kstars.out", std::ios::trunc);
         QuantumMonteCarlo::DqmcIO::output_k_stars( outfile, *lattice );
@@ -292,6 +434,19 @@ int main( int argc, char* argv[] ) {
         QuantumMonteCarlo::DqmcIO::output_imaginary_time_grids( outfile, *walker );
         outfile.close();
 
+        // output of the raw bins of an observable, either as text or in the binary container
+        auto output_bins = [&]( const std::string& file_stem, const auto& obs ) {
+            if ( meas_handler->isBinaryBins() ) {
+                outfile.open(out_path + "/" + file_stem + ".bins.bin", std::ios::trunc | std::ios::binary);
+                QuantumMonteCarlo::DqmcIO::output_observable_in_binary_bins( outfile, obs );
+            }
+            else {
+                outfile.open(out_path + "/" + file_stem + ".bins.out", std::ios::trunc);
+                QuantumMonteCarlo::DqmcIO::output_observable_in_bins( outfile, obs );
+            }
+            outfile.close();
+        };
+
         // output measuring results of the observables
 
         // s wave pairing correlation functions
@@ -303,10 +458,9 @@ int main( int argc, char* argv[] ) {
             outfile.close();
 
             // output of raw data in terms of bins
-            outfile.open(out_path + "/swave.bins.out", std::ios::trunc);
-            QuantumMonteCarlo::DqmcIO::output_observable_in_bins(
-                outfile, meas_handler->find<Observable::ScalarObs>("s_wave_pairing_corr") );
-            outfile.close();
+            if ( meas_handler->isOutputBins() ) {
+                output_bins( "swave", meas_handler->find<Observable::ScalarObs>("s_wave_pairing_corr") );
+            }
         }
 
         // density of states
@@ -318,10 +472,9 @@ int main( int argc, char* argv[] ) {
             outfile.close();
 
             // output of raw data in terms of bins
-            outfile.open(out_path + "/dos.bins.out", std::ios::trunc);
-            QuantumMonteCarlo::DqmcIO::output_observable_in_bins(
-                outfile, meas_handler->find<Observable::VectorObs>("density_of_states") );
-            outfile.close();
+            if ( meas_handler->isOutputBins() ) {
+                output_bins( "dos", meas_handler->find<Observable::VectorObs>("density_of_states") );
+            }
         }
 
         // dynamical green's function in the reciprocal space
@@ -333,10 +486,9 @@ int main( int argc, char* argv[] ) {
             outfile.close();
 
             // output of raw data in terms of bins
-            outfile.open(out_path + "/greens.bins.out", std::ios::trunc);
-            QuantumMonteCarlo::DqmcIO::output_observable_in_bins(
-                outfile, meas_handler->find<Observable::MatrixObs>("greens_functions") );
-            outfile.close();
+            if ( meas_handler->isOutputBins() ) {
+                output_bins( "greens", meas_handler->find<Observable::MatrixObs>("greens_functions") );
+            }
         }
 
         // dynamic spin susceptibility
@@ -348,10 +500,9 @@ int main( int argc, char* argv[] ) {
             outfile.close();
 
             // output of raw data in terms of bins
-            outfile.open(out_path + "/dss.bins.out", std::ios::trunc);
-            QuantumMonteCarlo::DqmcIO::output_observable_in_bins(
-                outfile, meas_handler->find<Observable::VectorObs>("dynamic_spin_susceptibility") );
-            outfile.close();
+            if ( meas_handler->isOutputBins() ) {
+                output_bins( "dss", meas_handler->find<Observable::VectorObs>("dynamic_spin_susceptibility") );
+            }
         }
 
     }
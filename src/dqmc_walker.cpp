@@ -6,6 +6,13 @@
 #include "utils/numerical_stable.hpp"
 #include "random.h"
 
+#include <iostream>
+#include <omp.h>
+#include <mkl_service.h>
+#ifdef __linux__
+#include <sched.h>
+#endif
+
 
 namespace QuantumMonteCarlo {
 
@@ -38,6 +45,60 @@ namespace QuantumMonteCarlo {
     }
 
 
+    void DqmcWalker::set_stack_decomposition( Utils::Decomposition decomposition ) 
+    {
+        this->m_stack_decomposition = decomposition;
+    }
+
+
+    const std::string_view DqmcWalker::StackDecompositionName() const
+    {
+        switch ( this->m_stack_decomposition ) {
+            case Utils::Decomposition::SVD:       return "SVD";
+            case Utils::Decomposition::QRP:       return "QRP";
+            case Utils::Decomposition::JacobiSVD: return "JacobiSVD";
+        }
+        return "";
+    }
+
+
+    void DqmcWalker::set_spin_parallel( bool is_spin_parallel, const std::vector<int>& lane_cores, int lane_mkl_threads ) 
+    {
+        assert( lane_cores.empty() || lane_cores.size() == 2 );
+        assert( lane_mkl_threads > 0 );
+        this->m_is_spin_parallel = is_spin_parallel;
+        this->m_spin_lane_cores = lane_cores;
+        this->m_lane_mkl_threads = lane_mkl_threads;
+    }
+
+
+    void DqmcWalker::set_batched_wrap( bool is_batched_wrap ) 
+    {
+        this->m_is_batched_wrap = is_batched_wrap;
+    }
+
+
+    void DqmcWalker::set_walker_pool_size( int walker_pool_size ) 
+    {
+        assert( walker_pool_size > 0 );
+        this->m_walker_pool_size = walker_pool_size;
+    }
+
+
+    void DqmcWalker::set_random_key( unsigned seed, int rank, int walker_id ) 
+    {
+        assert( rank >= 0 && walker_id >= 0 );
+        this->m_rng.set_key( seed, rank, walker_id );
+    }
+
+
+    void DqmcWalker::set_delay_depth( int delay_depth ) 
+    {
+        assert( delay_depth > 0 );
+        this->m_delay_depth = delay_depth;
+    }
+
+
     void DqmcWalker::initial( const LatticeBase& lattice, const MeasureHandler& meas_handler ) 
     {
         this->m_space_size = lattice.SpaceSize();
@@ -46,6 +107,19 @@ namespace QuantumMonteCarlo {
         
         this->m_is_equaltime = meas_handler.isEqualTime();
         this->m_is_dynamic = meas_handler.isDynamic();
+        this->m_is_equaltime_streaming = meas_handler.isEqualTimeStreaming();
+        this->m_is_dynamic_streaming = meas_handler.isDynamicStreaming();
+
+        // one uniform random number per site for the Metropolis acceptances of a time slice
+        this->m_uniforms.resize(this->m_space_size);
+    }
+
+
+    const int DqmcWalker::svd_stack_length() const
+    {
+        return ( this->m_time_size % this->m_stabilization_pace == 0 )? 
+                 this->m_time_size/this->m_stabilization_pace 
+               : this->m_time_size/this->m_stabilization_pace + 1 ;
     }
 
 
@@ -58,10 +132,14 @@ namespace QuantumMonteCarlo {
         if ( this->m_svd_stack_right_dn ) { this->m_svd_stack_right_dn.reset(); }
         
         // allocate memory for SvdStack classes
-        this->m_svd_stack_left_up = std::make_unique<SvdStack>(this->m_space_size, this->m_time_size);
-        this->m_svd_stack_left_dn = std::make_unique<SvdStack>(this->m_space_size, this->m_time_size);
-        this->m_svd_stack_right_up = std::make_unique<SvdStack>(this->m_space_size, this->m_time_size);
-        this->m_svd_stack_right_dn = std::make_unique<SvdStack>(this->m_space_size, this->m_time_size);
+        // and the spin-down stacks are not needed in the spin-symmetric mode
+        const int stack_length = this->svd_stack_length();
+        this->m_svd_stack_left_up = std::make_unique<SvdStack>(this->m_space_size, stack_length, this->m_stack_decomposition);
+        this->m_svd_stack_right_up = std::make_unique<SvdStack>(this->m_space_size, stack_length, this->m_stack_decomposition);
+        if ( !this->m_is_spin_symmetric ) {
+            this->m_svd_stack_left_dn = std::make_unique<SvdStack>(this->m_space_size, stack_length, this->m_stack_decomposition);
+            this->m_svd_stack_right_dn = std::make_unique<SvdStack>(this->m_space_size, stack_length, this->m_stack_decomposition);
+        }
     }
 
 
@@ -84,53 +162,93 @@ namespace QuantumMonteCarlo {
         
         
         // allocate memory for greens functions
+        // in the spin-symmetric mode, the spin-down greens functions are aliases of the spin-up ones
+        const bool is_spin_dn = !this->m_is_spin_symmetric;
         this->m_green_tt_up = std::make_unique<GreensFunc>(this->m_space_size, this->m_space_size);
-        this->m_green_tt_dn = std::make_unique<GreensFunc>(this->m_space_size, this->m_space_size);
+        if ( is_spin_dn ) {
+            this->m_green_tt_dn = std::make_unique<GreensFunc>(this->m_space_size, this->m_space_size);
+        }
 
-        if ( this->m_is_equaltime || this->m_is_dynamic ) {
+        // greens functions of all time slices are not needed for the streaming measurements
+        if ( ( this->m_is_equaltime && !this->m_is_equaltime_streaming ) || ( this->m_is_dynamic && !this->m_is_dynamic_streaming ) ) {
             this->m_vec_green_tt_up = std::make_unique<GreensFuncVec>(this->m_time_size, GreensFunc(this->m_space_size, this->m_space_size));
-            this->m_vec_green_tt_dn = std::make_unique<GreensFuncVec>(this->m_time_size, GreensFunc(this->m_space_size, this->m_space_size));
+            if ( is_spin_dn ) {
+                this->m_vec_green_tt_dn = std::make_unique<GreensFuncVec>(this->m_time_size, GreensFunc(this->m_space_size, this->m_space_size));
+            }
         }
 
         if ( this->m_is_dynamic ) {
             this->m_green_t0_up = std::make_unique<GreensFunc>(this->m_space_size, this->m_space_size);
-            this->m_green_t0_dn = std::make_unique<GreensFunc>(this->m_space_size, this->m_space_size);
             this->m_green_0t_up = std::make_unique<GreensFunc>(this->m_space_size, this->m_space_size);
-            this->m_green_0t_dn = std::make_unique<GreensFunc>(this->m_space_size, this->m_space_size);
+            if ( !this->m_is_dynamic_streaming ) {
+                this->m_vec_green_t0_up = std::make_unique<GreensFuncVec>(this->m_time_size, GreensFunc(this->m_space_size, this->m_space_size));
+                this->m_vec_green_0t_up = std::make_unique<GreensFuncVec>(this->m_time_size, GreensFunc(this->m_space_size, this->m_space_size));
+            }
 
-            this->m_vec_green_t0_up = std::make_unique<GreensFuncVec>(this->m_time_size, GreensFunc(this->m_space_size, this->m_space_size));
-            this->m_vec_green_t0_dn = std::make_unique<GreensFuncVec>(this->m_time_size, GreensFunc(this->m_space_size, this->m_space_size));
-            this->m_vec_green_0t_up = std::make_unique<GreensFuncVec>(this->m_time_size, GreensFunc(this->m_space_size, this->m_space_size));
-            this->m_vec_green_0t_dn = std::make_unique<GreensFuncVec>(this->m_time_size, GreensFunc(this->m_space_size, this->m_space_size));
+            if ( is_spin_dn ) {
+                this->m_green_t0_dn = std::make_unique<GreensFunc>(this->m_space_size, this->m_space_size);
+                this->m_green_0t_dn = std::make_unique<GreensFunc>(this->m_space_size, this->m_space_size);
+                if ( !this->m_is_dynamic_streaming ) {
+                    this->m_vec_green_t0_dn = std::make_unique<GreensFuncVec>(this->m_time_size, GreensFunc(this->m_space_size, this->m_space_size));
+                    this->m_vec_green_0t_dn = std::make_unique<GreensFuncVec>(this->m_time_size, GreensFunc(this->m_space_size, this->m_space_size));
+                }
+            }
         }
     }
 
 
+    void DqmcWalker::allocate_delayed_updates()
+    {
+        // buffers of the low-rank corrections, which are only needed if the updates are delayed
+        this->m_delayed_count = 0;
+        const int delay_depth = ( this->m_delay_depth > 1 )? this->m_delay_depth : 0;
+        const int delay_depth_dn = ( this->m_is_spin_symmetric )? 0 : delay_depth;
+        this->m_delayed_u_up.resize(this->m_space_size, delay_depth);
+        this->m_delayed_u_dn.resize(this->m_space_size, delay_depth_dn);
+        this->m_delayed_w_up.resize(this->m_space_size, delay_depth);
+        this->m_delayed_w_dn.resize(this->m_space_size, delay_depth_dn);
+        this->m_delayed_diag_up = RealScalarVec::Zero( ( delay_depth > 0 )? this->m_space_size : 0 );
+        this->m_delayed_diag_dn = RealScalarVec::Zero( ( delay_depth_dn > 0 )? this->m_space_size : 0 );
+    }
+
+
     void DqmcWalker::initial_svd_stacks( const LatticeBase& lattice, const ModelBase& model ) 
     {
         // initialize udv stacks for sweep use
         // sweep process will start from 0 to beta, so we initialize svd_stack_right here.
         // stabilize the process every stabilization_pace steps
 
+        // only one spin sector is propagated if the model is spin symmetric
+        this->m_is_spin_symmetric = model.isSpinSymmetric();
+
         // allocate memory
         this->allocate_svd_stacks();
 
-        Matrix tmp_stack_up = Matrix::Identity(this->m_space_size, this->m_space_size);
-        Matrix tmp_stack_dn = Matrix::Identity(this->m_space_size, this->m_space_size);
-
         // initial svd stacks for sweeping usages
-        for (auto t = this->m_time_size; t >= 1; --t) {
-            model.mult_transB_from_left(tmp_stack_up, t, +1.0);
-            model.mult_transB_from_left(tmp_stack_dn, t, -1.0);
-
-            // stabilize every nwrap steps with svd decomposition
-            if ( (t - 1) % this->m_stabilization_pace == 0 ) {
-                this->m_svd_stack_right_up->push(tmp_stack_up);
-                this->m_svd_stack_right_dn->push(tmp_stack_dn);
-                tmp_stack_up = Matrix::Identity(this->m_space_size, this->m_space_size);
-                tmp_stack_dn = Matrix::Identity(this->m_space_size, this->m_space_size);
+        this->build_svd_stacks( model );
+    }
+
+
+    void DqmcWalker::build_svd_stacks( const ModelBase& model )
+    {
+        this->run_spin_lanes( [&]( int lane ) {
+            const int spin = ( lane == 0 )? +1 : -1;
+            SvdStack& svd_stack_left = ( lane == 0 )? *this->m_svd_stack_left_up : *this->m_svd_stack_left_dn;
+            SvdStack& svd_stack_right = ( lane == 0 )? *this->m_svd_stack_right_up : *this->m_svd_stack_right_dn;
+            svd_stack_left.clear();
+            svd_stack_right.clear();
+            Matrix tmp_stack = Matrix::Identity(this->m_space_size, this->m_space_size);
+
+            for (auto t = this->m_time_size; t >= 1; --t) {
+                model.mult_transB_from_left(tmp_stack, t, spin);
+
+                // stabilize every nwrap steps with svd decomposition
+                if ( (t - 1) % this->m_stabilization_pace == 0 ) {
+                    svd_stack_right.push(tmp_stack);
+                    tmp_stack = Matrix::Identity(this->m_space_size, this->m_space_size);
+                }
             }
-        }
+        });
     }
 
 
@@ -138,12 +256,19 @@ namespace QuantumMonteCarlo {
     {
         // allocate memory
         this->allocate_greens_functions();
+        this->allocate_delayed_updates();
 
         // compute greens function at time slice t = 0
         // which corresponds to imaginary-time tau = beta
         // the svd stacks should be initialized correctly ahead of time
-        NumericalStable::compute_equaltime_greens( *this->m_svd_stack_left_up, *this->m_svd_stack_right_up, *this->m_green_tt_up );
-        NumericalStable::compute_equaltime_greens( *this->m_svd_stack_left_dn, *this->m_svd_stack_right_dn, *this->m_green_tt_dn );
+        this->run_spin_lanes( [&]( int lane ) {
+            if ( lane == 0 ) {
+                NumericalStable::compute_equaltime_greens( *this->m_svd_stack_left_up, *this->m_svd_stack_right_up, *this->m_green_tt_up );
+            }
+            else {
+                NumericalStable::compute_equaltime_greens( *this->m_svd_stack_left_dn, *this->m_svd_stack_right_dn, *this->m_green_tt_dn );
+            }
+        });
     }
 
 
@@ -159,7 +284,7 @@ namespace QuantumMonteCarlo {
         }
 
         // initialize the sign of the initial bosonic configurations
-        this->m_config_sign = ( this->m_green_tt_up->determinant() * this->m_green_tt_dn->determinant() >= 0 )? +1.0 : -1.0;
+        this->m_config_sign = ( this->GreenttUp().determinant() * this->GreenttDn().determinant() >= 0 )? +1.0 : -1.0;
     }
 
 
@@ -168,6 +293,8 @@ namespace QuantumMonteCarlo {
      *  Update the aux bosonic fields at space-time position (t,i) 
      *  for all i with Metropolis probability, and, if the update is accepted, 
      *  perform a in-place update of the green's functions.
+     *  If the delay depth is larger than 1, the accepted updates are collected
+     *  and applied to the green's functions by blocks of rank-k products.
      *  Record the updated green's function at the life-end of this function.
      */
     void DqmcWalker::metropolis_update( ModelBase& model, TimeIndex t )
@@ -176,16 +303,22 @@ namespace QuantumMonteCarlo {
         assert( t >= 0 && t <= this->m_time_size );
 
         const int eff_t = (t == 0)? this->m_time_size-1 : t-1;
+        this->m_rng.fill_uniform( this->m_uniforms.data(), this->m_space_size );
         for (auto i = 0; i < this->m_space_size; ++i) {
             
             // obtain the ratio of flipping the bosonic field at (i,l)
             const auto update_ratio = model.get_update_ratio( *this, eff_t, i );
 
-            if ( std::bernoulli_distribution(std::min(1.0, std::abs(update_ratio)))(Utils::Random::Engine) )
+            if ( this->m_uniforms[i] < std::min(1.0, std::abs(update_ratio)) )
             {   
                 // if accepted
                 // update the greens functions
-                model.update_greens_function( *this, eff_t, i );
+                if ( this->m_delay_depth > 1 ) {
+                    this->delayed_update_greens_function( model, eff_t, i );
+                }
+                else {
+                    model.update_greens_function( *this, eff_t, i );
+                }
 
                 // update the bosonic fields
                 model.update_bosonic_field( eff_t, i );
@@ -194,6 +327,165 @@ namespace QuantumMonteCarlo {
                 this->m_config_sign = ( update_ratio >= 0 )? +this->m_config_sign : -this->m_config_sign;
             }
         }
+
+        // apply the remaining updates before the greens functions are wrapped or recorded
+        if ( this->m_delay_depth > 1 ) {
+            this->flush_delayed_updates();
+        }
+    }
+
+
+
+    /*
+     *  Delayed update of the equal-time greens functions due to a local flip at site i of time slice t.
+     *  Suppose k updates have been collected, the current greens function reads G' = G - U * W^T,
+     *  where U and W are N x k matrices. A new flip with diagonal element delta transforms it into
+     *      G'' = G' - factor * G'(:,i) * ( e_i^T - G'(i,:) ),  with factor = delta / ( 1 + ( 1 - G'_ii ) * delta ),
+     *  which is recorded as one more column of U and W, and costs only O(N*k) operations.
+     *  Only the diagonal elements of G are updated in place.
+     */
+    void DqmcWalker::delayed_update_greens_function( const ModelBase& model, TimeIndex t, int i )
+    {
+        assert( this->m_delay_depth > 1 && this->m_delayed_count < this->m_delay_depth );
+        assert( i >= 0 && i < this->m_space_size );
+
+        const int k = this->m_delayed_count;
+        auto delayed_update = [&]( GreensFunc& green, Matrix& u, Matrix& w, RealScalarVec& diag, RealScalar delta )
+        {
+            // the i-th column and row of the current greens function G'
+            // caution that the diagonal element of G has been updated already
+            const RealScalar green_ii = green(i, i);
+            u.col(k).noalias() = green.col(i) - u.leftCols(k) * w.row(i).head(k).transpose();
+            w.col(k).noalias() = green.row(i).transpose() - w.leftCols(k) * u.row(i).head(k).transpose();
+            u(i, k) = green_ii;
+            w(i, k) = green_ii;
+
+            const RealScalar factor = delta / ( 1 + ( 1 - green_ii ) * delta );
+            u.col(k) *= factor;
+            w.col(k) = -w.col(k);
+            w(i, k) += 1.0;
+
+            // keep the diagonal elements up to date
+            green.diagonal() -= u.col(k).cwiseProduct(w.col(k));
+            diag += u.col(k).cwiseProduct(w.col(k));
+        };
+
+        delayed_update( *this->m_green_tt_up, this->m_delayed_u_up, this->m_delayed_w_up, this->m_delayed_diag_up, 
+                        model.get_update_delta( t, i, +1 ) );
+        if ( !this->m_is_spin_symmetric ) {
+            delayed_update( *this->m_green_tt_dn, this->m_delayed_u_dn, this->m_delayed_w_dn, this->m_delayed_diag_dn, 
+                            model.get_update_delta( t, i, -1 ) );
+        }
+        this->m_delayed_count++;
+
+        if ( this->m_delayed_count == this->m_delay_depth ) {
+            this->flush_delayed_updates();
+        }
+    }
+
+
+
+    /*
+     *  Apply the collected updates to the equal-time greens functions
+     *      G  ->  G - U * W^T
+     *  by one rank-k matrix product for each spin.
+     */
+    void DqmcWalker::flush_delayed_updates()
+    {
+        const int k = this->m_delayed_count;
+        if ( k == 0 ) { return; }
+
+        // restore the diagonal elements, which have been updated in advance
+        this->m_green_tt_up->diagonal() += this->m_delayed_diag_up;
+        this->m_green_tt_up->noalias() -= this->m_delayed_u_up.leftCols(k) * this->m_delayed_w_up.leftCols(k).transpose();
+        this->m_delayed_diag_up.setZero();
+
+        if ( !this->m_is_spin_symmetric ) {
+            this->m_green_tt_dn->diagonal() += this->m_delayed_diag_dn;
+            this->m_green_tt_dn->noalias() -= this->m_delayed_u_dn.leftCols(k) * this->m_delayed_w_dn.leftCols(k).transpose();
+            this->m_delayed_diag_dn.setZero();
+        }
+        this->m_delayed_count = 0;
+    }
+
+
+
+    /*
+     *  Run the task for both spin sectors, labeled by lane 0 for spin up and lane 1 for spin down.
+     *  In the spin-parallel mode, the two lanes are processed concurrently by two OpenMP threads,
+     *  each of which is optionally pinned to the assigned cpu core during the task,
+     *  and the number of MKL threads inside each lane is restricted to avoid oversubscriptions.
+     *  Otherwise the lanes are processed one after another.
+     *  In the spin-symmetric mode, only the spin-up lane is processed.
+     */
+    void DqmcWalker::run_spin_lanes( const std::function<void(int)>& task ) const
+    {
+        if ( this->m_is_spin_symmetric ) {
+            task( 0 );
+        }
+        else if ( this->m_is_spin_parallel ) {
+            #pragma omp parallel num_threads(2)
+            {
+                const int lane = omp_get_thread_num();
+                mkl_set_num_threads_local( this->m_lane_mkl_threads );
+                this->run_pinned_spin_lane( lane, task );
+                mkl_set_num_threads_local( 0 );
+            }
+        }
+        else {
+            task( 0 );
+            task( 1 );
+        }
+    }
+
+
+    void DqmcWalker::run_pinned_spin_lane( int lane, const std::function<void(int)>& task ) const
+    {
+        if ( (int)this->m_spin_lane_cores.size() != 2 ) { 
+            task( lane );
+            return; 
+        }
+
+#ifdef __linux__
+        // the OpenMP threads, in particular the master thread, are reused afterwards by the MKL routines 
+        // and the measurements, hence the affinity of the calling thread is saved and restored around the task
+        cpu_set_t saved_cpu_set;
+        CPU_ZERO( &saved_cpu_set );
+        if ( sched_getaffinity( 0, sizeof(cpu_set_t), &saved_cpu_set ) != 0 ) {
+            std::cerr << "QuantumMonteCarlo::DqmcWalker::run_pinned_spin_lane(): "
+                      << "fail to get the cpu affinity of the spin lane " << lane << "." << std::endl;
+            exit(1);
+        }
+
+        // bind the calling thread to the core assigned to the lane
+        cpu_set_t cpu_set;
+        CPU_ZERO( &cpu_set );
+        CPU_SET( this->m_spin_lane_cores[lane], &cpu_set );
+        if ( sched_setaffinity( 0, sizeof(cpu_set_t), &cpu_set ) != 0 ) {
+            std::cerr << "QuantumMonteCarlo::DqmcWalker::run_pinned_spin_lane(): "
+                      << "fail to pin the spin lane " << lane 
+                      << " to cpu core " << this->m_spin_lane_cores[lane] << "." << std::endl;
+            exit(1);
+        }
+
+        task( lane );
+
+        if ( sched_setaffinity( 0, sizeof(cpu_set_t), &saved_cpu_set ) != 0 ) {
+            std::cerr << "QuantumMonteCarlo::DqmcWalker::run_pinned_spin_lane(): "
+                      << "fail to restore the cpu affinity of the spin lane " << lane << "." << std::endl;
+            exit(1);
+        }
+#else
+        task( lane );
+#endif
+    }
+
+
+    void DqmcWalker::call_eqtime_hook( const EqtimeHook& hook, TimeIndex t ) const
+    {
+        if ( hook ) {
+            hook( t, *this->m_green_tt_up, *this->green_dn( this->m_green_tt_up, this->m_green_tt_dn ) );
+        }
     }
 
 
@@ -210,10 +502,16 @@ namespace QuantumMonteCarlo {
         assert( t >= 0 && t <= this->m_time_size );
 
         const int eff_t = ( t == this->m_time_size )? 1 : t+1;
-        model.mult_B_from_left     ( *this->m_green_tt_up, eff_t, +1 );
-        model.mult_invB_from_right ( *this->m_green_tt_up, eff_t, +1 );
-        model.mult_B_from_left     ( *this->m_green_tt_dn, eff_t, -1 );
-        model.mult_invB_from_right ( *this->m_green_tt_dn, eff_t, -1 );
+        if ( this->m_is_batched_wrap && !this->m_is_spin_symmetric && !this->m_is_spin_parallel ) {
+            model.wrap_forwards_batched( *this->m_green_tt_up, *this->m_green_tt_dn, eff_t );
+            return;
+        }
+        this->run_spin_lanes( [&]( int lane ) {
+            const int spin = ( lane == 0 )? +1 : -1;
+            GreensFunc& green_tt = ( lane == 0 )? *this->m_green_tt_up : *this->m_green_tt_dn;
+            model.mult_B_from_left     ( green_tt, eff_t, spin );
+            model.mult_invB_from_right ( green_tt, eff_t, spin );
+        });
     }
 
 
@@ -230,10 +528,16 @@ namespace QuantumMonteCarlo {
         assert( t >= 0 && t <= this->m_time_size );
 
         const int eff_t = ( t == 0 )? this->m_time_size : t;
-        model.mult_B_from_right   ( *this->m_green_tt_up, eff_t, +1 );
-        model.mult_invB_from_left ( *this->m_green_tt_up, eff_t, +1 );
-        model.mult_B_from_right   ( *this->m_green_tt_dn, eff_t, -1 );
-        model.mult_invB_from_left ( *this->m_green_tt_dn, eff_t, -1 );
+        if ( this->m_is_batched_wrap && !this->m_is_spin_symmetric && !this->m_is_spin_parallel ) {
+            model.wrap_backwards_batched( *this->m_green_tt_up, *this->m_green_tt_dn, eff_t );
+            return;
+        }
+        this->run_spin_lanes( [&]( int lane ) {
+            const int spin = ( lane == 0 )? +1 : -1;
+            GreensFunc& green_tt = ( lane == 0 )? *this->m_green_tt_up : *this->m_green_tt_dn;
+            model.mult_B_from_right   ( green_tt, eff_t, spin );
+            model.mult_invB_from_left ( green_tt, eff_t, spin );
+        });
     }
 
 
@@ -243,22 +547,27 @@ namespace QuantumMonteCarlo {
      *  For t = 1,2...,ts , attempt to update fields and propagate the greens functions
      *  Perform the stabilization every 'stabilization_pace' time slices
      */
-    void DqmcWalker::sweep_from_0_to_beta( ModelBase& model )
+    void DqmcWalker::sweep_from_0_to_beta( ModelBase& model, const EqtimeHook& hook )
     {
         this->m_current_time_slice++;
 
-        const int stack_length = ( this->m_time_size % this->m_stabilization_pace == 0 )? 
-                                   this->m_time_size/this->m_stabilization_pace 
-                                 : this->m_time_size/this->m_stabilization_pace + 1 ;
+        const int stack_length = this->svd_stack_length();
         assert( this->m_current_time_slice == 1 );
-        assert( this->m_svd_stack_left_up->empty() && this->m_svd_stack_left_dn->empty() );
-        assert( this->m_svd_stack_right_up->StackLength() == stack_length && 
-                this->m_svd_stack_right_dn->StackLength() == stack_length );
+        assert( this->m_svd_stack_left_up->empty() );
+        assert( this->m_svd_stack_right_up->StackLength() == stack_length );
+        assert( this->m_is_spin_symmetric || ( this->m_svd_stack_left_dn->empty() && 
+                this->m_svd_stack_right_dn->StackLength() == stack_length ) );
 
         // temporary matrices
         Matrix tmp_mat_up = Matrix::Identity(this->m_space_size, this->m_space_size);
         Matrix tmp_mat_dn = Matrix::Identity(this->m_space_size, this->m_space_size);
 
+        // wrapping errors collected by the two spin lanes
+        RealScalar lane_wrap_error[2] = { 0.0, 0.0 };
+
+        // whether to store the equal-time greens functions of all time slices
+        const bool is_recording = ( this->m_is_equaltime && !this->m_is_equaltime_streaming );
+
         // sweep upwards from 0 to beta
         for (auto t = 1; t <= this->m_time_size; ++t) 
         {
@@ -268,59 +577,68 @@ namespace QuantumMonteCarlo {
             // update auxiliary fields and record the updated greens functions
             this->metropolis_update( model, t );
             if ( this->m_is_equaltime ) {
-                (*this->m_vec_green_tt_up)[t-1] = *this->m_green_tt_up;
-                (*this->m_vec_green_tt_dn)[t-1] = *this->m_green_tt_dn;
                 (*this->m_vec_config_sign)[t-1] = this->m_config_sign;
             }
 
-            model.mult_B_from_left(tmp_mat_up, t, +1);
-            model.mult_B_from_left(tmp_mat_dn, t, -1);
+            // the spin-up and spin-down sectors are independent of each other from now on
+            this->run_spin_lanes( [&]( int lane ) {
+                const int spin = ( lane == 0 )? +1 : -1;
+                GreensFunc& green_tt = ( lane == 0 )? *this->m_green_tt_up : *this->m_green_tt_dn;
+                SvdStack& svd_stack_left = ( lane == 0 )? *this->m_svd_stack_left_up : *this->m_svd_stack_left_dn;
+                SvdStack& svd_stack_right = ( lane == 0 )? *this->m_svd_stack_right_up : *this->m_svd_stack_right_dn;
+                Matrix& tmp_mat = ( lane == 0 )? tmp_mat_up : tmp_mat_dn;
+
+                if ( is_recording ) {
+                    GreensFuncVec& vec_green_tt = ( lane == 0 )? *this->m_vec_green_tt_up : *this->m_vec_green_tt_dn;
+                    vec_green_tt[t-1] = green_tt;
+                }
 
-            // perform the stabilizations
-            if ( t % this->m_stabilization_pace == 0 || t == this->m_time_size ) {
-                // update svd stacks
-                this->m_svd_stack_right_up->pop();
-                this->m_svd_stack_right_dn->pop();
-                this->m_svd_stack_left_up->push(tmp_mat_up);
-                this->m_svd_stack_left_dn->push(tmp_mat_dn);
-
-                // collect the wrapping errors
-                Matrix tmp_green_tt_up = Matrix::Zero(this->m_space_size, this->m_space_size);
-                Matrix tmp_green_tt_dn = Matrix::Zero(this->m_space_size, this->m_space_size);
-                double tmp_wrap_error_tt_up = 0.0;
-                double tmp_wrap_error_tt_dn = 0.0;
-
-                // compute fresh greens every 'stabilization_pace' steps: g = ( 1 + stack_left*stack_right^T )^-1
-                // stack_left = B(t-1) * ... * B(0)
-                // stack_right = B(t)^T * ... * B(ts-1)^T
-                NumericalStable::compute_equaltime_greens(*this->m_svd_stack_left_up, *this->m_svd_stack_right_up, tmp_green_tt_up);
-                NumericalStable::compute_equaltime_greens(*this->m_svd_stack_left_dn, *this->m_svd_stack_right_dn, tmp_green_tt_dn);
-
-                // compute wrapping errors
-                NumericalStable::matrix_compare_error(tmp_green_tt_up, *this->m_green_tt_up, tmp_wrap_error_tt_up);
-                NumericalStable::matrix_compare_error(tmp_green_tt_dn, *this->m_green_tt_dn, tmp_wrap_error_tt_dn);
-                this->m_wrap_error = std::max(this->m_wrap_error, std::max(tmp_wrap_error_tt_up, tmp_wrap_error_tt_dn));
-
-                *this->m_green_tt_up = tmp_green_tt_up;
-                *this->m_green_tt_dn = tmp_green_tt_dn;
-
-                if ( this->m_is_equaltime ) {
-                    (*this->m_vec_green_tt_up)[t-1] = *this->m_green_tt_up;
-                    (*this->m_vec_green_tt_dn)[t-1] = *this->m_green_tt_dn;
+                model.mult_B_from_left(tmp_mat, t, spin);
+
+                // perform the stabilizations
+                if ( t % this->m_stabilization_pace == 0 || t == this->m_time_size ) {
+                    // update svd stacks
+                    svd_stack_right.pop();
+                    svd_stack_left.push(tmp_mat);
+
+                    // collect the wrapping errors
+                    Matrix tmp_green_tt = Matrix::Zero(this->m_space_size, this->m_space_size);
+                    double tmp_wrap_error_tt = 0.0;
+
+                    // compute fresh greens every 'stabilization_pace' steps: g = ( 1 + stack_left*stack_right^T )^-1
+                    // stack_left = B(t-1) * ... * B(0)
+                    // stack_right = B(t)^T * ... * B(ts-1)^T
+                    NumericalStable::compute_equaltime_greens(svd_stack_left, svd_stack_right, tmp_green_tt);
+
+                    // compute wrapping errors
+                    NumericalStable::matrix_compare_error(tmp_green_tt, green_tt, tmp_wrap_error_tt);
+                    lane_wrap_error[lane] = std::max(lane_wrap_error[lane], tmp_wrap_error_tt);
+
+                    green_tt = tmp_green_tt;
+
+                    if ( is_recording ) {
+                        GreensFuncVec& vec_green_tt = ( lane == 0 )? *this->m_vec_green_tt_up : *this->m_vec_green_tt_dn;
+                        vec_green_tt[t-1] = green_tt;
+                    }
+
+                    tmp_mat = Matrix::Identity(this->m_space_size, this->m_space_size);
                 }
+            });
 
-                tmp_mat_up = Matrix::Identity(this->m_space_size, this->m_space_size);
-                tmp_mat_dn = Matrix::Identity(this->m_space_size, this->m_space_size);
-            }
+            // the greens functions of time slice t are settled
+            this->call_eqtime_hook( hook, t-1 );
 
             // finally stop at time slice t = ts + 1
             this->m_current_time_slice++;
         }
+        this->m_wrap_error = std::max(this->m_wrap_error, std::max(lane_wrap_error[0], lane_wrap_error[1]));
 
         // end with fresh greens functions
-        if ( this->m_is_equaltime ) {
+        if ( is_recording ) {
             (*this->m_vec_green_tt_up)[this->m_time_size-1] = *this->m_green_tt_up;
-            (*this->m_vec_green_tt_dn)[this->m_time_size-1] = *this->m_green_tt_dn;
+            if ( !this->m_is_spin_symmetric ) {
+                (*this->m_vec_green_tt_dn)[this->m_time_size-1] = *this->m_green_tt_dn;
+            }
         }
     }
     
@@ -331,84 +649,108 @@ namespace QuantumMonteCarlo {
      *  For l = ts,ts-1,...,1 , attempt to update fields and propagate the greens functions
      *  Perform the stabilization every 'stabilization_pace' time slices
      */
-    void DqmcWalker::sweep_from_beta_to_0( ModelBase& model )
+    void DqmcWalker::sweep_from_beta_to_0( ModelBase& model, const EqtimeHook& hook )
     {
         this->m_current_time_slice--;
 
-        const int stack_length = ( this->m_time_size % this->m_stabilization_pace == 0 )? 
-                                   this->m_time_size/this->m_stabilization_pace 
-                                 : this->m_time_size/this->m_stabilization_pace + 1;
+        const int stack_length = this->svd_stack_length();
         assert( this->m_current_time_slice == this->m_time_size );
-        assert( this->m_svd_stack_right_up->empty() && this->m_svd_stack_right_dn->empty() );
-        assert( this->m_svd_stack_left_up->StackLength() == stack_length && 
-                this->m_svd_stack_left_dn->StackLength() == stack_length );
+        assert( this->m_svd_stack_right_up->empty() );
+        assert( this->m_svd_stack_left_up->StackLength() == stack_length );
+        assert( this->m_is_spin_symmetric || ( this->m_svd_stack_right_dn->empty() && 
+                this->m_svd_stack_left_dn->StackLength() == stack_length ) );
 
         // temporary matrices
         Matrix tmp_mat_up = Matrix::Identity(this->m_space_size, this->m_space_size);
         Matrix tmp_mat_dn = Matrix::Identity(this->m_space_size, this->m_space_size);
 
+        // wrapping errors collected by the two spin lanes
+        RealScalar lane_wrap_error[2] = { 0.0, 0.0 };
+
+        // whether to store the equal-time greens functions of all time slices
+        const bool is_recording = ( this->m_is_equaltime && !this->m_is_equaltime_streaming );
+
         // sweep downwards from beta to 0
         for (auto t = this->m_time_size; t >= 1; --t) {
 
             // perform the stabilizations
             if ( t % this->m_stabilization_pace == 0 && t != this->m_time_size ) {
-                // update svd stacks
-                this->m_svd_stack_left_up->pop();
-                this->m_svd_stack_left_dn->pop();
-                this->m_svd_stack_right_up->push(tmp_mat_up);
-                this->m_svd_stack_right_dn->push(tmp_mat_dn);
-
-                // collect the wrapping errors
-                Matrix tmp_green_tt_up = Matrix::Zero(this->m_space_size, this->m_space_size);
-                Matrix tmp_green_tt_dn = Matrix::Zero(this->m_space_size, this->m_space_size);
-                double tmp_wrap_error_tt_up = 0.0;
-                double tmp_wrap_error_tt_dn = 0.0;
-
-                NumericalStable::compute_equaltime_greens(*this->m_svd_stack_left_up, *this->m_svd_stack_right_up, tmp_green_tt_up);
-                NumericalStable::compute_equaltime_greens(*this->m_svd_stack_left_dn, *this->m_svd_stack_right_dn, tmp_green_tt_dn);
-
-                // compute the wrapping errors
-                NumericalStable::matrix_compare_error(tmp_green_tt_up, *this->m_green_tt_up, tmp_wrap_error_tt_up);
-                NumericalStable::matrix_compare_error(tmp_green_tt_dn, *this->m_green_tt_dn, tmp_wrap_error_tt_dn);
-                this->m_wrap_error = std::max(this->m_wrap_error, std::max(tmp_wrap_error_tt_up, tmp_wrap_error_tt_dn));
-
-                *this->m_green_tt_up = tmp_green_tt_up;
-                *this->m_green_tt_dn = tmp_green_tt_dn;
-
-                tmp_mat_up = Matrix::Identity(this->m_space_size, this->m_space_size);
-                tmp_mat_dn = Matrix::Identity(this->m_space_size, this->m_space_size);
+                this->run_spin_lanes( [&]( int lane ) {
+                    GreensFunc& green_tt = ( lane == 0 )? *this->m_green_tt_up : *this->m_green_tt_dn;
+                    SvdStack& svd_stack_left = ( lane == 0 )? *this->m_svd_stack_left_up : *this->m_svd_stack_left_dn;
+                    SvdStack& svd_stack_right = ( lane == 0 )? *this->m_svd_stack_right_up : *this->m_svd_stack_right_dn;
+                    Matrix& tmp_mat = ( lane == 0 )? tmp_mat_up : tmp_mat_dn;
+
+                    // update svd stacks
+                    svd_stack_left.pop();
+                    svd_stack_right.push(tmp_mat);
+
+                    // collect the wrapping errors
+                    Matrix tmp_green_tt = Matrix::Zero(this->m_space_size, this->m_space_size);
+                    double tmp_wrap_error_tt = 0.0;
+
+                    NumericalStable::compute_equaltime_greens(svd_stack_left, svd_stack_right, tmp_green_tt);
+
+                    // compute the wrapping errors
+                    NumericalStable::matrix_compare_error(tmp_green_tt, green_tt, tmp_wrap_error_tt);
+                    lane_wrap_error[lane] = std::max(lane_wrap_error[lane], tmp_wrap_error_tt);
+
+                    green_tt = tmp_green_tt;
+
+                    tmp_mat = Matrix::Identity(this->m_space_size, this->m_space_size);
+                });
             }
 
             // update auxiliary fields and record the updated greens functions
             this->metropolis_update( model, t );
             if ( this->m_is_equaltime ) {
-                (*this->m_vec_green_tt_up)[t-1] = *this->m_green_tt_up;
-                (*this->m_vec_green_tt_dn)[t-1] = *this->m_green_tt_dn;
                 (*this->m_vec_config_sign)[t-1] = this->m_config_sign;
             }
 
-            model.mult_transB_from_left(tmp_mat_up, t, +1);
-            model.mult_transB_from_left(tmp_mat_dn, t, -1);
+            this->run_spin_lanes( [&]( int lane ) {
+                const int spin = ( lane == 0 )? +1 : -1;
+                GreensFunc& green_tt = ( lane == 0 )? *this->m_green_tt_up : *this->m_green_tt_dn;
+                Matrix& tmp_mat = ( lane == 0 )? tmp_mat_up : tmp_mat_dn;
+
+                if ( is_recording ) {
+                    GreensFuncVec& vec_green_tt = ( lane == 0 )? *this->m_vec_green_tt_up : *this->m_vec_green_tt_dn;
+                    vec_green_tt[t-1] = green_tt;
+                }
+
+                model.mult_transB_from_left(tmp_mat, t, spin);
+            });
+
+            // the greens functions of the last time slice are replaced by the fresh ones at the end of the sweep
+            if ( t != this->m_time_size ) {
+                this->call_eqtime_hook( hook, t-1 );
+            }
 
             this->wrap_from_beta_to_0( model, t );
 
             this->m_current_time_slice--;
         }
+        this->m_wrap_error = std::max(this->m_wrap_error, std::max(lane_wrap_error[0], lane_wrap_error[1]));
 
         // at time slice t = 0
-        this->m_svd_stack_left_up->pop();
-        this->m_svd_stack_left_dn->pop();
-        this->m_svd_stack_right_up->push(tmp_mat_up);
-        this->m_svd_stack_right_dn->push(tmp_mat_dn);
+        this->run_spin_lanes( [&]( int lane ) {
+            GreensFunc& green_tt = ( lane == 0 )? *this->m_green_tt_up : *this->m_green_tt_dn;
+            SvdStack& svd_stack_left = ( lane == 0 )? *this->m_svd_stack_left_up : *this->m_svd_stack_left_dn;
+            SvdStack& svd_stack_right = ( lane == 0 )? *this->m_svd_stack_right_up : *this->m_svd_stack_right_dn;
+            Matrix& tmp_mat = ( lane == 0 )? tmp_mat_up : tmp_mat_dn;
 
-        NumericalStable::compute_equaltime_greens(*this->m_svd_stack_left_up, *this->m_svd_stack_right_up, *this->m_green_tt_up);
-        NumericalStable::compute_equaltime_greens(*this->m_svd_stack_left_dn, *this->m_svd_stack_right_dn, *this->m_green_tt_dn);
+            svd_stack_left.pop();
+            svd_stack_right.push(tmp_mat);
+            NumericalStable::compute_equaltime_greens(svd_stack_left, svd_stack_right, green_tt);
+        });
 
         // end with fresh greens functions
-        if ( this->m_is_equaltime ) {
+        if ( is_recording ) {
             (*this->m_vec_green_tt_up)[this->m_time_size-1] = *this->m_green_tt_up;
-            (*this->m_vec_green_tt_dn)[this->m_time_size-1] = *this->m_green_tt_dn;
+            if ( !this->m_is_spin_symmetric ) {
+                (*this->m_vec_green_tt_dn)[this->m_time_size-1] = *this->m_green_tt_dn;
+            }
         }
+        this->call_eqtime_hook( hook, this->m_time_size-1 );
     }
 
 
@@ -416,112 +758,203 @@ namespace QuantumMonteCarlo {
     /*
      *  Calculate time-displaced (dynamical) greens functions, while the auxiliary fields remain unchanged.
      *  For l = 1,2...,ts , recompute the SvdStacks every 'stabilization_pace' time slices.
-     *  The collected dynamic greens functions are stored in m_vec_green_t0(0t)_up(dn).
+     *  The collected dynamic greens functions are stored in m_vec_green_t0(0t)_up(dn),
+     *  or handed over to the measuring hook slice by slice in the streaming mode.
      *  Note that the equal-time greens functions are also re-calculated 
      *  according to the current auxiliary field configurations, 
      *  which are stored in m_vec_green_tt_up(dn).
+     *  Since the fields are fixed, the two spin sectors are propagated independently at each time slice.
      */
-    void DqmcWalker::sweep_for_dynamic_greens( ModelBase& model )
+    void DqmcWalker::sweep_for_dynamic_greens( ModelBase& model, const DynamicHook& hook )
     {
         if ( this->m_is_dynamic ) {
 
             this->m_current_time_slice++;
-            const int stack_length = ( this->m_time_size % this->m_stabilization_pace == 0 )? 
-                                       this->m_time_size/this->m_stabilization_pace 
-                                     : this->m_time_size/this->m_stabilization_pace + 1 ;
+            const int stack_length = this->svd_stack_length();
             assert( this->m_current_time_slice == 1 );
-            assert( this->m_svd_stack_left_up->empty() && this->m_svd_stack_left_dn->empty() );
-            assert( this->m_svd_stack_right_up->StackLength() == stack_length && 
-                    this->m_svd_stack_right_dn->StackLength() == stack_length );
+            assert( this->m_svd_stack_left_up->empty() );
+            assert( this->m_svd_stack_right_up->StackLength() == stack_length );
+            assert( this->m_is_spin_symmetric || ( this->m_svd_stack_left_dn->empty() && 
+                    this->m_svd_stack_right_dn->StackLength() == stack_length ) );
 
-            // initialize greens functions: at t = 0, gt0 = g00, g0t = g00 - 1
-            *this->m_green_t0_up = *this->m_green_tt_up;
-            *this->m_green_t0_dn = *this->m_green_tt_dn;
-            *this->m_green_0t_up = *this->m_green_tt_up - Matrix::Identity(this->m_space_size, this->m_space_size);
-            *this->m_green_0t_dn = *this->m_green_tt_dn - Matrix::Identity(this->m_space_size, this->m_space_size);
+            // whether to store the greens functions of all time slices
+            const bool is_recording = !this->m_is_dynamic_streaming;
+
+            // wrapping errors collected by the two spin lanes
+            RealScalar lane_wrap_error[2] = { 0.0, 0.0 };
 
             // temporary matrices
             Matrix tmp_mat_up = Matrix::Identity(this->m_space_size, this->m_space_size);
             Matrix tmp_mat_dn = Matrix::Identity(this->m_space_size, this->m_space_size);
 
+            // initialize greens functions: at t = 0, gt0 = g00, g0t = g00 - 1
+            this->run_spin_lanes( [&]( int lane ) {
+                const GreensFunc& green_tt = ( lane == 0 )? *this->m_green_tt_up : *this->m_green_tt_dn;
+                GreensFunc& green_t0 = ( lane == 0 )? *this->m_green_t0_up : *this->m_green_t0_dn;
+                GreensFunc& green_0t = ( lane == 0 )? *this->m_green_0t_up : *this->m_green_0t_dn;
+                green_t0 = green_tt;
+                green_0t = green_tt - Matrix::Identity(this->m_space_size, this->m_space_size);
+            });
+
             // sweep forwards from 0 to beta
             for (auto t = 1; t <= this->m_time_size; ++t) {
-                // wrap the equal time greens functions to current time slice t
-                this->wrap_from_0_to_beta( model, t-1 );
-                (*this->m_vec_green_tt_up)[t-1] = *this->m_green_tt_up;
-                (*this->m_vec_green_tt_dn)[t-1] = *this->m_green_tt_dn;
-            
-                // calculate and record the time-displaced greens functions at different time slices
-                model.mult_B_from_left(*this->m_green_t0_up, t, +1);
-                model.mult_B_from_left(*this->m_green_t0_dn, t, -1);
-                (*this->m_vec_green_t0_up)[t-1] = *this->m_green_t0_up;
-                (*this->m_vec_green_t0_dn)[t-1] = *this->m_green_t0_dn;
+                this->run_spin_lanes( [&]( int lane ) {
+                    const int spin = ( lane == 0 )? +1 : -1;
+                    GreensFunc& green_tt = ( lane == 0 )? *this->m_green_tt_up : *this->m_green_tt_dn;
+                    GreensFunc& green_t0 = ( lane == 0 )? *this->m_green_t0_up : *this->m_green_t0_dn;
+                    GreensFunc& green_0t = ( lane == 0 )? *this->m_green_0t_up : *this->m_green_0t_dn;
+                    SvdStack& svd_stack_left = ( lane == 0 )? *this->m_svd_stack_left_up : *this->m_svd_stack_left_dn;
+                    SvdStack& svd_stack_right = ( lane == 0 )? *this->m_svd_stack_right_up : *this->m_svd_stack_right_dn;
+                    Matrix& tmp_mat = ( lane == 0 )? tmp_mat_up : tmp_mat_dn;
+
+                    // wrap the equal time greens functions to current time slice t
+                    model.mult_B_from_left     ( green_tt, t, spin );
+                    model.mult_invB_from_right ( green_tt, t, spin );
+                
+                    // calculate the time-displaced greens functions at different time slices
+                    model.mult_B_from_left(green_t0, t, spin);
+                    model.mult_invB_from_right(green_0t, t, spin);
+
+                    model.mult_B_from_left(tmp_mat, t, spin);
+
+                    // perform the stabilizations
+                    if ( t % this->m_stabilization_pace == 0 || t == this->m_time_size ) {
+                        // update svd stacks
+                        svd_stack_right.pop();
+                        svd_stack_left.push(tmp_mat);
+
+                        // collect the wrapping errors
+                        Matrix tmp_green_t0 = Matrix::Zero(this->m_space_size, this->m_space_size);
+                        Matrix tmp_green_0t = Matrix::Zero(this->m_space_size, this->m_space_size);
+                        double tmp_wrap_error_t0 = 0.0;
+                        double tmp_wrap_error_0t = 0.0;
+
+                        // compute fresh greens every nwrap steps
+                        // stack_left = B(t-1) * ... * B(0)
+                        // stack_right = B(t)^T * ... * B(ts-1)^T
+                        // equal time green's function are re-evaluated for current field configurations
+                        NumericalStable::compute_equaltime_greens (svd_stack_left, svd_stack_right, green_tt);
+                        NumericalStable::compute_dynamic_greens   (svd_stack_left, svd_stack_right, tmp_green_t0, tmp_green_0t);
+
+                        // compute wrapping errors
+                        NumericalStable::matrix_compare_error(tmp_green_t0, green_t0, tmp_wrap_error_t0);
+                        NumericalStable::matrix_compare_error(tmp_green_0t, green_0t, tmp_wrap_error_0t);
+                        lane_wrap_error[lane] = std::max(lane_wrap_error[lane], std::max(tmp_wrap_error_t0, tmp_wrap_error_0t));
+
+                        green_t0 = tmp_green_t0;
+                        green_0t = tmp_green_0t;
+
+                        tmp_mat = Matrix::Identity(this->m_space_size, this->m_space_size);
+                    }
+
+                    // record the greens functions of time slice t
+                    if ( is_recording ) {
+                        GreensFuncVec& vec_green_tt = ( lane == 0 )? *this->m_vec_green_tt_up : *this->m_vec_green_tt_dn;
+                        GreensFuncVec& vec_green_t0 = ( lane == 0 )? *this->m_vec_green_t0_up : *this->m_vec_green_t0_dn;
+                        GreensFuncVec& vec_green_0t = ( lane == 0 )? *this->m_vec_green_0t_up : *this->m_vec_green_0t_dn;
+                        vec_green_tt[t-1] = green_tt;
+                        vec_green_t0[t-1] = green_t0;
+                        vec_green_0t[t-1] = green_0t;
+                    }
+                });
+
+                // the greens functions of time slice t are settled
+                if ( hook ) {
+                    hook( t-1, *this->m_green_tt_up, *this->green_dn( this->m_green_tt_up, this->m_green_tt_dn ),
+                               *this->m_green_t0_up, *this->green_dn( this->m_green_t0_up, this->m_green_t0_dn ),
+                               *this->m_green_0t_up, *this->green_dn( this->m_green_0t_up, this->m_green_0t_dn ) );
+                }
+            }
+            this->m_wrap_error = std::max(this->m_wrap_error, std::max(lane_wrap_error[0], lane_wrap_error[1]));
+
+            // finally stop at time slice t = ts + 1
+            this->m_current_time_slice += this->m_time_size;
+        }
+    }
+
+    /*
+     *  The fermionic weight of the configurations is read off from the right svd stacks at time slice 0,
+     *  which hold the decompositions of B(beta,0)^T, and det( 1 + B^T ) = det( 1 + B ).
+     */
+    const RealScalar DqmcWalker::LogFermionWeight() const
+    {
+        assert( this->m_current_time_slice == 0 );
+        assert( this->m_svd_stack_left_up->empty() );
+
+        RealScalar lane_log_weight[2] = { 0.0, 0.0 };
+        this->run_spin_lanes( [&]( int lane ) {
+            const SvdStack& svd_stack_right = ( lane == 0 )? *this->m_svd_stack_right_up : *this->m_svd_stack_right_dn;
+            RealScalar sign = 0.0;
+            NumericalStable::compute_log_det_00_bb( svd_stack_right.MatrixU(), svd_stack_right.SingularValues(), 
+                                                    svd_stack_right.MatrixV(), lane_log_weight[lane], sign );
+        });
+
+        // the two sectors contribute equally in the spin-symmetric mode
+        return ( this->m_is_spin_symmetric )? 2 * lane_log_weight[0] : lane_log_weight[0] + lane_log_weight[1];
+    }
 
-                model.mult_invB_from_right(*this->m_green_0t_up, t, +1);
-                model.mult_invB_from_right(*this->m_green_0t_dn, t, -1);
-                (*this->m_vec_green_0t_up)[t-1] = *this->m_green_0t_up;
-                (*this->m_vec_green_0t_dn)[t-1] = *this->m_green_0t_dn;
 
-                model.mult_B_from_left(tmp_mat_up, t, +1);
-                model.mult_B_from_left(tmp_mat_dn, t, -1);
+    void DqmcWalker::refresh_configurations( const LatticeBase& lattice, const ModelBase& model )
+    {
+        assert( this->m_current_time_slice == 0 );
+        assert( this->m_delayed_count == 0 );
 
-                // perform the stabilizations
-                if ( t % this->m_stabilization_pace == 0 || t == this->m_time_size ) {
-                    // update svd stacks
-                    this->m_svd_stack_right_up->pop();
-                    this->m_svd_stack_right_dn->pop();
-                    this->m_svd_stack_left_up->push(tmp_mat_up);
-                    this->m_svd_stack_left_dn->push(tmp_mat_dn);
+        // rebuild the right svd stacks from the current bosonic fields in place, with the left ones left empty
+        this->build_svd_stacks( model );
 
-                    // collect the wrapping errors
-                    Matrix tmp_green_t0_up = Matrix::Zero(this->m_space_size, this->m_space_size);
-                    Matrix tmp_green_t0_dn = Matrix::Zero(this->m_space_size, this->m_space_size);
-                    Matrix tmp_green_0t_up = Matrix::Zero(this->m_space_size, this->m_space_size);
-                    Matrix tmp_green_0t_dn = Matrix::Zero(this->m_space_size, this->m_space_size);
-                    double tmp_wrap_error_t0_up = 0.0;
-                    double tmp_wrap_error_t0_dn = 0.0;
-                    double tmp_wrap_error_0t_up = 0.0;
-                    double tmp_wrap_error_0t_dn = 0.0;
-
-                    // compute fresh greens every nwrap steps
-                    // stack_left = B(t-1) * ... * B(0)
-                    // stack_right = B(t)^T * ... * B(ts-1)^T
-                    // equal time green's function are re-evaluated for current field configurations
-                    NumericalStable::compute_equaltime_greens (*this->m_svd_stack_left_up, *this->m_svd_stack_right_up, *this->m_green_tt_up);
-                    NumericalStable::compute_equaltime_greens (*this->m_svd_stack_left_dn, *this->m_svd_stack_right_dn, *this->m_green_tt_dn);
-                    NumericalStable::compute_dynamic_greens   (*this->m_svd_stack_left_up, *this->m_svd_stack_right_up, tmp_green_t0_up, tmp_green_0t_up);
-                    NumericalStable::compute_dynamic_greens   (*this->m_svd_stack_left_dn, *this->m_svd_stack_right_dn, tmp_green_t0_dn, tmp_green_0t_dn);
+        // fresh greens functions and sign at time slice t = 0, without reallocations
+        this->run_spin_lanes( [&]( int lane ) {
+            if ( lane == 0 ) {
+                NumericalStable::compute_equaltime_greens( *this->m_svd_stack_left_up, *this->m_svd_stack_right_up, *this->m_green_tt_up );
+            }
+            else {
+                NumericalStable::compute_equaltime_greens( *this->m_svd_stack_left_dn, *this->m_svd_stack_right_dn, *this->m_green_tt_dn );
+            }
+        });
+        this->m_config_sign = ( this->GreenttUp().determinant() * this->GreenttDn().determinant() >= 0 )? +1.0 : -1.0;
+    }
 
-                    // compute wrapping errors
-                    NumericalStable::matrix_compare_error(tmp_green_t0_up, *this->m_green_t0_up, tmp_wrap_error_t0_up);
-                    NumericalStable::matrix_compare_error(tmp_green_t0_dn, *this->m_green_t0_dn, tmp_wrap_error_t0_dn);
-                    this->m_wrap_error = std::max(this->m_wrap_error, std::max(tmp_wrap_error_t0_up, tmp_wrap_error_t0_dn));
-
-                    NumericalStable::matrix_compare_error(tmp_green_0t_up, *this->m_green_0t_up, tmp_wrap_error_0t_up);
-                    NumericalStable::matrix_compare_error(tmp_green_0t_dn, *this->m_green_0t_dn, tmp_wrap_error_0t_dn);
-                    this->m_wrap_error = std::max(this->m_wrap_error, std::max(tmp_wrap_error_0t_up, tmp_wrap_error_0t_dn));
-
-                    *this->m_green_t0_up = tmp_green_t0_up;
-                    *this->m_green_t0_dn = tmp_green_t0_dn;
-                    *this->m_green_0t_up = tmp_green_0t_up;
-                    *this->m_green_0t_dn = tmp_green_0t_dn;
-
-                    (*this->m_vec_green_tt_up)[t-1] = *this->m_green_tt_up;
-                    (*this->m_vec_green_tt_dn)[t-1] = *this->m_green_tt_dn;
-                    (*this->m_vec_green_t0_up)[t-1] = *this->m_green_t0_up;
-                    (*this->m_vec_green_t0_dn)[t-1] = *this->m_green_t0_dn;
-                    (*this->m_vec_green_0t_up)[t-1] = *this->m_green_0t_up;
-                    (*this->m_vec_green_0t_dn)[t-1] = *this->m_green_0t_dn;
-
-                    tmp_mat_up = Matrix::Identity(this->m_space_size, this->m_space_size);
-                    tmp_mat_dn = Matrix::Identity(this->m_space_size, this->m_space_size);
-                }
 
-                // finally stop at time slice t = ts + 1
-                this->m_current_time_slice++;
+    void DqmcWalker::save_configurations()
+    {
+        assert( this->m_current_time_slice == 0 );
+        assert( this->m_delayed_count == 0 );
+
+        // the spare storage is allocated at the first call, with the same shapes as the current one,
+        // and afterwards the two sets are only swapped, which costs O(1).
+        // the left svd stacks are empty at time slice 0 and need not be saved.
+        if ( !this->m_saved_svd_stack_right_up ) {
+            this->m_saved_svd_stack_right_up = std::make_unique<SvdStack>(this->m_space_size, this->svd_stack_length(), this->m_stack_decomposition);
+            this->m_saved_green_tt_up.resize(this->m_space_size, this->m_space_size);
+            if ( !this->m_is_spin_symmetric ) {
+                this->m_saved_svd_stack_right_dn = std::make_unique<SvdStack>(this->m_space_size, this->svd_stack_length(), this->m_stack_decomposition);
+                this->m_saved_green_tt_dn.resize(this->m_space_size, this->m_space_size);
             }
         }
+
+        std::swap( this->m_svd_stack_right_up, this->m_saved_svd_stack_right_up );
+        this->m_green_tt_up->swap( this->m_saved_green_tt_up );
+        if ( !this->m_is_spin_symmetric ) {
+            std::swap( this->m_svd_stack_right_dn, this->m_saved_svd_stack_right_dn );
+            this->m_green_tt_dn->swap( this->m_saved_green_tt_dn );
+        }
+        this->m_saved_config_sign = this->m_config_sign;
+    }
+
+
+    void DqmcWalker::restore_configurations()
+    {
+        assert( this->m_current_time_slice == 0 );
+        assert( this->m_saved_svd_stack_right_up );
+
+        std::swap( this->m_svd_stack_right_up, this->m_saved_svd_stack_right_up );
+        this->m_green_tt_up->swap( this->m_saved_green_tt_up );
+        if ( !this->m_is_spin_symmetric ) {
+            std::swap( this->m_svd_stack_right_dn, this->m_saved_svd_stack_right_dn );
+            this->m_green_tt_dn->swap( this->m_saved_green_tt_dn );
+        }
+        this->m_config_sign = this->m_saved_config_sign;
     }
 
 
-} // namespace QuantumMonteCarlo
\ No newline at end of file
+} // namespace QuantumMonteCarlo
@@ -4,6 +4,8 @@ namespace Utils {
 
     namespace FFTSolver {
 
+        // ---------------------------------- Utils::FFTSolver::FFTSolver2d ---------------------------------------
+
         void FFTSolver2d::set_up_dimension(int row, int col) {
             this->m_row = row;
             this->m_col = col;
@@ -13,14 +15,17 @@ namespace Utils {
             // allocate for intermediate variable
             if (this->m_dft_data) { this->m_dft_data.reset(); }
             this->m_dft_data = std::make_unique<std::complex<double>[]>(this->m_row*this->m_col);
-                    
-            // create and commit fft descriptor                
-            MKL_LONG dim_sizes[2] = {this->m_row, this->m_col};
+
+            // create and commit fft descriptor
+            // mkl assumes the row-major layout of multi-dimensional data,
+            // hence the dimensions of the column-major eigen matrix are passed in the reversed order.
+            if (this->m_desc_handle) { DftiFreeDescriptor(&this->m_desc_handle); }
+            MKL_LONG dim_sizes[2] = {this->m_col, this->m_row};
             DftiCreateDescriptor(&this->m_desc_handle, DFTI_DOUBLE, DFTI_COMPLEX, 2, dim_sizes);
             DftiCommitDescriptor(this->m_desc_handle);
         }
 
-        void FFTSolver2d::compute(const Eigen::MatrixXd& in, Eigen::MatrixXd& out) {
+        void FFTSolver2d::compute(const Eigen::Ref<const Eigen::MatrixXd>& in, Eigen::MatrixXd& out) {
             // TODO: accelerate by using r2c fft
             // the input matrix should be real
             assert( in.rows() == this->m_row );
@@ -33,16 +38,59 @@ namespace Utils {
             DftiComputeForward(this->m_desc_handle, &this->m_dft_data[0]);
 
             // map transformed data to eigen matrix
-            // output only the real part of the complex results 
+            // output only the real part of the complex results
             out = Eigen::Map<Eigen::MatrixXcd>(&this->m_dft_data[0], this->m_row, this->m_col).real();
         }
 
         void FFTSolver2d::deallocate() {
             // deallocate memory
             if (this->m_dft_data) { this->m_dft_data.reset(); }
-            DftiFreeDescriptor(&m_desc_handle);
+            if (this->m_desc_handle) { DftiFreeDescriptor(&this->m_desc_handle); }
+        }
+
+
+        // ---------------------------------- Utils::FFTSolver::FFTSolver3d ---------------------------------------
+
+        void FFTSolver3d::set_up_dimension(int dim_x, int dim_y, int dim_z) {
+            this->m_dim_x = dim_x;
+            this->m_dim_y = dim_y;
+            this->m_dim_z = dim_z;
+        }
+
+        void FFTSolver3d::initial() {
+            // allocate for intermediate variable
+            if (this->m_dft_data) { this->m_dft_data.reset(); }
+            this->m_dft_data = std::make_unique<std::complex<double>[]>(this->m_dim_x*this->m_dim_y*this->m_dim_z);
+
+            // create and commit fft descriptor
+            // the x axis runs fastest in memory, which is the last dimension in the row-major convention of mkl.
+            if (this->m_desc_handle) { DftiFreeDescriptor(&this->m_desc_handle); }
+            MKL_LONG dim_sizes[3] = {this->m_dim_z, this->m_dim_y, this->m_dim_x};
+            DftiCreateDescriptor(&this->m_desc_handle, DFTI_DOUBLE, DFTI_COMPLEX, 3, dim_sizes);
+            DftiCommitDescriptor(this->m_desc_handle);
+        }
+
+        void FFTSolver3d::compute(const Eigen::VectorXd& in, Eigen::VectorXd& out) {
+            // the input vector should be real
+            const int size = this->m_dim_x * this->m_dim_y * this->m_dim_z;
+            assert( in.size() == size );
+
+            // map input eigen vector to c-style array
+            Eigen::Map<Eigen::VectorXcd>(&this->m_dft_data[0], size) = in;
+
+            // in-place fft
+            DftiComputeForward(this->m_desc_handle, &this->m_dft_data[0]);
+
+            // output only the real part of the complex results
+            out = Eigen::Map<Eigen::VectorXcd>(&this->m_dft_data[0], size).real();
+        }
+
+        void FFTSolver3d::deallocate() {
+            // deallocate memory
+            if (this->m_dft_data) { this->m_dft_data.reset(); }
+            if (this->m_desc_handle) { DftiFreeDescriptor(&this->m_desc_handle); }
         }
 
     } // namespace FFTSolver
 
-} // namespace Utils
\ No newline at end of file
+} // namespace Utils
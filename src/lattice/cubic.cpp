@@ -202,7 +202,7 @@ namespace Lattice {
 
     void Cubic::initial_hopping_matrix()
     {
-        this->m_hopping_matrix.resize(this->m_space_size, this->m_space_size);
+        this->m_hopping_matrix.setZero(this->m_space_size, this->m_space_size);
         for (auto index = 0; index < this->m_space_size; ++index) {
             // direction 0 for x+1, 1 for y+1 and 2 for z+1
             const int index_xplus1 = this->NearestNeighbour(index, 0);
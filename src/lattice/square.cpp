@@ -163,7 +163,7 @@ namespace Lattice {
 
     void Square::initial_hopping_matrix()
     {
-        this->m_hopping_matrix.resize(this->m_space_size, this->m_space_size);
+        this->m_hopping_matrix.setZero(this->m_space_size, this->m_space_size);
         for (auto index = 0; index < this->m_space_size; ++index) {
             // direction 0 for x+1 and 1 for y+1 
             const int index_xplus1 = this->NearestNeighbour(index, 0);
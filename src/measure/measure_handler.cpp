@@ -1,6 +1,8 @@
 #include "measure/measure_handler.h"
 #include "model/model_base.h"
 #include "lattice/lattice_base.h"
+#include "lattice/square.h"
+#include "lattice/cubic.h"
 #include "dqmc_walker.h"
 
 
@@ -9,6 +11,13 @@ namespace Measure {
     const bool MeasureHandler::isWarmUp() const { return this->m_is_warmup; }
     const bool MeasureHandler::isEqualTime() const { return this->m_is_equaltime; }
     const bool MeasureHandler::isDynamic() const { return this->m_is_dynamic; }
+    const bool MeasureHandler::isEqualTimeStreaming() const { return this->m_is_streaming && this->m_is_equaltime; }
+    const bool MeasureHandler::isDynamicStreaming() const { return this->m_is_streaming && this->m_is_dynamic; }
+    const bool MeasureHandler::isStreaming() const { return this->m_is_streaming; }
+    const bool MeasureHandler::isDynamicScheduling() const { return this->m_is_dynamic_scheduling; }
+    const bool MeasureHandler::isOutputBins() const { return this->m_is_output_bins; }
+    const bool MeasureHandler::isBinaryBins() const { return this->m_is_binary_bins; }
+    const ObsList& MeasureHandler::ObservableList() const { return this->m_obs_list; }
 
     const int MeasureHandler::WarmUpSweeps() const { return this->m_sweeps_warmup; }
     const int MeasureHandler::SweepsBetweenBins() const { return this->m_sweeps_between_bins; }
@@ -23,6 +32,21 @@ namespace Measure {
         return this->m_momentum_list[i]; 
     }
 
+    const bool MeasureHandler::isFFTEnabled() const { return this->m_is_fft_enabled; }
+
+    const EqtimeCorrelations& MeasureHandler::EqtimeCorr( const int t ) const
+    {
+        assert( this->m_is_equaltime );
+        assert( t >= 0 && t < (int)this->m_eqtime_corr.size() );
+        return this->m_eqtime_corr[t];
+    }
+
+    const DynamicCorrelations& MeasureHandler::DynamicCorr() const
+    {
+        assert( this->m_is_dynamic );
+        return this->m_dynamic_corr;
+    }
+
 
     void MeasureHandler::set_measure_params( int sweeps_warmup, int bin_num, int bin_size, int sweeps_between_bins )
     {
@@ -43,6 +67,30 @@ namespace Measure {
     }
 
 
+    void MeasureHandler::set_streaming( bool is_streaming )
+    {
+        this->m_is_streaming = is_streaming;
+    }
+
+
+    void MeasureHandler::set_dynamic_scheduling( bool is_dynamic_scheduling )
+    {
+        this->m_is_dynamic_scheduling = is_dynamic_scheduling;
+    }
+
+
+    void MeasureHandler::set_output_bins( bool is_output_bins )
+    {
+        this->m_is_output_bins = is_output_bins;
+    }
+
+
+    void MeasureHandler::set_binary_bins( bool is_binary_bins )
+    {
+        this->m_is_binary_bins = is_binary_bins;
+    }
+
+
     void MeasureHandler::set_measured_momentum( const MomentumIndex& momentum_index )
     {
         this->m_momentum = momentum_index;
@@ -61,6 +109,7 @@ namespace Measure {
         Observable::ObservableHandler::initial(this->m_obs_list);
 
         this->m_is_warmup = (this->m_sweeps_warmup != 0);
+        this->m_time_size = walker.TimeSize();
         this->m_is_equaltime = (   !this->m_eqtime_scalar_obs.empty() 
                                 || !this->m_eqtime_vector_obs.empty() 
                                 || !this->m_eqtime_matrix_obs.empty()  );
@@ -68,49 +117,69 @@ namespace Measure {
                                 || !this->m_dynamic_vector_obs.empty() 
                                 || !this->m_dynamic_matrix_obs.empty() );
 
-        // set up parameters for the observables
+        // set up parameters for the observables,
+        // whose bins are allocated on demand in the dynamic scheduling of bins
+        const int allocated_bins = ( this->m_is_dynamic_scheduling )? 0 : this->m_bin_num;
+
         // for equal-time observables
         if ( this->m_is_equaltime ) {
             // allocate for equal-time sign measurements
             this->m_equaltime_sign->set_zero_element(0.0);
-            this->m_equaltime_sign->set_number_of_bins(this->m_bin_num);
+            this->m_equaltime_sign->set_number_of_bins(allocated_bins);
             this->m_equaltime_sign->allocate();
 
             for (auto& scalar_obs : this->m_eqtime_scalar_obs) {
                 scalar_obs->set_zero_element(0.0);
-                scalar_obs->set_number_of_bins(this->m_bin_num);
+                scalar_obs->set_number_of_bins(allocated_bins);
                 scalar_obs->allocate();
             }
             for (auto& vector_obs : this->m_eqtime_vector_obs) {
                 // note that the dimensions of the observable should be adjusted or specialized here
                 vector_obs->set_zero_element(Vector::Zero(walker.TimeSize()));
-                vector_obs->set_number_of_bins(this->m_bin_num);
+                vector_obs->set_number_of_bins(allocated_bins);
                 vector_obs->allocate();
             }
             for (auto& matrix_obs : this->m_eqtime_matrix_obs) {
                 // specialize dimensions for certain observables if needed 
                 matrix_obs->set_zero_element(Matrix::Zero(lattice.SpaceSize(), lattice.SpaceSize()));
-                matrix_obs->set_number_of_bins(this->m_bin_num);
+                matrix_obs->set_number_of_bins(allocated_bins);
                 matrix_obs->allocate();
             }
+
+            // allocate for the equal-time quantities shared by the observables,
+            // and the pair correlations are allocated only if required
+            this->m_is_eqtime_pair_corr = (   this->find("momentum_distribution") 
+                                           || this->find("spin_density_structure_factor") 
+                                           || this->find("charge_density_structure_factor")
+                                           || this->find("s_wave_pairing_corr") );
+            this->m_eqtime_corr.resize(walker.TimeSize());
+            if ( this->m_is_eqtime_pair_corr ) {
+                for (auto& corr : this->m_eqtime_corr) {
+                    corr.greens_r.setZero(lattice.SpaceSize());
+                    corr.spin_corr_r.setZero(lattice.SpaceSize());
+                    corr.charge_corr_r.setZero(lattice.SpaceSize());
+                }
+            }
+            this->m_guc_diag.setZero(lattice.SpaceSize());
+            this->m_gdc_diag.setZero(lattice.SpaceSize());
         }
 
         // for dynamic observables
         if ( this->m_is_dynamic ) {
             // allocate for dynamic sign measurements
             this->m_dynamic_sign->set_zero_element(0.0);
-            this->m_dynamic_sign->set_number_of_bins(this->m_bin_num);
+            this->m_dynamic_sign->set_number_of_bins(allocated_bins);
             this->m_dynamic_sign->allocate();
 
             for (auto& scalar_obs : this->m_dynamic_scalar_obs) {
                 scalar_obs->set_zero_element(0.0);
-                scalar_obs->set_number_of_bins(this->m_bin_num);
+                scalar_obs->set_number_of_bins(allocated_bins);
                 scalar_obs->allocate();
             }
             for (auto& vector_obs : this->m_dynamic_vector_obs) {
                 // specialize dimensions for certain observables if needed 
                 vector_obs->set_zero_element(Vector::Zero(walker.TimeSize()));
-                vector_obs->set_number_of_bins(this->m_bin_num);
+                vector_obs->set_number_of_bins(allocated_bins);
                 vector_obs->allocate();
             }
             for (auto& matrix_obs : this->m_dynamic_matrix_obs) {
@@ -119,24 +188,333 @@ namespace Measure {
                     // for greens function measure, the rows represent different lattice momentum 
                     // and the columns represent imaginary-time grids. 
                     matrix_obs->set_zero_element(Matrix::Zero(this->m_momentum_list.size(), walker.TimeSize()));
-                    matrix_obs->set_number_of_bins(this->m_bin_num);
+                    matrix_obs->set_number_of_bins(allocated_bins);
                     matrix_obs->allocate();
+
+                    // the momentum-space greens functions are computed using fft if possible
+                    this->initial_fft_solver(lattice);
                 }
                 else {
                     // otherwise initialize by default
                     matrix_obs->set_zero_element(Matrix::Zero(lattice.SpaceSize(), lattice.SpaceSize()));
-                    matrix_obs->set_number_of_bins(this->m_bin_num);
+                    matrix_obs->set_number_of_bins(allocated_bins);
                     matrix_obs->allocate();
                 }
             }
+
+            // allocate for the dynamic quantities shared by the observables, only if required
+            this->m_is_dynamic_greens = ( this->find("greens_functions") || this->find("density_of_states") );
+            this->m_is_dynamic_current = this->find("superfluid_stiffness");
+            this->m_is_dynamic_spin = this->find("dynamic_spin_susceptibility");
+            if ( this->m_is_dynamic_greens ) {
+                this->m_dynamic_corr.greens_kt.setZero(this->m_momentum_list.size(), walker.TimeSize());
+                this->m_dynamic_corr.local_greens_t.setZero(walker.TimeSize());
+                this->m_greens_r.setZero(lattice.SpaceSize());
+                this->m_greens_k.setZero(this->m_momentum_list.size());
+            }
+            if ( this->m_is_dynamic_current ) {
+                // the minimal momenta kx = ( 2pi/L, 0 ) and ky = ( 0, 2pi/L ) are equivalent,
+                // and only the fourier factors of kx, whose momentum index is 1, are tabulated in the lattice module.
+                // hence we replace ky * r = kx * ry -> (kx,0) * (ry,0), with the site (ry,0) labeled by index ry,
+                // which keeps the fourier factors invariant.
+                // it should be noted that this replacement is only valid when the lattice has a even side length,
+                // otherwise the kx and ky will become the same momentum point due to the finite size effect.
+                this->m_current_factor_r.setZero(lattice.SpaceSize());
+                for (auto r = 0; r < lattice.SpaceSize(); ++r) {
+                    this->m_current_factor_r(r) = lattice.FourierFactor(lattice.Index2Site(r, 0), 1) 
+                                                - lattice.FourierFactor(lattice.Index2Site(r, 1), 1);
+                }
+                this->m_current_sum.setZero(lattice.SpaceSize());
+            }
+            if ( this->m_is_dynamic_spin ) {
+                this->m_dynamic_corr.local_spin_corr_t.setZero(walker.TimeSize());
+                this->m_magnetization_t.setZero(lattice.SpaceSize(), walker.TimeSize());
+            }
         }
     }
 
 
+    void MeasureHandler::initial_fft_solver( const LatticeBase& lattice )
+    {
+        this->m_is_fft_enabled = false;
+        this->m_fft_solver_2d.reset();
+        this->m_fft_solver_3d.reset();
+        this->m_fft_grid_index.clear();
+        this->m_fft_out.resize(0, 0);
+        this->m_fft_data.resize(0);
+
+        const bool is_square = ( dynamic_cast<const Lattice::Square*>(&lattice) != nullptr );
+        const bool is_cubic  = ( dynamic_cast<const Lattice::Cubic*>(&lattice) != nullptr );
+        if ( !is_square && !is_cubic ) { return; }
+
+        // the fft grids are k = 2pi/L * n with n = 0,1,...,L-1 along each axis,
+        // and the measured momenta which are not on the grids ( e.g. for odd side length )
+        // can not be obtained by fft.
+        const int side_length = lattice.SideLength();
+        this->m_fft_grid_index.reserve(this->m_momentum_list.size());
+        for (const auto& momentum_index : this->m_momentum_list) {
+            int grid_index = 0;
+            int stride = 1;
+            for (auto axis = 0; axis < lattice.SpaceDim(); ++axis) {
+                const double n = lattice.Index2Momentum(momentum_index, axis) * side_length / ( 2*M_PI );
+                if ( std::abs( n - std::round(n) ) > 1e-8 ) { this->m_fft_grid_index.clear(); return; }
+                grid_index += ( ( (int)std::round(n) % side_length + side_length ) % side_length ) * stride;
+                stride *= side_length;
+            }
+            this->m_fft_grid_index.emplace_back(grid_index);
+        }
+
+        if ( is_square ) {
+            this->m_fft_solver_2d = std::make_unique<Utils::FFTSolver::FFTSolver2d>();
+            this->m_fft_solver_2d->set_up_dimension(side_length, side_length);
+            this->m_fft_solver_2d->initial();
+            this->m_fft_out.resize(side_length, side_length);
+        }
+        else {
+            this->m_fft_solver_3d = std::make_unique<Utils::FFTSolver::FFTSolver3d>();
+            this->m_fft_solver_3d->set_up_dimension(side_length, side_length, side_length);
+            this->m_fft_solver_3d->initial();
+            this->m_fft_data.resize(side_length * side_length * side_length);
+        }
+        this->m_is_fft_enabled = true;
+    }
+
+
+    void MeasureHandler::fourier_transform( const Vector& data_r, Vector& data_k, const LatticeBase& lattice ) const
+    {
+        assert( data_r.size() == lattice.SpaceSize() );
+        data_k.resize(this->m_momentum_list.size());
+
+        if ( this->m_is_fft_enabled ) {
+            // the displacement index dx + L * dy ( + L^2 * dz ) coincides with the layout of fft solvers,
+            // and the real part of the forward transformation gives \sum r cos( k*r ) * f(r).
+            // notice that the solvers and the output buffers only hold the intermediate data,
+            // leaving the handler logically unchanged.
+            const double* data_fft = nullptr;
+            if ( this->m_fft_solver_2d ) {
+                const int side_length = lattice.SideLength();
+                this->m_fft_solver_2d->compute(Eigen::Map<const Matrix>(data_r.data(), side_length, side_length), this->m_fft_out);
+                data_fft = this->m_fft_out.data();
+            }
+            else {
+                this->m_fft_solver_3d->compute(data_r, this->m_fft_data);
+                data_fft = this->m_fft_data.data();
+            }
+            for (auto k = 0; k < (int)this->m_momentum_list.size(); ++k) {
+                data_k(k) = data_fft[this->m_fft_grid_index[k]];
+            }
+        }
+        else {
+            // direct summation over the displacements
+            for (auto k = 0; k < (int)this->m_momentum_list.size(); ++k) {
+                data_k(k) = 0.0;
+                for (auto r = 0; r < lattice.SpaceSize(); ++r) {
+                    data_k(k) += lattice.FourierFactor(r, this->m_momentum_list[k]) * data_r(r);
+                }
+            }
+        }
+    }
+
+
+    void MeasureHandler::compute_eqtime_correlations( int t, const Matrix& gu, const Matrix& gd, const LatticeBase& lattice )
+    {
+        // size of the square tiles of the greens functions, within which g(i,j) and g(j,i) stay in cache
+        constexpr int tile_size = 32;
+        const int space_size = lattice.SpaceSize();
+        assert( t >= 0 && t < (int)this->m_eqtime_corr.size() );
+
+        //  g(i,j) = < c_i * c^+_j > are the greens functions
+        // gc(i,j) = < c^+_i * c_j > = delta_ij - g(j,i)
+        auto& corr = this->m_eqtime_corr[t];
+
+        // local quantities
+        this->m_guc_diag = Vector::Ones(space_size) - gu.diagonal();
+        this->m_gdc_diag = Vector::Ones(space_size) - gd.diagonal();
+        corr.filling = ( this->m_guc_diag.sum() + this->m_gdc_diag.sum() ) / space_size;
+        corr.double_occupancy = this->m_guc_diag.dot(this->m_gdc_diag) / space_size;
+        corr.local_spin_corr = ( gu.diagonal().sum() + gd.diagonal().sum()
+                               - 2 * gu.diagonal().dot(gd.diagonal()) ) / space_size;
+
+        RealScalar nn_hopping = 0.0;
+        for (auto i = 0; i < space_size; ++i) {
+            // todo: the independent directions should equal to the coordination number of the lattice
+            for (auto dir = 0; dir < lattice.SpaceDim(); ++dir) {
+                nn_hopping += gu(i, lattice.NearestNeighbour(i, dir)) + gd(i, lattice.NearestNeighbour(i, dir));
+            }
+        }
+        corr.nn_hopping = nn_hopping / space_size;
+
+        if ( !this->m_is_eqtime_pair_corr ) { return; }
+
+        // pair correlations, where the contributions of the pairs (i,j) are gathered by the displacement r = rj - ri.
+        // both g(i,j) and g(j,i) are involved, and the pairs are visited tile by tile to keep them in cache.
+        corr.greens_r.setZero();
+        corr.spin_corr_r.setZero();
+        corr.charge_corr_r.setZero();
+        RealScalar s_wave_pairing = 0.0;
+
+        for (auto i0 = 0; i0 < space_size; i0 += tile_size) {
+            const int i1 = std::min(i0 + tile_size, space_size);
+            for (auto j0 = 0; j0 < space_size; j0 += tile_size) {
+                const int j1 = std::min(j0 + tile_size, space_size);
+                for (auto i = i0; i < i1; ++i) {
+                    const RealScalar guc_ii = this->m_guc_diag(i);
+                    const RealScalar gdc_ii = this->m_gdc_diag(i);
+                    for (auto j = j0; j < j1; ++j) {
+                        const int r = lattice.Displacement(i,j);
+                        const RealScalar guc_jj = this->m_guc_diag(j);
+                        const RealScalar gdc_jj = this->m_gdc_diag(j);
+                        const RealScalar guc_ij = (RealScalar)( i == j ) - gu(j,i);
+                        const RealScalar gdc_ij = (RealScalar)( i == j ) - gd(j,i);
+
+                        // Wick decompositions of < n_s(i) n_s'(j) > for equal ( s = s' ) and opposite spins
+                        const RealScalar equal_spin = guc_ii * guc_jj + guc_ij * gu(i,j) + gdc_ii * gdc_jj + gdc_ij * gd(i,j);
+                        const RealScalar opposite_spin = gdc_ii * guc_jj + guc_ii * gdc_jj;
+
+                        corr.greens_r(r) += gu(j,i) + gd(j,i);
+                        corr.spin_corr_r(r) += equal_spin - opposite_spin;
+                        corr.charge_corr_r(r) += equal_spin + opposite_spin;
+                        s_wave_pairing += guc_ij * gdc_ij;
+                    }
+                }
+            }
+        }
+        corr.greens_r /= space_size;
+        corr.spin_corr_r /= space_size;
+        corr.charge_corr_r /= space_size;
+        corr.s_wave_pairing = s_wave_pairing / space_size;
+    }
+
+
+    void MeasureHandler::stream_equaltime_slice( int t, 
+                                                 const Matrix& green_tt_up, 
+                                                 const Matrix& green_tt_dn, 
+                                                 const LatticeBase& lattice )
+    {
+        assert( this->m_is_streaming );
+        this->compute_eqtime_correlations(t, green_tt_up, green_tt_dn, lattice);
+    }
+
+
+    void MeasureHandler::compute_dynamic_correlations( int t, const Matrix& gttu, const Matrix& gttd,
+                                                              const Matrix& gt0u, const Matrix& gt0d,
+                                                              const Matrix& g0tu, const Matrix& g0td,
+                                                              const LatticeBase& lattice )
+    {
+        const int space_size = lattice.SpaceSize();
+        const int time_size = this->m_time_size;
+        assert( t >= 0 && t < time_size );
+
+        // the time slice t = 0,1,...,L-1 contributes to the imaginary time tau = t+1,
+        // and the last time slice with tau = beta is regarded as tau = 0, with G(beta,beta) = G(0,0).
+        const int tau = ( t+1 ) % time_size;
+        const bool is_last_slice = ( t == time_size-1 );
+        auto& corr = this->m_dynamic_corr;
+
+        // start a new dynamic sweep
+        if ( t == 0 ) {
+            corr.current_corr = 0.0;
+            this->m_current_sum.setZero();
+        }
+
+        if ( this->m_is_dynamic_greens ) {
+            // the factor 1/2 comes from two degenerate spin states ( spin averaged, which is model dependent ).
+            // at tau = 0 the equal-time greens functions are used, with the same convention as the stored mode.
+            const Matrix& gu = ( is_last_slice )? gttu : gt0u;
+            const Matrix& gd = ( is_last_slice )? gttd : gt0d;
+
+            // reduce to the translation-averaged greens function G(r) = 1/N \sum i ( c_{i+r}(t) * c^+_i(0) ) first,
+            // and then transform to the momentum space, G(k,t) = \sum r exp( -i k*r ) * G(r),
+            // which costs O(N^2) + O(NlogN) ( or O(N*K) without fft ) instead of O(N^2*K).
+            this->m_greens_r.setZero();
+            RealScalar trace = 0.0;
+            for (auto i = 0; i < space_size; ++i) {
+                for (auto j = 0; j < space_size; ++j) {
+                    this->m_greens_r(lattice.Displacement(i,j)) += 0.5 * ( gu(j,i) + gd(j,i) );
+                }
+                trace += 0.5 * ( gu(i,i) + gd(i,i) );
+            }
+            this->m_greens_r /= space_size;
+
+            this->fourier_transform(this->m_greens_r, this->m_greens_k, lattice);
+            corr.greens_kt.col(tau) = this->m_greens_k;
+            corr.local_greens_t(tau) = trace / space_size;
+        }
+
+        if ( this->m_is_dynamic_current ) {
+            // correlated part of the current-current correlations, 
+            // where ipx and jpx are the nearest neighbours of site i and j along the positive direction of axis x
+            RealScalar current_corr = 0.0;
+            for (auto i = 0; i < space_size; ++i) {
+                const auto ipx = lattice.NearestNeighbour(i, 0);
+                for (auto j = 0; j < space_size; ++j) {
+                    const auto jpx = lattice.NearestNeighbour(j, 0);
+                    current_corr += this->m_current_factor_r(lattice.Displacement(i,j)) * (
+                            - g0tu(ipx,jpx) * gt0u(j,i) - g0td(ipx,jpx) * gt0d(j,i)
+                            + g0tu(i,jpx) * gt0u(j,ipx) + g0td(i,jpx) * gt0d(j,ipx)
+                            + g0tu(ipx,j) * gt0u(jpx,i) + g0td(ipx,j) * gt0d(jpx,i)
+                            - g0tu(i,j) * gt0u(jpx,ipx) - g0td(i,j) * gt0d(jpx,ipx) );
+                }
+            }
+            corr.current_corr += current_corr;
+
+            // the uncorrelated part factorizes into < jx(j,t) > * < jx(i,0) >,
+            // so that only the currents summed over t are kept until G(0,0) is available
+            for (auto j = 0; j < space_size; ++j) {
+                const auto jpx = lattice.NearestNeighbour(j, 0);
+                this->m_current_sum(j) += gttu(j,jpx) - gttu(jpx,j) + gttd(j,jpx) - gttd(jpx,j);
+            }
+
+            if ( is_last_slice ) {
+                RealScalar uncorrelated = 0.0;
+                for (auto i = 0; i < space_size; ++i) {
+                    const auto ipx = lattice.NearestNeighbour(i, 0);
+                    const RealScalar current_i = gttu(i,ipx) - gttu(ipx,i) + gttd(i,ipx) - gttd(ipx,i);
+                    for (auto j = 0; j < space_size; ++j) {
+                        uncorrelated += this->m_current_factor_r(lattice.Displacement(i,j)) * this->m_current_sum(j) * current_i;
+                    }
+                }
+                corr.current_corr -= uncorrelated;
+            }
+        }
+
+        if ( this->m_is_dynamic_spin ) {
+            // correlated part - \sum s G_s(i,i;0,t) * G_s(i,i;t,0), and the local magnetization 
+            // < ( n_up - n_dn )(i,t) > = ( 1 - G_up(i,i;t,t) ) - ( 1 - G_dn(i,i;t,t) ) for the uncorrelated part
+            corr.local_spin_corr_t(tau) = - ( g0tu.diagonal().dot(gt0u.diagonal()) 
+                                            + g0td.diagonal().dot(gt0d.diagonal()) ) / space_size;
+            this->m_magnetization_t.col(tau) = gttd.diagonal() - gttu.diagonal();
+
+            if ( is_last_slice ) {
+                corr.local_spin_corr_t += this->m_magnetization_t.transpose() * this->m_magnetization_t.col(0) / space_size;
+            }
+        }
+    }
+
+
+    void MeasureHandler::stream_dynamic_slice( int t, const Matrix& green_tt_up, const Matrix& green_tt_dn,
+                                                      const Matrix& green_t0_up, const Matrix& green_t0_dn,
+                                                      const Matrix& green_0t_up, const Matrix& green_0t_dn,
+                                                      const LatticeBase& lattice )
+    {
+        assert( this->m_is_streaming );
+        this->compute_dynamic_correlations(t, green_tt_up, green_tt_dn, green_t0_up, green_t0_dn, 
+                                              green_0t_up, green_0t_dn, lattice);
+    }
+
+
     void MeasureHandler::equaltime_measure( const DqmcWalker& walker, 
                                             const ModelBase& model, 
                                             const LatticeBase& lattice )
     {
+        // prepare the shared quantities before measuring the observables,
+        // which have been collected during the sweep in the streaming mode
+        if ( !this->m_is_streaming ) {
+            for (auto t = 0; t < walker.TimeSize(); ++t) {
+                this->compute_eqtime_correlations(t, walker.GreenttUp(t), walker.GreenttDn(t), lattice);
+            }
+        }
+
         for (auto& scalar_obs : this->m_eqtime_scalar_obs) {
             scalar_obs->measure(*this, walker, model, lattice);
         }
@@ -154,6 +532,16 @@ namespace Measure {
                                           const ModelBase& model, 
                                           const LatticeBase& lattice )
     {
+        // prepare the shared quantities before measuring the observables,
+        // which have been collected during the dynamic sweep in the streaming mode
+        if ( !this->m_is_streaming ) {
+            for (auto t = 0; t < walker.TimeSize(); ++t) {
+                this->compute_dynamic_correlations(t, walker.GreenttUp(t), walker.GreenttDn(t),
+                                                      walker.Greent0Up(t), walker.Greent0Dn(t),
+                                                      walker.Green0tUp(t), walker.Green0tDn(t), lattice);
+            }
+        }
+
         for (auto& scalar_obs : this->m_dynamic_scalar_obs) {
             scalar_obs->measure(*this, walker, model, lattice);
         }
@@ -183,9 +571,6 @@ namespace Measure {
             for (auto& matrix_obs : this->m_eqtime_matrix_obs) {
                 matrix_obs->tmp_value() /= matrix_obs->counts() * this->m_equaltime_sign->tmp_value();
             }
-
-            // record the absolute value of sign
-            this->m_equaltime_sign->tmp_value() = std::abs(this->m_equaltime_sign->tmp_value());
         }
 
         if ( this->m_is_dynamic ) {
@@ -201,15 +586,15 @@ namespace Measure {
             for (auto& matrix_obs : this->m_dynamic_matrix_obs) {
                 matrix_obs->tmp_value() /= matrix_obs->counts() * this->m_dynamic_sign->tmp_value();  
             }
-
-            // record the absolute value of sign
-            this->m_dynamic_sign->tmp_value() = std::abs(this->m_dynamic_sign->tmp_value());
         }
     }
 
 
     void MeasureHandler::write_stats_to_bins( int bin )
     {
+        // the bins claimed in the dynamic scheduling are allocated once they are written
+        if ( this->m_is_dynamic_scheduling ) { this->extend_bins( bin+1 ); }
+
         if ( this->m_is_equaltime ) {
             this->m_equaltime_sign->bin_data(bin) = this->m_equaltime_sign->tmp_value();
 
@@ -240,20 +625,75 @@ namespace Measure {
     }
 
 
+    void MeasureHandler::truncate_bins( int bin_num )
+    {
+        assert( bin_num >= 0 && bin_num <= this->m_bin_num );
+        this->m_bin_num = bin_num;
+
+        if ( this->m_is_equaltime ) {
+            this->m_equaltime_sign->truncate_bins(bin_num);
+            for (auto& scalar_obs : this->m_eqtime_scalar_obs) { scalar_obs->truncate_bins(bin_num); }
+            for (auto& vector_obs : this->m_eqtime_vector_obs) { vector_obs->truncate_bins(bin_num); }
+            for (auto& matrix_obs : this->m_eqtime_matrix_obs) { matrix_obs->truncate_bins(bin_num); }
+        }
+
+        if ( this->m_is_dynamic ) {
+            this->m_dynamic_sign->truncate_bins(bin_num);
+            for (auto& scalar_obs : this->m_dynamic_scalar_obs) { scalar_obs->truncate_bins(bin_num); }
+            for (auto& vector_obs : this->m_dynamic_vector_obs) { vector_obs->truncate_bins(bin_num); }
+            for (auto& matrix_obs : this->m_dynamic_matrix_obs) { matrix_obs->truncate_bins(bin_num); }
+        }
+    }
+
+
+    void MeasureHandler::extend_bins( int bin_num )
+    {
+        assert( bin_num <= this->m_bin_num );
+        auto extend = [&]( auto& obs ) { if ( obs.bin_num() < bin_num ) { obs.extend_bins(bin_num); } };
+
+        if ( this->m_is_equaltime ) {
+            extend( *this->m_equaltime_sign );
+            for (auto& scalar_obs : this->m_eqtime_scalar_obs) { extend( *scalar_obs ); }
+            for (auto& vector_obs : this->m_eqtime_vector_obs) { extend( *vector_obs ); }
+            for (auto& matrix_obs : this->m_eqtime_matrix_obs) { extend( *matrix_obs ); }
+        }
+
+        if ( this->m_is_dynamic ) {
+            extend( *this->m_dynamic_sign );
+            for (auto& scalar_obs : this->m_dynamic_scalar_obs) { extend( *scalar_obs ); }
+            for (auto& vector_obs : this->m_dynamic_vector_obs) { extend( *vector_obs ); }
+            for (auto& matrix_obs : this->m_dynamic_matrix_obs) { extend( *matrix_obs ); }
+        }
+    }
+
+
     void MeasureHandler::analyse_stats()
     {
+        // the sign is analysed first, whose bins serve as the weights of the jackknife resampling
         if ( this->m_is_equaltime ) {
             this->m_equaltime_sign->analyse();
-            for (auto& scalar_obs : this->m_eqtime_scalar_obs) { scalar_obs->analyse(); }
-            for (auto& vector_obs : this->m_eqtime_vector_obs) { vector_obs->analyse(); }
-            for (auto& matrix_obs : this->m_eqtime_matrix_obs) { matrix_obs->analyse(); }
+            for (auto& scalar_obs : this->m_eqtime_scalar_obs) { 
+                scalar_obs->analyse(); scalar_obs->analyse_jackknife(*this->m_equaltime_sign); 
+            }
+            for (auto& vector_obs : this->m_eqtime_vector_obs) { 
+                vector_obs->analyse(); vector_obs->analyse_jackknife(*this->m_equaltime_sign); 
+            }
+            for (auto& matrix_obs : this->m_eqtime_matrix_obs) { 
+                matrix_obs->analyse(); matrix_obs->analyse_jackknife(*this->m_equaltime_sign); 
+            }
         }
 
         if ( this->m_is_dynamic ) {
             this->m_dynamic_sign->analyse();
-            for (auto& scalar_obs : this->m_dynamic_scalar_obs) { scalar_obs->analyse(); }
-            for (auto& vector_obs : this->m_dynamic_vector_obs) { vector_obs->analyse(); }
-            for (auto& matrix_obs : this->m_dynamic_matrix_obs) { matrix_obs->analyse(); }
+            for (auto& scalar_obs : this->m_dynamic_scalar_obs) { 
+                scalar_obs->analyse(); scalar_obs->analyse_jackknife(*this->m_dynamic_sign); 
+            }
+            for (auto& vector_obs : this->m_dynamic_vector_obs) { 
+                vector_obs->analyse(); vector_obs->analyse_jackknife(*this->m_dynamic_sign); 
+            }
+            for (auto& matrix_obs : this->m_dynamic_matrix_obs) { 
+                matrix_obs->analyse(); matrix_obs->analyse_jackknife(*this->m_dynamic_sign); 
+            }
         }
     }
     
@@ -277,4 +717,70 @@ namespace Measure {
     }
 
 
+    void MeasureHandler::merge_temporary( const MeasureHandler& other )
+    {
+        // the observables are listed in the same order for handlers set up with the same observable list
+        assert( this->m_obs_list == other.m_obs_list );
+
+        if ( this->m_is_equaltime ) {
+            this->m_equaltime_sign->merge_temporary( *other.m_equaltime_sign );
+            for (auto i = 0; i < (int)this->m_eqtime_scalar_obs.size(); ++i) { 
+                this->m_eqtime_scalar_obs[i]->merge_temporary( *other.m_eqtime_scalar_obs[i] ); 
+            }
+            for (auto i = 0; i < (int)this->m_eqtime_vector_obs.size(); ++i) { 
+                this->m_eqtime_vector_obs[i]->merge_temporary( *other.m_eqtime_vector_obs[i] ); 
+            }
+            for (auto i = 0; i < (int)this->m_eqtime_matrix_obs.size(); ++i) { 
+                this->m_eqtime_matrix_obs[i]->merge_temporary( *other.m_eqtime_matrix_obs[i] ); 
+            }
+        }
+
+        if ( this->m_is_dynamic ) {
+            this->m_dynamic_sign->merge_temporary( *other.m_dynamic_sign );
+            for (auto i = 0; i < (int)this->m_dynamic_scalar_obs.size(); ++i) { 
+                this->m_dynamic_scalar_obs[i]->merge_temporary( *other.m_dynamic_scalar_obs[i] ); 
+            }
+            for (auto i = 0; i < (int)this->m_dynamic_vector_obs.size(); ++i) { 
+                this->m_dynamic_vector_obs[i]->merge_temporary( *other.m_dynamic_vector_obs[i] ); 
+            }
+            for (auto i = 0; i < (int)this->m_dynamic_matrix_obs.size(); ++i) { 
+                this->m_dynamic_matrix_obs[i]->merge_temporary( *other.m_dynamic_matrix_obs[i] ); 
+            }
+        }
+    }
+
+
+    void MeasureHandler::merge_log_binning( const MeasureHandler& other )
+    {
+        // the observables are listed in the same order for handlers set up with the same observable list
+        assert( this->m_obs_list == other.m_obs_list );
+
+        if ( this->m_is_equaltime ) {
+            this->m_equaltime_sign->merge_log_binning( *other.m_equaltime_sign );
+            for (auto i = 0; i < (int)this->m_eqtime_scalar_obs.size(); ++i) { 
+                this->m_eqtime_scalar_obs[i]->merge_log_binning( *other.m_eqtime_scalar_obs[i] ); 
+            }
+            for (auto i = 0; i < (int)this->m_eqtime_vector_obs.size(); ++i) { 
+                this->m_eqtime_vector_obs[i]->merge_log_binning( *other.m_eqtime_vector_obs[i] ); 
+            }
+            for (auto i = 0; i < (int)this->m_eqtime_matrix_obs.size(); ++i) { 
+                this->m_eqtime_matrix_obs[i]->merge_log_binning( *other.m_eqtime_matrix_obs[i] ); 
+            }
+        }
+
+        if ( this->m_is_dynamic ) {
+            this->m_dynamic_sign->merge_log_binning( *other.m_dynamic_sign );
+            for (auto i = 0; i < (int)this->m_dynamic_scalar_obs.size(); ++i) { 
+                this->m_dynamic_scalar_obs[i]->merge_log_binning( *other.m_dynamic_scalar_obs[i] ); 
+            }
+            for (auto i = 0; i < (int)this->m_dynamic_vector_obs.size(); ++i) { 
+                this->m_dynamic_vector_obs[i]->merge_log_binning( *other.m_dynamic_vector_obs[i] ); 
+            }
+            for (auto i = 0; i < (int)this->m_dynamic_matrix_obs.size(); ++i) { 
+                this->m_dynamic_matrix_obs[i]->merge_log_binning( *other.m_dynamic_matrix_obs[i] ); 
+            }
+        }
+    }
+
+
 } // namespace Measure
@@ -40,8 +40,7 @@ namespace Measure {
     {
         // loop over equivalent time slices
         for (auto t = 0; t < walker.TimeSize(); ++t) {
-            filling_number.tmp_value() += walker.ConfigSign(t) * 
-                ( 2 - ( walker.GreenttUp(t).trace()+walker.GreenttDn(t).trace() )/lattice.SpaceSize() );
+            filling_number.tmp_value() += walker.ConfigSign(t) * meas_handler.EqtimeCorr(t).filling;
             ++filling_number;
         }
     }
@@ -56,15 +55,7 @@ namespace Measure {
                                             const LatticeBase& lattice )
     {
         for (auto t = 0; t < walker.TimeSize(); ++t) {
-            const GreensFunc& gu = walker.GreenttUp(t);
-            const GreensFunc& gd = walker.GreenttDn(t);
-            const RealScalar& config_sign = walker.ConfigSign(t);
-
-            RealScalar tmp_double_occu = 0.0;
-            for (int i = 0; i < lattice.SpaceSize(); ++i) {
-                tmp_double_occu += (1 - gu(i, i)) * (1 - gd(i, i));
-            }
-            double_occupancy.tmp_value() += config_sign * tmp_double_occu / lattice.SpaceSize();
+            double_occupancy.tmp_value() += walker.ConfigSign(t) * meas_handler.EqtimeCorr(t).double_occupancy;
             ++double_occupancy;
         }
     }
@@ -79,21 +70,8 @@ namespace Measure {
                                           const LatticeBase& lattice )
     {   
         for (auto t = 0; t < walker.TimeSize(); ++t) {
-            const GreensFunc& gu = walker.GreenttUp(t);
-            const GreensFunc& gd = walker.GreenttDn(t);
-            const RealScalar& config_sign = walker.ConfigSign(t);
-
-            RealScalar tmp_kinetic_energy = 0.0;
-            for (auto i = 0; i < lattice.SpaceSize(); ++i) {
-                // loop over lattice sites
-                for (auto dir = 0; dir < lattice.SpaceDim(); ++dir) {
-                    // loop over nearest neighbours
-                    // todo: the independent directions should equal to the coordination number of the lattice
-                    tmp_kinetic_energy += gu(i, lattice.NearestNeighbour(i, dir)) 
-                                        + gd(i, lattice.NearestNeighbour(i, dir));
-                }
-            }
-            kinetic_energy.tmp_value() += config_sign * ( 2*model.HoppingT() ) * tmp_kinetic_energy / lattice.SpaceSize();
+            // the hoppings between nearest neighbours have been summed up in the measuring pass
+            kinetic_energy.tmp_value() += walker.ConfigSign(t) * ( 2*model.HoppingT() ) * meas_handler.EqtimeCorr(t).nn_hopping;
             ++kinetic_energy;
         }
     }
@@ -109,15 +87,7 @@ namespace Measure {
                                            const LatticeBase& lattice )
     {
         for (auto t = 0; t < walker.TimeSize(); ++t) {
-            const GreensFunc& gu = walker.GreenttUp(t);
-            const GreensFunc& gd = walker.GreenttDn(t);
-            const RealScalar& config_sign = walker.ConfigSign(t);
-
-            RealScalar tmp_local_spin_corr = 0.0;
-            for (auto i = 0; i < lattice.SpaceSize(); ++i) {
-                tmp_local_spin_corr += config_sign * ( gu(i,i) + gd(i,i) - 2 * gu(i,i) * gd(i,i) );
-            }
-            local_spin_corr.tmp_value() += tmp_local_spin_corr / lattice.SpaceSize();
+            local_spin_corr.tmp_value() += walker.ConfigSign(t) * meas_handler.EqtimeCorr(t).local_spin_corr;
             ++local_spin_corr;
         }
     }
@@ -132,21 +102,12 @@ namespace Measure {
                                                  const ModelBase& model,
                                                  const LatticeBase& lattice )
     {  
+        const auto& fourier_factor = lattice.FourierFactor().col(meas_handler.Momentum());
         for (auto t = 0; t < walker.TimeSize(); ++t) {
-            const GreensFunc& gu = walker.GreenttUp(t);
-            const GreensFunc& gd = walker.GreenttDn(t);
+            // contract the translation-averaged greens function G(r) with the fourier factors
             const RealScalar& config_sign = walker.ConfigSign(t);
-
-            RealScalar tmp_momentum_dist = 0.0;
-            // the first site i
-            for (auto i = 0; i < lattice.SpaceSize(); ++i) {
-                // the second site j
-                for (auto j = 0; j < lattice.SpaceSize(); ++j) {
-                    tmp_momentum_dist += ( gu(j,i) + gd(j,i) )
-                        * lattice.FourierFactor( lattice.Displacement(i,j), meas_handler.Momentum() );
-                }
-            }
-            momentum_dist.tmp_value() += config_sign * ( 1 - 0.5 * tmp_momentum_dist / lattice.SpaceSize() );
+            const RealScalar tmp_momentum_dist = fourier_factor.dot( meas_handler.EqtimeCorr(t).greens_r );
+            momentum_dist.tmp_value() += config_sign * ( 1 - 0.5 * tmp_momentum_dist );
             ++momentum_dist;
         }
     }
@@ -161,26 +122,13 @@ namespace Measure {
                                                          const ModelBase& model,
                                                          const LatticeBase& lattice )
     {
+        const auto& fourier_factor = lattice.FourierFactor().col(meas_handler.Momentum());
         for (auto t = 0; t < walker.TimeSize(); ++t) {
-            //  g(i,j) = < c_i * c^+_j > are the greens functions
-            // gc(i,j) = < c^+_i * c_j > are isomorphic to the conjugation of greens functions
-            const GreensFunc& gu = walker.GreenttUp(t);
-            const GreensFunc& gd = walker.GreenttDn(t);
-            const GreensFunc& guc = Matrix::Identity(lattice.SpaceSize(), lattice.SpaceSize()) - gu.transpose();
-            const GreensFunc& gdc = Matrix::Identity(lattice.SpaceSize(), lattice.SpaceSize()) - gd.transpose();
+            // the spin-spin correlations have been averaged over the translations,
+            // namely 1/N \sum ij f(i,j) = \sum r f(r) for f(r) = 1/N \sum i f(i,i+r)
             const RealScalar& config_sign = walker.ConfigSign(t);
-
-            // loop over site i, j and take averages
-            RealScalar tmp_sdw = 0.0;
-            for (auto i = 0; i < lattice.SpaceSize(); ++i) {
-                for (auto j = 0; j < lattice.SpaceSize(); ++j) {
-                    tmp_sdw += config_sign * lattice.FourierFactor( lattice.Displacement(i,j), meas_handler.Momentum() )
-                        * ( + guc(i,i) * guc(j,j) + guc(i,j) * gu(i,j)
-                            + gdc(i,i) * gdc(j,j) + gdc(i,j) * gd(i,j)
-                            - gdc(i,i) * guc(j,j) - guc(i,i) * gdc(j,j) );
-                }
-            }
-            sdw_factor.tmp_value() += tmp_sdw / ( lattice.SpaceSize()*lattice.SpaceSize() );
+            const RealScalar tmp_sdw = fourier_factor.dot( meas_handler.EqtimeCorr(t).spin_corr_r );
+            sdw_factor.tmp_value() += config_sign * tmp_sdw / lattice.SpaceSize();
             ++sdw_factor;
         }
     }
@@ -195,26 +143,12 @@ namespace Measure {
                                                            const ModelBase& model,
                                                            const LatticeBase& lattice )
     {
+        const auto& fourier_factor = lattice.FourierFactor().col(meas_handler.Momentum());
         for (auto t = 0; t < walker.TimeSize(); ++t) {
-            //  g(i,j) = < c_i * c^+_j > are the greens functions
-            // gc(i,j) = < c^+_i * c_j > are isomorphic to the conjugation of greens functions
-            const GreensFunc& gu = walker.GreenttUp(t);
-            const GreensFunc& gd = walker.GreenttDn(t);
-            const GreensFunc& guc = Matrix::Identity(lattice.SpaceSize(), lattice.SpaceSize()) - gu.transpose();
-            const GreensFunc& gdc = Matrix::Identity(lattice.SpaceSize(), lattice.SpaceSize()) - gd.transpose();
+            // the charge-charge correlations have been averaged over the translations
             const RealScalar& config_sign = walker.ConfigSign(t);
-
-            // loop over site i, j and take averages
-            RealScalar tmp_cdw = 0.0;
-            for (auto i = 0; i < lattice.SpaceSize(); ++i) {
-                for (auto j = 0; j < lattice.SpaceSize(); ++j) {
-                    tmp_cdw += config_sign * lattice.FourierFactor( lattice.Displacement(i,j), meas_handler.Momentum() )
-                        * ( + guc(i,i) * guc(j,j) + guc(i,j) * gu(i,j)
-                            + gdc(i,i) * gdc(j,j) + gdc(i,j) * gd(i,j)
-                            + gdc(i,i) * guc(j,j) + guc(i,i) * gdc(j,j) );
-                }
-            }
-            cdw_factor.tmp_value() += tmp_cdw / ( lattice.SpaceSize()*lattice.SpaceSize() );
+            const RealScalar tmp_cdw = fourier_factor.dot( meas_handler.EqtimeCorr(t).charge_corr_r );
+            cdw_factor.tmp_value() += config_sign * tmp_cdw / lattice.SpaceSize();
             ++cdw_factor;
         }
     }
@@ -233,23 +167,8 @@ namespace Measure {
                                                const LatticeBase& lattice )
     {
         for (auto t = 0; t < walker.TimeSize(); ++t) {
-            //  g(i,j) = < c_i * c^+_j > are the greens functions
-            // gc(i,j) = < c^+_i * c_j > are isomorphic to the conjugation of greens functions
-            const GreensFunc& gu = walker.GreenttUp(t);
-            const GreensFunc& gd = walker.GreenttDn(t);
-            const GreensFunc& guc = Matrix::Identity(lattice.SpaceSize(), lattice.SpaceSize()) - gu.transpose();
-            const GreensFunc& gdc = Matrix::Identity(lattice.SpaceSize(), lattice.SpaceSize()) - gd.transpose();
-            const RealScalar& config_sign = walker.ConfigSign(t);
-
-            // loop over site i, j and take averages
-            RealScalar tmp_s_wave_pairing = 0.0;
-            for (auto i = 0; i < lattice.SpaceSize(); ++i) {
-                for (auto j = 0; j < lattice.SpaceSize(); ++j) {
-                    tmp_s_wave_pairing += config_sign * ( guc(i,j) * gdc(i,j) );
-                }
-            }
             // entensive quantity
-            s_wave_pairing.tmp_value() += tmp_s_wave_pairing / lattice.SpaceSize();
+            s_wave_pairing.tmp_value() += walker.ConfigSign(t) * meas_handler.EqtimeCorr(t).s_wave_pairing;
             ++s_wave_pairing;
         }
     }
@@ -282,28 +201,10 @@ namespace Measure {
                                             const LatticeBase& lattice )
     {   
         // because the auxiliary field configurations are not changed for time-displaced measurements,
-        // the sign of the configuration should be the same for all imaginary-time grids.  
-        const auto& config_sign = walker.ConfigSign();
-
-        for (auto t = 0; t < walker.TimeSize(); ++t) {
-            // the factor 1/2 comes from two degenerate spin states ( spin averaged, which is model dependent )
-            // note: gt0 will automatically degenerate to g00 if t = 0, it should be safe to replace Greentt with Greent0
-            const GreensFunc& gt0 = ( t == 0 )?
-                    0.5 * ( walker.GreenttUp(walker.TimeSize()-1) + walker.GreenttDn(walker.TimeSize()-1) )
-                  : 0.5 * ( walker.Greent0Up(t-1) + walker.Greent0Dn(t-1) ); 
-
-            // the first site i
-            for (auto i = 0; i < lattice.SpaceSize(); ++i) {
-                // the second site j
-                for (auto j = 0; j < lattice.SpaceSize(); ++j) {
-                    // loop for momentum explicitly
-                    for (auto k = 0; k < (int)meas_handler.MomentumList().size(); ++k) {
-                        greens_functions.tmp_value()(k,t) += config_sign * gt0(j,i) / lattice.SpaceSize()
-                            * lattice.FourierFactor(lattice.Displacement(i,j), meas_handler.MomentumList(k));
-                    }
-                }
-            }
-        }
+        // the sign of the configuration should be the same for all imaginary-time grids.
+        // the momentum-space greens functions G(k,t) are prepared by the measuring handler,
+        // via the translation-averaged greens functions G(r,t) and the fourier transformations.
+        greens_functions.tmp_value() += walker.ConfigSign() * meas_handler.DynamicCorr().greens_kt;
         ++greens_functions;
     }
 
@@ -316,15 +217,8 @@ namespace Measure {
                                              const ModelBase& model,
                                              const LatticeBase& lattice )
     {   
-        const auto& config_sign = walker.ConfigSign();
-        for (auto t = 0; t < walker.TimeSize(); ++t) {
-            // the factor 1/2 comes from two degenerate spin states ( spin averaged, which is model dependent )
-            // note: gt0 will automatically degenerate to g00 if t = 0, it should be safe to replace Greentt with Greent0
-            const GreensFunc& gt0 = ( t == 0 )?
-                    0.5 * ( walker.GreenttUp(walker.TimeSize()-1) + walker.GreenttDn(walker.TimeSize()-1) )
-                  : 0.5 * ( walker.Greent0Up(t-1) + walker.Greent0Dn(t-1) );
-            density_of_states.tmp_value()(t) += config_sign * gt0.trace() / lattice.SpaceSize();
-        }
+        // the spin-averaged local greens functions are prepared by the measuring handler
+        density_of_states.tmp_value() += walker.ConfigSign() * meas_handler.DynamicCorr().local_greens_t;
         ++density_of_states;
     }
 
@@ -350,68 +244,12 @@ namespace Measure {
         assert( dynamic_cast<const Lattice::Square*>(&lattice) != nullptr );
         assert( lattice.SideLength() % 2 == 0 );
 
-        RealScalar tmp_rho_s = 0.0;
-
-        const GreensFunc& g00up = walker.GreenttUp(walker.TimeSize()-1); 
-        const GreensFunc& g00dn = walker.GreenttDn(walker.TimeSize()-1); 
-        const auto& config_sign = walker.ConfigSign();
+        // the current-current correlations, summed over the imaginary time and weighted by the fourier factors
+        //     exp ( -i kx * r ) - exp ( -i ky * r )
+        // with the minimal momentum kx = ( 2pi/L, 0 ) and ky = ( 0, 2pi/L ), are prepared by the measuring handler.
+        const RealScalar tmp_rho_s = model.HoppingT() * model.HoppingT() * walker.ConfigSign() 
+                                   * meas_handler.DynamicCorr().current_corr;
 
-        for (auto t = 0; t < walker.TimeSize(); ++t) {
-            // dynamic greens functions
-            // which degenerate to the equal-time greens function if t equals 0.
-            // todo: check the correctness, eg. gt0(t=0) = g00 and g0t(t=0) = g00-1
-            const GreensFunc& gttup = ( t == 0 )? walker.GreenttUp(walker.TimeSize()-1) : walker.GreenttUp(t-1);
-            const GreensFunc& gttdn = ( t == 0 )? walker.GreenttDn(walker.TimeSize()-1) : walker.GreenttDn(t-1);
-            const GreensFunc& gt0up = ( t == 0 )? walker.Greent0Up(walker.TimeSize()-1) : walker.Greent0Up(t-1);
-            const GreensFunc& gt0dn = ( t == 0 )? walker.Greent0Dn(walker.TimeSize()-1) : walker.Greent0Dn(t-1);
-            const GreensFunc& g0tup = ( t == 0 )? walker.Green0tUp(walker.TimeSize()-1) : walker.Green0tUp(t-1);
-            const GreensFunc& g0tdn = ( t == 0 )? walker.Green0tDn(walker.TimeSize()-1) : walker.Green0tDn(t-1);
-            
-            // the first site i
-            for (auto i = 0; i < lattice.SpaceSize(); ++i) {
-                // the nearest neighbor of site i along positive direction of axis x
-                const auto ipx = lattice.NearestNeighbour(i, 0);
-
-                // the second site j
-                for (auto j = 0; j < lattice.SpaceSize(); ++j) {
-                    // the nearest neighbor of site j along positive direction of axis x
-                    const auto jpx = lattice.NearestNeighbour(j, 0);
-                    
-                    // we would like to compute the factor of fourier transformation
-                    //     exp ( -i kx * r ) - exp ( -i ky * r )
-                    // where r = rj - ri is the displacement between site i and j,
-                    // and kx, ky are the minimal momentum along x and y direction respectively
-                    //     kx = ( 2pi/L, 0 )    ky = ( 0, 2pi/L )
-                    const auto rx = lattice.Index2Site(lattice.Displacement(i,j), 0);
-                    const auto ry = lattice.Index2Site(lattice.Displacement(i,j), 1);
-
-                    // becasue these two momentum kx and ky are equivalent,
-                    // and belong to the same irreducible representation (k star),
-                    // we will only have the fourier factor table of kx = (kx,0) in our memory, whose momentum index is 1.
-                    // it may seem quite tricky here that we do the replacement
-                    //     kx * r = (kx,0) * (rx,ry)    = kx * rx   ->  (kx,0) * (rx,0)
-                    //     ky * r = (0,ky=kx) * (rx,ry) = kx * ry   ->  (kx,0) * (ry,0)
-                    // with the site (rx,0) labeled by index rx and the site (ry,0) labeled by index ry.     
-                    // this replacement will keep the fourier factors invariant.
-                    const auto fourier_factor = lattice.FourierFactor(rx, 1) - lattice.FourierFactor(ry, 1);
-                    
-                    // it should be noted that this replacement is only valid when the lattice has a even side length,
-                    // otherwise the kx and ky will become the same momentum point due to the finite size effect.
-                    
-                    // compute the stiffness
-                    tmp_rho_s += model.HoppingT() * model.HoppingT() * config_sign * fourier_factor * (
-                            // uncorrelated part
-                            - ( gttup(j,jpx) - gttup(jpx,j) + gttdn(j,jpx) - gttdn(jpx,j) ) *
-                              ( g00up(i,ipx) - g00up(ipx,i) + g00dn(i,ipx) - g00dn(ipx,i) )
-                                        
-                            // correlated part
-                            - g0tup(ipx,jpx) * gt0up(j,i) - g0tdn(ipx, jpx) * gt0dn(j, i)
-                            + g0tup(i,jpx) * gt0up(j,ipx) + g0tdn(i, jpx) * gt0dn(j, ipx)
-                            + g0tup(ipx,j) * gt0up(jpx,i) + g0tdn(ipx, j) * gt0dn(jpx, i)
-                            - g0tup(i,j) * gt0up(jpx,ipx) - g0tdn(i, j) * gt0dn(jpx, ipx) );
-                }
-            }
-        }
         // the 1/4 prefactor is because that the Cooper pair carries charge 2
         // see https://arxiv.org/pdf/1912.08848.pdf
         superfluid_stiffness.tmp_value() += 0.25 * tmp_rho_s / ( lattice.SpaceSize()*lattice.SpaceSize() );
@@ -429,35 +267,10 @@ namespace Measure {
                                                         const ModelBase& model,
                                                         const LatticeBase& lattice )
     {   
-        const auto& config_sign = walker.ConfigSign();
-        const GreensFunc& g00up = walker.GreenttUp(walker.TimeSize()-1); 
-        const GreensFunc& g00dn = walker.GreenttDn(walker.TimeSize()-1);
-        const GreensFunc& gc00up = Matrix::Identity(lattice.SpaceSize(), lattice.SpaceSize()) - g00up.transpose();
-        const GreensFunc& gc00dn = Matrix::Identity(lattice.SpaceSize(), lattice.SpaceSize()) - g00dn.transpose();
-        
-        for ( auto t = 0; t < walker.TimeSize(); ++t ) {
-            const GreensFunc& gttup = ( t == 0 )? walker.GreenttUp(walker.TimeSize()-1) : walker.GreenttUp(t-1);
-            const GreensFunc& gttdn = ( t == 0 )? walker.GreenttDn(walker.TimeSize()-1) : walker.GreenttDn(t-1);
-            const GreensFunc& gt0up = ( t == 0 )? walker.Greent0Up(walker.TimeSize()-1) : walker.Greent0Up(t-1);
-            const GreensFunc& gt0dn = ( t == 0 )? walker.Greent0Dn(walker.TimeSize()-1) : walker.Greent0Dn(t-1);
-            const GreensFunc& g0tup = ( t == 0 )? walker.Green0tUp(walker.TimeSize()-1) : walker.Green0tUp(t-1);
-            const GreensFunc& g0tdn = ( t == 0 )? walker.Green0tDn(walker.TimeSize()-1) : walker.Green0tDn(t-1);
-            const GreensFunc& gcttup = Matrix::Identity(lattice.SpaceSize(), lattice.SpaceSize()) - gttup.transpose();
-            const GreensFunc& gcttdn = Matrix::Identity(lattice.SpaceSize(), lattice.SpaceSize()) - gttdn.transpose();
-            
-            for ( auto i = 0; i < lattice.SpaceSize(); ++i ) {
-                // the factor 1/4 comes from the spin 1/2, e.g. Sz = 1/2 ( nup - ndn )
-                dynamic_spin_susceptibility.tmp_value()(t) += 0.25 * config_sign / lattice.SpaceSize() *
-                ( 
-                    + gcttup(i,i) * gc00up(i,i) - g0tup(i,i) * gt0up(i,i)
-                    + gcttdn(i,i) * gc00dn(i,i) - g0tdn(i,i) * gt0dn(i,i)
-                    - gcttup(i,i) * gc00dn(i,i) - gc00up(i,i) * gcttdn(i,i)
-                );
-            }
-        
-        }
+        // the factor 1/4 comes from the spin 1/2, e.g. Sz = 1/2 ( nup - ndn ),
+        // and the local spin correlations are prepared by the measuring handler.
+        dynamic_spin_susceptibility.tmp_value() += 0.25 * walker.ConfigSign() * meas_handler.DynamicCorr().local_spin_corr_t;
         ++dynamic_spin_susceptibility;
-        
     }
 
 
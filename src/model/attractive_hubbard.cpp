@@ -3,6 +3,8 @@
 #include "dqmc_walker.h"
 #include "random.h"
 
+#include <random>
+
 #define EIGEN_USE_MKL_ALL
 #define EIGEN_VECTORIZE_SSE4_2
 #include <Eigen/Core>
@@ -48,6 +50,8 @@ namespace Model {
         const RealScalar time_interval = walker.TimeInterval();
 
         this->m_alpha = acosh( exp(0.5 * time_interval * this->m_onsite_u) );
+        this->m_exp_alpha = { exp( -this->m_alpha ), exp( +this->m_alpha ) };
+        this->m_exp_2alpha = { exp( -2 * this->m_alpha ), exp( +2 * this->m_alpha ) };
 
         // allocate memory for bosonic fields
         this->m_bosonic_field.resize(this->m_time_size, this->m_space_size);
@@ -61,11 +65,11 @@ namespace Model {
         const SpaceSpaceMat chemical_potential_mat = this->m_chemical_potential * SpaceSpaceMat::Identity(space_size,space_size);
         const SpaceSpaceMat Kmat = -this->m_hopping_t * lattice.HoppingMatrix() + chemical_potential_mat;
         
-        this->m_expK_mat       = ( -time_interval * Kmat ).exp();
-        this->m_inv_expK_mat   = ( +time_interval * Kmat ).exp();
+        this->m_expK_mat       = std::make_shared<const Matrix>( ( -time_interval * Kmat ).exp() );
+        this->m_inv_expK_mat   = std::make_shared<const Matrix>( ( +time_interval * Kmat ).exp() );
         
         // in general K matrix is symmetrical
-        this->m_trans_expK_mat = this->m_expK_mat.transpose();
+        this->m_trans_expK_mat = std::make_shared<const Matrix>( this->m_expK_mat->transpose() );
 
         // since V is diagonalized in the Hubbard model
         // there is no need to explicitly compute expV
@@ -83,7 +87,7 @@ namespace Model {
     }
     
     
-    void AttractiveHubbard::set_bosonic_fields_to_random() 
+    void AttractiveHubbard::set_bosonic_fields_to_random( Utils::Philox& rng ) 
     {
         // set configurations of the bosonic fields to random
         const auto time_size = this->m_bosonic_field.rows();
@@ -92,13 +96,46 @@ namespace Model {
         std::bernoulli_distribution bernoulli_dist(0.5);
         for (auto t = 0; t < time_size; ++t) {
             for (auto i = 0; i < space_size; ++i) {
-                // for Z2 bosonic field, simply set 1.0 or -1.0
-                this->m_bosonic_field(t, i) = bernoulli_dist(Utils::Random::Engine)? +1.0 : -1.0;
+                // for Z2 bosonic field, simply set +1 or -1
+                this->m_bosonic_field(t, i) = bernoulli_dist(rng)? +1 : -1;
             }
         }
     }
 
 
+    std::unique_ptr<ModelBase> AttractiveHubbard::clone() const
+    {
+        auto model = std::make_unique<AttractiveHubbard>( *this );
+
+        // the dense multiplications of expK are bound to the model itself, and should be relinked to the copy
+        if ( !model->m_is_checkerboard ) { model->link(); }
+        return model;
+    }
+
+
+    const Vector AttractiveHubbard::BosonicFields() const
+    {
+        // the row-major storage is contiguous in space within each time slice
+        return Eigen::Map<const Eigen::Matrix<std::int8_t, Eigen::Dynamic, 1>>
+                    ( this->m_bosonic_field.data(), this->m_bosonic_field.size() ).cast<RealScalar>();
+    }
+
+
+    void AttractiveHubbard::set_bosonic_fields( const Vector& fields )
+    {
+        assert( fields.size() == this->m_bosonic_field.size() );
+        Eigen::Map<Eigen::Matrix<std::int8_t, Eigen::Dynamic, 1>>
+            ( this->m_bosonic_field.data(), this->m_bosonic_field.size() ) = fields.cast<std::int8_t>();
+    }
+
+
+    const RealScalar AttractiveHubbard::LogBosonicWeight() const
+    {
+        // flipping s(t,i) changes the weight by exp( 2 * alpha * s(t,i) ), as in get_update_ratio()
+        return -this->m_alpha * this->m_bosonic_field.cast<RealScalar>().sum();
+    }
+
+
     void AttractiveHubbard::update_bosonic_field( TimeIndex time_index, SpaceIndex space_index )
     {
         assert( time_index >= 0 && time_index < this->m_time_size );
@@ -117,11 +154,11 @@ namespace Model {
         const Eigen::MatrixXd& green_tt_up = walker.GreenttUp();
         const Eigen::MatrixXd& green_tt_dn = walker.GreenttDn();
 
-        return  exp( 2 * this->m_alpha * this->m_bosonic_field(time_index, space_index) ) 
+        return  this->exp_2alpha( +this->m_bosonic_field(time_index, space_index) ) 
                 * (  1 + ( 1 - green_tt_up(space_index, space_index) ) 
-                       * ( exp( -2 * this->m_alpha * this->m_bosonic_field(time_index, space_index) ) - 1 )  )
+                       * ( this->exp_2alpha( -this->m_bosonic_field(time_index, space_index) ) - 1 )  )
                 * (  1 + ( 1 - green_tt_dn(space_index, space_index) ) 
-                       * ( exp( -2 * this->m_alpha * this->m_bosonic_field(time_index, space_index) ) - 1 )  );
+                       * ( this->exp_2alpha( -this->m_bosonic_field(time_index, space_index) ) - 1 )  );
     }
 
 
@@ -139,9 +176,9 @@ namespace Model {
         //   Quantum Monte Carlo Methods (Algorithms for Lattice Models) Determinant method
         // here we use the sparseness of the matrix \delta
         const double factor_up 
-            = ( exp( -2 * this->m_alpha * this->m_bosonic_field(time_index, space_index) ) - 1 )
+            = ( this->exp_2alpha( -this->m_bosonic_field(time_index, space_index) ) - 1 )
             / ( 1 + ( 1 - green_tt_up(space_index, space_index) ) 
-            * ( exp( -2 * this->m_alpha * this->m_bosonic_field(time_index, space_index) ) - 1 ) );
+            * ( this->exp_2alpha( -this->m_bosonic_field(time_index, space_index) ) - 1 ) );
        
         // for attractive hubbard model, because the spin-up and spin-down parts are coupled 
         // to the bosonic fields in the same way, the model possesses the spin degeneracy, 
@@ -151,9 +188,43 @@ namespace Model {
         green_tt_up
             -= factor_up * green_tt_up.col(space_index) 
             * ( Eigen::VectorXd::Unit(this->m_space_size, space_index).transpose() - green_tt_up.row(space_index) );
-        green_tt_dn
-            -= factor_dn * green_tt_dn.col(space_index)
-            * ( Eigen::VectorXd::Unit(this->m_space_size, space_index).transpose() - green_tt_dn.row(space_index) );
+        // in the spin-symmetric mode of the walker, the spin-down greens function is an alias of the spin-up one
+        if ( &green_tt_dn != &green_tt_up ) {
+            green_tt_dn
+                -= factor_dn * green_tt_dn.col(space_index)
+                * ( Eigen::VectorXd::Unit(this->m_space_size, space_index).transpose() - green_tt_dn.row(space_index) );
+        }
+    }
+
+
+    const double AttractiveHubbard::get_update_delta( TimeIndex time_index, SpaceIndex space_index, Spin spin ) const
+    {
+        assert( time_index >= 0 && time_index < this->m_time_size );
+        assert( space_index >= 0 && space_index < this->m_space_size );
+        assert( abs(spin) == 1.0 );
+
+        // the spin-up and spin-down parts are coupled to the bosonic fields in the same way,
+        // hence \delta_ii = exp( -2 * alpha * s(t,i) ) - 1 is independent of the spin
+        return this->exp_2alpha( -this->m_bosonic_field(time_index, space_index) ) - 1;
+    }
+
+
+    void AttractiveHubbard::fill_expV_diagonal( TimeIndex time_index, Spin spin, bool is_inverse, Vector& diag ) const
+    {
+        assert( time_index >= 0 && time_index <= this->m_time_size );
+        assert( abs(spin) == 1.0 );
+
+        // due to the periodical boundary condition (PBC)
+        // the time slice labeled by 0 actually corresponds to slice tau = beta
+        const int eff_time_index = ( time_index == 0 )? this->m_time_size-1 : time_index-1;
+        const int x = ( is_inverse )? -1 : +1;
+
+        // the diagonal elements are looked up from the tables, and no exponentials are evaluated on the hot path.
+        // the diagonal is filled in place, which is free of allocation once the buffer is sized.
+        diag.resize(this->m_space_size);
+        for (auto i = 0; i < this->m_space_size; ++i) {
+            diag(i) = this->exp_alpha( x * this->m_bosonic_field(eff_time_index, i) );
+        }
     }
 
 
@@ -167,13 +238,7 @@ namespace Model {
         // 1.0 for spin up and -1.0 for spin down
         assert( abs(spin) == 1.0 );
 
-        // due to the periodical boundary condition (PBC)
-        // the time slice labeled by 0 actually corresponds to slice tau = beta
-        const int eff_time_index = ( time_index == 0 )? this->m_time_size-1 : time_index-1;
-        this->m_mult_expK_from_left( green );
-        for (auto i = 0; i < this->m_space_size; ++i) {
-            green.row(i) *= exp( +1.0 * this->m_alpha * this->m_bosonic_field(eff_time_index, i) );
-        }
+        this->mult_expV_expK_from_left( green, time_index, spin );
     }
 
 
@@ -186,11 +251,7 @@ namespace Model {
         assert( time_index >= 0 && time_index <= this->m_time_size );
         assert( abs(spin) == 1.0 );
 
-        const int eff_time_index = ( time_index == 0 )? this->m_time_size-1 : time_index-1;
-        for (auto i = 0; i < this->m_space_size; ++i) {
-            green.col(i) *= exp( +1.0 * this->m_alpha * this->m_bosonic_field(eff_time_index, i) );
-        }
-        this->m_mult_expK_from_right( green );
+        this->mult_expV_expK_from_right( green, time_index, spin );
     }
 
 
@@ -203,11 +264,7 @@ namespace Model {
         assert( time_index >= 0 && time_index <= this->m_time_size );
         assert( abs(spin) == 1.0 );
 
-        const int eff_time_index = ( time_index == 0 )? this->m_time_size-1 : time_index-1;
-        for (auto i = 0; i < this->m_space_size; ++i) {
-            green.row(i) *= exp( -1.0 * this->m_alpha * this->m_bosonic_field(eff_time_index, i) );
-        }
-        this->m_mult_inv_expK_from_left( green );
+        this->mult_inv_expK_expV_from_left( green, time_index, spin );
     }
 
 
@@ -220,11 +277,7 @@ namespace Model {
         assert( time_index >= 0 && time_index <= this->m_time_size );
         assert( abs(spin) == 1.0 );
 
-        const int eff_time_index = ( time_index == 0 )? this->m_time_size-1 : time_index-1;
-        this->m_mult_inv_expK_from_right( green );
-        for (auto i = 0; i < this->m_space_size; ++i) {
-            green.col(i) *= exp( -1.0 * this->m_alpha * this->m_bosonic_field(eff_time_index, i) );
-        }
+        this->mult_inv_expK_expV_from_right( green, time_index, spin );
     }
 
     
@@ -237,11 +290,7 @@ namespace Model {
         assert( time_index >= 0 && time_index <= this->m_time_size );
         assert( abs(spin) == 1.0 );
 
-        const int eff_time_index = ( time_index == 0 )? this->m_time_size-1 : time_index-1;
-        for (auto i = 0; i < this->m_space_size; ++i) {
-            green.row(i) *= exp( +1.0 * this->m_alpha * this->m_bosonic_field(eff_time_index, i) );
-        }
-        this->m_mult_trans_expK_from_left( green );
+        this->mult_trans_expK_expV_from_left( green, time_index, spin );
     }
 
 
@@ -1,57 +1,262 @@
 #include "model/model_base.h"
 #include "checkerboard/checkerboard_base.h"
 
+#include <mkl_cblas.h>
+
 
 namespace Model {
 
     void ModelBase::mult_expK_from_left( GreensFunc& green ) const 
     { 
         assert( green.rows() == this->m_space_size && green.cols() == this->m_space_size );
-        green = this->m_expK_mat * green;
+        green = *this->m_expK_mat * green;
     }
 
     void ModelBase::mult_expK_from_right( GreensFunc& green ) const 
     { 
         assert( green.rows() == this->m_space_size && green.cols() == this->m_space_size );
-        green = green * this->m_expK_mat; 
+        green = green * (*this->m_expK_mat); 
     }
 
     void ModelBase::mult_inv_expK_from_left( GreensFunc& green ) const 
     { 
         assert( green.rows() == this->m_space_size && green.cols() == this->m_space_size );
-        green = this->m_inv_expK_mat * green; 
+        green = *this->m_inv_expK_mat * green; 
     }
 
     void ModelBase::mult_inv_expK_from_right( GreensFunc& green ) const 
     { 
         assert( green.rows() == this->m_space_size && green.cols() == this->m_space_size );
-        green = green * this->m_inv_expK_mat; 
+        green = green * (*this->m_inv_expK_mat); 
     }
     
     void ModelBase::mult_trans_expK_from_left( GreensFunc& green ) const 
     { 
         assert( green.rows() == this->m_space_size && green.cols() == this->m_space_size );
-        green = this->m_trans_expK_mat * green;
+        green = *this->m_trans_expK_mat * green;
     }
 
 
     void ModelBase::link()
     {
+        // allocate the buffers for the dense multiplications
+        this->m_is_checkerboard = false;
+        for (auto& buffer : this->m_product_buffer) { buffer.resize(this->m_space_size, this->m_space_size); }
+        for (auto& buffer : this->m_expV_buffer) { buffer.resize(this->m_space_size); }
+
         this->m_mult_expK_from_left       = std::bind(&ModelBase::mult_expK_from_left, this, std::placeholders::_1);
         this->m_mult_expK_from_right      = std::bind(&ModelBase::mult_expK_from_right, this, std::placeholders::_1);
         this->m_mult_inv_expK_from_left   = std::bind(&ModelBase::mult_inv_expK_from_left, this, std::placeholders::_1);
         this->m_mult_inv_expK_from_right  = std::bind(&ModelBase::mult_inv_expK_from_right, this, std::placeholders::_1);
         this->m_mult_trans_expK_from_left = std::bind(&ModelBase::mult_trans_expK_from_left, this, std::placeholders::_1);
+
+        // the dense products with expV are performed by the model itself
+        this->m_mult_diag_expK_from_left       = nullptr;
+        this->m_mult_diag_expK_from_right      = nullptr;
+        this->m_mult_inv_expK_diag_from_left   = nullptr;
+        this->m_mult_inv_expK_diag_from_right  = nullptr;
+        this->m_mult_trans_expK_diag_from_left = nullptr;
     }
 
 
     void ModelBase::link( const CheckerBoardBase& checkerboard )
     {
+        // the checkerboard breakups are performed in place, and only the diagonal buffers are required
+        this->m_is_checkerboard = true;
+        for (auto& buffer : this->m_product_buffer) { buffer.resize(0, 0); }
+        for (auto& buffer : this->m_expV_buffer) { buffer.resize(this->m_space_size); }
+
         this->m_mult_expK_from_left       = std::bind(&CheckerBoardBase::mult_expK_from_left, &checkerboard, std::placeholders::_1);
         this->m_mult_expK_from_right      = std::bind(&CheckerBoardBase::mult_expK_from_right, &checkerboard, std::placeholders::_1);
         this->m_mult_inv_expK_from_left   = std::bind(&CheckerBoardBase::mult_inv_expK_from_left, &checkerboard, std::placeholders::_1);
         this->m_mult_inv_expK_from_right  = std::bind(&CheckerBoardBase::mult_inv_expK_from_right, &checkerboard, std::placeholders::_1);
         this->m_mult_trans_expK_from_left = std::bind(&CheckerBoardBase::mult_trans_expK_from_left, &checkerboard, std::placeholders::_1);
+
+        this->m_mult_diag_expK_from_left       = std::bind(&CheckerBoardBase::mult_diag_expK_from_left, &checkerboard, 
+                                                           std::placeholders::_1, std::placeholders::_2);
+        this->m_mult_diag_expK_from_right      = std::bind(&CheckerBoardBase::mult_diag_expK_from_right, &checkerboard, 
+                                                           std::placeholders::_1, std::placeholders::_2);
+        this->m_mult_inv_expK_diag_from_left   = std::bind(&CheckerBoardBase::mult_inv_expK_diag_from_left, &checkerboard, 
+                                                           std::placeholders::_1, std::placeholders::_2);
+        this->m_mult_inv_expK_diag_from_right  = std::bind(&CheckerBoardBase::mult_inv_expK_diag_from_right, &checkerboard, 
+                                                           std::placeholders::_1, std::placeholders::_2);
+        this->m_mult_trans_expK_diag_from_left = std::bind(&CheckerBoardBase::mult_trans_expK_diag_from_left, &checkerboard, 
+                                                           std::placeholders::_1, std::placeholders::_2);
+    }
+
+
+
+    // the diagonal matrix expV multiplied from the left ( right ) scales the rows ( columns ) of a matrix.
+    // for the checkerboard breakups the scaling is performed within the breakups,
+    // while for the dense exponent of K it costs one O(N^2) pass besides the gemm,
+    // which is either a coefficient-wise scaling in place or folded into the copy of the product back to G.
+    // the buffers of spin up and spin down are labeled by 0 and 1 respectively.
+
+    const Vector& ModelBase::expV_diagonal( TimeIndex time_index, Spin spin, bool is_inverse ) const
+    {
+        Vector& diag = this->m_expV_buffer[( spin == +1 )? 0 : 1];
+        this->fill_expV_diagonal( time_index, spin, is_inverse, diag );
+        return diag;
+    }
+
+    void ModelBase::mult_expV_expK_from_left( GreensFunc& green, TimeIndex time_index, Spin spin ) const
+    {
+        assert( green.rows() == this->m_space_size && green.cols() == this->m_space_size );
+        const Vector& expV = this->expV_diagonal( time_index, spin, false );
+        if ( this->m_is_checkerboard ) {
+            this->m_mult_diag_expK_from_left( green, expV );
+        }
+        else {
+            Matrix& product = this->m_product_buffer[( spin == +1 )? 0 : 1];
+            product.noalias() = *this->m_expK_mat * green;
+            green.noalias() = expV.asDiagonal() * product;
+        }
+    }
+
+    void ModelBase::mult_expV_expK_from_right( GreensFunc& green, TimeIndex time_index, Spin spin ) const
+    {
+        assert( green.rows() == this->m_space_size && green.cols() == this->m_space_size );
+        const Vector& expV = this->expV_diagonal( time_index, spin, false );
+        if ( this->m_is_checkerboard ) {
+            this->m_mult_diag_expK_from_right( green, expV );
+        }
+        else {
+            Matrix& product = this->m_product_buffer[( spin == +1 )? 0 : 1];
+            green.array().rowwise() *= expV.transpose().array();
+            product.noalias() = green * (*this->m_expK_mat);
+            green.swap( product );
+        }
+    }
+
+    void ModelBase::mult_inv_expK_expV_from_left( GreensFunc& green, TimeIndex time_index, Spin spin ) const
+    {
+        assert( green.rows() == this->m_space_size && green.cols() == this->m_space_size );
+        const Vector& inv_expV = this->expV_diagonal( time_index, spin, true );
+        if ( this->m_is_checkerboard ) {
+            this->m_mult_inv_expK_diag_from_left( green, inv_expV );
+        }
+        else {
+            Matrix& product = this->m_product_buffer[( spin == +1 )? 0 : 1];
+            green.array().colwise() *= inv_expV.array();
+            product.noalias() = *this->m_inv_expK_mat * green;
+            green.swap( product );
+        }
+    }
+
+    void ModelBase::mult_inv_expK_expV_from_right( GreensFunc& green, TimeIndex time_index, Spin spin ) const
+    {
+        assert( green.rows() == this->m_space_size && green.cols() == this->m_space_size );
+        const Vector& inv_expV = this->expV_diagonal( time_index, spin, true );
+        if ( this->m_is_checkerboard ) {
+            this->m_mult_inv_expK_diag_from_right( green, inv_expV );
+        }
+        else {
+            Matrix& product = this->m_product_buffer[( spin == +1 )? 0 : 1];
+            product.noalias() = green * (*this->m_inv_expK_mat);
+            green.noalias() = product * inv_expV.asDiagonal();
+        }
+    }
+
+    void ModelBase::mult_trans_expK_expV_from_left( GreensFunc& green, TimeIndex time_index, Spin spin ) const
+    {
+        assert( green.rows() == this->m_space_size && green.cols() == this->m_space_size );
+        const Vector& expV = this->expV_diagonal( time_index, spin, false );
+        if ( this->m_is_checkerboard ) {
+            this->m_mult_trans_expK_diag_from_left( green, expV );
+        }
+        else {
+            Matrix& product = this->m_product_buffer[( spin == +1 )? 0 : 1];
+            green.array().colwise() *= expV.array();
+            product.noalias() = *this->m_trans_expK_mat * green;
+            green.swap( product );
+        }
+    }
+
+
+
+    void ModelBase::gemm_batched( const std::array<const Matrix*, 2>& a, 
+                                  const std::array<const Matrix*, 2>& b, 
+                                  const std::array<Matrix*, 2>& c )
+    {
+        // one group of two square products with identical shapes, in the column-major layout of eigen
+        const MKL_INT size = a[0]->rows();
+        const MKL_INT group_size = 2;
+        const CBLAS_TRANSPOSE trans = CblasNoTrans;
+        const double alpha = 1.0;
+        const double beta = 0.0;
+        const double* a_array[2] = { a[0]->data(), a[1]->data() };
+        const double* b_array[2] = { b[0]->data(), b[1]->data() };
+        double* c_array[2] = { c[0]->data(), c[1]->data() };
+        for (auto s = 0; s < 2; ++s) {
+            assert( a[s]->rows() == size && a[s]->cols() == size );
+            assert( b[s]->rows() == size && b[s]->cols() == size );
+            assert( c[s]->rows() == size && c[s]->cols() == size );
+        }
+
+        cblas_dgemm_batch( CblasColMajor, &trans, &trans, &size, &size, &size, 
+                           &alpha, a_array, &size, b_array, &size, &beta, c_array, &size, 1, &group_size );
+    }
+
+
+    void ModelBase::wrap_forwards_batched( GreensFunc& green_up, GreensFunc& green_dn, TimeIndex time_index ) const
+    {
+        assert( &green_up != &green_dn );
+        if ( this->m_is_checkerboard ) {
+            this->mult_B_from_left( green_up, time_index, +1 );
+            this->mult_invB_from_right( green_up, time_index, +1 );
+            this->mult_B_from_left( green_dn, time_index, -1 );
+            this->mult_invB_from_right( green_dn, time_index, -1 );
+            return;
+        }
+
+        // the same products as mult_B_from_left() and mult_invB_from_right() of the dense path,
+        // with the exponents of K shared by the two spin sectors
+        // G  ->  expV * ( expK * G )
+        gemm_batched( { this->m_expK_mat.get(), this->m_expK_mat.get() }, 
+                      { &green_up, &green_dn }, 
+                      { &this->m_product_buffer[0], &this->m_product_buffer[1] } );
+        for (auto s = 0; s < 2; ++s) {
+            const Spin spin = ( s == 0 )? +1 : -1;
+            this->m_product_buffer[s].array().colwise() *= this->expV_diagonal( time_index, spin, false ).array();
+        }
+
+        // G  ->  ( G * expK^-1 ) * expV^-1
+        gemm_batched( { &this->m_product_buffer[0], &this->m_product_buffer[1] }, 
+                      { this->m_inv_expK_mat.get(), this->m_inv_expK_mat.get() }, 
+                      { &green_up, &green_dn } );
+        green_up.array().rowwise() *= this->expV_diagonal( time_index, +1, true ).transpose().array();
+        green_dn.array().rowwise() *= this->expV_diagonal( time_index, -1, true ).transpose().array();
+    }
+
+
+    void ModelBase::wrap_backwards_batched( GreensFunc& green_up, GreensFunc& green_dn, TimeIndex time_index ) const
+    {
+        assert( &green_up != &green_dn );
+        if ( this->m_is_checkerboard ) {
+            this->mult_B_from_right( green_up, time_index, +1 );
+            this->mult_invB_from_left( green_up, time_index, +1 );
+            this->mult_B_from_right( green_dn, time_index, -1 );
+            this->mult_invB_from_left( green_dn, time_index, -1 );
+            return;
+        }
+
+        // the same products as mult_B_from_right() and mult_invB_from_left() of the dense path,
+        // with the exponents of K shared by the two spin sectors
+        // G  ->  ( G * expV ) * expK
+        green_up.array().rowwise() *= this->expV_diagonal( time_index, +1, false ).transpose().array();
+        green_dn.array().rowwise() *= this->expV_diagonal( time_index, -1, false ).transpose().array();
+        gemm_batched( { &green_up, &green_dn }, 
+                      { this->m_expK_mat.get(), this->m_expK_mat.get() }, 
+                      { &this->m_product_buffer[0], &this->m_product_buffer[1] } );
+
+        // G  ->  expK^-1 * ( expV^-1 * G )
+        for (auto s = 0; s < 2; ++s) {
+            const Spin spin = ( s == 0 )? +1 : -1;
+            this->m_product_buffer[s].array().colwise() *= this->expV_diagonal( time_index, spin, true ).array();
+        }
+        gemm_batched( { this->m_inv_expK_mat.get(), this->m_inv_expK_mat.get() }, 
+                      { &this->m_product_buffer[0], &this->m_product_buffer[1] }, 
+                      { &green_up, &green_dn } );
     }
 
 
@@ -2,11 +2,74 @@
 
 namespace Utils {
 
-    // initialization of the static member
-    std::default_random_engine Random::Engine( time(nullptr) );
+    void Philox::set_key( std::uint32_t seed, std::uint32_t rank, std::uint32_t stream ) {
+        this->m_key = { seed, rank };
+        this->m_stream = stream;
+        this->m_block_counter = 0;
+        this->m_buffer_pos = 4;
+    }
+
+
+    Philox::Block Philox::philox4x32_10( Block counter, Key key ) {
+        // multipliers and Weyl increments of the key schedule
+        constexpr std::uint64_t M0 = 0xD2511F53, M1 = 0xCD9E8D57;
+        constexpr std::uint32_t W0 = 0x9E3779B9, W1 = 0xBB67AE85;
+
+        for (auto round = 0; round < 10; ++round) {
+            const std::uint64_t product0 = M0 * counter[0];
+            const std::uint64_t product1 = M1 * counter[2];
+            counter = { (std::uint32_t)(product1 >> 32) ^ counter[1] ^ key[0],
+                        (std::uint32_t)product1,
+                        (std::uint32_t)(product0 >> 32) ^ counter[3] ^ key[1],
+                        (std::uint32_t)product0 };
+            key[0] += W0;
+            key[1] += W1;
+        }
+        return counter;
+    }
+
+
+    Philox::Block Philox::next_block() {
+        const Block counter = { (std::uint32_t)this->m_block_counter,
+                                (std::uint32_t)(this->m_block_counter >> 32),
+                                this->m_stream, 0 };
+        ++this->m_block_counter;
+        return philox4x32_10( counter, this->m_key );
+    }
+
+
+    Philox::result_type Philox::operator()() {
+        if ( this->m_buffer_pos == 4 ) {
+            this->m_buffer = this->next_block();
+            this->m_buffer_pos = 0;
+        }
+        return this->m_buffer[this->m_buffer_pos++];
+    }
+
+
+    // 53 random bits out of two words, scaled by 2^-53
+    static inline double to_uniform( std::uint32_t high, std::uint32_t low ) {
+        return ( (std::uint64_t)(high >> 5) * 67108864.0 + (low >> 6) ) * ( 1.0 / 9007199254740992.0 );
+    }
+
+
+    double Philox::uniform() {
+        const std::uint32_t high = (*this)();
+        const std::uint32_t low = (*this)();
+        return to_uniform( high, low );
+    }
+
 
-    void Random::set_seed( const int seed ) {
-        Engine.seed( seed );
+    void Philox::fill_uniform( double* data, int size ) {
+        int i = 0;
+        for ( ; i + 1 < size; i += 2 ) {
+            const Block block = this->next_block();
+            data[i] = to_uniform( block[0], block[1] );
+            data[i+1] = to_uniform( block[2], block[3] );
+        }
+        if ( i < size ) {
+            data[i] = this->uniform();
+        }
     }
 
 } // namespace Utils
@@ -0,0 +1,172 @@
+#include "replica_exchange.h"
+#include "dqmc_walker.h"
+#include "model/model_base.h"
+#include "lattice/lattice_base.h"
+#include "random.h"
+
+#include <cmath>
+#include <algorithm>
+#include <iostream>
+#include <functional>
+#include <boost/mpi/collectives.hpp>
+#include <boost/mpi/nonblocking.hpp>
+
+
+namespace QuantumMonteCarlo {
+
+    using RealScalar = double;
+    using Vector = Eigen::VectorXd;
+
+
+    const std::string_view ReplicaExchange::ParameterName() const
+    {
+        switch ( this->m_parameter ) {
+            case Parameter::OnSiteU:            return "onsite_u";
+            case Parameter::ChemicalPotential:  return "chemical_potential";
+            case Parameter::Beta:               return "beta";
+        }
+        return "";
+    }
+
+
+    const double ReplicaExchange::AcceptanceRate( int i ) const
+    {
+        assert( i >= 0 && i < this->ReplicasNum()-1 );
+        return ( this->m_attempts[i] > 0 )? (double)this->m_accepts[i] / this->m_attempts[i] : 0.0;
+    }
+
+
+    void ReplicaExchange::set_params( Parameter parameter, const std::vector<double>& values, int exchange_interval )
+    {
+        assert( !values.empty() );
+        assert( exchange_interval >= 1 );
+        this->m_parameter = parameter;
+        this->m_values = values;
+        this->m_exchange_interval = exchange_interval;
+    }
+
+
+    void ReplicaExchange::initial( const boost::mpi::communicator& world )
+    {
+        const int replicas_num = this->ReplicasNum();
+        if ( world.size() % replicas_num != 0 ) {
+            std::cerr << "QuantumMonteCarlo::ReplicaExchange::initial(): "
+                      << "the number of processes should be a multiple of the number of replicas." << std::endl;
+            exit(1);
+        }
+
+        // consecutive ranks form a chain of replicas, ordered by the replica index
+        this->m_replica = world.rank() % replicas_num;
+        this->m_chain = world.rank() / replicas_num;
+        this->m_chain_comm = world.split( this->m_chain, this->m_replica );
+        this->m_replica_comm = world.split( this->m_replica, this->m_chain );
+
+        this->m_sweep_count = 0;
+        this->m_round_count = 0;
+        this->m_attempts.assign( std::max(replicas_num-1, 0), 0 );
+        this->m_accepts.assign( std::max(replicas_num-1, 0), 0 );
+    }
+
+
+    void ReplicaExchange::set_replica_params( ModelBase& model, DqmcWalker& walker ) const
+    {
+        if ( walker.WalkerPoolSize() > 1 ) {
+            std::cerr << "QuantumMonteCarlo::ReplicaExchange::set_replica_params(): "
+                      << "the replica exchanges and the walker pool can not be enabled at the same time." << std::endl;
+            exit(1);
+        }
+
+        const double value = this->m_values[this->m_replica];
+        switch ( this->m_parameter ) {
+            case Parameter::OnSiteU:
+                model.set_model_params( model.HoppingT(), value, model.ChemicalPotential() );
+                break;
+            case Parameter::ChemicalPotential:
+                model.set_model_params( model.HoppingT(), model.OnSiteU(), value );
+                break;
+            case Parameter::Beta:
+                // the number of time slices is kept fixed, so that the fields of the replicas have the same shape
+                walker.set_physical_params( value, walker.TimeSize() );
+                break;
+        }
+    }
+
+
+    /*
+     *  Swap of the configurations x_i and x_j of the neighbouring replicas i and j = i+1,
+     *  accepted with the probability
+     *      min{ 1, W_i(x_j) * W_j(x_i) / ( W_i(x_i) * W_j(x_j) ) } ,
+     *  where W is the absolute weight of the configuration with the parameters of the replica.
+     *  Each process evaluates its own weight for both configurations, after the fields are exchanged,
+     *  and the lower replica makes the decision with its own random engine.
+     *  The rejected exchanges are undone by restoring the original fields,
+     *  together with the svd stacks and the greens functions saved before the trial.
+     */
+    void ReplicaExchange::exchange( DqmcWalker& walker, ModelBase& model, const LatticeBase& lattice )
+    {
+        if ( ++this->m_sweep_count % this->m_exchange_interval != 0 ) { return; }
+        const int parity = this->m_round_count++ % 2;
+
+        // pair up with the neighbouring replica of this round, if any
+        const int partner = ( this->m_replica % 2 == parity )? this->m_replica + 1 : this->m_replica - 1;
+        if ( partner < 0 || partner >= this->ReplicasNum() ) { return; }
+        const bool is_lower = ( this->m_replica < partner );
+
+        // weight of the own configurations, read off from the current svd stacks
+        const Vector own_fields = model.BosonicFields();
+        const RealScalar log_weight_own = walker.LogFermionWeight() + model.LogBosonicWeight();
+
+        // exchange the fields with the partner
+        Vector partner_fields( own_fields.size() );
+        boost::mpi::request requests[2];
+        requests[0] = this->m_chain_comm.isend( partner, 0, own_fields.data(), own_fields.size() );
+        requests[1] = this->m_chain_comm.irecv( partner, 0, partner_fields.data(), partner_fields.size() );
+        boost::mpi::wait_all( requests, requests + 2 );
+
+        // weight of the partner's configurations with the parameters of this replica,
+        // with the stacks and greens functions of the own configurations kept aside
+        walker.save_configurations();
+        model.set_bosonic_fields( partner_fields );
+        walker.refresh_configurations( lattice, model );
+        const RealScalar log_weight_cross = walker.LogFermionWeight() + model.LogBosonicWeight();
+
+        bool is_accepted = false;
+        if ( is_lower ) {
+            RealScalar partner_log_weights[2];
+            this->m_chain_comm.recv( partner, 1, partner_log_weights, 2 );
+            const RealScalar log_ratio = ( log_weight_cross + partner_log_weights[1] )
+                                       - ( log_weight_own + partner_log_weights[0] );
+            is_accepted = ( walker.RandomEngine().uniform() < std::exp( std::min(0.0, log_ratio) ) );
+            this->m_chain_comm.send( partner, 2, is_accepted );
+
+            ++this->m_attempts[this->m_replica];
+            if ( is_accepted ) { ++this->m_accepts[this->m_replica]; }
+        }
+        else {
+            const RealScalar log_weights[2] = { log_weight_own, log_weight_cross };
+            this->m_chain_comm.send( partner, 1, log_weights, 2 );
+            this->m_chain_comm.recv( partner, 2, is_accepted );
+        }
+
+        // the greens functions of the partner's fields are ready if accepted,
+        // otherwise roll back to the own fields together with the saved stacks and greens functions
+        if ( !is_accepted ) {
+            model.set_bosonic_fields( own_fields );
+            walker.restore_configurations();
+        }
+    }
+
+
+    void ReplicaExchange::gather_statistics( const boost::mpi::communicator& world )
+    {
+        const int pairs_num = this->m_attempts.size();
+        if ( pairs_num == 0 ) { return; }
+
+        std::vector<int> attempts( pairs_num ), accepts( pairs_num );
+        boost::mpi::all_reduce( world, this->m_attempts.data(), pairs_num, attempts.data(), std::plus<int>() );
+        boost::mpi::all_reduce( world, this->m_accepts.data(), pairs_num, accepts.data(), std::plus<int>() );
+        this->m_attempts = attempts;
+        this->m_accepts = accepts;
+    }
+
+} // namespace QuantumMonteCarlo
@@ -12,13 +12,23 @@ namespace Utils {
     using Matrix = Eigen::MatrixXd;
     using Vector = Eigen::VectorXd;
 
-    SvdStack::SvdStack(int mat_dim, int stack_length) 
+    SvdStack::SvdStack(int mat_dim, int stack_length, Decomposition decomposition) 
                 : m_mat_dim(mat_dim), 
-                  m_tmp_matrix(mat_dim, mat_dim)
+                  m_tmp_matrix(mat_dim, mat_dim),
+                  m_decomposition(decomposition)
     {
         this->m_stack.reserve(stack_length);
+        this->m_v_prods.reserve(stack_length);
         for (int i = 0; i < stack_length; ++i) {
             this->m_stack.emplace_back(mat_dim);
+            this->m_v_prods.emplace_back(mat_dim, mat_dim);
+        }
+
+        // allocate the workspace for the chosen decomposition method
+        switch ( this->m_decomposition ) {
+            case Decomposition::SVD:       this->m_svd_workspace.resize(mat_dim, mat_dim); break;
+            case Decomposition::QRP:       this->m_qrp_workspace.resize(mat_dim); break;
+            case Decomposition::JacobiSVD: this->m_jacobi_svd_workspace.resize(mat_dim); break;
         }
     }
 
@@ -28,6 +38,10 @@ namespace Utils {
 
     int SvdStack::StackLength() const { return this->m_stack_length; }
 
+    Decomposition SvdStack::DecompositionMethod() const { return this->m_decomposition; }
+
+    bool SvdStack::isOrthogonalV() const { return this->m_decomposition != Decomposition::QRP; }
+
     void SvdStack::clear() { this->m_stack_length = 0; }
 
 
@@ -35,31 +49,47 @@ namespace Utils {
         assert( matrix.rows() == this->m_mat_dim && matrix.cols() == this->m_mat_dim );
         assert( this->m_stack_length < (int)this->m_stack.size() );
 
+        // the decompositions are performed using the persistent workspace,
+        // and no memory is allocated during the push
         if (this->m_stack_length == 0) {
             // udv decomposition
-            Utils::LinearAlgebra::mkl_lapack_dgesvd (
-                this->m_mat_dim, 
-                this->m_mat_dim, 
-                matrix, 
-                this->m_stack[this->m_stack_length].MatrixU(), 
-                this->m_stack[this->m_stack_length].SingularValues(), 
-                this->m_stack[this->m_stack_length].MatrixV() );
+            this->decompose(matrix, this->m_stack[this->m_stack_length]);
+            this->m_v_prods[this->m_stack_length] = this->m_stack[this->m_stack_length].MatrixV();
         }
         else {
             // important! mind the order of multiplication!
             // Avoid mixing of different numerical scales here
-            this->m_tmp_matrix = ( matrix * this->MatrixU() ) * this->SingularValues().asDiagonal();
-            Utils::LinearAlgebra::mkl_lapack_dgesvd (
-                this->m_mat_dim, 
-                this->m_mat_dim, 
-                this->m_tmp_matrix, 
-                this->m_stack[this->m_stack_length].MatrixU(), 
-                this->m_stack[this->m_stack_length].SingularValues(), 
-                this->m_stack[this->m_stack_length].MatrixV() );
+            SvdClass& top = this->m_stack[this->m_stack_length-1];
+            this->m_tmp_matrix.noalias() = matrix * top.MatrixU();
+            this->m_tmp_matrix.array().rowwise() *= top.SingularValues().transpose().array();
+            this->decompose(this->m_tmp_matrix, this->m_stack[this->m_stack_length]);
+
+            // accumulate the v matrices, and only one matrix product is needed for each push
+            this->m_v_prods[this->m_stack_length].noalias() 
+                = this->m_v_prods[this->m_stack_length-1] * this->m_stack[this->m_stack_length].MatrixV();
         }
         this->m_stack_length += 1;
     }
 
+    void SvdStack::decompose(const Matrix& matrix, SvdClass& udv) {
+        switch ( this->m_decomposition ) {
+            case Decomposition::SVD:
+                Utils::LinearAlgebra::mkl_lapack_dgesvd( this->m_svd_workspace, matrix, 
+                                                         udv.MatrixU(), udv.SingularValues(), udv.MatrixV() );
+                break;
+
+            case Decomposition::QRP:
+                Utils::LinearAlgebra::mkl_lapack_dgeqp3( this->m_qrp_workspace, matrix, 
+                                                         udv.MatrixU(), udv.SingularValues(), udv.MatrixV() );
+                break;
+
+            case Decomposition::JacobiSVD:
+                Utils::LinearAlgebra::mkl_lapack_dgesvj( this->m_jacobi_svd_workspace, matrix, 
+                                                         udv.MatrixU(), udv.SingularValues(), udv.MatrixV() );
+                break;
+        }
+    }
+
     void SvdStack::pop() {
         // caution that the memory is not actually released
         assert(this->m_stack_length > 0);
@@ -67,23 +97,20 @@ namespace Utils {
     }
 
 
-    const Vector SvdStack::SingularValues() {
+    const Vector& SvdStack::SingularValues() const {
         assert(this->m_stack_length > 0);
         return this->m_stack[this->m_stack_length-1].SingularValues();
     }
 
-    const Matrix SvdStack::MatrixU() {
+    const Matrix& SvdStack::MatrixU() const {
         assert(this->m_stack_length > 0);
         return this->m_stack[this->m_stack_length-1].MatrixU();
     }
 
-    const Matrix SvdStack::MatrixV() {
+    const Matrix& SvdStack::MatrixV() const {
+        // the accumulated product V_0 * V_1 * ... is cached during push()
         assert(this->m_stack_length > 0);
-        Matrix r = this->m_stack[0].MatrixV();
-        for (int i = 1; i < this->m_stack_length; ++i) {
-            r = r * this->m_stack[i].MatrixV();
-        }
-        return r;
+        return this->m_v_prods[this->m_stack_length-1];
     }
 
 
@@ -0,0 +1,132 @@
+/**
+  *  Unit test of the multiplications of the B matrices B(t) = expV(t) * expK by the models,
+  *  where the diagonal expV(t) is fused into the dense gemm path or into the checkerboard kernels.
+  *  The products B * G, G * B, B^-1 * G, G * B^-1 and B^T * G, as well as the batched wraps of both spin sectors,
+  *  are compared with the unfused products expV * ( expK * G ) of the same exponent of K.
+  */
+
+#include <array>
+#include <functional>
+#include "test_utils.h"
+
+#define EIGEN_USE_MKL_ALL
+#define EIGEN_VECTORIZE_SSE4_2
+#include <unsupported/Eigen/MatrixFunctions>
+
+
+int main() {
+
+    using Matrix = Eigen::MatrixXd;
+    using Vector = Eigen::VectorXd;
+
+    auto config = []( const std::string& model, const std::string& lattice, const std::string& cell,
+                      const std::string& checkerboard, const std::string& method ) {
+        return TestUtils::write_config( "test_b_matrices_" + model + "_" + lattice + "_" + method, R"(
+            [Model]
+                type = ")" + model + R"("
+                [Model.Params]
+                hopping_t = 1.0
+                onsite_u = 4.0
+                chemical_potential = -0.5
+            [Lattice]
+                type = ")" + lattice + R"("
+                cell = )" + cell + R"(
+                momentum = "MPoint"
+                momentum_list = "KstarsAll"
+            [CheckerBoard]
+                whether_or_not = )" + checkerboard + R"(
+                method = ")" + method + R"("
+                sparse_threshold = 1e-12
+            [MonteCarlo]
+                beta = 4.0
+                time_size = 40
+                stabilization_pace = 10
+            [Measure]
+                observables = [ "none" ]
+        )" );
+    };
+
+    const std::array<std::array<std::string, 5>, 5> cases {{
+        { "RepulsiveHubbard",  "Square", "[ 6, 6 ]",    "false", "breakups" },
+        { "AttractiveHubbard", "Square", "[ 6, 6 ]",    "false", "breakups" },
+        { "RepulsiveHubbard",  "Square", "[ 6, 6 ]",    "true",  "breakups" },
+        { "AttractiveHubbard", "Cubic",  "[ 4, 4, 4 ]", "true",  "breakups" },
+        { "RepulsiveHubbard",  "Square", "[ 6, 6 ]",    "true",  "sparse" },
+    }};
+
+    for ( const auto& [model_type, lattice, cell, is_checkerboard, method] : cases ) {
+        TestUtils::Modules modules;
+        modules.parse( config( model_type, lattice, cell, is_checkerboard, method ) );
+        modules.initial( 12345 );
+        const auto& model = *modules.model;
+        const int space_size = modules.lattice->SpaceSize();
+        const std::string label = " of " + model_type + " on the " + cell + " " + lattice + " lattice"
+                                + ( ( is_checkerboard == "true" )? " by the " + method + " method" : " by dense expK" );
+
+        // the exponent of K used by the model, namely the product of the breakups for the checkerboard,
+        // and the exact exponent with K = - t * H + mu * I otherwise
+        Matrix expK, inv_expK;
+        if ( modules.checkerboard ) {
+            expK = inv_expK = Matrix::Identity( space_size, space_size );
+            modules.checkerboard->mult_expK_from_right( expK );
+            modules.checkerboard->mult_inv_expK_from_right( inv_expK );
+        }
+        else {
+            const double dt = modules.walker->TimeInterval();
+            const Matrix Kmat = -model.HoppingT() * modules.lattice->HoppingMatrix()
+                              + model.ChemicalPotential() * Matrix::Identity(space_size, space_size);
+            expK = ( -dt * Kmat ).exp();
+            inv_expK = ( +dt * Kmat ).exp();
+        }
+
+        // one time slice in the bulk and the slice 0 labeling tau = beta
+        for ( const int time_index : { 7, 0 } ) {
+            std::array<Matrix, 2> B, inv_B;
+            for ( const int spin : { +1, -1 } ) {
+                Vector expV, inv_expV;
+                model.fill_expV_diagonal( time_index, spin, false, expV );
+                model.fill_expV_diagonal( time_index, spin, true, inv_expV );
+                B[( spin == +1 )? 0 : 1] = expV.asDiagonal() * expK;
+                inv_B[( spin == +1 )? 0 : 1] = inv_expK * inv_expV.asDiagonal();
+
+                const Matrix green = Matrix::Random( space_size, space_size );
+                const Matrix& b = B[( spin == +1 )? 0 : 1];
+                const Matrix& inv_b = inv_B[( spin == +1 )? 0 : 1];
+                const std::array<std::tuple<std::string, std::function<void(Matrix&)>, Matrix>, 5> products {{
+                    { "B * G",    [&]( Matrix& m ) { model.mult_B_from_left( m, time_index, spin ); },      expV.asDiagonal() * ( expK * green ) },
+                    { "G * B",    [&]( Matrix& m ) { model.mult_B_from_right( m, time_index, spin ); },     green * b },
+                    { "B^-1 * G", [&]( Matrix& m ) { model.mult_invB_from_left( m, time_index, spin ); },   inv_b * green },
+                    { "G * B^-1", [&]( Matrix& m ) { model.mult_invB_from_right( m, time_index, spin ); },  green * inv_b },
+                    { "B^T * G",  [&]( Matrix& m ) { model.mult_transB_from_left( m, time_index, spin ); }, b.transpose() * green },
+                }};
+
+                for ( const auto& [name, mult, reference] : products ) {
+                    Matrix result = green;
+                    mult( result );
+                    TestUtils::check_close( ( result - reference ).norm() / reference.norm(), 1e-12,
+                                            ( boost::format("%s at t = %d, spin = %+d") % name % time_index % spin ).str() + label );
+                }
+            }
+
+            // batched wraps of both spin sectors
+            const std::array<Matrix, 2> green = { Matrix::Random( space_size, space_size ), Matrix::Random( space_size, space_size ) };
+            Matrix forwards_up = green[0], forwards_dn = green[1];
+            Matrix backwards_up = green[0], backwards_dn = green[1];
+            model.wrap_forwards_batched( forwards_up, forwards_dn, time_index );
+            model.wrap_backwards_batched( backwards_up, backwards_dn, time_index );
+
+            const std::array<std::tuple<std::string, Matrix, Matrix>, 4> wraps {{
+                { "B * G * B^-1 of spin up",   forwards_up,  B[0] * green[0] * inv_B[0] },
+                { "B * G * B^-1 of spin down", forwards_dn,  B[1] * green[1] * inv_B[1] },
+                { "B^-1 * G * B of spin up",   backwards_up, inv_B[0] * green[0] * B[0] },
+                { "B^-1 * G * B of spin down", backwards_dn, inv_B[1] * green[1] * B[1] },
+            }};
+            for ( const auto& [name, result, reference] : wraps ) {
+                TestUtils::check_close( ( result - reference ).norm() / reference.norm(), 1e-12,
+                                        ( boost::format("batched wrap %s at t = %d") % name % time_index ).str() + label );
+            }
+        }
+    }
+
+    return TestUtils::report();
+}
@@ -0,0 +1,112 @@
+/**
+  *  Unit test of the binary container of the observable bins, Utils::BinaryBins and Utils::BinsReader.
+  *  The bins of scalar, vector and matrix observables written by DqmcIO should be read back
+  *  from the memory-mapped file bit by bit, together with the shapes and the names in the header.
+  */
+
+#include <cstdint>
+#include <random>
+#include <filesystem>
+#include "test_utils.h"
+#include "dqmc_io.h"
+#include "utils/binary_bins.hpp"
+
+
+// write the bins of the observable into the temporary folder and map the file back
+template<typename ObsType>
+std::string write_bins( const Observable::Observable<ObsType>& obs )
+{
+    const std::string file = ( std::filesystem::temp_directory_path() / ( obs.name() + ".bins.bin" ) ).string();
+    std::ofstream outfile( file, std::ios::trunc | std::ios::binary );
+    QuantumMonteCarlo::DqmcIO::output_observable_in_binary_bins( outfile, obs );
+    outfile.close();
+    return file;
+}
+
+// check the header of the mapped file and the alignment of the data
+void check_header( const Utils::BinsReader& reader, const std::string& name, int rank, int rows, int cols, int bin_num )
+{
+    TestUtils::check( reader.name() == name && reader.rank() == rank, "name and rank of \'" + name + "\'" );
+    TestUtils::check( reader.rows() == rows && reader.cols() == cols && reader.bin_num() == bin_num,
+                      ( boost::format("shape %dx%d and %d bins of \'%s\'") % rows % cols % bin_num % name ).str() );
+    TestUtils::check( reinterpret_cast<std::uintptr_t>( reader.bins().data() ) % Utils::BinaryBins::alignment == 0,
+                      "data of \'" + name + "\' aligned to 64 bytes" );
+}
+
+
+int main() {
+
+    std::mt19937 engine( 12345 );
+    std::normal_distribution<double> normal( 0.0, 1.0 );
+    const int bin_num = 7;
+
+    // ---------------------------------------  Scalar observable  -----------------------------------------
+    {
+        Observable::ScalarObs obs( bin_num );
+        obs.set_name_and_description( "scalar_obs", "Scalar observable" );
+        obs.set_zero_element( 0.0 );
+        obs.allocate();
+        for ( auto& bin : obs.bin_data() ) { bin = normal(engine); }
+
+        const Utils::BinsReader reader( write_bins(obs) );
+        check_header( reader, "scalar_obs", 0, 1, 1, bin_num );
+        bool is_identical = true;
+        for ( auto bin = 0; bin < bin_num; ++bin ) {
+            is_identical = is_identical && ( reader.scalar(bin) == obs.bin_data(bin) )
+                                        && ( reader.bins()(0, bin) == obs.bin_data(bin) );
+        }
+        TestUtils::check( is_identical, "bins of the scalar observable read back exactly" );
+    }
+
+    // ---------------------------------------  Vector observable  -----------------------------------------
+    {
+        const int size = 13;
+        Observable::VectorObs obs( bin_num );
+        obs.set_name_and_description( "vector_observable_with_a_longer_name", "Vector observable" );
+        obs.set_zero_element( Eigen::VectorXd::Zero(size) );
+        obs.allocate();
+        for ( auto& bin : obs.bin_data() ) { bin = Eigen::VectorXd::NullaryExpr( size, [&](){ return normal(engine); } ); }
+
+        const Utils::BinsReader reader( write_bins(obs) );
+        check_header( reader, "vector_observable_with_a_longer_name", 1, size, 1, bin_num );
+        bool is_identical = true;
+        for ( auto bin = 0; bin < bin_num; ++bin ) {
+            is_identical = is_identical && ( reader.bin(bin) == obs.bin_data(bin) )
+                                        && ( reader.bins().col(bin) == obs.bin_data(bin) );
+        }
+        TestUtils::check( is_identical, "bins of the vector observable read back exactly" );
+    }
+
+    // ---------------------------------------  Matrix observable  -----------------------------------------
+    {
+        const int rows = 5, cols = 3;
+        Observable::MatrixObs obs( bin_num );
+        obs.set_name_and_description( "matrix_obs", "Matrix observable" );
+        obs.set_zero_element( Eigen::MatrixXd::Zero(rows, cols) );
+        obs.allocate();
+        for ( auto& bin : obs.bin_data() ) { bin = Eigen::MatrixXd::NullaryExpr( rows, cols, [&](){ return normal(engine); } ); }
+
+        const Utils::BinsReader reader( write_bins(obs) );
+        check_header( reader, "matrix_obs", 2, rows, cols, bin_num );
+        bool is_identical = true;
+        for ( auto bin = 0; bin < bin_num; ++bin ) {
+            const Eigen::MatrixXd& data = obs.bin_data(bin);
+            is_identical = is_identical && ( reader.bin(bin) == data )
+                                        && ( reader.bins().col(bin) == Eigen::Map<const Eigen::VectorXd>( data.data(), data.size() ) );
+        }
+        TestUtils::check( is_identical, "bins of the matrix observable read back exactly" );
+    }
+
+    // -------------------------------------  Observable without bins  ---------------------------------------
+    {
+        Observable::ScalarObs obs( 0 );
+        obs.set_name_and_description( "empty_obs", "Observable without bins" );
+        obs.set_zero_element( 0.0 );
+        obs.allocate();
+
+        const Utils::BinsReader reader( write_bins(obs) );
+        check_header( reader, "empty_obs", 0, 1, 1, 0 );
+    }
+
+    return TestUtils::report();
+}
@@ -0,0 +1,125 @@
+/**
+  *  Unit test of the checkpoints QuantumMonteCarlo::Checkpoint.
+  *  The state saved after a short simulation should be restored into a walker initialized differently,
+  *  reproducing the fields, the random engine, the bins and the greens functions of the original walker,
+  *  while a checkpoint of different model parameters should be refused by the restart.
+  */
+
+#include <vector>
+#include <sys/wait.h>
+#include <boost/mpi/environment.hpp>
+#include <boost/mpi/communicator.hpp>
+#include "test_utils.h"
+#include "checkpoint.h"
+#include "dqmc.h"
+
+
+// the toml configuration of the test with the given on-site interaction
+std::string config_content( double onsite_u )
+{
+    return ( boost::format( R"(
+        [Model]
+            type = "RepulsiveHubbard"
+            [Model.Params]
+            hopping_t = 1.0
+            onsite_u = %.1f
+            chemical_potential = -0.5
+        [Lattice]
+            type = "Square"
+            cell = [ 4, 4 ]
+            momentum = "MPoint"
+            momentum_list = "KstarsAll"
+        [MonteCarlo]
+            beta = 2.0
+            time_size = 20
+            stabilization_pace = 10
+        [Measure]
+            sweeps_warmup = 4
+            bin_num = 3
+            bin_size = 4
+            sweeps_between_bins = 1
+            observables = [ "filling_number", "double_occupancy", "kinetic_energy" ]
+    )" ) % onsite_u ).str();
+}
+
+
+int main( int argc, char* argv[] ) {
+
+    boost::mpi::environment env( argc, argv );
+    boost::mpi::communicator world;
+
+    using Matrix = Eigen::MatrixXd;
+    const std::string config_file = TestUtils::write_config( "test_checkpoint", config_content(4.0) );
+    const std::string folder = ( std::filesystem::temp_directory_path() / "test_checkpoint" ).string();
+    QuantumMonteCarlo::WalkerPool walker_pool;
+    QuantumMonteCarlo::Dqmc::show_progress_bar( false );
+
+    // short simulation, whose final state is stored into the checkpoint
+    TestUtils::Modules original;
+    original.parse( config_file );
+    original.initial( 12345 );
+    QuantumMonteCarlo::Dqmc::thermalize( *original.walker, *original.model, *original.lattice, *original.meas_handler );
+    QuantumMonteCarlo::Dqmc::measure( *original.walker, *original.model, *original.lattice, *original.meas_handler );
+
+    QuantumMonteCarlo::Checkpoint checkpoint;
+    checkpoint.initial( world, folder );
+    checkpoint.save( original.meas_handler->WarmUpSweeps(), original.meas_handler->BinsNum(), *original.lattice,
+                     *original.walker, *original.model, *original.meas_handler, walker_pool, nullptr );
+
+
+    // -------------------------  Restore into a walker with different fields  --------------------------
+    {
+        TestUtils::Modules restored;
+        restored.parse( config_file );
+        restored.initial( 54321 );
+        checkpoint.restore( world, *restored.lattice, *restored.walker, *restored.model,
+                            *restored.meas_handler, walker_pool, nullptr );
+
+        TestUtils::check( checkpoint.WarmUpSweepsDone() == original.meas_handler->WarmUpSweeps()
+                          && checkpoint.BinsDone() == original.meas_handler->BinsNum(), "progress of the simulation" );
+        TestUtils::check( restored.model->BosonicFields() == original.model->BosonicFields(), "bosonic fields" );
+
+        // the restored engine continues the random stream of the original one
+        auto original_rng = original.walker->RandomEngine();
+        auto restored_rng = restored.walker->RandomEngine();
+        bool is_identical = true;
+        for ( auto i = 0; i < 16; ++i ) { is_identical = is_identical && ( original_rng() == restored_rng() ); }
+        TestUtils::check( is_identical, "random engine" );
+
+        is_identical = true;
+        for ( const std::string name : { "filling_number", "double_occupancy", "kinetic_energy" } ) {
+            const auto original_obs = original.meas_handler->find<Observable::ScalarObs>( name );
+            const auto restored_obs = restored.meas_handler->find<Observable::ScalarObs>( name );
+            is_identical = is_identical && ( original_obs.bin_data() == restored_obs.bin_data() );
+        }
+        TestUtils::check( is_identical, "bins of the observables" );
+
+        // the greens functions are recomputed from the restored fields
+        const Matrix& green_up = original.walker->GreenttUp();
+        const Matrix& green_dn = original.walker->GreenttDn();
+        const double error = std::max( ( restored.walker->GreenttUp() - green_up ).cwiseAbs().maxCoeff(),
+                                       ( restored.walker->GreenttDn() - green_dn ).cwiseAbs().maxCoeff() );
+        TestUtils::check_close( error, 1e-10, "equal-time greens functions" );
+    }
+
+
+    // ---------------------  Restart with different model parameters is refused  ----------------------
+    {
+        TestUtils::Modules mismatched;
+        mismatched.parse( TestUtils::write_config( "test_checkpoint_mismatch", config_content(6.0) ) );
+        mismatched.initial( 12345 );
+
+        // the restore terminates the process on failure, hence it is run in a child process
+        const pid_t pid = fork();
+        if ( pid == 0 ) {
+            checkpoint.restore( world, *mismatched.lattice, *mismatched.walker, *mismatched.model,
+                                *mismatched.meas_handler, walker_pool, nullptr );
+            _exit(0);
+        }
+        int status{};
+        waitpid( pid, &status, 0 );
+        TestUtils::check( WIFEXITED(status) && WEXITSTATUS(status) == 1, "checkpoint of different onsite_u refused" );
+    }
+
+    return TestUtils::report();
+}
@@ -0,0 +1,83 @@
+/**
+  *  Unit test of the delayed updates of the equal-time greens functions.
+  *  Starting from identical fields and random streams, the walkers with delayed rank-k updates
+  *  should accept the same flips as the conventional rank-1 updates,
+  *  and end up with the same greens functions up to round-off.
+  */
+
+#include <vector>
+#include <algorithm>
+#include "test_utils.h"
+
+
+int main() {
+
+    const std::string config_file = TestUtils::write_config( "test_delayed_update", R"(
+        [Model]
+            type = "RepulsiveHubbard"
+            [Model.Params]
+            hopping_t = 1.0
+            onsite_u = 4.0
+            chemical_potential = -0.5
+        [Lattice]
+            type = "Square"
+            cell = [ 4, 4 ]
+            momentum = "MPoint"
+            momentum_list = "KstarsAll"
+        [MonteCarlo]
+            beta = 4.0
+            time_size = 40
+            stabilization_pace = 10
+        [Measure]
+            observables = [ "none" ]
+    )" );
+
+    // the greens functions are compared slice by slice during the sweeps,
+    // since they are recomputed from the svd stacks at the end of each sweep
+    using Matrix = Eigen::MatrixXd;
+    const int sweeps = 2;
+    std::vector<Matrix> reference_green_up, reference_green_dn;
+
+    // reference walker with rank-1 updates
+    TestUtils::Modules reference;
+    reference.parse( config_file );
+    reference.walker->set_delay_depth( 1 );
+    reference.initial( 12345 );
+    auto record = [&]( int t, const Matrix& green_up, const Matrix& green_dn ) {
+        reference_green_up.emplace_back( green_up );
+        reference_green_dn.emplace_back( green_dn );
+    };
+    for ( auto sweep = 0; sweep < sweeps; ++sweep ) {
+        reference.walker->sweep_from_0_to_beta( *reference.model, record );
+        reference.walker->sweep_from_beta_to_0( *reference.model, record );
+    }
+
+    for ( const int delay_depth : { 2, 5, 16 } ) {
+        TestUtils::Modules delayed;
+        delayed.parse( config_file );
+        delayed.walker->set_delay_depth( delay_depth );
+        delayed.initial( 12345 );
+
+        std::size_t slice = 0;
+        double error_up = 0.0, error_dn = 0.0;
+        auto compare = [&]( int t, const Matrix& green_up, const Matrix& green_dn ) {
+            error_up = std::max( error_up, ( green_up - reference_green_up[slice] ).cwiseAbs().maxCoeff() );
+            error_dn = std::max( error_dn, ( green_dn - reference_green_dn[slice] ).cwiseAbs().maxCoeff() );
+            ++slice;
+        };
+        for ( auto sweep = 0; sweep < sweeps; ++sweep ) {
+            delayed.walker->sweep_from_0_to_beta( *delayed.model, compare );
+            delayed.walker->sweep_from_beta_to_0( *delayed.model, compare );
+        }
+
+        TestUtils::check( slice == reference_green_up.size() 
+                          && delayed.model->BosonicFields() == reference.model->BosonicFields(),
+            ( boost::format("identical flips accepted with delay depth %d") % delay_depth ).str() );
+        TestUtils::check_close( error_up, 1e-8,
+            ( boost::format("spin-up greens functions of all slices with delay depth %d") % delay_depth ).str() );
+        TestUtils::check_close( error_dn, 1e-8,
+            ( boost::format("spin-down greens functions of all slices with delay depth %d") % delay_depth ).str() );
+    }
+
+    return TestUtils::report();
+}
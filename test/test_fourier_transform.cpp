@@ -0,0 +1,67 @@
+/**
+  *  Unit test of the fourier transformation of the translation-averaged real-space data in MeasureHandler.
+  *  For the square and cubic lattices the transformation is computed by fft,
+  *  which should agree with the direct summation \sum r cos( k*r ) * f(r) over the displacements.
+  */
+
+#include <array>
+#include "test_utils.h"
+
+
+int main() {
+
+    using Vector = Eigen::VectorXd;
+
+    const std::array<std::array<std::string, 3>, 4> cases {{
+        { "Square", "[ 6, 6 ]", "KstarsAll" },     { "Square", "[ 8, 8 ]", "Gamma2X2M2GammaLoop" },
+        { "Cubic", "[ 4, 4, 4 ]", "KstarsAll" },   { "Cubic", "[ 6, 6, 6 ]", "LambdaLine" },
+    }};
+
+    for ( const auto& [lattice, cell, momentum_list] : cases ) {
+        const std::string config_file = TestUtils::write_config( "test_fourier_transform", R"(
+            [Model]
+                type = "RepulsiveHubbard"
+                [Model.Params]
+                hopping_t = 1.0
+                onsite_u = 4.0
+                chemical_potential = 0.0
+            [Lattice]
+                type = ")" + lattice + R"("
+                cell = )" + cell + R"(
+                momentum = "MPoint"
+                momentum_list = ")" + momentum_list + R"("
+            [MonteCarlo]
+                beta = 1.0
+                time_size = 10
+                stabilization_pace = 5
+            [Measure]
+                observables = [ "greens_functions" ]
+        )" );
+
+        TestUtils::Modules modules;
+        modules.parse( config_file );
+        modules.initial( 12345 );
+        const auto& meas_handler = *modules.meas_handler;
+        const auto& lattice_base = *modules.lattice;
+        const std::string label = " for the " + momentum_list + " momenta of the " + lattice + " lattice " + cell;
+        TestUtils::check( meas_handler.isFFTEnabled(), "fft enabled" + label );
+
+        // random translation-averaged data f(r), transformed twice to check the reuse of the fft buffers
+        for ( auto round = 0; round < 2; ++round ) {
+            const Vector data_r = Vector::Random( lattice_base.SpaceSize() );
+            Vector data_k;
+            meas_handler.fourier_transform( data_r, data_k, lattice_base );
+
+            Vector reference = Vector::Zero( meas_handler.MomentumList().size() );
+            for ( auto k = 0; k < reference.size(); ++k ) {
+                for ( auto r = 0; r < lattice_base.SpaceSize(); ++r ) {
+                    reference(k) += lattice_base.FourierFactor( r, meas_handler.MomentumList(k) ) * data_r(r);
+                }
+            }
+            TestUtils::check_close( ( data_k - reference ).cwiseAbs().maxCoeff(), 1e-12,
+                                    "fft against the direct summation" + label );
+        }
+    }
+
+    return TestUtils::report();
+}
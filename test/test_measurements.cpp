@@ -0,0 +1,254 @@
+/**
+  *  Unit test of the measurements of the equal-time and dynamic observables.
+  *  For one set of greens functions recorded by the walker, the samples of the observables,
+  *  which are contracted from the correlations shared by the measuring handler,
+  *  should agree with the direct evaluations of their defining formulas over all pairs of sites.
+  *  Moreover, the streaming mode should reproduce the bins of the stored mode for all the observables.
+  */
+
+#include <cmath>
+#include "test_utils.h"
+#include "dqmc.h"
+
+
+int main() {
+
+    using Matrix = Eigen::MatrixXd;
+    using Vector = Eigen::VectorXd;
+
+    auto config = []( const std::string& streaming ) {
+        return TestUtils::write_config( "test_measurements_" + streaming, R"(
+            [Model]
+                type = "RepulsiveHubbard"
+                [Model.Params]
+                hopping_t = 1.0
+                onsite_u = 4.0
+                chemical_potential = -0.3
+            [Lattice]
+                type = "Square"
+                cell = [ 4, 4 ]
+                momentum = "MPoint"
+                momentum_list = "KstarsAll"
+            [MonteCarlo]
+                beta = 2.0
+                time_size = 20
+                stabilization_pace = 5
+            [Measure]
+                sweeps_warmup = 0
+                bin_num = 2
+                bin_size = 4
+                sweeps_between_bins = 2
+                streaming = )" + streaming + R"(
+                observables = [ "all" ]
+        )" );
+    };
+
+    const double tolerance = 1e-12;
+    auto relative_error = []( const auto& result, const auto& reference ) {
+        using std::abs;
+        if constexpr ( std::is_same_v<std::decay_t<decltype(result)>, double> ) {
+            return abs( result - reference ) / std::max( abs( reference ), 1e-12 );
+        }
+        else {
+            return ( result - reference ).norm() / std::max( reference.norm(), 1e-12 );
+        }
+    };
+
+
+    // ------------------------  Shared correlations against the direct evaluations  ----------------------------
+    {
+        TestUtils::Modules modules;
+        modules.parse( config( "false" ) );
+        modules.initial( 12345 );
+        auto& walker = *modules.walker;
+        auto& model = *modules.model;
+        const auto& lattice = *modules.lattice;
+        auto& meas_handler = *modules.meas_handler;
+
+        const int space_size = lattice.SpaceSize();
+        const int time_size = walker.TimeSize();
+        const Matrix identity = Matrix::Identity( space_size, space_size );
+        const int momentum = meas_handler.Momentum();
+        const auto& momentum_list = meas_handler.MomentumList();
+
+        // -------------------------------------------  Equal-time  ---------------------------------------------
+        walker.sweep_from_0_to_beta( model );
+        walker.sweep_from_beta_to_0( model );
+        meas_handler.equaltime_measure( walker, model, lattice );
+
+        double filling = 0.0, double_occupancy = 0.0, kinetic_energy = 0.0, local_spin_corr = 0.0;
+        double momentum_distribution = 0.0, sdw_factor = 0.0, cdw_factor = 0.0, s_wave_pairing = 0.0;
+        for ( auto t = 0; t < time_size; ++t ) {
+            const Matrix& gu = walker.GreenttUp(t);
+            const Matrix& gd = walker.GreenttDn(t);
+            const Matrix guc = identity - gu.transpose();
+            const Matrix gdc = identity - gd.transpose();
+            const double sign = walker.ConfigSign(t);
+
+            filling += sign * ( 2 - ( gu.trace() + gd.trace() ) / space_size );
+            for ( auto i = 0; i < space_size; ++i ) {
+                double_occupancy += sign * ( 1 - gu(i,i) ) * ( 1 - gd(i,i) ) / space_size;
+                local_spin_corr += sign * ( gu(i,i) + gd(i,i) - 2 * gu(i,i) * gd(i,i) ) / space_size;
+                for ( auto dir = 0; dir < lattice.SpaceDim(); ++dir ) {
+                    const int ipx = lattice.NearestNeighbour(i, dir);
+                    kinetic_energy += sign * 2 * model.HoppingT() * ( gu(i,ipx) + gd(i,ipx) ) / space_size;
+                }
+            }
+
+            double tmp_momentum_dist = 0.0;
+            for ( auto i = 0; i < space_size; ++i ) {
+                for ( auto j = 0; j < space_size; ++j ) {
+                    const double factor = lattice.FourierFactor( lattice.Displacement(i,j), momentum );
+                    tmp_momentum_dist += ( gu(j,i) + gd(j,i) ) * factor;
+                    const double equal_spin = guc(i,i) * guc(j,j) + guc(i,j) * gu(i,j) + gdc(i,i) * gdc(j,j) + gdc(i,j) * gd(i,j);
+                    const double opposite_spin = gdc(i,i) * guc(j,j) + guc(i,i) * gdc(j,j);
+                    sdw_factor += sign * factor * ( equal_spin - opposite_spin ) / ( space_size * space_size );
+                    cdw_factor += sign * factor * ( equal_spin + opposite_spin ) / ( space_size * space_size );
+                    s_wave_pairing += sign * guc(i,j) * gdc(i,j) / space_size;
+                }
+            }
+            momentum_distribution += sign * ( 1 - 0.5 * tmp_momentum_dist / space_size );
+        }
+
+        const std::array<std::pair<std::string, double>, 8> eqtime_references {{
+            { "filling_number", filling },                  { "double_occupancy", double_occupancy },
+            { "kinetic_energy", kinetic_energy },           { "local_spin_corr", local_spin_corr },
+            { "momentum_distribution", momentum_distribution },
+            { "spin_density_structure_factor", sdw_factor },
+            { "charge_density_structure_factor", cdw_factor },
+            { "s_wave_pairing_corr", s_wave_pairing },
+        }};
+        for ( const auto& [name, reference] : eqtime_references ) {
+            const auto obs = meas_handler.find<Observable::ScalarObs>( name );
+            TestUtils::check_close( relative_error( obs.tmp_value(), reference ), tolerance, name + " against the direct evaluation" );
+            TestUtils::check( obs.counts() == time_size, name + " counts one sample per time slice" );
+        }
+
+        // --------------------------------------------  Dynamic  ----------------------------------------------
+        // the time index t labels the imaginary time t * dtau, taken from the time slice t-1,
+        // and t = 0 wraps around to the last time slice with G(beta,beta) = G(0,0)
+        walker.sweep_for_dynamic_greens( model );
+        meas_handler.dynamic_measure( walker, model, lattice );
+
+        const double sign = walker.ConfigSign();
+        const int last = time_size - 1;
+        const Matrix& g00up = walker.GreenttUp(last);
+        const Matrix& g00dn = walker.GreenttDn(last);
+        const Matrix gc00up = identity - g00up.transpose();
+        const Matrix gc00dn = identity - g00dn.transpose();
+
+        Matrix greens_functions = Matrix::Zero( momentum_list.size(), time_size );
+        Vector density_of_states = Vector::Zero( time_size );
+        Vector dynamic_spin_susceptibility = Vector::Zero( time_size );
+        double current_correlated = 0.0, current_uncorrelated = 0.0;
+
+        for ( auto t = 0; t < time_size; ++t ) {
+            const int slice = ( t == 0 )? last : t-1;
+            const Matrix& gttup = walker.GreenttUp(slice);
+            const Matrix& gttdn = walker.GreenttDn(slice);
+            const Matrix& gt0up = walker.Greent0Up(slice);
+            const Matrix& gt0dn = walker.Greent0Dn(slice);
+            const Matrix& g0tup = walker.Green0tUp(slice);
+            const Matrix& g0tdn = walker.Green0tDn(slice);
+            const Matrix gcttup = identity - gttup.transpose();
+            const Matrix gcttdn = identity - gttdn.transpose();
+
+            // the greens functions at t = 0 are the equal-time ones
+            const Matrix gt0 = ( t == 0 )? Matrix( 0.5 * ( gttup + gttdn ) ) : Matrix( 0.5 * ( gt0up + gt0dn ) );
+            density_of_states(t) = sign * gt0.trace() / space_size;
+
+            for ( auto i = 0; i < space_size; ++i ) {
+                const int ipx = lattice.NearestNeighbour(i, 0);
+                dynamic_spin_susceptibility(t) += 0.25 * sign / space_size * (
+                    + gcttup(i,i) * gc00up(i,i) - g0tup(i,i) * gt0up(i,i)
+                    + gcttdn(i,i) * gc00dn(i,i) - g0tdn(i,i) * gt0dn(i,i)
+                    - gcttup(i,i) * gc00dn(i,i) - gc00up(i,i) * gcttdn(i,i) );
+
+                for ( auto j = 0; j < space_size; ++j ) {
+                    const int jpx = lattice.NearestNeighbour(j, 0);
+                    for ( auto k = 0; k < (int)momentum_list.size(); ++k ) {
+                        greens_functions(k,t) += sign * gt0(j,i) / space_size
+                            * lattice.FourierFactor( lattice.Displacement(i,j), momentum_list[k] );
+                    }
+
+                    const int rx = lattice.Index2Site( lattice.Displacement(i,j), 0 );
+                    const int ry = lattice.Index2Site( lattice.Displacement(i,j), 1 );
+                    const double factor = lattice.FourierFactor(rx, 1) - lattice.FourierFactor(ry, 1);
+                    current_uncorrelated += factor
+                        * ( gttup(j,jpx) - gttup(jpx,j) + gttdn(j,jpx) - gttdn(jpx,j) )
+                        * ( g00up(i,ipx) - g00up(ipx,i) + g00dn(i,ipx) - g00dn(ipx,i) );
+                    current_correlated += factor * (
+                        - g0tup(ipx,jpx) * gt0up(j,i) - g0tdn(ipx,jpx) * gt0dn(j,i)
+                        + g0tup(i,jpx) * gt0up(j,ipx) + g0tdn(i,jpx) * gt0dn(j,ipx)
+                        + g0tup(ipx,j) * gt0up(jpx,i) + g0tdn(ipx,j) * gt0dn(jpx,i)
+                        - g0tup(i,j) * gt0up(jpx,ipx) - g0tdn(i,j) * gt0dn(jpx,ipx) );
+                }
+            }
+        }
+        const double superfluid_stiffness = 0.25 * model.HoppingT() * model.HoppingT() * sign
+                                          * ( current_correlated - current_uncorrelated ) / ( space_size * space_size );
+
+        TestUtils::check_close( relative_error( meas_handler.find<Observable::MatrixObs>("greens_functions").tmp_value(), greens_functions ),
+                                tolerance, "greens_functions against the direct evaluation" );
+        TestUtils::check_close( relative_error( meas_handler.find<Observable::VectorObs>("density_of_states").tmp_value(), density_of_states ),
+                                tolerance, "density_of_states against the direct evaluation" );
+        TestUtils::check_close( relative_error( meas_handler.find<Observable::VectorObs>("dynamic_spin_susceptibility").tmp_value(),
+                                                dynamic_spin_susceptibility ),
+                                tolerance, "dynamic_spin_susceptibility against the direct evaluation" );
+        TestUtils::check_close( relative_error( meas_handler.find<Observable::ScalarObs>("superfluid_stiffness").tmp_value(), superfluid_stiffness ),
+                                tolerance, "superfluid_stiffness against the direct evaluation" );
+
+        // the wraparound of t = 0 to the equal-time greens functions of the last time slice
+        const auto& dynamic_corr = meas_handler.DynamicCorr();
+        TestUtils::check_close( relative_error( dynamic_corr.local_greens_t(0), 0.5 * ( g00up + g00dn ).trace() / space_size ),
+                                tolerance, "local greens function at t = 0 taken from G(0,0)" );
+        TestUtils::check_close( relative_error( Vector( sign * dynamic_corr.greens_kt.col(0) ), Vector( greens_functions.col(0) ) ),
+                                tolerance, "G(k,t) at t = 0 taken from G(0,0)" );
+
+        // the uncorrelated part of the current correlations, contracted with G(0,0) at the last time slice,
+        // which should be sizable for the check above to be meaningful
+        TestUtils::check_close( relative_error( dynamic_corr.current_corr, current_correlated - current_uncorrelated ),
+                                tolerance, "current correlations with the uncorrelated part subtracted" );
+        TestUtils::check( std::abs( current_uncorrelated ) > 1e-6 * std::abs( current_correlated ),
+                          ( boost::format("uncorrelated part of the current correlations is nonzero ( %.3e )") % current_uncorrelated ).str() );
+    }
+
+
+    // ------------------------------------  Streaming against stored mode  -------------------------------------
+    {
+        std::array<TestUtils::Modules, 2> modules;
+        QuantumMonteCarlo::Dqmc::show_progress_bar( false );
+        for ( auto mode = 0; mode < 2; ++mode ) {
+            modules[mode].parse( config( ( mode == 0 )? "false" : "true" ) );
+            modules[mode].initial( 12345 );
+            QuantumMonteCarlo::Dqmc::measure( *modules[mode].walker, *modules[mode].model,
+                                              *modules[mode].lattice, *modules[mode].meas_handler );
+        }
+        auto& stored = *modules[0].meas_handler;
+        auto& streaming = *modules[1].meas_handler;
+        TestUtils::check( streaming.isStreaming() && !stored.isStreaming(), "streaming mode is enabled only for the second run" );
+        TestUtils::check( stored.find<Observable::ScalarObs>("filling_number").bin_data(stored.BinsNum()-1) > 0.0,
+                          "bins are filled by the measurements" );
+
+        auto compare_bins = [&]( const std::string& name, const auto& obs_stored, const auto& obs_streaming ) {
+            double error = 0.0;
+            for ( auto bin = 0; bin < stored.BinsNum(); ++bin ) {
+                error = std::max( error, relative_error( obs_streaming.bin_data(bin), obs_stored.bin_data(bin) ) );
+            }
+            TestUtils::check_close( error, tolerance, name + " of the streaming mode against the stored mode" );
+        };
+
+        for ( const auto& name : { "filling_number", "double_occupancy", "kinetic_energy", "momentum_distribution",
+                                   "local_spin_corr", "spin_density_structure_factor", "charge_density_structure_factor",
+                                   "s_wave_pairing_corr", "superfluid_stiffness", "equaltime_sign", "dynamic_sign" } ) {
+            compare_bins( name, stored.find<Observable::ScalarObs>(name), streaming.find<Observable::ScalarObs>(name) );
+        }
+        for ( const auto& name : { "density_of_states", "dynamic_spin_susceptibility" } ) {
+            compare_bins( name, stored.find<Observable::VectorObs>(name), streaming.find<Observable::VectorObs>(name) );
+        }
+        compare_bins( "greens_functions", stored.find<Observable::MatrixObs>("greens_functions"),
+                                          streaming.find<Observable::MatrixObs>("greens_functions") );
+    }
+
+    return TestUtils::report();
+}
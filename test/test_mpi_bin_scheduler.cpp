@@ -0,0 +1,128 @@
+/**
+  *  Unit test of the dynamic scheduling of bins among MPI processes, which should be run with two ranks.
+  *  The processes run at deliberately uneven paces, and the bins drawn from the shared counter
+  *  should add up to the total number of bins, also for a restarted simulation.
+  *  In a measurement, each process should keep exactly the bins it measured,
+  *  and the reduced statistics should equal those of all the bins gathered together.
+  */
+
+#include <chrono>
+#include <thread>
+#include <numeric>
+#include <algorithm>
+#include <vector>
+#include <boost/mpi.hpp>
+#include "test_utils.h"
+#include "dqmc.h"
+#include "bin_scheduler.h"
+#include "utils/mpi.hpp"
+
+
+int main( int argc, char* argv[] ) {
+
+    boost::mpi::environment env( argc, argv );
+    boost::mpi::communicator world;
+    if ( world.size() != 2 ) {
+        std::cerr << "test_mpi_bin_scheduler: the test should be run with 2 processes." << std::endl;
+        return 1;
+    }
+
+    const int rank = world.rank();
+    const std::string label = ( boost::format(" on rank %d") % rank ).str();
+
+    // the process of rank 1 is slowed down, so that the bins are unevenly distributed
+    const auto pause = [&]() {
+        if ( rank == 1 ) { std::this_thread::sleep_for( std::chrono::milliseconds(50) ); }
+    };
+
+
+    // -----------------------------------------  Drawing of the bins  ------------------------------------------
+    for ( const int bins_done : { 0, 1 } ) {
+        const int bin_num = 7;
+        QuantumMonteCarlo::BinScheduler bin_scheduler;
+        bin_scheduler.initial( world, bin_num, bins_done );
+        while ( bin_scheduler.acquire_bin() ) { pause(); }
+        TestUtils::check( !bin_scheduler.acquire_bin(), "no more bins once the counter is exhausted" + label );
+
+        std::vector<int> bins_taken;
+        boost::mpi::all_gather( world, bin_scheduler.BinsTaken(), bins_taken );
+        const int total = std::accumulate( bins_taken.begin(), bins_taken.end(), 0 );
+        TestUtils::check( total == bin_num, ( boost::format("bins drawn by the processes add up ( %d + %d = %d ) with %d bins restored")
+                                              % bins_taken[0] % bins_taken[1] % bin_num % bins_done ).str() + label );
+        TestUtils::check( bins_taken[0] > bins_taken[1], "more bins drawn by the faster process" + label );
+        bin_scheduler.deallocate();
+    }
+
+
+    // --------------------------------------  Measurement with the scheduler  ------------------------------------
+    {
+        const std::string config_file = TestUtils::write_config( ( boost::format("test_mpi_bin_scheduler_%d") % rank ).str(), R"(
+            [Model]
+                type = "RepulsiveHubbard"
+                [Model.Params]
+                hopping_t = 1.0
+                onsite_u = 4.0
+                chemical_potential = -0.3
+            [Lattice]
+                type = "Square"
+                cell = [ 4, 4 ]
+                momentum = "MPoint"
+                momentum_list = "KstarsAll"
+            [MonteCarlo]
+                beta = 2.0
+                time_size = 20
+                stabilization_pace = 5
+            [Measure]
+                sweeps_warmup = 0
+                bin_num = 5
+                bin_size = 4
+                sweeps_between_bins = 0
+                observables = [ "filling_number", "double_occupancy" ]
+        )" );
+
+        TestUtils::Modules modules;
+        modules.parse( config_file );
+        modules.initial( 12345 + rank );
+        auto& meas_handler = *modules.meas_handler;
+        const int bin_num = meas_handler.BinsNum();
+
+        QuantumMonteCarlo::BinScheduler bin_scheduler;
+        bin_scheduler.initial( world, bin_num );
+        QuantumMonteCarlo::Dqmc::show_progress_bar( false );
+        QuantumMonteCarlo::Dqmc::set_sweep_hook( [&]( QuantumMonteCarlo::DqmcWalker&, Model::ModelBase& ) { pause(); } );
+        QuantumMonteCarlo::Dqmc::measure( *modules.walker, *modules.model, *modules.lattice, meas_handler, nullptr, &bin_scheduler );
+        QuantumMonteCarlo::Dqmc::set_sweep_hook( {} );
+        bin_scheduler.deallocate();
+
+        // only the measured bins are kept, all of which are filled
+        const int bins_taken = bin_scheduler.BinsTaken();
+        const auto local_obs = meas_handler.find<Observable::ScalarObs>("filling_number");
+        TestUtils::check( local_obs.bin_num() == bins_taken && (int)local_obs.bin_data().size() == bins_taken,
+                          ( boost::format("bins truncated to the %d bins measured") % bins_taken ).str() + label );
+        TestUtils::check( std::all_of( local_obs.bin_data().begin(), local_obs.bin_data().end(), []( double x ) { return x > 0.0; } ),
+                          "all the kept bins are filled" + label );
+        TestUtils::check( boost::mpi::all_reduce( world, bins_taken, std::plus<int>() ) == bin_num,
+                          "bins measured by the processes add up" + label );
+
+        // all the bins gathered together as the reference
+        std::vector<std::vector<double>> gathered;
+        boost::mpi::all_gather( world, local_obs.bin_data(), gathered );
+        std::vector<double> all_bins;
+        for ( const auto& bins : gathered ) { all_bins.insert( all_bins.end(), bins.begin(), bins.end() ); }
+        Observable::ScalarObs reference( all_bins.size() );
+        reference.set_zero_element( 0.0 );
+        reference.allocate();
+        for ( auto bin = 0; bin < (int)all_bins.size(); ++bin ) { reference.bin_data(bin) = all_bins[bin]; }
+        reference.analyse();
+
+        // reduced statistics of the unevenly distributed bins
+        Utils::MPI::mpi_reduce( world, meas_handler );
+        auto reduced_obs = meas_handler.find<Observable::ScalarObs>("filling_number");
+        reduced_obs.analyse();
+        TestUtils::check( reduced_obs.bin_num() == bin_num, "reduced number of bins" + label );
+        TestUtils::check_close( std::abs( reduced_obs.mean_value() - reference.mean_value() ), 1e-12, "reduced mean value" + label );
+        TestUtils::check_close( std::abs( reduced_obs.error_bar() - reference.error_bar() ), 1e-12, "reduced error bar" + label );
+    }
+
+    return TestUtils::report();
+}
@@ -0,0 +1,135 @@
+/**
+  *  Unit test of the in-place reductions of the observables among MPI processes, Utils::MPI,
+  *  which runs on any number of ranks, including a single one.
+  *  The bins of the sign and of a scalar and a vector observable are dealt out among the processes,
+  *  and the reduced mean values, error bars and jackknife estimates should equal those of analyse()
+  *  and analyse_jackknife() applied to all the bins held by one process.
+  *  The reduced logarithmic binning should equal the merge of the hierarchies of all the processes.
+  */
+
+#include <cmath>
+#include <vector>
+#include <boost/mpi.hpp>
+#include "test_utils.h"
+#include "utils/mpi.hpp"
+
+
+int main( int argc, char* argv[] ) {
+
+    using Vector = Eigen::VectorXd;
+
+    boost::mpi::environment env( argc, argv );
+    boost::mpi::communicator world;
+    const int rank = world.rank();
+    const std::string label = ( boost::format(" on rank %d of %d") % rank % world.size() ).str();
+
+    // deterministic bins of the sign and of the ratios of the observables to the sign
+    const int bin_num = 11;
+    const int vector_size = 3;
+    auto sign_bin = []( int bin ) { return 0.6 + 0.3 * std::sin( 1.3 * bin ); };
+    auto scalar_bin = []( int bin ) { return 2.0 + std::cos( 0.7 * bin ); };
+    auto vector_bin = [&]( int bin ) {
+        Vector v( vector_size );
+        for ( auto i = 0; i < vector_size; ++i ) { v(i) = 1.0 + 0.5 * std::sin( 0.9 * bin + i ) * ( i + 1 ); }
+        return v;
+    };
+
+    // the observables of the given bins, allocated and filled
+    auto create = []( const std::vector<int>& bins, const auto& zero, const auto& bin_value ) {
+        Observable::Observable<std::decay_t<decltype(zero)>> obs( bins.size() );
+        obs.set_zero_element( zero );
+        obs.allocate();
+        for ( auto i = 0; i < (int)bins.size(); ++i ) { obs.bin_data(i) = bin_value( bins[i] ); }
+        return obs;
+    };
+
+    // all the bins as the reference, and the bins of this process dealt out in turns
+    std::vector<int> all_bins, local_bins;
+    for ( auto bin = 0; bin < bin_num; ++bin ) {
+        all_bins.push_back( bin );
+        if ( bin % world.size() == rank ) { local_bins.push_back( bin ); }
+    }
+    const Vector zero_vector = Vector::Zero( vector_size );
+
+
+    // ------------------------------------  Reduction of the bin statistics  ------------------------------------
+    {
+        auto ref_sign = create( all_bins, 0.0, sign_bin );
+        auto ref_scalar = create( all_bins, 0.0, scalar_bin );
+        auto ref_vector = create( all_bins, zero_vector, vector_bin );
+        ref_sign.analyse();
+        ref_scalar.analyse();
+        ref_scalar.analyse_jackknife( ref_sign );
+        ref_vector.analyse();
+        ref_vector.analyse_jackknife( ref_sign );
+
+        // the sign is reduced in advance, whose bins weigh the jackknife sums of the others
+        auto sign = create( local_bins, 0.0, sign_bin );
+        auto scalar = create( local_bins, 0.0, scalar_bin );
+        auto vector = create( local_bins, zero_vector, vector_bin );
+        Utils::MPI::reduce_observable( world, &sign );
+        Utils::MPI::reduce_observable( world, &scalar );
+        Utils::MPI::reduce_observable( world, &vector );
+        Utils::MPI::reduce_jackknife( world, &scalar, &sign );
+        Utils::MPI::reduce_jackknife( world, &vector, &sign );
+        sign.analyse();
+        scalar.analyse();
+        scalar.analyse_jackknife( sign );
+        vector.analyse();
+        vector.analyse_jackknife( sign );
+
+        TestUtils::check( sign.bin_num() == bin_num && scalar.bin_num() == bin_num && vector.bin_num() == bin_num,
+                          "reduced number of bins" + label );
+        TestUtils::check_close( std::abs( sign.mean_value() - ref_sign.mean_value() ), 1e-12, "mean value of the sign" + label );
+        TestUtils::check_close( std::abs( sign.error_bar() - ref_sign.error_bar() ), 1e-12, "error bar of the sign" + label );
+        TestUtils::check_close( std::abs( scalar.mean_value() - ref_scalar.mean_value() ), 1e-12, "mean value of the scalar" + label );
+        TestUtils::check_close( std::abs( scalar.error_bar() - ref_scalar.error_bar() ), 1e-12, "error bar of the scalar" + label );
+        TestUtils::check_close( std::abs( scalar.jackknife_mean() - ref_scalar.jackknife_mean() ), 1e-12,
+                                "jackknife mean of the scalar" + label );
+        TestUtils::check_close( std::abs( scalar.jackknife_error() - ref_scalar.jackknife_error() ), 1e-12,
+                                "jackknife error of the scalar" + label );
+        TestUtils::check_close( ( vector.mean_value() - ref_vector.mean_value() ).norm(), 1e-12, "mean value of the vector" + label );
+        TestUtils::check_close( ( vector.error_bar() - ref_vector.error_bar() ).norm(), 1e-12, "error bar of the vector" + label );
+        TestUtils::check_close( ( vector.jackknife_mean() - ref_vector.jackknife_mean() ).norm(), 1e-12,
+                                "jackknife mean of the vector" + label );
+        TestUtils::check_close( ( vector.jackknife_error() - ref_vector.jackknife_error() ).norm(), 1e-12,
+                                "jackknife error of the vector" + label );
+        TestUtils::check( ref_scalar.jackknife_error() > 0.0, "nonzero jackknife error" + label );
+    }
+
+
+    // --------------------------------  Reduction of the logarithmic binning  ---------------------------------
+    {
+        // chains of different lengths, hence hierarchies of different depths to be padded
+        auto samples = []( int proc ) { return 40 + 25 * proc; };
+        auto sample = []( int proc, int i ) { return std::sin( 0.37 * i + proc ) + 0.1 * proc; };
+
+        auto obs = create( local_bins, 0.0, scalar_bin );
+        for ( auto i = 0; i < samples(rank); ++i ) { obs.log_binning().push( sample( rank, i ) ); }
+        Utils::MPI::reduce_log_binning( world, &obs );
+
+        Observable::LogBinning<double> reference;
+        reference.set_zero_element( 0.0 );
+        for ( auto proc = 0; proc < world.size(); ++proc ) {
+            Observable::LogBinning<double> chain;
+            chain.set_zero_element( 0.0 );
+            for ( auto i = 0; i < samples(proc); ++i ) { chain.push( sample( proc, i ) ); }
+            reference.merge( chain );
+        }
+
+        auto& reduced = obs.log_binning();
+        TestUtils::check( reduced.levels() == reference.levels(),
+                          ( boost::format("levels of the reduced binning ( %d of %d )") % reduced.levels() % reference.levels() ).str() + label );
+        double error = 0.0;
+        bool is_count_equal = true;
+        for ( auto level = 0; level < std::min( reduced.levels(), reference.levels() ); ++level ) {
+            is_count_equal = is_count_equal && ( reduced.count(level) == reference.count(level) );
+            error = std::max( { error, std::abs( reduced.sum(level) - reference.sum(level) ),
+                                       std::abs( reduced.sqsum(level) - reference.sqsum(level) ) } );
+        }
+        TestUtils::check( is_count_equal, "counts of the reduced binning" + label );
+        TestUtils::check_close( error, 1e-12, "sums of the reduced binning" + label );
+    }
+
+    return TestUtils::report();
+}
@@ -0,0 +1,140 @@
+/**
+  *  Unit test of the replica exchanges between two MPI processes, which should be run with two ranks.
+  *  With identical parameters of the replicas the swap is accepted, after which each process
+  *  holds the fields of its partner together with the greens functions rebuilt from scratch for them.
+  *  With very different onsite interactions the swap is rejected, and the fields,
+  *  the svd stacks and the greens functions saved before the trial are restored bit for bit.
+  */
+
+#include <vector>
+#include <boost/mpi.hpp>
+#include <boost/serialization/vector.hpp>
+#include "test_utils.h"
+#include "replica_exchange.h"
+
+
+int main( int argc, char* argv[] ) {
+
+    using Vector = Eigen::VectorXd;
+    using Matrix = Eigen::MatrixXd;
+
+    boost::mpi::environment env( argc, argv );
+    boost::mpi::communicator world;
+    if ( world.size() != 2 ) {
+        std::cerr << "test_mpi_replica_exchange: the test should be run with 2 processes." << std::endl;
+        return 1;
+    }
+
+    const std::string config_file = TestUtils::write_config( ( boost::format("test_mpi_replica_exchange_%d") % world.rank() ).str(), R"(
+        [Model]
+            type = "RepulsiveHubbard"
+            [Model.Params]
+            hopping_t = 1.0
+            onsite_u = 4.0
+            chemical_potential = -0.3
+        [Lattice]
+            type = "Square"
+            cell = [ 4, 4 ]
+            momentum = "MPoint"
+            momentum_list = "KstarsAll"
+        [MonteCarlo]
+            beta = 2.0
+            time_size = 20
+            stabilization_pace = 5
+        [Measure]
+            observables = [ "none" ]
+    )" );
+
+    // the modules of the replica, with distinct random fields on each process
+    auto create_modules = [&]( const QuantumMonteCarlo::ReplicaExchange& replica_exchange, TestUtils::Modules& modules ) {
+        modules.parse( config_file );
+        replica_exchange.set_replica_params( *modules.model, *modules.walker );
+        modules.initial( 12345 + world.rank() );
+    };
+
+    auto distance = []( const Matrix& a, const Matrix& b ) { return ( a - b ).norm() / b.norm(); };
+    const std::string label = ( boost::format(" on rank %d") % world.rank() ).str();
+
+
+    // -------------------------------  Accepted exchange of identical replicas  ---------------------------------
+    {
+        QuantumMonteCarlo::ReplicaExchange replica_exchange;
+        replica_exchange.set_params( QuantumMonteCarlo::ReplicaExchange::Parameter::OnSiteU, { 4.0, 4.0 }, 1 );
+        replica_exchange.initial( world );
+
+        TestUtils::Modules modules;
+        create_modules( replica_exchange, modules );
+        auto& walker = *modules.walker;
+        auto& model = *modules.model;
+        walker.sweep_from_0_to_beta( model );
+        walker.sweep_from_beta_to_0( model );
+
+        // fields of both processes before the exchange
+        const Vector own_fields = model.BosonicFields();
+        std::vector<std::vector<double>> fields;
+        boost::mpi::all_gather( world, std::vector<double>( own_fields.data(), own_fields.data() + own_fields.size() ), fields );
+        const Vector partner_fields = Eigen::Map<const Vector>( fields[1-world.rank()].data(), fields[1-world.rank()].size() );
+        TestUtils::check( partner_fields != own_fields, "distinct fields of the replicas before the exchange" + label );
+
+        replica_exchange.exchange( walker, model, *modules.lattice );
+        replica_exchange.gather_statistics( world );
+        TestUtils::check( replica_exchange.Attempts(0) == 1 && replica_exchange.Accepts(0) == 1,
+                          ( boost::format("exchange of identical replicas accepted ( %d of %d )")
+                            % replica_exchange.Accepts(0) % replica_exchange.Attempts(0) ).str() + label );
+        TestUtils::check( model.BosonicFields() == partner_fields, "fields of the partner taken over" + label );
+
+        // reference greens functions of the partner's fields, computed from scratch
+        TestUtils::Modules reference;
+        create_modules( replica_exchange, reference );
+        reference.model->set_bosonic_fields( partner_fields );
+        QuantumMonteCarlo::DqmcInitializer::initial_dqmc( *reference.model, *reference.lattice, *reference.walker, *reference.meas_handler );
+
+        TestUtils::check_close( distance( walker.GreenttUp(), reference.walker->GreenttUp() ), 1e-10,
+                                "greens function of spin up for the partner's fields" + label );
+        TestUtils::check_close( distance( walker.GreenttDn(), reference.walker->GreenttDn() ), 1e-10,
+                                "greens function of spin down for the partner's fields" + label );
+        TestUtils::check_close( std::abs( walker.LogFermionWeight() - reference.walker->LogFermionWeight() ), 1e-8,
+                                "fermion weight of the partner's fields" + label );
+        TestUtils::check( walker.ConfigSign() == reference.walker->ConfigSign(), "sign of the partner's fields" + label );
+    }
+
+
+    // -------------------------------  Rejected exchange of distant replicas  ---------------------------------
+    {
+        QuantumMonteCarlo::ReplicaExchange replica_exchange;
+        replica_exchange.set_params( QuantumMonteCarlo::ReplicaExchange::Parameter::OnSiteU, { 1.0, 8.0 }, 1 );
+        replica_exchange.initial( world );
+
+        TestUtils::Modules modules;
+        create_modules( replica_exchange, modules );
+        auto& walker = *modules.walker;
+        auto& model = *modules.model;
+        walker.sweep_from_0_to_beta( model );
+        walker.sweep_from_beta_to_0( model );
+
+        const Vector own_fields = model.BosonicFields();
+        const Matrix green_up = walker.GreenttUp();
+        const Matrix green_dn = walker.GreenttDn();
+        const double log_weight = walker.LogFermionWeight();
+        const double config_sign = walker.ConfigSign();
+
+        replica_exchange.exchange( walker, model, *modules.lattice );
+        replica_exchange.gather_statistics( world );
+        TestUtils::check( replica_exchange.Attempts(0) == 1 && replica_exchange.Accepts(0) == 0,
+                          ( boost::format("exchange of distant replicas rejected ( %d of %d )")
+                            % replica_exchange.Accepts(0) % replica_exchange.Attempts(0) ).str() + label );
+
+        // the saved state is swapped back instead of being recomputed, hence identical bit for bit
+        TestUtils::check( model.BosonicFields() == own_fields, "own fields restored" + label );
+        TestUtils::check( walker.GreenttUp() == green_up && walker.GreenttDn() == green_dn, "greens functions restored" + label );
+        TestUtils::check( walker.LogFermionWeight() == log_weight, "svd stacks restored" + label );
+        TestUtils::check( walker.ConfigSign() == config_sign, "sign restored" + label );
+
+        // the restored walker keeps sweeping as before
+        walker.sweep_from_0_to_beta( model );
+        walker.sweep_from_beta_to_0( model );
+        TestUtils::check( std::isfinite( walker.LogFermionWeight() ), "sweeps after the rejected exchange" + label );
+    }
+
+    return TestUtils::report();
+}
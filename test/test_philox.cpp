@@ -0,0 +1,55 @@
+/**
+  *  Unit test of the counter-based random number generator Utils::Philox.
+  *  The Philox4x32-10 bijection should reproduce the known-answer vectors of Random123 ( kat_vectors ),
+  *  and the generator should hand out the words of the blocks { n_low, n_high, stream, 0 } in order.
+  */
+
+#include <array>
+#include "test_utils.h"
+#include "random.h"
+
+
+int main() {
+
+    using Block = Utils::Philox::Block;
+    using Key = Utils::Philox::Key;
+
+    // -------------------------  Known-answer vectors of Random123  ----------------------------------
+    // counter, key and the expected output of philox4x32 with 10 rounds
+    const std::array<std::tuple<Block, Key, Block>, 3> kat_vectors {{
+        { { 0x00000000, 0x00000000, 0x00000000, 0x00000000 }, { 0x00000000, 0x00000000 },
+          { 0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8 } },
+        { { 0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff }, { 0xffffffff, 0xffffffff },
+          { 0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd } },
+        { { 0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344 }, { 0xa4093822, 0x299f31d0 },
+          { 0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1 } },
+    }};
+
+    for ( const auto& [counter, key, expected] : kat_vectors ) {
+        const Block result = Utils::Philox::philox4x32_10( counter, key );
+        TestUtils::check( result == expected, ( boost::format("philox4x32-10 of counter %08x %08x %08x %08x and key %08x %08x")
+                                     % counter[0] % counter[1] % counter[2] % counter[3] % key[0] % key[1] ).str() );
+    }
+
+
+    // --------------------------  Layout of the counters of the generator  -----------------------------
+    {
+        const std::uint32_t seed = 12345, rank = 3, stream = 7;
+        Utils::Philox rng( seed, rank, stream );
+        bool is_identical = true;
+        for ( std::uint64_t n = 0; n < 16; ++n ) {
+            const Block block = Utils::Philox::philox4x32_10( { (std::uint32_t)n, (std::uint32_t)(n >> 32), stream, 0 }, 
+                                                              { seed, rank } );
+            for ( const auto word : block ) { is_identical = is_identical && ( rng() == word ); }
+        }
+        TestUtils::check( is_identical && rng.BlockCounter() == 16, "random words handed out block by block in the counter order" );
+
+        // the generator with zero seed, rank and stream starts with the first known-answer vector
+        Utils::Philox zero_rng( 0, 0, 0 );
+        Block first{};
+        for ( auto& word : first ) { word = zero_rng(); }
+        TestUtils::check( first == std::get<2>( kat_vectors[0] ), "first block of the generator with zero key and stream" );
+    }
+
+    return TestUtils::report();
+}
@@ -0,0 +1,106 @@
+/**
+  *  Unit test of the column-pivoting QR decomposition (UDT) of the svd stacks.
+  *  The decomposition should reproduce rank-deficient matrices without infinities,
+  *  and the equal-time and time-displaced greens functions computed from the UDT stacks,
+  *  whose V factors are no longer orthogonal, should agree with those from the SVD stacks.
+  */
+
+#include <vector>
+#include "test_utils.h"
+#include "utils/linear_algebra.hpp"
+
+
+int main() {
+
+    using Matrix = Eigen::MatrixXd;
+    using Vector = Eigen::VectorXd;
+
+    // ------------------------------  Rank-deficient matrices  --------------------------------------
+    {
+        const int dim = 8;
+        Matrix mat = Matrix::Random(dim, dim);
+        mat.col(2).setZero();
+        mat.col(5).setZero();
+        mat.col(6) = mat.col(1);
+
+        Utils::QrpWorkspace workspace( dim );
+        Matrix u( dim, dim ), v( dim, dim );
+        Vector d( dim );
+        Utils::LinearAlgebra::mkl_lapack_dgeqp3( workspace, mat, u, d, v );
+
+        TestUtils::check( u.allFinite() && d.allFinite() && v.allFinite(),
+                          "finite UDT decomposition of a rank-deficient matrix" );
+        TestUtils::check_close( ( u * d.asDiagonal() * v.transpose() - mat ).cwiseAbs().maxCoeff(), 1e-12,
+                                "reconstruction of a rank-deficient matrix" );
+        TestUtils::check_close( ( u.transpose() * u - Matrix::Identity(dim, dim) ).cwiseAbs().maxCoeff(), 1e-12,
+                                "orthogonality of U" );
+    }
+
+
+    // ------------------------------  Greens functions at t = 0  -------------------------------------
+    const std::string config_file = TestUtils::write_config( "test_qrp_decomposition", R"(
+        [Model]
+            type = "RepulsiveHubbard"
+            [Model.Params]
+            hopping_t = 1.0
+            onsite_u = 6.0
+            chemical_potential = -0.5
+        [Lattice]
+            type = "Square"
+            cell = [ 4, 4 ]
+            momentum = "MPoint"
+            momentum_list = "KstarsAll"
+        [MonteCarlo]
+            beta = 8.0
+            time_size = 80
+            stabilization_pace = 10
+        [Measure]
+            observables = [ "greens_functions" ]
+    )" );
+
+    // time-displaced greens functions G(t,0) and G(0,t) of both spins at all the time slices,
+    // computed from the stacks at the stabilizations and wrapped in between
+    using GreensRecord = std::vector<std::array<Matrix, 4>>;
+    auto record_dynamic_greens = []( TestUtils::Modules& modules ) {
+        GreensRecord record{};
+        modules.walker->sweep_for_dynamic_greens( *modules.model,
+            [&]( int t, const Matrix&, const Matrix&, const Matrix& gt0_up, const Matrix& gt0_dn, 
+                 const Matrix& g0t_up, const Matrix& g0t_dn ) {
+                record.push_back( { gt0_up, gt0_dn, g0t_up, g0t_dn } );
+            });
+        return record;
+    };
+
+    TestUtils::Modules svd;
+    svd.parse( config_file );
+    svd.walker->set_stack_decomposition( Utils::Decomposition::SVD );
+    svd.initial( 12345 );
+    const GreensRecord svd_dynamic_greens = record_dynamic_greens( svd );
+
+    for ( const auto decomposition : { Utils::Decomposition::QRP, Utils::Decomposition::JacobiSVD } ) {
+        TestUtils::Modules udt;
+        udt.parse( config_file );
+        udt.walker->set_stack_decomposition( decomposition );
+        udt.initial( 12345 );
+
+        const std::string name( udt.walker->StackDecompositionName() );
+        TestUtils::check_close( ( udt.walker->GreenttUp() - svd.walker->GreenttUp() ).cwiseAbs().maxCoeff(), 1e-10,
+                                "spin-up greens function at t = 0 from the " + name + " stacks" );
+        TestUtils::check_close( ( udt.walker->GreenttDn() - svd.walker->GreenttDn() ).cwiseAbs().maxCoeff(), 1e-10,
+                                "spin-down greens function at t = 0 from the " + name + " stacks" );
+
+        const GreensRecord udt_dynamic_greens = record_dynamic_greens( udt );
+        double error = 0.0;
+        for ( auto t = 0; t < (int)svd_dynamic_greens.size(); ++t ) {
+            for ( auto i = 0; i < 4; ++i ) {
+                error = std::max( error, ( udt_dynamic_greens[t][i] - svd_dynamic_greens[t][i] ).cwiseAbs().maxCoeff() );
+            }
+        }
+        TestUtils::check( udt_dynamic_greens.size() == svd_dynamic_greens.size() && !svd_dynamic_greens.empty(),
+                          "time slices of the dynamic greens functions from the " + name + " stacks" );
+        // the round-off accumulated by the wraps between the stabilizations is of the size of the wrap error
+        TestUtils::check_close( error, 1e-8, "greens functions G(t,0) and G(0,t) from the " + name + " stacks" );
+    }
+
+    return TestUtils::report();
+}
@@ -0,0 +1,124 @@
+/**
+  *  Unit test of the multiplications of exp( -dt K ) by the checkerboard classes.
+  *  The truncated exp( -dt K ) of the sparse method should reproduce the dense products up to the threshold,
+  *  and the checkerboard breakups should agree with them up to the Trotter error of order dt^2,
+  *  while the left, right, inverse and transposed products of each method should be consistent to round-off.
+  */
+
+#include <array>
+#include <functional>
+#include "test_utils.h"
+#include "checkerboard/sparse.h"
+
+#define EIGEN_USE_MKL_ALL
+#define EIGEN_VECTORIZE_SSE4_2
+#include <unsupported/Eigen/MatrixFunctions>
+
+
+int main() {
+
+    using Matrix = Eigen::MatrixXd;
+
+    auto config = []( const std::string& lattice, const std::string& cell, const std::string& method, const std::string& mu ) {
+        return TestUtils::write_config( "test_sparse_checkerboard_" + lattice + "_" + method, R"(
+            [Model]
+                type = "RepulsiveHubbard"
+                [Model.Params]
+                hopping_t = 1.0
+                onsite_u = 4.0
+                chemical_potential = )" + mu + R"(
+            [Lattice]
+                type = ")" + lattice + R"("
+                cell = )" + cell + R"(
+                momentum = "MPoint"
+                momentum_list = "KstarsAll"
+            [CheckerBoard]
+                whether_or_not = true
+                method = ")" + method + R"("
+                sparse_threshold = 1e-12
+            [MonteCarlo]
+                beta = 4.0
+                time_size = 40
+                stabilization_pace = 10
+            [Measure]
+                observables = [ "none" ]
+        )" );
+    };
+
+    // the chemical potential enters the plaquettes of the breakups as a prefactor,
+    // whose sign is checked against K = - t * H + mu * I at nonzero mu.
+    // on the 4x4x4 cubic lattice the bond families of each direction commute,
+    // so that its breakups are exact, and the Trotter error of the breakups is only probed on the 6x6x6 lattice.
+    const std::array<std::array<std::string, 4>, 10> cases {{
+        { "Square", "[ 8, 8 ]", "sparse", "0.0" },      { "Square", "[ 8, 8 ]", "breakups", "0.0" },
+        { "Square", "[ 8, 8 ]", "sparse", "-0.5" },     { "Square", "[ 8, 8 ]", "breakups", "-0.5" },
+        { "Cubic", "[ 4, 4, 4 ]", "sparse", "0.0" },    { "Cubic", "[ 4, 4, 4 ]", "breakups", "0.0" },
+        { "Cubic", "[ 4, 4, 4 ]", "sparse", "-0.5" },   { "Cubic", "[ 4, 4, 4 ]", "breakups", "-0.5" },
+        { "Cubic", "[ 6, 6, 6 ]", "sparse", "-0.5" },   { "Cubic", "[ 6, 6, 6 ]", "breakups", "-0.5" },
+    }};
+
+    for ( const auto& [lattice, cell, method, mu] : cases ) {
+        TestUtils::Modules modules;
+        modules.parse( config( lattice, cell, method, mu ) );
+        modules.initial( 12345 );
+        const auto& checkerboard = *modules.checkerboard;
+
+        // dense reference exp( -dt K ) with K = - t * H + mu * I
+        const int space_size = modules.lattice->SpaceSize();
+        const double dt = modules.walker->TimeInterval();
+        const Matrix Kmat = -modules.model->HoppingT() * modules.lattice->HoppingMatrix()
+                          + modules.model->ChemicalPotential() * Matrix::Identity(space_size, space_size);
+        const Matrix expK = ( -dt * Kmat ).exp();
+        const Matrix inv_expK = ( +dt * Kmat ).exp();
+
+        // relative deviations of the products, which are exact up to the truncation for the sparse method,
+        // and up to the Trotter error of order dt^2 for the breakups
+        const double tolerance = ( method == "sparse" )? 1e-10 : 1.5 * dt * dt;
+        const std::string label = " by the " + method + " method on the " + cell + " " + lattice + " lattice at mu = " + mu;
+        if ( method == "sparse" ) {
+            const auto& sparse = dynamic_cast<const CheckerBoard::Sparse&>( checkerboard );
+            TestUtils::check_close( sparse.InverseError(), 1e-10, "inverse error of the truncated exp( -dt K )" + label );
+        }
+
+        const Matrix green = Matrix::Random( space_size, space_size );
+        const std::array<std::tuple<std::string, std::function<void(Matrix&)>, Matrix>, 5> products {{
+            { "expK * G",    [&]( Matrix& m ) { checkerboard.mult_expK_from_left(m); },        expK * green },
+            { "G * expK",    [&]( Matrix& m ) { checkerboard.mult_expK_from_right(m); },       green * expK },
+            { "expK^-1 * G", [&]( Matrix& m ) { checkerboard.mult_inv_expK_from_left(m); },    inv_expK * green },
+            { "G * expK^-1", [&]( Matrix& m ) { checkerboard.mult_inv_expK_from_right(m); },   green * inv_expK },
+            { "expK^T * G",  [&]( Matrix& m ) { checkerboard.mult_trans_expK_from_left(m); },  expK.transpose() * green },
+        }};
+
+        for ( const auto& [name, mult, reference] : products ) {
+            Matrix result = green;
+            mult( result );
+            TestUtils::check_close( ( result - reference ).norm() / reference.norm(), tolerance, name + label );
+        }
+
+        // the products of the approximate exp( -dt K ) should be consistent among themselves beyond the Trotter error,
+        // i.e. the left and right products and the transpose share one matrix B, and the inverse products invert it,
+        // which is sensitive to the order of the bond families in the breakups
+        Matrix breakup = Matrix::Identity( space_size, space_size );
+        checkerboard.mult_expK_from_right( breakup );
+        Matrix left = green, right = green, trans = green, round_trip_left = green, round_trip_right = green;
+        checkerboard.mult_expK_from_left( left );
+        checkerboard.mult_trans_expK_from_left( trans );
+        checkerboard.mult_expK_from_right( right );
+        checkerboard.mult_expK_from_left( round_trip_left );
+        checkerboard.mult_inv_expK_from_left( round_trip_left );
+        checkerboard.mult_expK_from_right( round_trip_right );
+        checkerboard.mult_inv_expK_from_right( round_trip_right );
+
+        const double consistency_tolerance = 1e-10;
+        TestUtils::check_close( ( left - breakup * green ).norm() / left.norm(), consistency_tolerance,
+                                "left and right products of one matrix" + label );
+        TestUtils::check_close( ( trans - breakup.transpose() * green ).norm() / trans.norm(), consistency_tolerance,
+                                "transpose of the right products" + label );
+        TestUtils::check_close( ( round_trip_left - green ).norm() / green.norm(), consistency_tolerance,
+                                "expK^-1 * expK * G = G" + label );
+        TestUtils::check_close( ( round_trip_right - green ).norm() / green.norm(), consistency_tolerance,
+                                "G * expK * expK^-1 = G" + label );
+    }
+
+    return TestUtils::report();
+}
@@ -0,0 +1,97 @@
+#ifndef TEST_UTILS_H
+#define TEST_UTILS_H
+#pragma once
+
+/**
+  *  This header file includes the helpers shared by the unit tests under test/,
+  *  each of which checks one module against its reference implementation
+  *  and returns a non-zero exit code if any check fails, so that it can be run by ctest.
+  */
+
+#include <memory>
+#include <string>
+#include <fstream>
+#include <iostream>
+#include <filesystem>
+#include <boost/format.hpp>
+
+#include "model/model_base.h"
+#include "lattice/lattice_base.h"
+#include "checkerboard/checkerboard_base.h"
+#include "measure/measure_handler.h"
+#include "dqmc_walker.h"
+#include "dqmc_initializer.h"
+#include "svd_stack.h"
+
+
+namespace TestUtils {
+
+    // number of failed checks of the current test
+    inline int failures = 0;
+
+    // record the result of one check
+    inline void check( bool is_passed, const std::string& message )
+    {
+        std::cout << ( is_passed? "[ PASSED ] " : "[ FAILED ] " ) << message << std::endl;
+        if ( !is_passed ) { ++failures; }
+    }
+
+    // check that the deviation from the reference is below the tolerance
+    inline void check_close( double error, double tolerance, const std::string& message )
+    {
+        check( error <= tolerance, ( boost::format("%s ( error %.3e, tolerance %.1e )")
+                                     % message % error % tolerance ).str() );
+    }
+
+    // exit code of the test
+    inline int report()
+    {
+        std::cout << ( ( failures == 0 )? ">> All checks passed." : ">> Some checks failed." ) << std::endl;
+        return ( failures == 0 )? 0 : 1;
+    }
+
+    // write the toml configuration into a file under the temporary folder, and return its path
+    inline std::string write_config( const std::string& name, const std::string& content )
+    {
+        const std::string file = ( std::filesystem::temp_directory_path() / ( name + ".toml" ) ).string();
+        std::ofstream outfile( file, std::ios::trunc );
+        outfile << content;
+        return file;
+    }
+
+
+    // ----------------------------------  Struct TestUtils::Modules  --------------------------------------
+    // the dqmc modules of one walker, created from the toml configuration
+    struct Modules {
+        std::unique_ptr<Model::ModelBase> model{};
+        std::unique_ptr<Lattice::LatticeBase> lattice{};
+        std::unique_ptr<QuantumMonteCarlo::DqmcWalker> walker{};
+        std::unique_ptr<Measure::MeasureHandler> meas_handler{};
+        std::unique_ptr<CheckerBoard::CheckerBoardBase> checkerboard{};
+
+        // parse the parameters from the configuration file
+        void parse( const std::string& config_file )
+        {
+            QuantumMonteCarlo::DqmcInitializer::parse_toml_config
+                ( config_file, 1, model, lattice, walker, meas_handler, checkerboard );
+        }
+
+        // initialize the modules with random fields generated by the engine keyed by the seed,
+        // hence the modules of the same seed start from identical configurations and random streams
+        void initial( unsigned seed )
+        {
+            if ( checkerboard ) {
+                QuantumMonteCarlo::DqmcInitializer::initial_modules( *model, *lattice, *walker, *meas_handler, *checkerboard );
+            }
+            else {
+                QuantumMonteCarlo::DqmcInitializer::initial_modules( *model, *lattice, *walker, *meas_handler );
+            }
+            walker->set_random_key( seed, 0 );
+            model->set_bosonic_fields_to_random( walker->RandomEngine() );
+            QuantumMonteCarlo::DqmcInitializer::initial_dqmc( *model, *lattice, *walker, *meas_handler );
+        }
+    };
+
+} // namespace TestUtils
+
+#endif // TEST_UTILS_H
@@ -0,0 +1,165 @@
+/**
+  *  Unit test of the walker pool, in which companion walkers run alongside the main walker of the process.
+  *  The samples and the logarithmic binning of a companion, merged into the main measure handler,
+  *  should equal the sums over both walkers, and a measurement with a pool of two walkers
+  *  should collect the samples of both into the bins of the main handler only.
+  */
+
+#include "test_utils.h"
+#include "dqmc.h"
+
+
+int main() {
+
+    const std::string config_file = TestUtils::write_config( "test_walker_pool", R"(
+        [Model]
+            type = "RepulsiveHubbard"
+            [Model.Params]
+            hopping_t = 1.0
+            onsite_u = 4.0
+            chemical_potential = -0.3
+        [Lattice]
+            type = "Square"
+            cell = [ 4, 4 ]
+            momentum = "MPoint"
+            momentum_list = "KstarsAll"
+        [MonteCarlo]
+            beta = 2.0
+            time_size = 20
+            stabilization_pace = 5
+            walkers = 2
+        [Measure]
+            sweeps_warmup = 0
+            bin_num = 3
+            bin_size = 4
+            sweeps_between_bins = 2
+            observables = [ "filling_number", "spin_density_structure_factor", "density_of_states", "greens_functions" ]
+    )" );
+
+    auto create_pool = [&]( TestUtils::Modules& modules, QuantumMonteCarlo::WalkerPool& walker_pool ) {
+        modules.parse( config_file );
+        modules.initial( 12345 );
+        QuantumMonteCarlo::DqmcInitializer::create_walker_pool
+            ( *modules.model, *modules.lattice, *modules.walker, *modules.meas_handler, walker_pool );
+        for ( auto i = 0; i < walker_pool.size(); ++i ) {
+            walker_pool.models[i]->set_bosonic_fields_to_random( walker_pool.walkers[i]->RandomEngine() );
+            QuantumMonteCarlo::DqmcInitializer::initial_dqmc
+                ( *walker_pool.models[i], *modules.lattice, *walker_pool.walkers[i], *walker_pool.meas_handlers[i] );
+        }
+    };
+
+
+    // ---------------------------  Merged samples equal the sums over both walkers  -----------------------------
+    {
+        TestUtils::Modules modules;
+        QuantumMonteCarlo::WalkerPool walker_pool;
+        create_pool( modules, walker_pool );
+        TestUtils::check( walker_pool.size() == 1, "one companion walker for a pool of two walkers" );
+
+        auto& main_handler = *modules.meas_handler;
+        auto& companion_handler = *walker_pool.meas_handlers[0];
+        const auto& lattice = *modules.lattice;
+
+        // one dynamic sweep and one equal-time sweep of each walker
+        for ( auto id = 0; id < 2; ++id ) {
+            auto& walker = ( id == 0 )? *modules.walker : *walker_pool.walkers[0];
+            auto& model = ( id == 0 )? *modules.model : *walker_pool.models[0];
+            auto& meas_handler = ( id == 0 )? main_handler : companion_handler;
+            walker.sweep_for_dynamic_greens( model );
+            meas_handler.dynamic_measure( walker, model, lattice );
+            walker.sweep_from_beta_to_0( model );
+            meas_handler.equaltime_measure( walker, model, lattice );
+        }
+        TestUtils::check( modules.walker->ConfigSign() != walker_pool.walkers[0]->ConfigSign()
+                          || modules.model->BosonicFields() != walker_pool.models[0]->BosonicFields(),
+                          "the walkers sample independent configurations" );
+
+        // observables before the merge, which are copies of those in the handlers
+        const auto main_scalar = main_handler.find<Observable::ScalarObs>("filling_number");
+        const auto companion_scalar = companion_handler.find<Observable::ScalarObs>("filling_number");
+        const auto main_sdw = main_handler.find<Observable::ScalarObs>("spin_density_structure_factor");
+        const auto companion_sdw = companion_handler.find<Observable::ScalarObs>("spin_density_structure_factor");
+        const auto main_vector = main_handler.find<Observable::VectorObs>("density_of_states");
+        const auto companion_vector = companion_handler.find<Observable::VectorObs>("density_of_states");
+        const auto main_matrix = main_handler.find<Observable::MatrixObs>("greens_functions");
+        const auto companion_matrix = companion_handler.find<Observable::MatrixObs>("greens_functions");
+        const auto main_sign = main_handler.find<Observable::ScalarObs>("equaltime_sign");
+        const auto companion_sign = companion_handler.find<Observable::ScalarObs>("equaltime_sign");
+
+        main_handler.merge_temporary( companion_handler );
+        main_handler.merge_log_binning( companion_handler );
+
+        auto check_merged = [&]( const std::string& name, auto merged, auto main_obs, auto companion_obs ) {
+            TestUtils::check( merged.counts() == main_obs.counts() + companion_obs.counts(),
+                              ( boost::format("merged counts of %s ( %d = %d + %d )") % name
+                                % merged.counts() % main_obs.counts() % companion_obs.counts() ).str() );
+            const auto expected = main_obs.tmp_value() + companion_obs.tmp_value();
+            if constexpr ( std::is_same_v<std::decay_t<decltype(expected)>, double> ) {
+                TestUtils::check_close( std::abs( merged.tmp_value() - expected ), 1e-12, "merged samples of " + name );
+            }
+            else {
+                TestUtils::check_close( ( merged.tmp_value() - expected ).norm(), 1e-12, "merged samples of " + name );
+            }
+
+            // the logarithmic binning of the single measurement steps of both chains
+            auto& merged_binning = merged.log_binning();
+            auto& main_binning = main_obs.log_binning();
+            auto& companion_binning = companion_obs.log_binning();
+            TestUtils::check( main_binning.count(0) == 1.0 && companion_binning.count(0) == 1.0
+                              && merged_binning.count(0) == 2.0, "merged logarithmic binning of " + name );
+            const auto expected_sum = main_binning.sum(0) + companion_binning.sum(0);
+            if constexpr ( std::is_same_v<std::decay_t<decltype(expected_sum)>, double> ) {
+                TestUtils::check_close( std::abs( merged_binning.sum(0) - expected_sum ), 1e-12, "merged binning sums of " + name );
+            }
+            else {
+                TestUtils::check_close( ( merged_binning.sum(0) - expected_sum ).norm(), 1e-12, "merged binning sums of " + name );
+            }
+        };
+
+        check_merged( "filling_number", main_handler.find<Observable::ScalarObs>("filling_number"), main_scalar, companion_scalar );
+        check_merged( "spin_density_structure_factor", main_handler.find<Observable::ScalarObs>("spin_density_structure_factor"),
+                      main_sdw, companion_sdw );
+        check_merged( "density_of_states", main_handler.find<Observable::VectorObs>("density_of_states"), main_vector, companion_vector );
+        check_merged( "greens_functions", main_handler.find<Observable::MatrixObs>("greens_functions"), main_matrix, companion_matrix );
+        check_merged( "equaltime_sign", main_handler.find<Observable::ScalarObs>("equaltime_sign"), main_sign, companion_sign );
+    }
+
+
+    // -----------------------------------  Measurement with a pool of two walkers  ------------------------------------
+    {
+        TestUtils::Modules modules;
+        QuantumMonteCarlo::WalkerPool walker_pool;
+        create_pool( modules, walker_pool );
+        QuantumMonteCarlo::Dqmc::show_progress_bar( false );
+        QuantumMonteCarlo::Dqmc::measure( *modules.walker, *modules.model, *modules.lattice, *modules.meas_handler, &walker_pool );
+
+        auto& main_handler = *modules.meas_handler;
+        auto& companion_handler = *walker_pool.meas_handlers[0];
+        const int bin_num = main_handler.BinsNum();
+        const int sweeps_per_bin = main_handler.BinsSize() / 2;
+
+        // the companion only accumulates temporary samples, which are cleared once merged at the bin boundaries
+        auto main_obs = main_handler.find<Observable::ScalarObs>("filling_number");
+        const auto companion_obs = companion_handler.find<Observable::ScalarObs>("filling_number");
+        TestUtils::check( companion_obs.bin_num() == 0 && companion_obs.bin_data().empty(), "no bins are allocated for the companion" );
+        TestUtils::check( companion_obs.counts() == 0, "samples of the companion are cleared after the merge" );
+        TestUtils::check( main_obs.bin_num() == bin_num, "bins are collected by the main handler" );
+
+        bool is_filled = true;
+        for ( auto bin = 0; bin < bin_num; ++bin ) { is_filled = is_filled && ( main_obs.bin_data(bin) > 0.0 ); }
+        TestUtils::check( is_filled, "all the bins of the main handler are filled" );
+
+        // one equal-time and one dynamic measurement per sweep forth and back of each walker,
+        // all of which enter the logarithmic binning of the main handler
+        const int expected = 2 * bin_num * sweeps_per_bin;
+        TestUtils::check( (int)main_obs.log_binning().count(0) == expected,
+                          ( boost::format("equal-time measurements of both walkers in the logarithmic binning ( %d of %d )")
+                            % main_obs.log_binning().count(0) % expected ).str() );
+        auto dynamic_obs = main_handler.find<Observable::VectorObs>("density_of_states");
+        TestUtils::check( (int)dynamic_obs.log_binning().count(0) == expected,
+                          ( boost::format("dynamic measurements of both walkers in the logarithmic binning ( %d of %d )")
+                            % dynamic_obs.log_binning().count(0) % expected ).str() );
+    }
+
+    return TestUtils::report();
+}